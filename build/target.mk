@@ -32,6 +32,14 @@ SERIAL_BOOT=$(BINDIR)/serial_boot
 MKFS=$(BINDIR)/mkfs
 
 CFLAGS=-O3 -I$(TOPDIR)/software/libs/libc/include -I$(TOPDIR)/software/libs/libos
+
+# Set ISA_EXTENSIONS=1 to build the libraries with instructions that the
+# hardware and emulator support but the released toolchain can't assemble
+# yet (atomic_*, dwait, dtouch, pause, ...). Otherwise they use portable code.
+ifeq ($(ISA_EXTENSIONS),1)
+CFLAGS+=-DNYUZI_ISA_EXTENSIONS=1
+endif
+
 LDFLAGS=-L$(TOPDIR)/software/libs/libc/ -L$(TOPDIR)/software/libs/libos -L$(TOPDIR)/software/libs/librender
 
 define SRCS_TO_OBJS
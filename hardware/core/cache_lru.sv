@@ -39,6 +39,19 @@
 // fills back to back. It also avoids livelock where two threads evict each
 // other's lines back and forth.
 //
+// If the client also asserts access_update_demote, the line is not expected
+// to be used again soon (for example, it was just flushed), so it is not
+// moved to the MRU position. With RRIP, it becomes the next line replaced.
+//
+// If CACHE_RRIP is defined, this uses static re-reference interval
+// prediction instead of pseudo-LRU. Each way has a two bit re-reference
+// prediction value (RRPV), where 3 means it is not expected to be used again
+// soon. A fill replaces the first way with an RRPV of 3. If there isn't one,
+// all ways in the set are aged until there is. Filled lines start at 2 and
+// move to 0 when they are accessed. Lines that are only used once, like
+// those touched when clearing or copying a buffer, are replaced before lines
+// that are used repeatedly, where LRU would evict the whole working set.
+//
 
 module cache_lru
 	#(parameter NUM_SETS = 1,
@@ -58,13 +71,20 @@ module cache_lru
 	input                                 access_en,
 	input [SET_INDEX_WIDTH - 1:0]         access_set,
 	input                                 access_update_en,
-	input [WAY_INDEX_WIDTH - 1:0]         access_update_way);
+	input [WAY_INDEX_WIDTH - 1:0]         access_update_way,
+	input                                 access_update_demote);
 
+`ifdef CACHE_RRIP
+	localparam LRU_FLAG_BITS = NUM_WAYS * 2;
+	localparam RRPV_INSERT = 2'd2;
+	localparam RRPV_DISTANT = 2'd3;
+`else
 	localparam LRU_FLAG_BITS =
 		NUM_WAYS == 1 ? 1 :
 		NUM_WAYS == 2 ? 1 :
 		NUM_WAYS == 4 ? 3 :
 		7;	// NUM_WAYS = 8
+`endif
 
 	logic[LRU_FLAG_BITS - 1:0] lru_flags;
 	logic update_lru_en;
@@ -81,7 +101,11 @@ module cache_lru
 	assign read_en = access_en || fill_en;
 	assign read_set = fill_en ? fill_set : access_set;
 	assign new_mru = was_fill ? fill_way : access_update_way;
+`ifdef CACHE_RRIP
 	assign update_lru_en = was_fill || access_update_en;
+`else
+	assign update_lru_en = was_fill || (access_update_en && !access_update_demote);
+`endif
 
 	// This uses a pseudo-LRU algorithm
 	// The current state of each set is represented by 3 bits. Imagine a tree:
@@ -113,6 +137,53 @@ module cache_lru
 		.write_data(update_flags),
 		.*);
 
+`ifdef CACHE_RRIP
+	logic[1:0] rrpv[NUM_WAYS];
+	logic[1:0] max_rrpv;
+
+	genvar rrpv_way;
+	generate
+		for (rrpv_way = 0; rrpv_way < NUM_WAYS; rrpv_way++)
+		begin : rrpv_gen
+			assign rrpv[rrpv_way] = lru_flags[rrpv_way * 2+:2];
+		end
+	endgenerate
+
+	// The fill way is the first with the highest RRPV. Rather than
+	// incrementing every way one step at a time until one reaches 3, add
+	// the difference all at once.
+	always_comb
+	begin
+		fill_way = 0;
+		max_rrpv = rrpv[0];
+		for (int way = 1; way < NUM_WAYS; way++)
+		begin
+			if (rrpv[way] > max_rrpv)
+			begin
+				fill_way = WAY_INDEX_WIDTH'(way);
+				max_rrpv = rrpv[way];
+			end
+		end
+	end
+
+	always_comb
+	begin
+		for (int way = 0; way < NUM_WAYS; way++)
+		begin
+			if (was_fill)
+			begin
+				if (fill_way == WAY_INDEX_WIDTH'(way))
+					update_flags[way * 2+:2] = RRPV_INSERT;
+				else
+					update_flags[way * 2+:2] = rrpv[way] + (RRPV_DISTANT - max_rrpv);
+			end
+			else if (access_update_way == WAY_INDEX_WIDTH'(way))
+				update_flags[way * 2+:2] = access_update_demote ? RRPV_DISTANT : 2'd0;
+			else
+				update_flags[way * 2+:2] = rrpv[way];
+		end
+	end
+`else
 	generate
 		case (NUM_WAYS)
 			1:
@@ -172,14 +243,14 @@ module cache_lru
 				always_comb
 				begin
 					case (new_mru)
-						3'd0: update_flags = {2'b11, lru_flags[5], 1'b1, lru_flags[2:0]};
-						3'd1: update_flags = {2'b01, lru_flags[5], 1'b1, lru_flags[2:0]};
+						3'd0: update_flags = {2'b11, lru_flags[4], 1'b1, lru_flags[2:0]};
+						3'd1: update_flags = {2'b01, lru_flags[4], 1'b1, lru_flags[2:0]};
 						3'd2: update_flags = {lru_flags[6], 3'b011, lru_flags[2:0]};
 						3'd3: update_flags = {lru_flags[6], 3'b001, lru_flags[2:0]};
 						3'd4: update_flags = {lru_flags[6:4], 3'b011, lru_flags[0]};
 						3'd5: update_flags = {lru_flags[6:4], 3'b010, lru_flags[0]};
-						3'd6: update_flags = {lru_flags[6:4], 2'b00, lru_flags[1], 1'b1};
-						3'd7: update_flags = {lru_flags[6:4], 2'b00, lru_flags[1], 1'b0};
+						3'd6: update_flags = {lru_flags[6:4], 1'b0, lru_flags[2], 2'b01};
+						3'd7: update_flags = {lru_flags[6:4], 1'b0, lru_flags[2], 2'b00};
 						default: update_flags = '0;
 					endcase
 				end
@@ -195,6 +266,7 @@ module cache_lru
 			end
 		endcase
 	endgenerate
+`endif
 
 	always_ff @(posedge clk, posedge reset)
 	begin
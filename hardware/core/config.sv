@@ -21,17 +21,50 @@
 // Configurable parameters
 // - Number of cache ways must be 1, 2, 4, or 8 (TLB_WAYS does not have
 //   this limitation)
-// - If you change the number of L2 ways, you must also modify the
-//   flush_l2_cache function in testbench/verilator_tb.sv. Comments above
-//   that function describe how and why.
 // - NUM_CORES must be 1-8. To synthesize more cores, increase CORE_ID_WIDTH
 //   in defines.sv.
 // - The size of a cache is sets * ways * cache line size (64 bytes)
+// - L2_BANKS splits the L2 cache into independent banks that can each
+//   process a request every cycle. Consecutive cache lines map to different
+//   banks. L2_SETS is the total for all banks. L2_BANKS must be a power of
+//   two and less than L2_SETS.
 // - L1D_SETS sets must be 64 or fewer if virtual address translation is
 //   enabled.
+// - If HAS_STRIDE_PREFETCHER is defined, each core detects constant stride
+//   L1 data cache miss streams and fetches lines STRIDE_PREFETCH_DISTANCE
+//   strides ahead into the L2 cache. It is off by default.
+// - AXI_DATA_WIDTH may be 32, 64, 128, or 256. The boot ROM and SDRAM
+//   controller convert to their native widths. The other FPGA peripherals
+//   (axi_sram, vga_controller) only support 32.
+// - L2_REQUEST_QUEUE_LENGTH and L2_MAX_OUTSTANDING_READS must be powers of
+//   two and at least 4. The first limits how many L2 misses and writebacks
+//   can wait to be sent to system memory, the second how many reads can be
+//   in progress on the AXI bus. Each L2 bank has its own queues.
+// - STORE_COMBINE_CYCLES is how long a store waits in the store queue for
+//   later stores to the same cache line to combine with it. Setting it to
+//   0 sends stores as soon as possible.
+// - WAIT_TIMEOUT_CYCLES is the longest a thread stays suspended by a dwait
+//   instruction if the cache line it is waiting on isn't written.
+// - If CACHE_RRIP is defined, the L1 and L2 caches use static re-reference
+//   interval prediction to pick lines to replace, which keeps the working
+//   set when data is streamed through the cache. Otherwise they use
+//   pseudo-LRU. See cache_lru.sv.
+// - Parameters wrapped in ifndef can be overridden when building the
+//   Verilator model, for example: make CONFIG_DEFINES="AXI_DATA_WIDTH=128".
+//   The test_configs target in tests/Makefile uses this to test other
+//   configurations.
+// - PAUSE_CYCLES is how long a thread that executes a pause instruction
+//   (spin loop hint) yields the pipeline to threads that haven't. It must
+//   be at least 1.
+// - If THREAD_SELECT_GTO is defined, thread_select_stage keeps issuing
+//   from the same thread until it stalls, then switches to the thread that
+//   has waited longest (greedy-then-oldest). Otherwise threads of the same
+//   priority issue round robin.
 //
 
+`ifndef NUM_CORES
 `define NUM_CORES 1
+`endif
 `define THREADS_PER_CORE 4
 `define L1D_WAYS 4
 `define L1D_SETS 64		// 16k
@@ -39,10 +72,24 @@
 `define L1I_SETS 64		// 16k
 `define L2_WAYS 8
 `define L2_SETS 256		// 128k
+`ifndef L2_BANKS
+`define L2_BANKS 1
+`endif
+`ifndef AXI_DATA_WIDTH
 `define AXI_DATA_WIDTH 32
+`endif
+`define L2_REQUEST_QUEUE_LENGTH 8
+`define L2_MAX_OUTSTANDING_READS 4
 `define HAS_MMU 1
 `define ITLB_ENTRIES 64
 `define DTLB_ENTRIES 64
 `define TLB_WAYS 4
+// `define HAS_STRIDE_PREFETCHER 1
+`define STRIDE_PREFETCH_DISTANCE 4
+`define STORE_COMBINE_CYCLES 8
+`define WAIT_TIMEOUT_CYCLES 1024
+// `define CACHE_RRIP 1
+`define PAUSE_CYCLES 32
+// `define THREAD_SELECT_GTO 1
 
 `endif
@@ -42,7 +42,8 @@ module core
 	input iorsp_packet_t                   ia_response,
 
 	// Performance events
-	output logic [`CORE_PERF_EVENTS - 1:0] core_perf_events);
+	output logic [`CORE_PERF_EVENTS - 1:0] core_perf_events,
+	output logic [`THREADS_PER_CORE - 1:0][`CORE_PERF_EVENTS - 1:0] core_perf_thread_events);
 
 	// XXX for some reason, AUTOLOGIC doesn't generate these.
 	// Should figure out why.
@@ -52,12 +53,14 @@ module core
 	scalar_t cr_fault_handler;
 	scalar_t cr_tlb_miss_handler;
 	subcycle_t cr_eret_subcycle[`THREADS_PER_CORE];
+	thread_idx_t retire_thread_idx;
 
 	/*AUTOLOGIC*/
 	// Beginning of automatic wires (for undeclared instantiated-module outputs)
 	logic [`ASID_WIDTH-1:0] cr_current_asid [`THREADS_PER_CORE];// From control_registers of control_registers.v
 	logic		cr_mmu_en [`THREADS_PER_CORE];// From control_registers of control_registers.v
 	logic		cr_supervisor_en [`THREADS_PER_CORE];// From control_registers of control_registers.v
+	thread_priority_t cr_thread_priority [`THREADS_PER_CORE];// From control_registers of control_registers.v
 	logic		dd_alignment_fault;	// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_cache_miss;		// From dcache_data_stage of dcache_data_stage.v
 	scalar_t	dd_cache_miss_addr;	// From dcache_data_stage of dcache_data_stage.v
@@ -81,16 +84,29 @@ module core
 	vector_lane_mask_t dd_lane_mask;	// From dcache_data_stage of dcache_data_stage.v
 	cache_line_data_t dd_load_data;		// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_membar_en;		// From dcache_data_stage of dcache_data_stage.v
+	scalar_t	dd_prefetch_addr;	// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_prefetch_en;		// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_privilege_op_fault;	// From dcache_data_stage of dcache_data_stage.v
 	l1d_addr_t	dd_request_vaddr;	// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_rollback_en;		// From dcache_data_stage of dcache_data_stage.v
 	scalar_t	dd_rollback_pc;		// From dcache_data_stage of dcache_data_stage.v
+	logic [$clog2(`CACHE_LINE_WORDS)-1:0] dd_sample_data_lane [`SAMPLE_TEXELS];// From dcache_data_stage of dcache_data_stage.v
+	sample_texel_mask_t dd_sample_texels_read;// From dcache_data_stage of dcache_data_stage.v
+	logic [16:0]	dd_sample_weight [`SAMPLE_TEXELS];// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_scgath_coalesce_en;	// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_scgath_complete;	// From dcache_data_stage of dcache_data_stage.v
+	logic [$clog2(`CACHE_LINE_WORDS)-1:0] dd_scgath_data_lane [`VECTOR_LANES];// From dcache_data_stage of dcache_data_stage.v
+	vector_lane_mask_t dd_scgath_lane_mask;	// From dcache_data_stage of dcache_data_stage.v
+	subcycle_t	dd_scgath_resume_subcycle;// From dcache_data_stage of dcache_data_stage.v
 	scalar_t	dd_store_addr;		// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_store_atomic;	// From dcache_data_stage of dcache_data_stage.v
+	atomic_op_t	dd_store_atomic_op;	// From dcache_data_stage of dcache_data_stage.v
 	scalar_t	dd_store_bypass_addr;	// From dcache_data_stage of dcache_data_stage.v
 	thread_idx_t	dd_store_bypass_thread_idx;// From dcache_data_stage of dcache_data_stage.v
 	cache_line_data_t dd_store_data;	// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_store_en;		// From dcache_data_stage of dcache_data_stage.v
 	logic [`CACHE_LINE_BYTES-1:0] dd_store_mask;// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_store_no_allocate;	// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_store_synchronized;	// From dcache_data_stage of dcache_data_stage.v
 	thread_idx_t	dd_store_thread_idx;	// From dcache_data_stage of dcache_data_stage.v
 	subcycle_t	dd_subcycle;		// From dcache_data_stage of dcache_data_stage.v
@@ -98,8 +114,10 @@ module core
 	logic		dd_suspend_thread;	// From dcache_data_stage of dcache_data_stage.v
 	thread_idx_t	dd_thread_idx;		// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_tlb_miss;		// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_update_lru_demote;	// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_update_lru_en;	// From dcache_data_stage of dcache_data_stage.v
 	l1d_way_idx_t	dd_update_lru_way;	// From dcache_data_stage of dcache_data_stage.v
+	logic		dd_wait_en;		// From dcache_data_stage of dcache_data_stage.v
 	logic		dd_write_fault;		// From dcache_data_stage of dcache_data_stage.v
 	l1d_way_idx_t	dt_fill_lru;		// From dcache_tag_stage of dcache_tag_stage.v
 	decoded_instruction_t dt_instruction;	// From dcache_tag_stage of dcache_tag_stage.v
@@ -110,6 +128,12 @@ module core
 	vector_lane_mask_t dt_mask_value;	// From dcache_tag_stage of dcache_tag_stage.v
 	l1d_addr_t	dt_request_paddr;	// From dcache_tag_stage of dcache_tag_stage.v
 	l1d_addr_t	dt_request_vaddr;	// From dcache_tag_stage of dcache_tag_stage.v
+	logic [$clog2(`CACHE_LINE_WORDS)-1:0] dt_sample_data_lane [`SAMPLE_TEXELS];// From dcache_tag_stage of dcache_tag_stage.v
+	logic [7:0]	dt_sample_frac_u;	// From dcache_tag_stage of dcache_tag_stage.v
+	logic [7:0]	dt_sample_frac_v;	// From dcache_tag_stage of dcache_tag_stage.v
+	sample_texel_mask_t dt_sample_same_line;// From dcache_tag_stage of dcache_tag_stage.v
+	logic [$clog2(`CACHE_LINE_WORDS)-1:0] dt_scgath_data_lane [`VECTOR_LANES];// From dcache_tag_stage of dcache_tag_stage.v
+	vector_lane_mask_t dt_scgath_same_line;	// From dcache_tag_stage of dcache_tag_stage.v
 	l1d_tag_t	dt_snoop_tag [`L1D_WAYS];// From dcache_tag_stage of dcache_tag_stage.v
 	logic		dt_snoop_valid [`L1D_WAYS];// From dcache_tag_stage of dcache_tag_stage.v
 	vector_t	dt_store_value;		// From dcache_tag_stage of dcache_tag_stage.v
@@ -122,10 +146,18 @@ module core
 	logic		dt_update_itlb_en;	// From dcache_tag_stage of dcache_tag_stage.v
 	logic		dt_update_itlb_global;	// From dcache_tag_stage of dcache_tag_stage.v
 	page_index_t	dt_update_itlb_ppage_idx;// From dcache_tag_stage of dcache_tag_stage.v
+	logic		dt_update_itlb_superpage;// From dcache_tag_stage of dcache_tag_stage.v
 	logic		dt_update_itlb_supervisor;// From dcache_tag_stage of dcache_tag_stage.v
 	logic		dt_valid [`L1D_WAYS];	// From dcache_tag_stage of dcache_tag_stage.v
 	logic [`VECTOR_LANES-1:0] [7:0] fx1_add_exponent;// From fp_execute_stage1 of fp_execute_stage1.v
 	logic [`VECTOR_LANES-1:0] fx1_add_result_sign;// From fp_execute_stage1 of fp_execute_stage1.v
+	logic [`VECTOR_LANES-1:0] [23:0] fx1_fma_addend_significand;// From fp_execute_stage1 of fp_execute_stage1.v
+	logic [`VECTOR_LANES-1:0] [6:0] fx1_fma_addend_shift;// From fp_execute_stage1 of fp_execute_stage1.v
+	logic [`VECTOR_LANES-1:0] fx1_fma_addend_sign;// From fp_execute_stage1 of fp_execute_stage1.v
+	logic [`VECTOR_LANES-1:0] fx1_fma_bypass;// From fp_execute_stage1 of fp_execute_stage1.v
+	scalar_t [`VECTOR_LANES-1:0] fx1_fma_bypass_value;// From fp_execute_stage1 of fp_execute_stage1.v
+	logic [`VECTOR_LANES-1:0] [9:0] fx1_fma_exponent;// From fp_execute_stage1 of fp_execute_stage1.v
+	logic [`VECTOR_LANES-1:0] fx1_fma_subtract;// From fp_execute_stage1 of fp_execute_stage1.v
 	logic [`VECTOR_LANES-1:0] [5:0] fx1_ftoi_lshift;// From fp_execute_stage1 of fp_execute_stage1.v
 	decoded_instruction_t fx1_instruction;	// From fp_execute_stage1 of fp_execute_stage1.v
 	logic		fx1_instruction_valid;	// From fp_execute_stage1 of fp_execute_stage1.v
@@ -144,6 +176,12 @@ module core
 	thread_idx_t	fx1_thread_idx;		// From fp_execute_stage1 of fp_execute_stage1.v
 	logic [`VECTOR_LANES-1:0] [7:0] fx2_add_exponent;// From fp_execute_stage2 of fp_execute_stage2.v
 	logic [`VECTOR_LANES-1:0] fx2_add_result_sign;// From fp_execute_stage2 of fp_execute_stage2.v
+	logic [`VECTOR_LANES-1:0] [75:0] fx2_fma_addend;// From fp_execute_stage2 of fp_execute_stage2.v
+	logic [`VECTOR_LANES-1:0] fx2_fma_addend_sign;// From fp_execute_stage2 of fp_execute_stage2.v
+	logic [`VECTOR_LANES-1:0] fx2_fma_bypass;// From fp_execute_stage2 of fp_execute_stage2.v
+	scalar_t [`VECTOR_LANES-1:0] fx2_fma_bypass_value;// From fp_execute_stage2 of fp_execute_stage2.v
+	logic [`VECTOR_LANES-1:0] [9:0] fx2_fma_exponent;// From fp_execute_stage2 of fp_execute_stage2.v
+	logic [`VECTOR_LANES-1:0] fx2_fma_subtract;// From fp_execute_stage2 of fp_execute_stage2.v
 	logic [`VECTOR_LANES-1:0] [5:0] fx2_ftoi_lshift;// From fp_execute_stage2 of fp_execute_stage2.v
 	logic [`VECTOR_LANES-1:0] fx2_guard;	// From fp_execute_stage2 of fp_execute_stage2.v
 	decoded_instruction_t fx2_instruction;	// From fp_execute_stage2 of fp_execute_stage2.v
@@ -164,6 +202,11 @@ module core
 	logic [`VECTOR_LANES-1:0] [7:0] fx3_add_exponent;// From fp_execute_stage3 of fp_execute_stage3.v
 	logic [`VECTOR_LANES-1:0] fx3_add_result_sign;// From fp_execute_stage3 of fp_execute_stage3.v
 	scalar_t [`VECTOR_LANES-1:0] fx3_add_significand;// From fp_execute_stage3 of fp_execute_stage3.v
+	logic [`VECTOR_LANES-1:0] fx3_fma_bypass;// From fp_execute_stage3 of fp_execute_stage3.v
+	scalar_t [`VECTOR_LANES-1:0] fx3_fma_bypass_value;// From fp_execute_stage3 of fp_execute_stage3.v
+	logic [`VECTOR_LANES-1:0] [9:0] fx3_fma_exponent;// From fp_execute_stage3 of fp_execute_stage3.v
+	logic [`VECTOR_LANES-1:0] fx3_fma_sign;// From fp_execute_stage3 of fp_execute_stage3.v
+	logic [`VECTOR_LANES-1:0] [75:0] fx3_fma_sum;// From fp_execute_stage3 of fp_execute_stage3.v
 	logic [`VECTOR_LANES-1:0] [5:0] fx3_ftoi_lshift;// From fp_execute_stage3 of fp_execute_stage3.v
 	decoded_instruction_t fx3_instruction;	// From fp_execute_stage3 of fp_execute_stage3.v
 	logic		fx3_instruction_valid;	// From fp_execute_stage3 of fp_execute_stage3.v
@@ -179,6 +222,12 @@ module core
 	logic [`VECTOR_LANES-1:0] [7:0] fx4_add_exponent;// From fp_execute_stage4 of fp_execute_stage4.v
 	logic [`VECTOR_LANES-1:0] fx4_add_result_sign;// From fp_execute_stage4 of fp_execute_stage4.v
 	logic [`VECTOR_LANES-1:0] [31:0] fx4_add_significand;// From fp_execute_stage4 of fp_execute_stage4.v
+	logic [`VECTOR_LANES-1:0] fx4_fma_bypass;// From fp_execute_stage4 of fp_execute_stage4.v
+	scalar_t [`VECTOR_LANES-1:0] fx4_fma_bypass_value;// From fp_execute_stage4 of fp_execute_stage4.v
+	logic [`VECTOR_LANES-1:0] [9:0] fx4_fma_exponent;// From fp_execute_stage4 of fp_execute_stage4.v
+	logic [`VECTOR_LANES-1:0] [6:0] fx4_fma_norm_shift;// From fp_execute_stage4 of fp_execute_stage4.v
+	logic [`VECTOR_LANES-1:0] fx4_fma_sign;// From fp_execute_stage4 of fp_execute_stage4.v
+	logic [`VECTOR_LANES-1:0] [75:0] fx4_fma_sum;// From fp_execute_stage4 of fp_execute_stage4.v
 	decoded_instruction_t fx4_instruction;	// From fp_execute_stage4 of fp_execute_stage4.v
 	logic		fx4_instruction_valid;	// From fp_execute_stage4 of fp_execute_stage4.v
 	logic [`VECTOR_LANES-1:0] fx4_logical_subtract;// From fp_execute_stage4 of fp_execute_stage4.v
@@ -197,6 +246,9 @@ module core
 	vector_t	fx5_result;		// From fp_execute_stage5 of fp_execute_stage5.v
 	subcycle_t	fx5_subcycle;		// From fp_execute_stage5 of fp_execute_stage5.v
 	thread_idx_t	fx5_thread_idx;		// From fp_execute_stage5 of fp_execute_stage5.v
+	logic		id_branch_predict_en;	// From instruction_decode_stage of instruction_decode_stage.v
+	scalar_t	id_branch_predict_pc;	// From instruction_decode_stage of instruction_decode_stage.v
+	thread_idx_t	id_branch_predict_thread_idx;// From instruction_decode_stage of instruction_decode_stage.v
 	decoded_instruction_t id_instruction;	// From instruction_decode_stage of instruction_decode_stage.v
 	logic		id_instruction_valid;	// From instruction_decode_stage of instruction_decode_stage.v
 	thread_idx_t	id_thread_idx;		// From instruction_decode_stage of instruction_decode_stage.v
@@ -267,17 +319,32 @@ module core
 	vector_t	of_store_value;		// From operand_fetch_stage of operand_fetch_stage.v
 	subcycle_t	of_subcycle;		// From operand_fetch_stage of operand_fetch_stage.v
 	thread_idx_t	of_thread_idx;		// From operand_fetch_stage of operand_fetch_stage.v
+	logic		perf_branch_mispredict;	// From writeback_stage of writeback_stage.v
 	logic		perf_dcache_hit;	// From dcache_data_stage of dcache_data_stage.v
 	logic		perf_dcache_miss;	// From dcache_data_stage of dcache_data_stage.v
 	logic		perf_dtlb_miss;		// From dcache_data_stage of dcache_data_stage.v
 	logic		perf_icache_hit;	// From ifetch_data_stage of ifetch_data_stage.v
 	logic		perf_icache_miss;	// From ifetch_data_stage of ifetch_data_stage.v
-	logic		perf_instruction_issue;	// From thread_select_stage of thread_select_stage.v
+	thread_bitmap_t	perf_instruction_issue;	// From thread_select_stage of thread_select_stage.v
 	logic		perf_instruction_retire;// From writeback_stage of writeback_stage.v
 	logic		perf_itlb_miss;		// From ifetch_data_stage of ifetch_data_stage.v
+	logic		perf_prefetch_late;	// From l1_l2_interface of l1_l2_interface.v
+	logic		perf_prefetch_useful;	// From l1_l2_interface of l1_l2_interface.v
+	logic		perf_rollback_branch;	// From writeback_stage of writeback_stage.v
+	logic		perf_rollback_dcache_miss;// From writeback_stage of writeback_stage.v
+	logic		perf_rollback_sync;	// From writeback_stage of writeback_stage.v
+	logic		perf_scgath_access;	// From dcache_data_stage of dcache_data_stage.v
+	thread_bitmap_t	perf_stall_dcache;	// From thread_select_stage of thread_select_stage.v
+	thread_bitmap_t	perf_stall_icache;	// From thread_select_stage of thread_select_stage.v
+	thread_bitmap_t	perf_stall_raw;		// From thread_select_stage of thread_select_stage.v
+	thread_bitmap_t	perf_stall_schedule;	// From thread_select_stage of thread_select_stage.v
+	thread_bitmap_t	perf_stall_store_queue;	// From thread_select_stage of thread_select_stage.v
+	thread_bitmap_t	perf_stall_writeback_conflict;// From thread_select_stage of thread_select_stage.v
 	logic		perf_store;		// From dcache_data_stage of dcache_data_stage.v
+	logic		perf_store_combined;	// From l1_l2_interface of l1_l2_interface.v
 	logic		perf_store_rollback;	// From writeback_stage of writeback_stage.v
 	logic		sq_rollback_en;		// From l1_l2_interface of l1_l2_interface.v
+	scalar_t	sq_store_atomic_value;	// From l1_l2_interface of l1_l2_interface.v
 	cache_line_data_t sq_store_bypass_data;	// From l1_l2_interface of l1_l2_interface.v
 	logic [`CACHE_LINE_BYTES-1:0] sq_store_bypass_mask;// From l1_l2_interface of l1_l2_interface.v
 	logic		sq_store_sync_success;	// From l1_l2_interface of l1_l2_interface.v
@@ -297,6 +364,9 @@ module core
 	pipeline_sel_t	wb_rollback_pipeline;	// From writeback_stage of writeback_stage.v
 	subcycle_t	wb_rollback_subcycle;	// From writeback_stage of writeback_stage.v
 	thread_idx_t	wb_rollback_thread_idx;	// From writeback_stage of writeback_stage.v
+	subcycle_t	wb_sample_subcycle [`THREADS_PER_CORE];// From writeback_stage of writeback_stage.v
+	sample_texel_mask_t wb_sample_texels_read [`THREADS_PER_CORE];// From writeback_stage of writeback_stage.v
+	vector_lane_mask_t wb_scgath_done_mask [`THREADS_PER_CORE];// From writeback_stage of writeback_stage.v
 	thread_bitmap_t	wb_suspend_thread_oh;	// From writeback_stage of writeback_stage.v
 	logic		wb_writeback_en;	// From writeback_stage of writeback_stage.v
 	logic		wb_writeback_is_last_subcycle;// From writeback_stage of writeback_stage.v
@@ -329,18 +399,65 @@ module core
 	l1_l2_interface #(.CORE_ID(CORE_ID)) l1_l2_interface(.*);
 	io_request_queue #(.CORE_ID(CORE_ID)) io_request_queue(.*);
 
-	assign core_perf_events = {
-		perf_dtlb_miss,
-		perf_dcache_hit,
-		perf_dcache_miss,
-		perf_itlb_miss,
-		perf_icache_hit,
-		perf_icache_miss,
-		perf_instruction_issue,
-		perf_instruction_retire,
-		perf_store,
-		perf_store_rollback
-	};
+	//
+	// Performance events. Each event is tagged with the thread that caused it
+	// so performance counters can be filtered by thread. Stall events may be
+	// asserted for several threads in the same cycle.
+	//
+	assign retire_thread_idx = fx5_instruction_valid ? fx5_thread_idx
+		: (ix_instruction_valid ? ix_thread_idx : dd_thread_idx);
+
+	genvar perf_thread_idx;
+	generate
+		for (perf_thread_idx = 0; perf_thread_idx < `THREADS_PER_CORE; perf_thread_idx++)
+		begin : perf_thread_gen
+			logic is_rollback_thread;
+			logic is_dt_thread;
+			logic is_ift_thread;
+			logic[`CORE_PERF_EVENTS - 1:0] thread_events;
+
+			assign is_rollback_thread = wb_rollback_thread_idx == thread_idx_t'(perf_thread_idx);
+			assign is_dt_thread = dt_thread_idx == thread_idx_t'(perf_thread_idx);
+			assign is_ift_thread = ift_thread_idx == thread_idx_t'(perf_thread_idx);
+
+			always_comb
+			begin
+				thread_events[CORE_PERF_STORE_ROLLBACK] = perf_store_rollback && dd_thread_idx == thread_idx_t'(perf_thread_idx);
+				thread_events[CORE_PERF_STORE] = perf_store && is_dt_thread;
+				thread_events[CORE_PERF_INSTRUCTION_RETIRE] = perf_instruction_retire && retire_thread_idx == thread_idx_t'(perf_thread_idx);
+				thread_events[CORE_PERF_INSTRUCTION_ISSUE] = perf_instruction_issue[perf_thread_idx];
+				thread_events[CORE_PERF_ICACHE_MISS] = perf_icache_miss && is_ift_thread;
+				thread_events[CORE_PERF_ICACHE_HIT] = perf_icache_hit && is_ift_thread;
+				thread_events[CORE_PERF_ITLB_MISS] = perf_itlb_miss && is_ift_thread;
+				thread_events[CORE_PERF_DCACHE_MISS] = perf_dcache_miss && is_dt_thread;
+				thread_events[CORE_PERF_DCACHE_HIT] = perf_dcache_hit && is_dt_thread;
+				thread_events[CORE_PERF_DTLB_MISS] = perf_dtlb_miss && is_dt_thread;
+				thread_events[CORE_PERF_STALL_ICACHE] = perf_stall_icache[perf_thread_idx];
+				thread_events[CORE_PERF_STALL_DCACHE] = perf_stall_dcache[perf_thread_idx];
+				thread_events[CORE_PERF_STALL_STORE_QUEUE] = perf_stall_store_queue[perf_thread_idx];
+				thread_events[CORE_PERF_STALL_RAW] = perf_stall_raw[perf_thread_idx];
+				thread_events[CORE_PERF_STALL_WRITEBACK_CONFLICT] = perf_stall_writeback_conflict[perf_thread_idx];
+				thread_events[CORE_PERF_ROLLBACK_BRANCH] = perf_rollback_branch && is_rollback_thread;
+				thread_events[CORE_PERF_ROLLBACK_DCACHE_MISS] = perf_rollback_dcache_miss && is_rollback_thread;
+				thread_events[CORE_PERF_ROLLBACK_SYNC] = perf_rollback_sync && is_rollback_thread;
+				thread_events[CORE_PERF_PREFETCH_USEFUL] = perf_prefetch_useful && is_dt_thread;
+				thread_events[CORE_PERF_PREFETCH_LATE] = perf_prefetch_late && is_dt_thread;
+				thread_events[CORE_PERF_BRANCH_MISPREDICT] = perf_branch_mispredict && is_rollback_thread;
+				thread_events[CORE_PERF_STORE_COMBINED] = perf_store_combined && is_dt_thread;
+				thread_events[CORE_PERF_SCGATH_ACCESS] = perf_scgath_access && is_dt_thread;
+				thread_events[CORE_PERF_STALL_SCHEDULE] = perf_stall_schedule[perf_thread_idx];
+			end
+
+			assign core_perf_thread_events[perf_thread_idx] = thread_events;
+		end
+	endgenerate
+
+	always_comb
+	begin
+		core_perf_events = '0;
+		for (int i = 0; i < `THREADS_PER_CORE; i++)
+			core_perf_events |= core_perf_thread_events[i];
+	end
 endmodule
 
 // Local Variables:
@@ -22,6 +22,10 @@
 //   stage.
 // - Reads from cache data storage.
 // - Drives signals to previous stage to update LRU
+// - For a texture sample, finds which of the lane's texels are in this
+//   cache line. If any are left after this, rolls the thread back to the
+//   same subcycle to read the next line. Otherwise the writeback stage
+//   filters the texels and writes the lane.
 //
 
 module dcache_data_stage(
@@ -42,10 +46,17 @@ module dcache_data_stage(
 	input                                     dt_valid[`L1D_WAYS],
 	input l1d_tag_t                           dt_tag[`L1D_WAYS],
 	input                                     dt_tlb_supervisor,
+	input vector_lane_mask_t                  dt_scgath_same_line,
+	input [$clog2(`CACHE_LINE_WORDS) - 1:0]   dt_scgath_data_lane[`VECTOR_LANES],
+	input sample_texel_mask_t                 dt_sample_same_line,
+	input [$clog2(`CACHE_LINE_WORDS) - 1:0]   dt_sample_data_lane[`SAMPLE_TEXELS],
+	input [7:0]                               dt_sample_frac_u,
+	input [7:0]                               dt_sample_frac_v,
 
 	// To dcache_tag_stage
 	output logic                              dd_update_lru_en,
 	output l1d_way_idx_t                      dd_update_lru_way,
+	output logic                              dd_update_lru_demote,
 
 	// To io_request_queue
 	output                                    dd_io_write_en,
@@ -71,6 +82,14 @@ module dcache_data_stage(
 	output logic                              dd_tlb_miss,
 	output logic                              dd_supervisor_fault,
 	output logic                              dd_privilege_op_fault,
+	output logic                              dd_scgath_coalesce_en,
+	output vector_lane_mask_t                 dd_scgath_lane_mask,
+	output logic[$clog2(`CACHE_LINE_WORDS) - 1:0] dd_scgath_data_lane[`VECTOR_LANES],
+	output subcycle_t                         dd_scgath_resume_subcycle,
+	output logic                              dd_scgath_complete,
+	output sample_texel_mask_t                dd_sample_texels_read,
+	output logic[$clog2(`CACHE_LINE_WORDS) - 1:0] dd_sample_data_lane[`SAMPLE_TEXELS],
+	output logic[16:0]                        dd_sample_weight[`SAMPLE_TEXELS],
 
 	// From control registers
 	input logic                               cr_supervisor_en[`THREADS_PER_CORE],
@@ -101,11 +120,17 @@ module dcache_data_stage(
 	output logic                              dd_membar_en,
 	output logic                              dd_iinvalidate_en,
 	output logic                              dd_dinvalidate_en,
+	output logic                              dd_prefetch_en,
+	output logic                              dd_wait_en,
+	output scalar_t                           dd_prefetch_addr,
 	output [`CACHE_LINE_BYTES - 1:0]          dd_store_mask,
 	output scalar_t                           dd_store_addr,
 	output cache_line_data_t                  dd_store_data,
 	output thread_idx_t                       dd_store_thread_idx,
 	output logic                              dd_store_synchronized,
+	output logic                              dd_store_no_allocate,
+	output logic                              dd_store_atomic,
+	output atomic_op_t                        dd_store_atomic_op,
 	output scalar_t                           dd_store_bypass_addr,
 	output thread_idx_t                       dd_store_bypass_thread_idx,
 
@@ -114,12 +139,26 @@ module dcache_data_stage(
 	input logic                               wb_rollback_en,
 	input thread_idx_t                        wb_rollback_thread_idx,
 	input pipeline_sel_t                      wb_rollback_pipeline,
+	input vector_lane_mask_t                  wb_scgath_done_mask[`THREADS_PER_CORE],
+	input sample_texel_mask_t                 wb_sample_texels_read[`THREADS_PER_CORE],
+	input subcycle_t                          wb_sample_subcycle[`THREADS_PER_CORE],
 
 	// Performance counters
 	output logic                              perf_dcache_hit,
 	output logic                              perf_dcache_miss,
 	output logic                              perf_store,
-	output logic                              perf_dtlb_miss);
+	output logic                              perf_dtlb_miss,
+	output logic                              perf_scgath_access);
+
+	// A scatter/gather subcycle also services all later lanes that use the
+	// same cache line, then rolls the thread forward to the first lane it
+	// didn't service. The rollback squashes subcycles that were already
+	// issued, so only do this if at least this many of the remaining subcycles
+	// (including this one) won't need a cache access. The emulator uses the
+	// same value.
+	localparam SCGATH_COALESCE_MIN_LANES = 5;
+
+	typedef logic[$clog2(`VECTOR_LANES):0] scgath_count_t;
 
 	logic dcache_access_en;
 	logic creg_access_en;
@@ -143,11 +182,33 @@ module dcache_data_stage(
 	logic io_access_en;
 	logic is_unaligned;
 	logic is_synchronized;
+	logic is_atomic;
 	logic cache_control_en;
+	logic is_dtouch;
 	logic[$clog2(`VECTOR_LANES) - 1:0] scgath_lane;
 	logic is_tlb_access;
 	logic is_tlb_update;
 	logic supervisor_fault;
+	logic is_scgath;
+	logic scgath_lane_active;
+	vector_lane_mask_t scgath_done;
+	vector_lane_mask_t scgath_active_mask;
+	vector_lane_mask_t scgath_pending;
+	scgath_count_t scgath_pending_count;
+	scgath_count_t scgath_resume;
+	vector_lane_mask_t scgath_lane_mask;
+	logic scgath_run_en;
+	logic scgath_coalesce_en;
+	logic[`CACHE_LINE_WORDS - 1:0] scgath_word_mask;
+	cache_line_data_t scgath_store_data;
+	logic is_sample;
+	logic sample_lane_active;
+	logic sample_access_en;
+	logic sample_retry;
+	sample_texel_mask_t sample_texels_read;
+	sample_texel_mask_t sample_texels_new;
+	logic[8:0] sample_weight_u[2];
+	logic[8:0] sample_weight_v[2];
 
 	// Unlike earlier stages, this commits instruction side effects like stores,
 	// so it needs to check if there is a rollback (which would be for the
@@ -159,6 +220,10 @@ module dcache_data_stage(
 		&& wb_rollback_pipeline == PIPE_MEM;
 	assign is_io_address = dt_request_paddr ==? 32'hffff????;
 	assign is_synchronized = dt_instruction.memory_access_type == MEM_SYNC;
+	assign is_atomic = dt_instruction.memory_access_type == MEM_ATOMIC;
+	assign is_sample = dt_instruction.is_memory_access
+		&& dt_instruction.memory_access_type == MEM_SAMPLE;
+	assign sample_lane_active = (dt_mask_value & subcycle_mask) != 0;
 
 	// Determine if this instruction accesses the TLB (and thus will raise a TLB
 	// miss if the entry is not present)
@@ -168,13 +233,17 @@ module dcache_data_stage(
 		if (dt_instruction_valid && !rollback_this_stage)
 		begin
 			if (dt_instruction.is_memory_access)
-				is_tlb_access = dt_instruction.memory_access_type != MEM_CONTROL_REG;
+			begin
+				is_tlb_access = dt_instruction.memory_access_type != MEM_CONTROL_REG
+					&& (!is_sample || sample_lane_active);
+			end
 			else if (dt_instruction.is_cache_control)
 			begin
 				// Only these cache control opertions perform a virtual->physical
 				// address translation.
 				is_tlb_access = dt_instruction.cache_control_op == CACHE_DFLUSH
-					|| dt_instruction.cache_control_op == CACHE_DINVALIDATE;
+					|| dt_instruction.cache_control_op == CACHE_DINVALIDATE
+					|| dt_instruction.cache_control_op == CACHE_DWAIT;
 			end
 		end
 	end
@@ -186,7 +255,8 @@ module dcache_data_stage(
 		&& dt_instruction.is_memory_access
 		&& dt_instruction.memory_access_type != MEM_CONTROL_REG
 		&& dt_tlb_hit
-		&& !is_io_address;
+		&& !is_io_address
+		&& (!is_sample || sample_lane_active);
 	assign dcache_load_en = dcache_access_en && dt_instruction.is_load;
 	assign dcache_store_en = dcache_access_en && !dt_instruction.is_load
 		&& dd_store_mask != 0;
@@ -196,7 +266,13 @@ module dcache_data_stage(
 	assign dd_store_bypass_addr = dt_request_paddr;
 	assign dd_store_bypass_thread_idx = dt_thread_idx;
 	assign dd_store_addr = dt_request_paddr;
-	assign dd_store_synchronized = is_synchronized;
+
+	// An atomic operation waits for a response from the L2 cache like a
+	// synchronized store does.
+	assign dd_store_synchronized = is_synchronized || is_atomic;
+	assign dd_store_atomic = is_atomic;
+	assign dd_store_atomic_op = dt_instruction.atomic_op;
+	assign dd_store_no_allocate = dt_instruction.memory_access_type == MEM_BLOCK_NA;
 	assign dd_store_en = dcache_store_en
 		&& !is_unaligned
 		&& dt_tlb_writable
@@ -209,7 +285,8 @@ module dcache_data_stage(
 		&& dt_instruction.is_memory_access
 		&& dt_instruction.memory_access_type != MEM_CONTROL_REG
 		&& dt_tlb_hit
-		&& is_io_address;
+		&& is_io_address
+		&& !is_sample;
 	assign dd_io_write_en = io_access_en
 		&& !dt_instruction.is_load
 		&& !supervisor_fault
@@ -238,6 +315,25 @@ module dcache_data_stage(
 		&& !is_io_address;
 	assign dd_membar_en = cache_control_en
 		&& dt_instruction.cache_control_op == CACHE_MEMBAR;
+
+	// A software prefetch is only a hint, so it never faults. If the page isn't
+	// mapped or accessible, or the line is already in the L1 cache, it does
+	// nothing. It doesn't count as a TLB access for that reason.
+	assign is_dtouch = cache_control_en
+		&& dt_instruction.cache_control_op == CACHE_DTOUCH;
+	assign dd_prefetch_en = is_dtouch
+		&& dt_tlb_hit
+		&& !supervisor_fault
+		&& !is_io_address
+		&& !(|way_hit_oh);
+	assign dd_prefetch_addr = dcache_request_addr;
+
+	// dwait suspends the thread until l1_wait_monitor wakes it up. It is
+	// rolled back to the next instruction, so it doesn't run again.
+	assign dd_wait_en = cache_control_en
+		&& dt_instruction.cache_control_op == CACHE_DWAIT
+		&& dt_tlb_hit
+		&& !is_io_address;
 	assign is_tlb_update = cache_control_en
 		&& (dt_instruction.cache_control_op == CACHE_DTLB_INSERT
 			|| dt_instruction.cache_control_op == CACHE_ITLB_INSERT
@@ -260,6 +356,8 @@ module dcache_data_stage(
 	assign perf_dcache_miss = !cache_hit && dt_tlb_hit && dcache_load_en;
 	assign perf_store = dcache_store_en;
 	assign perf_dtlb_miss = is_tlb_access && !dt_tlb_hit;
+	assign perf_scgath_access = is_scgath && scgath_lane_active
+		&& ((dcache_load_en && cache_hit) || dcache_store_en);
 
 	//
 	// Check for cache hit
@@ -293,12 +391,14 @@ module dcache_data_stage(
 	begin
 		word_store_mask = 0;
 		case (dt_instruction.memory_access_type)
-			MEM_BLOCK, MEM_BLOCK_M:	// Block vector access
+			MEM_BLOCK, MEM_BLOCK_M, MEM_BLOCK_NA:	// Block vector access
 				word_store_mask = dt_mask_value;
 
 			MEM_SCGATH, MEM_SCGATH_M:	// Scatter/Gather access
 			begin
-				if ((dt_mask_value & subcycle_mask) != 0)
+				if (scgath_run_en)
+					word_store_mask = scgath_word_mask;
+				else if (scgath_lane_active)
 					word_store_mask = cache_lane_mask;
 				else
 					word_store_mask = 0;
@@ -324,6 +424,109 @@ module dcache_data_stage(
 	assign scgath_lane = ~dt_subcycle;
 	assign lane_store_value = dt_store_value[scgath_lane];
 
+	//
+	// Scatter/gather coalescing
+	//
+	assign is_scgath = dt_instruction.is_memory_access
+		&& (dt_instruction.memory_access_type == MEM_SCGATH
+		|| dt_instruction.memory_access_type == MEM_SCGATH_M);
+
+	// Lanes that an earlier subcycle of this instruction already serviced are
+	// treated as if they were masked off. The first subcycle starts over,
+	// because the mask may be left over from a previous instruction.
+	assign scgath_done = is_scgath && dt_subcycle != 0
+		? wb_scgath_done_mask[dt_thread_idx] : vector_lane_mask_t'(0);
+	assign scgath_active_mask = dt_mask_value & ~scgath_done;
+	assign scgath_lane_active = (scgath_active_mask & subcycle_mask) != 0;
+
+	// Split the active lanes for this and later subcycles into the ones in
+	// the same cache line as this lane, which this access can service, and
+	// the ones still pending after it (including unaligned lanes, so they fault
+	// on their own subcycle). Combine the lanes into one store. If more than
+	// one lane writes the same word, the one with the later subcycle wins, as
+	// it would if they were stored one at a time.
+	always_comb
+	begin
+		scgath_lane_mask = 0;
+		scgath_pending = 0;
+		scgath_word_mask = 0;
+		scgath_store_data = 0;
+		for (int i = 0; i < `VECTOR_LANES; i++)
+		begin
+			if (scgath_count_t'(i) >= {1'b0, dt_subcycle}
+				&& scgath_active_mask[`VECTOR_LANES - 1 - i])
+			begin
+				if (scgath_count_t'(i) == {1'b0, dt_subcycle}
+					|| dt_scgath_same_line[`VECTOR_LANES - 1 - i])
+				begin
+					scgath_lane_mask[`VECTOR_LANES - 1 - i] = 1;
+					scgath_word_mask[dt_scgath_data_lane[`VECTOR_LANES - 1 - i]] = 1;
+					scgath_store_data[dt_scgath_data_lane[`VECTOR_LANES - 1 - i] * 32+:32] = {
+						dt_store_value[`VECTOR_LANES - 1 - i][7:0],
+						dt_store_value[`VECTOR_LANES - 1 - i][15:8],
+						dt_store_value[`VECTOR_LANES - 1 - i][23:16],
+						dt_store_value[`VECTOR_LANES - 1 - i][31:24]
+					};
+				end
+				else
+					scgath_pending[`VECTOR_LANES - 1 - i] = 1;
+			end
+		end
+	end
+
+	// The thread resumes at the first pending subcycle.
+	always_comb
+	begin
+		scgath_resume = scgath_count_t'(`VECTOR_LANES);
+		scgath_pending_count = 0;
+		for (int i = `VECTOR_LANES - 1; i >= 0; i--)
+		begin
+			if (scgath_pending[`VECTOR_LANES - 1 - i])
+			begin
+				scgath_resume = scgath_count_t'(i);
+				scgath_pending_count = scgath_pending_count + 1'b1;
+			end
+		end
+	end
+
+	assign scgath_run_en = is_scgath
+		&& scgath_lane_active
+		&& scgath_count_t'(`VECTOR_LANES) - {1'b0, dt_subcycle} - scgath_pending_count
+		>= scgath_count_t'(SCGATH_COALESCE_MIN_LANES);
+
+	// Only skip ahead if the access completes. If it misses the cache or
+	// faults, this subcycle will be retried and can coalesce then.
+	assign scgath_coalesce_en = scgath_run_en
+		&& !is_unaligned
+		&& ((dcache_load_en && cache_hit && !supervisor_fault) || dd_store_en);
+
+	//
+	// Texture sample
+	// Texels that an earlier subcycle read are only valid if it was for the
+	// same lane. This reads all of the others that are in this cache line.
+	// If the line doesn't finish the lane, retry the subcycle to read the
+	// next one. This doesn't suspend the thread.
+	//
+	assign sample_texels_read = wb_sample_subcycle[dt_thread_idx] == dt_subcycle
+		? wb_sample_texels_read[dt_thread_idx] : sample_texel_mask_t'(0);
+	assign sample_access_en = is_sample
+		&& dcache_load_en
+		&& cache_hit
+		&& !is_unaligned
+		&& !supervisor_fault;
+	assign sample_texels_new = sample_access_en
+		? dt_sample_same_line & ~sample_texels_read : sample_texel_mask_t'(0);
+	assign sample_retry = sample_access_en
+		&& (sample_texels_read | dt_sample_same_line) != {`SAMPLE_TEXELS{1'b1}};
+
+	// Bilinear filter weights. Each texel is weighted by the fractional
+	// distance of the sample position from the opposite texels, with 8 bits
+	// of precision. The four weights add up to 65536.
+	assign sample_weight_u[0] = 9'd256 - {1'b0, dt_sample_frac_u};
+	assign sample_weight_u[1] = {1'b0, dt_sample_frac_u};
+	assign sample_weight_v[0] = 9'd256 - {1'b0, dt_sample_frac_v};
+	assign sample_weight_v[1] = {1'b0, dt_sample_frac_v};
+
 	// byte_store_mask and dd_store_data.
 	always_comb
 	begin
@@ -349,7 +552,7 @@ module dcache_data_stage(
 					byte_store_mask = 4'b0011;
 			end
 
-			MEM_L, MEM_SYNC: // 32 bits
+			MEM_L, MEM_SYNC, MEM_ATOMIC: // 32 bits
 			begin
 				byte_store_mask = 4'b1111;
 				dd_store_data = {`CACHE_LINE_WORDS{dt_store_value[0][7:0], dt_store_value[0][15:8],
@@ -359,8 +562,13 @@ module dcache_data_stage(
 			MEM_SCGATH, MEM_SCGATH_M:
 			begin
 				byte_store_mask = 4'b1111;
-				dd_store_data = {`CACHE_LINE_WORDS{lane_store_value[7:0], lane_store_value[15:8],
-					lane_store_value[23:16], lane_store_value[31:24]}};
+				if (scgath_run_en)
+					dd_store_data = scgath_store_data;
+				else
+				begin
+					dd_store_data = {`CACHE_LINE_WORDS{lane_store_value[7:0], lane_store_value[15:8],
+						lane_store_value[23:16], lane_store_value[31:24]}};
+				end
 			end
 
 			default: // Vector
@@ -376,8 +584,8 @@ module dcache_data_stage(
 	begin
 		case (dt_instruction.memory_access_type)
 			MEM_S, MEM_SX: is_unaligned = dt_request_paddr.offset[0];
-			MEM_L, MEM_SYNC, MEM_SCGATH, MEM_SCGATH_M: is_unaligned = |dt_request_paddr.offset[1:0];
-			MEM_BLOCK, MEM_BLOCK_M: is_unaligned = dt_request_paddr.offset != 0;
+			MEM_L, MEM_SYNC, MEM_ATOMIC, MEM_SCGATH, MEM_SCGATH_M, MEM_SAMPLE: is_unaligned = |dt_request_paddr.offset[1:0];
+			MEM_BLOCK, MEM_BLOCK_M, MEM_BLOCK_NA: is_unaligned = dt_request_paddr.offset != 0;
 			default: is_unaligned = 0;
 		endcase
 	end
@@ -441,6 +649,10 @@ module dcache_data_stage(
 	assign dd_update_lru_en = cache_hit && dcache_access_en && !is_unaligned;
 	assign dd_update_lru_way = way_hit_idx;
 
+	// A block store that doesn't allocate is streaming through a buffer, so
+	// this line won't be needed again soon.
+	assign dd_update_lru_demote = dd_store_no_allocate;
+
 	// Always treat the first synchronized load as a cache miss, even if data is
 	// present. This is to register request with L2 cache. The second request will
 	// not be a miss if the data is in the cache (there is a window where it could
@@ -472,6 +684,14 @@ module dcache_data_stage(
 		end
 	endgenerate
 
+	always_ff @(posedge clk)
+	begin
+		dd_scgath_data_lane <= dt_scgath_data_lane;
+		dd_sample_data_lane <= dt_sample_data_lane;
+		for (int i = 0; i < `SAMPLE_TEXELS; i++)
+			dd_sample_weight[i] <= {8'd0, sample_weight_u[i % 2]} * {8'd0, sample_weight_v[i / 2]};
+	end
+
 	always_ff @(posedge clk, posedge reset)
 	begin
 		if (reset)
@@ -487,6 +707,11 @@ module dcache_data_stage(
 			dd_request_vaddr <= '0;
 			dd_rollback_en <= '0;
 			dd_rollback_pc <= '0;
+			dd_sample_texels_read <= '0;
+			dd_scgath_coalesce_en <= '0;
+			dd_scgath_complete <= '0;
+			dd_scgath_lane_mask <= '0;
+			dd_scgath_resume_subcycle <= '0;
 			dd_subcycle <= '0;
 			dd_supervisor_fault <= '0;
 			dd_suspend_thread <= '0;
@@ -503,29 +728,38 @@ module dcache_data_stage(
 			// Make sure this decodes only one type of instruction
 			assert($onehot0({dcache_load_en, dcache_store_en, dd_io_write_en, dd_io_read_en,
 				dd_flush_en, dd_iinvalidate_en, dd_dinvalidate_en, dd_membar_en,
-				dd_creg_write_en, dd_creg_read_en}));
+				dd_prefetch_en, dd_wait_en, dd_creg_write_en, dd_creg_read_en}));
 
 			dd_instruction_valid <= dt_instruction_valid && !rollback_this_stage;
 			dd_instruction <= dt_instruction;
-			dd_lane_mask <= dt_mask_value;
+			dd_lane_mask <= scgath_active_mask;
 			dd_thread_idx <= dt_thread_idx;
 			dd_request_vaddr <= dt_request_vaddr;
 			dd_subcycle <= dt_subcycle;
-			dd_rollback_pc <= dt_instruction.pc;
+			dd_rollback_pc <= dd_wait_en ? dt_instruction.pc + 32'd4 : dt_instruction.pc;
 			dd_is_io_address <= is_io_address;
+			dd_scgath_coalesce_en <= scgath_coalesce_en;
+			dd_sample_texels_read <= sample_texels_new;
+			dd_scgath_lane_mask <= scgath_lane_mask;
+			dd_scgath_resume_subcycle <= subcycle_t'(scgath_resume);
+			dd_scgath_complete <= scgath_resume == scgath_count_t'(`VECTOR_LANES);
 
-			// Rollback on cache miss
-			dd_rollback_en <= dcache_load_en && !cache_hit && dt_tlb_hit;
+			// Rollback on cache miss, wait, or a texture sample that needs
+			// another cache line
+			dd_rollback_en <= (dcache_load_en && !cache_hit && dt_tlb_hit) || dd_wait_en
+				|| sample_retry;
 
 			// Suspend the thread if there is a cache miss.
 			// In the near miss case (described above), don't suspend thread.
-			dd_suspend_thread <= dcache_load_en
+			dd_suspend_thread <= (dcache_load_en
 				&& dt_tlb_hit
 				&& !cache_hit
 				&& !cache_near_miss
-				&& !is_unaligned;
+				&& !is_unaligned)
+				|| dd_wait_en;
 			dd_alignment_fault <= (dcache_load_en || dcache_store_en) && is_unaligned;
-			dd_supervisor_fault <= supervisor_fault;
+			dd_supervisor_fault <= supervisor_fault && !is_dtouch
+				&& (!is_sample || sample_lane_active);
 			dd_privilege_op_fault <= !cr_supervisor_en[dt_thread_idx]
 				&& ((creg_access_en && !dt_instruction.is_load)
 				|| is_tlb_update);
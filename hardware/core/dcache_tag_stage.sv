@@ -28,6 +28,11 @@
 // virtually indexed and physically tagged: the tag memories contain physical
 // addresses, translated by the TLB.
 //
+// A texture sample reads the four texels around each lane's sample position,
+// one cache line per subcycle. The writeback stage tracks which texels of
+// the current lane it has already read, and this accesses the line that
+// contains the first one that is left.
+//
 
 module dcache_tag_stage
 	(input                                      clk,
@@ -35,6 +40,7 @@ module dcache_tag_stage
 
 	// From operand_fetch_stage
 	input vector_t                              of_operand1,
+	input vector_t                              of_operand2,
 	input vector_lane_mask_t                    of_mask_value,
 	input vector_t                              of_store_value,
 	input                                       of_instruction_valid,
@@ -56,10 +62,17 @@ module dcache_tag_stage
 	output logic                                dt_valid[`L1D_WAYS],
 	output l1d_tag_t                            dt_tag[`L1D_WAYS],
 	output logic                                dt_tlb_supervisor,
+	output vector_lane_mask_t                   dt_scgath_same_line,
+	output logic[$clog2(`CACHE_LINE_WORDS) - 1:0] dt_scgath_data_lane[`VECTOR_LANES],
+	output sample_texel_mask_t                  dt_sample_same_line,
+	output logic[$clog2(`CACHE_LINE_WORDS) - 1:0] dt_sample_data_lane[`SAMPLE_TEXELS],
+	output logic[7:0]                           dt_sample_frac_u,
+	output logic[7:0]                           dt_sample_frac_v,
 
 	// from dcache_data_stage
 	input                                       dd_update_lru_en,
 	input l1d_way_idx_t                         dd_update_lru_way,
+	input                                       dd_update_lru_demote,
 
 	// To ifetch_tag_stage
 	output                                      dt_invalidate_tlb_en,
@@ -69,6 +82,7 @@ module dcache_tag_stage
 	output page_index_t                         dt_update_itlb_ppage_idx,
 	output                                      dt_update_itlb_supervisor,
 	output                                      dt_update_itlb_global,
+	output                                      dt_update_itlb_superpage,
 
 	// From l1_l2_interface
 	input                                       l2i_dcache_lru_fill_en,
@@ -92,7 +106,9 @@ module dcache_tag_stage
 
 	// From writeback_stage
 	input logic                                 wb_rollback_en,
-	input thread_idx_t                          wb_rollback_thread_idx);
+	input thread_idx_t                          wb_rollback_thread_idx,
+	input sample_texel_mask_t                   wb_sample_texels_read[`THREADS_PER_CORE],
+	input subcycle_t                            wb_sample_subcycle[`THREADS_PER_CORE]);
 
 	l1d_addr_t request_addr_nxt;
 	logic cache_load_en;
@@ -108,6 +124,20 @@ module dcache_tag_stage
 	logic tlb_writable;
 	logic tlb_supervisor;
 	tlb_entry_t new_tlb_value;
+	vector_lane_mask_t scgath_same_line_nxt;
+	logic is_sample;
+	scalar_t sample_u;
+	scalar_t sample_v;
+	logic[3:0] sample_width_bits;
+	logic[3:0] sample_height_bits;
+	scalar_t sample_u_fixed;
+	scalar_t sample_v_fixed;
+	logic[15:0] sample_x[2];	// Left, right
+	logic[15:0] sample_y[2];	// Top, bottom
+	scalar_t sample_texel_addr[`SAMPLE_TEXELS];
+	sample_texel_mask_t sample_texels_read;
+	scalar_t sample_request_addr;
+	sample_texel_mask_t sample_same_line_nxt;
 
 	assign instruction_valid = of_instruction_valid
 		&& (!wb_rollback_en || wb_rollback_thread_idx != of_thread_idx)
@@ -119,7 +149,85 @@ module dcache_tag_stage
 		&& of_instruction.is_memory_access      // Not cache control
 		&& of_instruction.is_load;
 	assign scgath_lane = ~of_subcycle;
-	assign request_addr_nxt = of_operand1[scgath_lane] + of_instruction.immediate_value;
+	assign is_sample = of_instruction.is_memory_access
+		&& of_instruction.memory_access_type == MEM_SAMPLE;
+	assign request_addr_nxt = is_sample ? sample_request_addr
+		: of_operand1[scgath_lane] + of_instruction.immediate_value;
+
+	//
+	// Texture sample address generation
+	// Bits 23-0 of the u and v coordinates are the fraction of the texture
+	// width or height (0.0-1.0) and bits 27-24 are log2 of the width or
+	// height. Shift each so the texel index is above bit 8 and the 8 bit
+	// filter weight is below it. Rows are packed 32 bit texels starting at
+	// the base address (op2). The right column and bottom row wrap around.
+	//
+	assign sample_u = of_operand1[scgath_lane];
+	assign sample_v = of_store_value[scgath_lane];
+	assign sample_width_bits = sample_u[27:24];
+	assign sample_height_bits = sample_v[27:24];
+	assign sample_u_fixed = {8'd0, sample_u[23:0]} >> (5'd16 - 5'(sample_width_bits));
+	assign sample_v_fixed = {8'd0, sample_v[23:0]} >> (5'd16 - 5'(sample_height_bits));
+	assign sample_x[0] = sample_u_fixed[23:8];
+	assign sample_x[1] = (sample_u_fixed[23:8] + 16'd1) & ((16'd1 << sample_width_bits) - 16'd1);
+	assign sample_y[0] = sample_v_fixed[23:8];
+	assign sample_y[1] = (sample_v_fixed[23:8] + 16'd1) & ((16'd1 << sample_height_bits) - 16'd1);
+
+	genvar texel_idx;
+	generate
+		for (texel_idx = 0; texel_idx < `SAMPLE_TEXELS; texel_idx++)
+		begin : sample_texel_gen
+			scalar_t texel_index;
+
+			assign texel_index = (scalar_t'(sample_y[texel_idx / 2]) << sample_width_bits)
+				| scalar_t'(sample_x[texel_idx % 2]);
+			assign sample_texel_addr[texel_idx] = of_operand2[0] + {texel_index[29:0], 2'd0};
+			assign sample_same_line_nxt[texel_idx] = sample_texel_addr[texel_idx][31:`CACHE_LINE_OFFSET_WIDTH]
+				== sample_request_addr[31:`CACHE_LINE_OFFSET_WIDTH];
+
+			always_ff @(posedge clk)
+				dt_sample_data_lane[texel_idx] <= ~sample_texel_addr[texel_idx][2+:$clog2(`CACHE_LINE_WORDS)];
+		end
+	endgenerate
+
+	// The writeback stage only tracks texels for one subcycle at a time.
+	// This may be out of date if the previous subcycle of this thread is
+	// still in the pipeline. dcache_data_stage checks it again.
+	assign sample_texels_read = wb_sample_subcycle[of_thread_idx] == of_subcycle
+		? wb_sample_texels_read[of_thread_idx] : sample_texel_mask_t'(0);
+
+	always_comb
+	begin
+		if (!sample_texels_read[0])
+			sample_request_addr = sample_texel_addr[0];
+		else if (!sample_texels_read[1])
+			sample_request_addr = sample_texel_addr[1];
+		else if (!sample_texels_read[2])
+			sample_request_addr = sample_texel_addr[2];
+		else
+			sample_request_addr = sample_texel_addr[3];
+	end
+
+	// For a scatter/gather access, find which lanes use the same cache line as
+	// the current one, so dcache_data_stage can service them with a single
+	// access. Unaligned lanes are excluded so they still fault on their own
+	// subcycle. dt_scgath_data_lane is where each lane's word is in
+	// cache_line_data_t (which is in reverse address order).
+	genvar lane_idx;
+	generate
+		for (lane_idx = 0; lane_idx < `VECTOR_LANES; lane_idx++)
+		begin : scgath_lane_gen
+			scalar_t lane_addr;
+
+			assign lane_addr = of_operand1[lane_idx] + of_instruction.immediate_value;
+			assign scgath_same_line_nxt[lane_idx] = lane_addr[31:`CACHE_LINE_OFFSET_WIDTH]
+				== request_addr_nxt[31:`CACHE_LINE_OFFSET_WIDTH]
+				&& lane_addr[1:0] == 2'd0;
+
+			always_ff @(posedge clk)
+				dt_scgath_data_lane[lane_idx] <= ~lane_addr[2+:$clog2(`CACHE_LINE_WORDS)];
+		end
+	endgenerate
 	assign new_tlb_value = of_store_value[0];
 	assign dt_invalidate_tlb_en = is_valid_cache_control
 		&& of_instruction.cache_control_op == CACHE_TLB_INVAL
@@ -135,6 +243,7 @@ module dcache_tag_stage
 		&& cr_supervisor_en[of_thread_idx];
 	assign dt_update_itlb_supervisor = new_tlb_value.supervisor;
 	assign dt_update_itlb_global = new_tlb_value.global;
+	assign dt_update_itlb_superpage = new_tlb_value.superpage;
 	assign tlb_lookup_en = instruction_valid
 		&& of_instruction.memory_access_type != MEM_CONTROL_REG
 		&& !update_dtlb_en
@@ -228,6 +337,7 @@ module dcache_tag_stage
 		.update_writable(new_tlb_value.writable),
 		.update_supervisor(new_tlb_value.supervisor),
 		.update_global(new_tlb_value.global),
+		.update_superpage(new_tlb_value.superpage),
 		.lookup_ppage_idx(tlb_ppage_idx),
 		.lookup_hit(tlb_hit),
 		.lookup_writable(tlb_writable),
@@ -269,6 +379,7 @@ module dcache_tag_stage
 		.access_set(request_addr_nxt.set_idx),
 		.access_update_en(dd_update_lru_en),
 		.access_update_way(dd_update_lru_way),
+		.access_update_demote(dd_update_lru_demote),
 		.*);
 
 	always_ff @(posedge clk, posedge reset)
@@ -280,6 +391,10 @@ module dcache_tag_stage
 			dt_instruction <= '0;
 			dt_instruction_valid <= '0;
 			dt_mask_value <= '0;
+			dt_sample_frac_u <= '0;
+			dt_sample_frac_v <= '0;
+			dt_sample_same_line <= '0;
+			dt_scgath_same_line <= '0;
 			dt_store_value <= '0;
 			dt_subcycle <= '0;
 			dt_thread_idx <= '0;
@@ -292,6 +407,10 @@ module dcache_tag_stage
 			dt_instruction_valid <= instruction_valid;
 			dt_instruction <= of_instruction;
 			dt_mask_value <= of_mask_value;
+			dt_scgath_same_line <= scgath_same_line_nxt;
+			dt_sample_same_line <= sample_same_line_nxt;
+			dt_sample_frac_u <= sample_u_fixed[7:0];
+			dt_sample_frac_v <= sample_v_fixed[7:0];
 			dt_thread_idx <= of_thread_idx;
 			dt_store_value <= of_store_value;
 			dt_subcycle <= of_subcycle;
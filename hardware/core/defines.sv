@@ -32,6 +32,7 @@ typedef scalar_t[`VECTOR_LANES - 1:0] vector_t;
 typedef logic[$clog2(`THREADS_PER_CORE) - 1:0] thread_idx_t;
 typedef logic[`THREADS_PER_CORE - 1:0] thread_bitmap_t;	// One bit per thread
 typedef logic[4:0] register_idx_t;
+typedef logic[1:0] thread_priority_t;	// Higher values issue first
 typedef logic[$clog2(`VECTOR_LANES) - 1:0] subcycle_t;
 typedef logic[`VECTOR_LANES - 1:0] vector_lane_mask_t;
 
@@ -43,7 +44,9 @@ typedef logic[`VECTOR_LANES - 1:0] vector_lane_mask_t;
 typedef enum logic[5:0] {
 	OP_OR			= 6'b000000,
 	OP_AND			= 6'b000001,
+	OP_UNORM8_F		= 6'b000010,	// Byte (op1 >> op2) / 255.0 as float
 	OP_XOR			= 6'b000011,
+	OP_RSQRT		= 6'b000100,	// Reciprocal square root estimate
 	OP_ADD_I		= 6'b000101,
 	OP_SUB_I		= 6'b000110,
 	OP_MULL_I		= 6'b000111,	// Multiply low
@@ -74,13 +77,32 @@ typedef enum logic[5:0] {
 	OP_ADD_F		= 6'b100000,
 	OP_SUB_F		= 6'b100001,
 	OP_MUL_F		= 6'b100010,
+	OP_FMADD_F		= 6'b100011,	// Fused multiply-add, addend in bits 14-10
+	OP_ADDS_U8		= 6'b100100,	// Packed bytes, unsigned saturating add
+	OP_SUBS_U8		= 6'b100101,	// Packed bytes, unsigned saturating subtract
+	OP_ADDS_U16		= 6'b100110,	// Packed halfwords, unsigned saturating add
+	OP_SUBS_U16		= 6'b100111,	// Packed halfwords, unsigned saturating subtract
+	OP_MULHI_U8		= 6'b101000,	// Packed bytes, (a * b) >> 8
+	OP_MULHI_U16	= 6'b101001,	// Packed halfwords, (a * b) >> 16
 	OP_ITOF			= 6'b101010,
+	OP_UNPACK_U8	= 6'b101011,	// Byte op2 of op1, zero extended
 	OP_CMPGT_F		= 6'b101100,	// Floating point greater than
 	OP_CMPLT_F		= 6'b101110,	// Floating point less than
 	OP_CMPGE_F		= 6'b101101,	// Floating point greater or equal
 	OP_CMPLE_F		= 6'b101111,	// Floating point less than or equal
 	OP_CMPEQ_F      = 6'b110000,	// Floating point equal
 	OP_CMPNE_F      = 6'b110001,    // Floating point not-equal
+	OP_HADD_I		= 6'b110010,	// Horizontal sum of lanes
+	OP_HMIN_I		= 6'b110011,	// Horizontal minimum (signed)
+	OP_HMAX_I		= 6'b110100,	// Horizontal maximum (signed)
+	OP_HMIN_F		= 6'b110101,	// Horizontal minimum (floating point)
+	OP_HMAX_F		= 6'b110110,	// Horizontal maximum (floating point)
+	OP_COMPRESS		= 6'b110111,	// Pack lanes selected by op2 into lowest elements
+	OP_UNPACK_U16	= 6'b111000,	// Halfword op2 of op1, zero extended
+	OP_PACK_U8		= 6'b111001,	// (op1 << 8) | op2 clamped to 0-255
+	OP_PACK_U16		= 6'b111010,	// (op1 << 16) | op2 clamped to 0-65535
+	OP_HTOF			= 6'b111011,	// Half float op2 of op1 to single
+	OP_FTOH			= 6'b111100,	// (op1 << 16) | op2 rounded to half float
 	OP_SYSCALL      = 6'b111111
 } alu_op_t;
 
@@ -94,19 +116,40 @@ typedef enum logic[3:0] {
 	MEM_CONTROL_REG	= 4'b0110,		// Control register
 	MEM_BLOCK		= 4'b0111,		// Vector block
 	MEM_BLOCK_M		= 4'b1000,
+	MEM_BLOCK_NA	= 4'b1001,		// Vector block, don't allocate in L2 (store only)
+	MEM_ATOMIC		= 4'b1010,		// Atomic read-modify-write in L2 (store only)
+	MEM_SAMPLE		= 4'b1011,		// Bilinear filtered texture sample (load only)
 	MEM_SCGATH		= 4'b1101,		// Vector scatter/gather
 	MEM_SCGATH_M	= 4'b1110
 } memory_op_t;
 
+// Operation for MEM_ATOMIC. This comes from instruction bits 12:10, which
+// would be the mask register in a masked memory access. All return the
+// old value of the memory word.
 typedef enum logic[2:0] {
-	CACHE_DTLB_INSERT   = 3'b000,
-	CACHE_DINVALIDATE   = 3'b001,
-	CACHE_DFLUSH        = 3'b010,
-	CACHE_IINVALIDATE   = 3'b011,
-	CACHE_MEMBAR        = 3'b100,
-	CACHE_TLB_INVAL     = 3'b101,
-	CACHE_TLB_INVAL_ALL = 3'b110,
-	CACHE_ITLB_INSERT   = 3'b111
+	ATOMIC_ADD  = 3'b000,
+	ATOMIC_AND  = 3'b001,
+	ATOMIC_OR   = 3'b010,
+	ATOMIC_XOR  = 3'b011,
+	ATOMIC_XCHG = 3'b100,
+	ATOMIC_MIN  = 3'b101,	// Signed
+	ATOMIC_MAX  = 3'b110	// Signed
+} atomic_op_t;
+
+// The high bit comes from instruction bit 14, which is otherwise unused in
+// cache control instructions.
+typedef enum logic[3:0] {
+	CACHE_DTLB_INSERT   = 4'b0000,
+	CACHE_DINVALIDATE   = 4'b0001,
+	CACHE_DFLUSH        = 4'b0010,
+	CACHE_IINVALIDATE   = 4'b0011,
+	CACHE_MEMBAR        = 4'b0100,
+	CACHE_TLB_INVAL     = 4'b0101,
+	CACHE_TLB_INVAL_ALL = 4'b0110,
+	CACHE_ITLB_INSERT   = 4'b0111,
+	CACHE_DTOUCH        = 4'b1010,	// Software prefetch, same operands as dflush
+	CACHE_DWAIT         = 4'b1011,	// Wait for line to be written, same operands as dflush
+	CACHE_PAUSE         = 4'b1100	// Spin loop hint, no operands (like membar)
 } cache_op_t;
 
 typedef enum logic[2:0] {
@@ -158,7 +201,8 @@ typedef enum logic [4:0] {
 	CR_CURRENT_ASID = 5'd9,
 	CR_SCRATCHPAD0 = 5'd11,
 	CR_SCRATCHPAD1 = 5'd12,
-	CR_SUBCYCLE = 5'd13
+	CR_SUBCYCLE = 5'd13,
+	CR_THREAD_PRIORITY = 5'd14
 } control_register_t;
 
 typedef struct packed {
@@ -192,9 +236,11 @@ typedef struct packed {
 	scalar_t immediate_value;
 	logic is_branch;
 	branch_type_t branch_type;
+	logic branch_predicted;	// Fetch was redirected to the branch target
 	pipeline_sel_t pipeline_sel;
 	logic is_memory_access;
 	memory_op_t memory_access_type;
+	atomic_op_t atomic_op;
 	logic is_load;
 	logic is_compare;
 	subcycle_t last_subcycle;
@@ -233,6 +279,8 @@ typedef struct packed {
 
 `define PAGE_SIZE 'h1000
 `define PAGE_NUM_BITS (32 - $clog2(`PAGE_SIZE))
+`define SUPERPAGE_SIZE 'h400000
+`define SUPERPAGE_NUM_BITS (32 - $clog2(`SUPERPAGE_SIZE))
 `define ASID_WIDTH 8
 `define CACHE_LINE_BYTES (`VECTOR_LANES * 4) // Cache line must currently be same as vector width
 `define CACHE_LINE_BITS (`CACHE_LINE_BYTES * 8)
@@ -246,7 +294,8 @@ typedef logic[`PAGE_NUM_BITS - 1:0] page_index_t;
 
 typedef struct packed {
 	logic[`PAGE_NUM_BITS - 1:0] ppage_idx;
-	logic[32 - (`PAGE_NUM_BITS + 5) - 1:0] unused;
+	logic[32 - (`PAGE_NUM_BITS + 6) - 1:0] unused;
+	logic superpage;
 	logic global;
 	logic supervisor;
 	logic executable;
@@ -264,6 +313,12 @@ typedef struct packed {
 	logic[`CACHE_LINE_OFFSET_WIDTH - 1:0] offset;
 } l1d_addr_t;
 
+// A texture sample (MEM_SAMPLE) reads four texels for each lane, in the
+// order top left, top right, bottom left, bottom right. A bit is set in
+// sample_texel_mask_t for each one.
+`define SAMPLE_TEXELS 4
+typedef logic[`SAMPLE_TEXELS - 1:0] sample_texel_mask_t;
+
 typedef logic[$clog2(`L1I_WAYS) - 1:0] l1i_way_idx_t;
 typedef logic[$clog2(`L1I_SETS) - 1:0] l1i_set_idx_t;
 typedef logic[`ICACHE_TAG_BITS - 1:0] l1i_tag_t;
@@ -276,6 +331,8 @@ typedef struct packed {
 
 typedef logic[$clog2(`L2_WAYS) - 1:0] l2_way_idx_t;
 typedef logic[$clog2(`L2_SETS) - 1:0] l2_set_idx_t;
+`define L2_BANK_SETS (`L2_SETS / `L2_BANKS)
+typedef logic[$clog2(`L2_BANK_SETS) - 1:0] l2_bank_set_idx_t;
 typedef logic[(31 - (`CACHE_LINE_OFFSET_WIDTH + $clog2(`L2_SETS))):0] l2_tag_t;
 typedef struct packed {
 	l2_tag_t tag;
@@ -298,14 +355,17 @@ typedef enum logic {
 typedef logic[3:0] core_id_t;
 typedef logic[$clog2(`THREADS_PER_CORE) - 1:0] l1_miss_entry_idx_t;
 
-typedef enum logic[2:0] {
+typedef enum logic[3:0] {
 	L2REQ_LOAD,
 	L2REQ_LOAD_SYNC,
 	L2REQ_STORE,
 	L2REQ_STORE_SYNC,
 	L2REQ_FLUSH,
 	L2REQ_IINVALIDATE,
-	L2REQ_DINVALIDATE
+	L2REQ_DINVALIDATE,
+	L2REQ_PREFETCH,		// Fill L2 only, no L1 update
+	L2REQ_STORE_NO_ALLOCATE,	// Full line store, write to memory on L2 miss
+	L2REQ_ATOMIC		// Read-modify-write one word, returns old value
 } l2req_packet_type_t;
 
 typedef struct packed {
@@ -317,6 +377,7 @@ typedef struct packed {
 	scalar_t address;
 	logic[`CACHE_LINE_BYTES - 1:0] store_mask;
 	cache_line_data_t data;
+	atomic_op_t atomic_op;
 } l2req_packet_t;
 
 typedef enum logic[2:0] {
@@ -324,7 +385,8 @@ typedef enum logic[2:0] {
 	L2RSP_STORE_ACK,
 	L2RSP_FLUSH_ACK,
 	L2RSP_IINVALIDATE_ACK,
-	L2RSP_DINVALIDATE_ACK
+	L2RSP_DINVALIDATE_ACK,
+	L2RSP_PREFETCH_ACK
 } l2rsp_packet_type_t;
 
 typedef struct packed {
@@ -336,6 +398,7 @@ typedef struct packed {
 	cache_type_t cache_type;
 	scalar_t address;
 	cache_line_data_t data;
+	scalar_t atomic_value;	// Old value of word for L2REQ_ATOMIC
 } l2rsp_packet_t;
 
 typedef struct packed {
@@ -405,8 +468,42 @@ interface axi4_interface;
 		output s_awready, s_wready, s_bvalid, s_arready, s_rvalid, s_rdata);
 endinterface
 
-`define CORE_PERF_EVENTS 10
-`define L2_PERF_EVENTS 3
+// Bit indices of performance events in core_perf_events and l2_perf_events.
+// Software sees the L2 events first, then the events for each core (see
+// README.md).
+localparam CORE_PERF_STORE_ROLLBACK = 0;
+localparam CORE_PERF_STORE = 1;
+localparam CORE_PERF_INSTRUCTION_RETIRE = 2;
+localparam CORE_PERF_INSTRUCTION_ISSUE = 3;
+localparam CORE_PERF_ICACHE_MISS = 4;
+localparam CORE_PERF_ICACHE_HIT = 5;
+localparam CORE_PERF_ITLB_MISS = 6;
+localparam CORE_PERF_DCACHE_MISS = 7;
+localparam CORE_PERF_DCACHE_HIT = 8;
+localparam CORE_PERF_DTLB_MISS = 9;
+localparam CORE_PERF_STALL_ICACHE = 10;
+localparam CORE_PERF_STALL_DCACHE = 11;
+localparam CORE_PERF_STALL_STORE_QUEUE = 12;
+localparam CORE_PERF_STALL_RAW = 13;
+localparam CORE_PERF_STALL_WRITEBACK_CONFLICT = 14;
+localparam CORE_PERF_ROLLBACK_BRANCH = 15;
+localparam CORE_PERF_ROLLBACK_DCACHE_MISS = 16;
+localparam CORE_PERF_ROLLBACK_SYNC = 17;
+localparam CORE_PERF_PREFETCH_USEFUL = 18;
+localparam CORE_PERF_PREFETCH_LATE = 19;
+localparam CORE_PERF_BRANCH_MISPREDICT = 20;
+localparam CORE_PERF_STORE_COMBINED = 21;
+localparam CORE_PERF_SCGATH_ACCESS = 22;
+localparam CORE_PERF_STALL_SCHEDULE = 23;
+`define CORE_PERF_EVENTS 24
+
+localparam L2_PERF_WRITEBACK = 0;
+localparam L2_PERF_MISS = 1;
+localparam L2_PERF_HIT = 2;
+localparam L2_PERF_QUEUE_STALL = 3;
+localparam L2_PERF_AXI_READ_BEAT = 4;
+localparam L2_PERF_AXI_WRITE_BEAT = 5;
+`define L2_PERF_EVENTS 6
 `define TOTAL_PERF_EVENTS (`L2_PERF_EVENTS + `CORE_PERF_EVENTS * `NUM_CORES)
 
 `endif
@@ -28,6 +28,15 @@
 // - Steer significand down smaller-exponent lane
 // Floating point multiplication
 // - Add exponents/multiply significands
+// Fused multiply-add
+// - Compute how far to shift the addend to align it with the product
+// - Detect cases where the result doesn't depend on the sum (special values,
+//   zero product, or an addend so much larger that the product can't affect
+//   the rounded result)
+//
+// The fused multiply-add sum is computed in a 76 bit fixed point window.
+// The 48 bit product is at bits 49-2. The addend can be anywhere from 26 bits
+// above the product to below the window, where it only sets the sticky bit.
 //
 
 module fp_execute_stage1(
@@ -46,6 +55,7 @@ module fp_execute_stage1(
 	input decoded_instruction_t                    of_instruction,
 	input thread_idx_t                             of_thread_idx,
 	input subcycle_t                               of_subcycle,
+	input vector_t                                 of_store_value,	// FMA addend
 
 	// To fp_execute_stage2
 	output logic                                   fx1_instruction_valid,
@@ -69,14 +79,25 @@ module fp_execute_stage1(
 	output logic[`VECTOR_LANES - 1:0][31:0]        fx1_multiplicand,
 	output logic[`VECTOR_LANES - 1:0][31:0]        fx1_multiplier,
 	output logic[`VECTOR_LANES - 1:0][7:0]         fx1_mul_exponent,
-	output logic[`VECTOR_LANES - 1:0]              fx1_mul_sign);
+	output logic[`VECTOR_LANES - 1:0]              fx1_mul_sign,
+
+	// Fused multiply-add
+	output logic[`VECTOR_LANES - 1:0][23:0]        fx1_fma_addend_significand,
+	output logic[`VECTOR_LANES - 1:0][6:0]         fx1_fma_addend_shift,
+	output logic[`VECTOR_LANES - 1:0]              fx1_fma_addend_sign,
+	output logic[`VECTOR_LANES - 1:0]              fx1_fma_subtract,
+	output logic[`VECTOR_LANES - 1:0][9:0]         fx1_fma_exponent,
+	output logic[`VECTOR_LANES - 1:0]              fx1_fma_bypass,
+	output scalar_t[`VECTOR_LANES - 1:0]           fx1_fma_bypass_value);
 
 	logic is_fmul;
 	logic is_imul;
 	logic is_ftoi;
 	logic is_itof;
+	logic is_fmadd;
 
 	assign is_fmul = of_instruction.alu_op == OP_MUL_F;
+	assign is_fmadd = of_instruction.alu_op == OP_FMADD_F;
 	assign is_imul = of_instruction.alu_op == OP_MULL_I || of_instruction.alu_op == OP_MULH_U
 		|| of_instruction.alu_op == OP_MULH_I;
 	assign is_ftoi = of_instruction.alu_op == OP_FTOI;
@@ -106,6 +127,21 @@ module fp_execute_stage1(
 			logic mul_exponent_carry;
 			logic[5:0] ftoi_rshift;
 			logic[5:0] ftoi_lshift_nxt;
+			ieee754_binary32_t fop3;
+			logic fop1_is_zero;
+			logic fop2_is_zero;
+			logic fop3_is_zero;
+			logic fop3_is_inf;
+			logic fop3_is_nan;
+			logic[7:0] fma_exponent1;
+			logic[7:0] fma_exponent2;
+			logic[7:0] fma_exponent3;
+			logic[10:0] fma_addend_shift;
+			logic fma_product_sign;
+			logic fma_product_is_inf;
+			logic fma_result_is_nan;
+			logic fma_bypass;
+			scalar_t fma_bypass_value;
 
 			assign fop1 = of_operand1[lane_idx];
 			assign fop2 = of_operand2[lane_idx];
@@ -118,6 +154,12 @@ module fp_execute_stage1(
 			assign fop1_is_nan = fop1.exponent == 8'hff && fop1.significand != 0;
 			assign fop2_is_inf = fop2.exponent == 8'hff && fop2.significand == 0;
 			assign fop2_is_nan = fop2.exponent == 8'hff && fop2.significand != 0;
+			assign fop3 = of_store_value[lane_idx];
+			assign fop1_is_zero = fop1.exponent == 0 && fop1.significand == 0;
+			assign fop2_is_zero = fop2.exponent == 0 && fop2.significand == 0;
+			assign fop3_is_zero = fop3.exponent == 0 && fop3.significand == 0;
+			assign fop3_is_inf = fop3.exponent == 8'hff && fop3.significand == 0;
+			assign fop3_is_nan = fop3.exponent == 8'hff && fop3.significand != 0;
 
 			// Compute how much to shift the significand right to truncate
 			// fractional digits
@@ -159,6 +201,8 @@ module fp_execute_stage1(
 						|| (fop2_is_inf && of_operand1[lane_idx] == 0);
 				else if (is_ftoi)
 					result_is_nan = fop2_is_nan || fop2_is_inf || fop2.exponent >= 8'd159;
+				else if (is_fmadd)
+					result_is_nan = fma_result_is_nan;
 				else
 					result_is_nan = fop1_is_nan || fop2_is_nan || (fop1_is_inf && fop2_is_inf && logical_subtract);
 			end
@@ -169,6 +213,41 @@ module fp_execute_stage1(
 			assign {mul_exponent_underflow, mul_exponent_carry, mul_exponent}
 				=  {2'd0, fop1.exponent} + {2'd0, fop2.exponent} - 10'd127;
 
+			// Fused multiply-add. Subnormal numbers have an effective exponent
+			// of 1. The addend shift is the distance to shift it right from
+			// the top of the window (where it is 26 bits above the product).
+			// If it is negative, the addend is large enough that the product
+			// can't change the rounded result. If it is more than 76, the
+			// addend is entirely below the window.
+			assign fma_exponent1 = fop1.exponent == 0 ? 8'd1 : fop1.exponent;
+			assign fma_exponent2 = fop2.exponent == 0 ? 8'd1 : fop2.exponent;
+			assign fma_exponent3 = fop3.exponent == 0 ? 8'd1 : fop3.exponent;
+			assign fma_addend_shift = 11'(fma_exponent1) + 11'(fma_exponent2)
+				- 11'(fma_exponent3) - 11'd100;
+			assign fma_product_sign = fop1.sign ^ fop2.sign;
+			assign fma_product_is_inf = fop1_is_inf || fop2_is_inf;
+			assign fma_result_is_nan = fop1_is_nan || fop2_is_nan || fop3_is_nan
+				|| (fop1_is_inf && fop2_is_zero) || (fop2_is_inf && fop1_is_zero)
+				|| (fma_product_is_inf && fop3_is_inf && fma_product_sign != fop3.sign);
+
+			always_comb
+			begin
+				fma_bypass = 1;
+				if (fma_product_is_inf)
+					fma_bypass_value = {fma_product_sign, 8'hff, 23'd0};
+				else if (fop3_is_inf)
+					fma_bypass_value = fop3;
+				else if ((fop1_is_zero || fop2_is_zero) && fop3_is_zero)
+					fma_bypass_value = {fma_product_sign && fop3.sign, 31'd0};
+				else if (fop1_is_zero || fop2_is_zero || fma_addend_shift[10])
+					fma_bypass_value = fop3;
+				else
+				begin
+					fma_bypass = 0;
+					fma_bypass_value = fop3;
+				end
+			end
+
 			// Subtle: In the case where values are equal, leave operand1 in the _le slot. This properly
 			// handles the sign for +/- zero.
 			assign op1_is_larger = fop1.exponent > fop2.exponent
@@ -253,6 +332,16 @@ module fp_execute_stage1(
 
 				fx1_mul_exponent[lane_idx] <= mul_exponent;
 				fx1_mul_sign[lane_idx] <= fop1.sign ^ fop2.sign;
+
+				// Fused multiply-add
+				fx1_fma_addend_significand[lane_idx] <= {fop3.exponent != 0, fop3.significand};
+				fx1_fma_addend_shift[lane_idx] <= fma_addend_shift > 11'd76 ? 7'd77
+					: 7'(fma_addend_shift);
+				fx1_fma_addend_sign[lane_idx] <= fop3.sign;
+				fx1_fma_subtract[lane_idx] <= fma_product_sign != fop3.sign;
+				fx1_fma_exponent[lane_idx] <= 10'(fma_exponent1) + 10'(fma_exponent2) - 10'd127;
+				fx1_fma_bypass[lane_idx] <= fma_bypass;
+				fx1_fma_bypass_value[lane_idx] <= fma_bypass_value;
 			end
 		end
 	endgenerate
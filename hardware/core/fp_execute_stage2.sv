@@ -25,6 +25,9 @@
 // - Perform actual operation (XXX placeholder, see below)
 // Float to int conversion
 // - Shift significand right to truncate fractional bit positions
+// Fused multiply-add
+// - Align addend with product, collapsing bits below the window into a
+//   sticky bit
 //
 
 module fp_execute_stage2(
@@ -60,6 +63,15 @@ module fp_execute_stage2(
 	input [`VECTOR_LANES - 1:0][31:0]        fx1_multiplicand,
 	input [`VECTOR_LANES - 1:0][31:0]        fx1_multiplier,
 
+	// Fused multiply-add
+	input [`VECTOR_LANES - 1:0][23:0]        fx1_fma_addend_significand,
+	input [`VECTOR_LANES - 1:0][6:0]         fx1_fma_addend_shift,
+	input [`VECTOR_LANES - 1:0]              fx1_fma_addend_sign,
+	input [`VECTOR_LANES - 1:0]              fx1_fma_subtract,
+	input [`VECTOR_LANES - 1:0][9:0]         fx1_fma_exponent,
+	input [`VECTOR_LANES - 1:0]              fx1_fma_bypass,
+	input scalar_t[`VECTOR_LANES - 1:0]      fx1_fma_bypass_value,
+
 	// To fp_execute_stage3
 	output logic                             fx2_instruction_valid,
 	output decoded_instruction_t             fx2_instruction,
@@ -83,7 +95,15 @@ module fp_execute_stage2(
 	// Floating point multiplication
 	output logic[`VECTOR_LANES - 1:0][63:0]  fx2_significand_product,
 	output logic[`VECTOR_LANES - 1:0][7:0]   fx2_mul_exponent,
-	output logic[`VECTOR_LANES - 1:0]        fx2_mul_sign);
+	output logic[`VECTOR_LANES - 1:0]        fx2_mul_sign,
+
+	// Fused multiply-add
+	output logic[`VECTOR_LANES - 1:0][75:0]  fx2_fma_addend,
+	output logic[`VECTOR_LANES - 1:0]        fx2_fma_addend_sign,
+	output logic[`VECTOR_LANES - 1:0]        fx2_fma_subtract,
+	output logic[`VECTOR_LANES - 1:0][9:0]   fx2_fma_exponent,
+	output logic[`VECTOR_LANES - 1:0]        fx2_fma_bypass,
+	output scalar_t[`VECTOR_LANES - 1:0]     fx2_fma_bypass_value);
 
 	logic is_imulhs;
 
@@ -100,11 +120,20 @@ module fp_execute_stage2(
 			logic sticky;
 			logic[63:0] sext_multiplicand;
 			logic[63:0] sext_multiplier;
+			logic[75:0] fma_aligned_addend;
+			logic[24:0] fma_sticky_bits;
 
 			assign {aligned_significand, guard, round, sticky_bits} = {fx1_significand_se[lane_idx], 27'd0} >>
 				fx1_se_align_shift[lane_idx];
 			assign sticky = |sticky_bits;
 
+			// The addend starts at the top of the window. The 25 bits below
+			// the window are only needed to compute the sticky bit, which is
+			// merged into the lowest bit of the window (which is below the
+			// product).
+			assign {fma_aligned_addend, fma_sticky_bits} = {fx1_fma_addend_significand[lane_idx], 77'd0}
+				>> fx1_fma_addend_shift[lane_idx];
+
 			// Sign extend multiply operands
 			assign sext_multiplicand = {{32{fx1_multiplicand[lane_idx][31] && is_imulhs}},
 				fx1_multiplicand[lane_idx]};
@@ -126,6 +155,13 @@ module fp_execute_stage2(
 				fx2_result_is_inf[lane_idx] <= fx1_result_is_inf[lane_idx];
 				fx2_result_is_nan[lane_idx] <= fx1_result_is_nan[lane_idx];
 				fx2_ftoi_lshift[lane_idx] <= fx1_ftoi_lshift[lane_idx];
+				fx2_fma_addend[lane_idx] <= {fma_aligned_addend[75:1],
+					fma_aligned_addend[0] || |fma_sticky_bits};
+				fx2_fma_addend_sign[lane_idx] <= fx1_fma_addend_sign[lane_idx];
+				fx2_fma_subtract[lane_idx] <= fx1_fma_subtract[lane_idx];
+				fx2_fma_exponent[lane_idx] <= fx1_fma_exponent[lane_idx];
+				fx2_fma_bypass[lane_idx] <= fx1_fma_bypass[lane_idx];
+				fx2_fma_bypass_value[lane_idx] <= fx1_fma_bypass_value[lane_idx];
 
 				// XXX Simple version. Should have a wallace tree here to collect partial products.
 				fx2_significand_product[lane_idx] <= sext_multiplicand * sext_multiplier;
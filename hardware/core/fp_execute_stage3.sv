@@ -26,6 +26,8 @@
 // - Convert negative values to 2's complement.
 // Floating point multiplication
 // - pass through
+// Fused multiply-add
+// - Add/subtract product and aligned addend
 //
 
 module fp_execute_stage3(
@@ -57,6 +59,14 @@ module fp_execute_stage3(
 	input [`VECTOR_LANES - 1:0][7:0]         fx2_mul_exponent,
 	input [`VECTOR_LANES - 1:0]              fx2_mul_sign,
 
+	// Fused multiply-add
+	input [`VECTOR_LANES - 1:0][75:0]        fx2_fma_addend,
+	input [`VECTOR_LANES - 1:0]              fx2_fma_addend_sign,
+	input [`VECTOR_LANES - 1:0]              fx2_fma_subtract,
+	input [`VECTOR_LANES - 1:0][9:0]         fx2_fma_exponent,
+	input [`VECTOR_LANES - 1:0]              fx2_fma_bypass,
+	input scalar_t[`VECTOR_LANES - 1:0]      fx2_fma_bypass_value,
+
 	// To fp_execute_stage4
 	output logic                             fx3_instruction_valid,
 	output decoded_instruction_t             fx3_instruction,
@@ -76,7 +86,14 @@ module fp_execute_stage3(
 	// Floating point multiplication
 	output logic[`VECTOR_LANES - 1:0][63:0]  fx3_significand_product,
 	output logic[`VECTOR_LANES - 1:0][7:0]   fx3_mul_exponent,
-	output logic[`VECTOR_LANES - 1:0]        fx3_mul_sign);
+	output logic[`VECTOR_LANES - 1:0]        fx3_mul_sign,
+
+	// Fused multiply-add
+	output logic[`VECTOR_LANES - 1:0][75:0]  fx3_fma_sum,
+	output logic[`VECTOR_LANES - 1:0]        fx3_fma_sign,
+	output logic[`VECTOR_LANES - 1:0][9:0]   fx3_fma_exponent,
+	output logic[`VECTOR_LANES - 1:0]        fx3_fma_bypass,
+	output scalar_t[`VECTOR_LANES - 1:0]     fx3_fma_bypass_value);
 
 	logic is_ftoi;
 
@@ -93,6 +110,10 @@ module fp_execute_stage3(
 			logic round_tie;
 			logic do_round;
 			logic _unused;
+			logic[75:0] fma_product;
+			logic[76:0] fma_difference;
+			logic[75:0] fma_sum;
+			logic fma_sign;
 
 			// Round-to-nearest, round half to even. Compute the value of the low bit
 			// of the sum to predict if the result is odd.
@@ -114,6 +135,30 @@ module fp_execute_stage3(
 			assign {unnormalized_sum, _unused} = {fx2_significand_le[lane_idx], 1'b1}
 				+ {(fx2_significand_se[lane_idx] ^ {32{fx2_logical_subtract[lane_idx]}}), carry_in};
 
+			// Fused multiply-add. The sum is the magnitude. The result has the
+			// sign of the larger of the product and the addend.
+			assign fma_product = {26'd0, fx2_significand_product[lane_idx][47:0], 2'd0};
+			assign fma_difference = {1'b0, fma_product} - {1'b0, fx2_fma_addend[lane_idx]};
+
+			always_comb
+			begin
+				if (!fx2_fma_subtract[lane_idx])
+				begin
+					fma_sum = fma_product + fx2_fma_addend[lane_idx];
+					fma_sign = fx2_mul_sign[lane_idx];
+				end
+				else if (fma_difference[76])
+				begin
+					fma_sum = fx2_fma_addend[lane_idx] - fma_product;
+					fma_sign = fx2_fma_addend_sign[lane_idx];
+				end
+				else
+				begin
+					fma_sum = fma_difference[75:0];
+					fma_sign = fx2_mul_sign[lane_idx];
+				end
+			end
+
 			always_ff @(posedge clk)
 			begin
 				fx3_result_is_inf[lane_idx] <= fx2_result_is_inf[lane_idx];
@@ -130,6 +175,13 @@ module fp_execute_stage3(
 				fx3_significand_product[lane_idx] <= fx2_significand_product[lane_idx];
 				fx3_mul_exponent[lane_idx] <= fx2_mul_exponent[lane_idx];
 				fx3_mul_sign[lane_idx] <= fx2_mul_sign[lane_idx];
+
+				// Fused multiply-add
+				fx3_fma_sum[lane_idx] <= fma_sum;
+				fx3_fma_sign[lane_idx] <= fma_sign;
+				fx3_fma_exponent[lane_idx] <= fx2_fma_exponent[lane_idx];
+				fx3_fma_bypass[lane_idx] <= fx2_fma_bypass[lane_idx];
+				fx3_fma_bypass_value[lane_idx] <= fx2_fma_bypass_value[lane_idx];
 			end
 		end
 	endgenerate
@@ -24,6 +24,8 @@
 //   addition
 // - Passes through multiplication result. Could have second stage of wallace
 //   tree here.
+// Fused multiply-add
+// - Finds leading zero to determine normalization shift
 //
 
 module fp_execute_stage4(
@@ -51,6 +53,13 @@ module fp_execute_stage4(
 	input [`VECTOR_LANES - 1:0][7:0]         fx3_mul_exponent,
 	input [`VECTOR_LANES - 1:0]              fx3_mul_sign,
 
+	// Fused multiply-add
+	input [`VECTOR_LANES - 1:0][75:0]        fx3_fma_sum,
+	input [`VECTOR_LANES - 1:0]              fx3_fma_sign,
+	input [`VECTOR_LANES - 1:0][9:0]         fx3_fma_exponent,
+	input [`VECTOR_LANES - 1:0]              fx3_fma_bypass,
+	input scalar_t[`VECTOR_LANES - 1:0]      fx3_fma_bypass_value,
+
 	// To fp_execute_stage5
 	output logic                             fx4_instruction_valid,
 	output decoded_instruction_t             fx4_instruction,
@@ -70,7 +79,15 @@ module fp_execute_stage4(
 	// Floating point multiplication
 	output logic[`VECTOR_LANES - 1:0][63:0]  fx4_significand_product,
 	output logic[`VECTOR_LANES - 1:0][7:0]   fx4_mul_exponent,
-	output logic[`VECTOR_LANES - 1:0]        fx4_mul_sign);
+	output logic[`VECTOR_LANES - 1:0]        fx4_mul_sign,
+
+	// Fused multiply-add
+	output logic[`VECTOR_LANES - 1:0][75:0]  fx4_fma_sum,
+	output logic[`VECTOR_LANES - 1:0][6:0]   fx4_fma_norm_shift,
+	output logic[`VECTOR_LANES - 1:0]        fx4_fma_sign,
+	output logic[`VECTOR_LANES - 1:0][9:0]   fx4_fma_exponent,
+	output logic[`VECTOR_LANES - 1:0]        fx4_fma_bypass,
+	output scalar_t[`VECTOR_LANES - 1:0]     fx4_fma_bypass_value);
 
 	logic is_ftoi;
 
@@ -81,6 +98,7 @@ module fp_execute_stage4(
 		for (lane_idx = 0; lane_idx < `VECTOR_LANES; lane_idx++)
 		begin : lane_logic_gen
 			logic[5:0] leading_zeroes;
+			logic[6:0] fma_leading_zeroes;
 
 			// Determine normalization shift count for add/sub.
 			always_comb
@@ -127,6 +145,18 @@ module fp_execute_stage4(
 				endcase
 			end
 
+			// Normalization shift for fused multiply-add. This is 76 if the sum
+			// is zero.
+			always_comb
+			begin
+				fma_leading_zeroes = 7'd76;
+				for (int bit_idx = 0; bit_idx < 76; bit_idx++)
+				begin
+					if (fx3_fma_sum[lane_idx][bit_idx])
+						fma_leading_zeroes = 7'(75 - bit_idx);
+				end
+			end
+
 			always_ff @(posedge clk)
 			begin
 				fx4_add_significand[lane_idx] <= fx3_add_significand[lane_idx];
@@ -139,6 +169,12 @@ module fp_execute_stage4(
 				fx4_mul_sign[lane_idx] <= fx3_mul_sign[lane_idx];
 				fx4_result_is_inf[lane_idx] <= fx3_result_is_inf[lane_idx];
 				fx4_result_is_nan[lane_idx] <= fx3_result_is_nan[lane_idx];
+				fx4_fma_sum[lane_idx] <= fx3_fma_sum[lane_idx];
+				fx4_fma_norm_shift[lane_idx] <= fma_leading_zeroes;
+				fx4_fma_sign[lane_idx] <= fx3_fma_sign[lane_idx];
+				fx4_fma_exponent[lane_idx] <= fx3_fma_exponent[lane_idx];
+				fx4_fma_bypass[lane_idx] <= fx3_fma_bypass[lane_idx];
+				fx4_fma_bypass_value[lane_idx] <= fx3_fma_bypass_value[lane_idx];
 			end
 		end
 	endgenerate
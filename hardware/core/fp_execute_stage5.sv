@@ -23,6 +23,9 @@
 // Floating point addition/multiplication
 // - Normalization shift
 // - Post normalization rounding (for addition overflow)
+// Fused multiply-add
+// - Normalization shift and rounding. Like multiplication, this doesn't
+//   produce subnormal results. They are flushed to zero.
 //
 
 module fp_execute_stage5(
@@ -50,6 +53,14 @@ module fp_execute_stage5(
 	input [`VECTOR_LANES - 1:0][7:0]    fx4_mul_exponent,
 	input [`VECTOR_LANES - 1:0]         fx4_mul_sign,
 
+	// Fused multiply-add
+	input [`VECTOR_LANES - 1:0][75:0]   fx4_fma_sum,
+	input [`VECTOR_LANES - 1:0][6:0]    fx4_fma_norm_shift,
+	input [`VECTOR_LANES - 1:0]         fx4_fma_sign,
+	input [`VECTOR_LANES - 1:0][9:0]    fx4_fma_exponent,
+	input [`VECTOR_LANES - 1:0]         fx4_fma_bypass,
+	input scalar_t[`VECTOR_LANES - 1:0] fx4_fma_bypass_value,
+
 	// To writeback_stage
 	output logic                        fx5_instruction_valid,
 	output decoded_instruction_t        fx5_instruction,
@@ -62,8 +73,10 @@ module fp_execute_stage5(
 	logic is_imull;
 	logic is_imulh;
 	logic is_ftoi;
+	logic is_fmadd;
 
 	assign is_fmul = fx4_instruction.alu_op == OP_MUL_F;
+	assign is_fmadd = fx4_instruction.alu_op == OP_FMADD_F;
 	assign is_imull = fx4_instruction.alu_op == OP_MULL_I;
 	assign is_imulh = fx4_instruction.alu_op == OP_MULH_U || fx4_instruction.alu_op == OP_MULH_I;
 	assign is_ftoi = fx4_instruction.alu_op == OP_FTOI;
@@ -95,6 +108,13 @@ module fp_execute_stage5(
 			logic sum_is_zero;
 			logic mul_hidden_bit;
 			logic mul_round_overflow;
+			logic[75:0] fma_normalized;
+			logic fma_guard;
+			logic fma_sticky;
+			logic fma_do_round;
+			logic[24:0] fma_rounded_significand;
+			logic[9:0] fma_exponent;
+			scalar_t fma_result;
 
 			assign adjusted_add_exponent = fx4_add_exponent[lane_idx]
 				- `IEEE754_B32_EXP_WIDTH'(fx4_norm_shift[lane_idx]) + `IEEE754_B32_EXP_WIDTH'd8;
@@ -177,6 +197,35 @@ module fp_execute_stage5(
 					fmul_result = {fx4_mul_sign[lane_idx], mul_exponent, mul_rounded_significand};
 			end
 
+			// Fused multiply-add. After normalization, the hidden bit is bit 75.
+			// Round to nearest even.
+			assign fma_normalized = fx4_fma_sum[lane_idx] << fx4_fma_norm_shift[lane_idx];
+			assign fma_guard = fma_normalized[51];
+			assign fma_sticky = |fma_normalized[50:0];
+			assign fma_do_round = fma_guard && (fma_sticky || fma_normalized[52]);
+			assign fma_rounded_significand = {1'b0, fma_normalized[75:52]} + 25'(fma_do_round);
+			assign fma_exponent = fx4_fma_exponent[lane_idx] + 10'd27
+				- 10'(fx4_fma_norm_shift[lane_idx]) + 10'(fma_rounded_significand[24]);
+
+			always_comb
+			begin
+				if (fx4_result_is_nan[lane_idx])
+					fma_result = 32'h7fffffff;
+				else if (fx4_fma_bypass[lane_idx])
+					fma_result = fx4_fma_bypass_value[lane_idx];
+				else if (fx4_fma_norm_shift[lane_idx] == 7'd76)
+					fma_result = 0;	// Exact zero (cancellation)
+				else if (fma_exponent[9] || fma_exponent == 0)
+					fma_result = {fx4_fma_sign[lane_idx], 31'd0};	// Underflow
+				else if (fma_exponent >= 10'd255)
+					fma_result = {fx4_fma_sign[lane_idx], 8'hff, 23'd0};	// Overflow
+				else
+				begin
+					fma_result = {fx4_fma_sign[lane_idx], fma_exponent[7:0],
+						fma_rounded_significand[22:0]};
+				end
+			end
+
 			always_ff @(posedge clk)
 			begin
 				if (is_ftoi)
@@ -194,6 +243,8 @@ module fp_execute_stage5(
 					fx5_result[lane_idx] <= fx4_significand_product[lane_idx][63:32];
 				else if (is_fmul)
 					fx5_result[lane_idx] <= fmul_result;
+				else if (is_fmadd)
+					fx5_result[lane_idx] <= fma_result;
 				else
 					fx5_result[lane_idx] <= add_result;
 			end
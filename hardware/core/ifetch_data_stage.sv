@@ -75,6 +75,10 @@ module ifetch_data_stage(
 	input                            wb_rollback_en,
 	input thread_idx_t               wb_rollback_thread_idx,
 
+	// From instruction_decode_stage
+	input                            id_branch_predict_en,
+	input thread_idx_t               id_branch_predict_thread_idx,
+
 	// Performance counters
 	output logic                     perf_icache_hit,
 	output logic                     perf_icache_miss,
@@ -153,8 +157,9 @@ module ifetch_data_stage(
 
 	assign ifd_update_lru_en = cache_hit && ift_instruction_requested;
 	assign ifd_update_lru_way = way_hit_idx;
-	assign rollback_this_stage = wb_rollback_en && wb_rollback_thread_idx
-		== ift_thread_idx;
+	assign rollback_this_stage = (wb_rollback_en && wb_rollback_thread_idx
+		== ift_thread_idx) || (id_branch_predict_en && id_branch_predict_thread_idx
+		== ift_thread_idx);
 
 	always_ff @(posedge clk, posedge reset)
 	begin
@@ -25,6 +25,9 @@
 //   resident.
 // - Reads translation lookaside buffer to translate from virtual to physical
 //   address.
+// - When the decode stage predicts a branch is taken, continues fetching the
+//   thread from the branch target, discarding instructions after the branch
+//   the same way as a rollback.
 //
 
 module ifetch_tag_stage
@@ -71,6 +74,7 @@ module ifetch_tag_stage
 	input                               dt_update_itlb_en,
 	input                               dt_update_itlb_supervisor,
 	input                               dt_update_itlb_global,
+	input                               dt_update_itlb_superpage,
 	input page_index_t                  dt_update_itlb_ppage_idx,
 
 	// From writeback_stage
@@ -78,6 +82,11 @@ module ifetch_tag_stage
 	input thread_idx_t                  wb_rollback_thread_idx,
 	input scalar_t                      wb_rollback_pc,
 
+	// From instruction_decode_stage
+	input                               id_branch_predict_en,
+	input thread_idx_t                  id_branch_predict_thread_idx,
+	input scalar_t                      id_branch_predict_pc,
+
 	// From thread_select_stage
 	input thread_bitmap_t               ts_fetch_en);
 
@@ -134,6 +143,8 @@ module ifetch_tag_stage
 					next_program_counter[thread_idx] <= RESET_PC;
 				else if (wb_rollback_en && wb_rollback_thread_idx == thread_idx_t'(thread_idx))
 					next_program_counter[thread_idx] <= wb_rollback_pc;
+				else if (id_branch_predict_en && id_branch_predict_thread_idx == thread_idx_t'(thread_idx))
+					next_program_counter[thread_idx] <= id_branch_predict_pc;
 				else if ((ifd_cache_miss || ifd_near_miss) && last_selected_thread_oh[thread_idx])
 					next_program_counter[thread_idx] <= next_program_counter[thread_idx] - 4;
 				else if (selected_thread_oh[thread_idx] && cache_fetch_en)
@@ -200,6 +211,7 @@ module ifetch_tag_stage
 		.update_writable(1'b0),
 		.update_supervisor(dt_update_itlb_supervisor),
 		.update_global(dt_update_itlb_global),
+		.update_superpage(dt_update_itlb_superpage),
 		.invalidate_en(dt_invalidate_tlb_en),
 		.invalidate_all_en(dt_invalidate_tlb_all_en),
 		.request_vpage_idx(cache_fetch_en ? pc_to_fetch[31-:`PAGE_NUM_BITS] : dt_itlb_vpage_idx),
@@ -244,6 +256,7 @@ module ifetch_tag_stage
 		.access_set(pc_to_fetch.set_idx),
 		.access_update_en(ifd_update_lru_en),
 		.access_update_way(ifd_update_lru_way),
+		.access_update_demote(1'b0),
 		.*);
 
 	//
@@ -280,7 +293,8 @@ module ifetch_tag_stage
 			ift_thread_idx <= selected_thread_idx;
 			ift_instruction_requested <= cache_fetch_en
 				&& !((ifd_cache_miss || ifd_near_miss) && ifd_cache_miss_thread_idx == selected_thread_idx)
-				&& !(wb_rollback_en && wb_rollback_thread_idx == selected_thread_idx);
+				&& !(wb_rollback_en && wb_rollback_thread_idx == selected_thread_idx)
+				&& !(id_branch_predict_en && id_branch_predict_thread_idx == selected_thread_idx);
 			last_selected_thread_oh <= selected_thread_oh;
 		end
 	end
@@ -21,6 +21,11 @@
 // Populate the decoded_instruction_t structure with fields from
 // the instruction. The structure contains control fields will be
 // used later in the pipeline.
+// - Statically predicts PC relative branches and redirects instruction fetch
+//   for ones that are predicted taken. Unconditional branches and calls are
+//   always taken. Conditional branches are predicted taken if they go
+//   backward (usually a loop) and not taken if they go forward. The integer
+//   execute stage checks the prediction and rolls back if it was wrong.
 //
 // Register port to operand mapping
 //                                               store
@@ -29,15 +34,34 @@
 // | R - scalar/scalar |   s1  |   s2  |       |       |
 // | R - vector/scalar |   v1  |   s2  |  s1   |       |
 // | R - vector/vector |   v1  |   v2  |  s2   |       |
+// | R - fmadd v/s     |   v1  |   s2  |       |  v3   |
+// | R - fmadd v/v     |   v1  |   v2  |       |  s3   |
 // | I - scalar        |   s1  |  imm  |  n/a  |       |
 // | I - vector        |   v1  |  imm  |  s2   |       |
 // | M - scalar        |   s1  |  imm  |  n/a  |  s2   |
 // | M - block         |   s1  |  imm  |  s2   |  v2   |
 // | M - scatter/gather|   v1  |  imm  |  s2   |  v2   |
+// | M - sample        |   v1  |   s2  |  s1   |  v2   |
 // | C                 |   s1  |  imm  |       |       |
 // | B                 |   s1  |       |       |       |
 // +-------------------+-------+-------+-------+-------+
 //
+// Horizontal reductions (hadd_i, hmin_i, hmax_i, hmin_f, hmax_f) combine
+// the lanes of op2 that are enabled by the mask and write the result to a
+// scalar register. They only have vector/vector formats. compress only has
+// vector/scalar formats. The scalar operand is a lane mask.
+//
+// Fused multiply-add has a third source register (the addend) in bits 14-10,
+// the field that holds the mask register for masked formats. It is read
+// through the register port the format doesn't otherwise use and is passed
+// down the pipeline as the store value (v3/s3 above). Only the unmasked
+// vector formats are supported.
+//
+// A texture sample (load_sample) has no immediate offset. The u coordinates
+// are in bits 4-0, the mask register in bits 14-10, the texture base address
+// register in bits 19-15, and the v coordinates in bits 24-20. The v
+// coordinates are passed down the pipeline as the store value.
+//
 
 module instruction_decode_stage(
 	input                         clk,
@@ -57,6 +81,11 @@ module instruction_decode_stage(
 	output logic                  id_instruction_valid,
 	output thread_idx_t           id_thread_idx,
 
+	// To ifetch_tag_stage/ifetch_data_stage
+	output logic                  id_branch_predict_en,
+	output thread_idx_t           id_branch_predict_thread_idx,
+	output scalar_t               id_branch_predict_pc,
+
 	// From interrupt_controller
 	input thread_bitmap_t         ic_interrupt_pending,
 
@@ -117,12 +146,19 @@ module instruction_decode_stage(
 	logic is_fmt_m;
 	logic is_getlane;
 	logic is_compare;
+	logic is_fmadd;
+	logic is_reduce;
+	logic is_compress;
+	logic is_packed;
+	logic is_half_convert;
+	logic is_sample;
 	alu_op_t alu_op;
 	memory_op_t memory_access_type;
 	register_idx_t scalar_sel2;
 	logic is_legal_instruction;
 	logic is_syscall;
 	logic raise_interrupt;
+	logic predict_taken;
 
 	// I originally tried to structure the instruction set so that this could
 	// determine the format of the instruction from the first 7 bits. Those
@@ -157,6 +193,8 @@ module instruction_decode_stage(
 			7'b10_0_0110: dlut_out = {F, F, F, IMM_24_10, SCLR1_4_0, SCLR2_9_5,     F, F, T, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, F, F};
 			7'b10_0_0111: dlut_out = {F, F, F, IMM_24_10, SCLR1_4_0, SCLR2_NONE,    F, T, T, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, T, F};
 			7'b10_0_1000: dlut_out = {F, F, F, IMM_24_15, SCLR1_4_0, SCLR2_14_10, F, T, T, F, OP2_SRC_IMMEDIATE, MASK_SRC_SCALAR2, T, F};
+			7'b10_0_1001: dlut_out = {F, F, F, IMM_24_10, SCLR1_4_0, SCLR2_NONE,    F, T, T, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, T, F};
+			7'b10_0_1010: dlut_out = {F, F, T, IMM_24_15, SCLR1_4_0, SCLR2_9_5,     F, F, T, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, F, F};
 			7'b10_0_1101: dlut_out = {F, F, F, IMM_24_10, SCLR1_4_0, SCLR2_NONE,    T, T, T, T, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, T, F};
 			7'b10_0_1110: dlut_out = {F, F, F, IMM_24_15, SCLR1_4_0, SCLR2_14_10, T, T, T, T, OP2_SRC_IMMEDIATE, MASK_SRC_SCALAR2, T, F};
 
@@ -170,6 +208,7 @@ module instruction_decode_stage(
 			7'b10_1_0110: dlut_out = {F, F, T, IMM_24_10, SCLR1_4_0, SCLR2_NONE,    T, F, F, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, F, F};
 			7'b10_1_0111: dlut_out = {F, T, T, IMM_24_10, SCLR1_4_0, SCLR2_NONE,    T, F, F, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, F, F};
 			7'b10_1_1000: dlut_out = {F, T, T, IMM_24_15, SCLR1_4_0, SCLR2_14_10, T, F, F, F, OP2_SRC_IMMEDIATE, MASK_SRC_SCALAR2, F, F};
+			7'b10_1_1011: dlut_out = {F, T, T, IMM_ZERO, SCLR1_14_10, SCLR2_19_15,  T, T, F, T, OP2_SRC_SCALAR2, MASK_SRC_SCALAR1, T, F};
 			7'b10_1_1101: dlut_out = {F, T, T, IMM_24_10, SCLR1_4_0, SCLR2_NONE,    T, T, F, T, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, F, F};
 			7'b10_1_1110: dlut_out = {F, T, T, IMM_24_15, SCLR1_4_0, SCLR2_14_10, T, T, F, T, OP2_SRC_IMMEDIATE, MASK_SRC_SCALAR2, F, F};
 
@@ -196,6 +235,33 @@ module instruction_decode_stage(
 			// Invalid instruction format
 			default: dlut_out = {T, F, F, IMM_ZERO, SCLR1_NONE, SCLR2_NONE, F, F, F, F, OP2_SRC_IMMEDIATE, MASK_SRC_ALL_ONES, F, F};
 		endcase
+
+		// There is no atomic operation for this encoding
+		if (ifd_instruction[31:25] == 7'b10_0_1010 && ifd_instruction[12:10] == 3'b111)
+			dlut_out.illegal = T;
+
+		if (is_fmadd)
+		begin
+			case (ifd_instruction[28:26])
+				3'b001:	// Vector/scalar, vector addend
+				begin
+					dlut_out.has_vector2 = T;
+					dlut_out.store_value_is_vector = T;
+				end
+
+				3'b100:	// Vector/vector, scalar addend
+					dlut_out.scalar2_loc = SCLR2_14_10;
+
+				default:
+					dlut_out.illegal = T;
+			endcase
+		end
+
+		if (is_reduce && ifd_instruction[28:26] != 3'b100 && ifd_instruction[28:26] != 3'b101)
+			dlut_out.illegal = T;
+
+		if (is_compress && ifd_instruction[28:26] != 3'b001 && ifd_instruction[28:26] != 3'b010)
+			dlut_out.illegal = T;
 	end
 
 	assign is_fmt_r = ifd_instruction[31:29] == 3'b110;	// register arithmetic
@@ -204,6 +270,26 @@ module instruction_decode_stage(
 	assign is_getlane = (is_fmt_r || is_fmt_i) && alu_op == OP_GETLANE;
 
 	assign is_syscall = is_fmt_r && ifd_instruction[25:20] == OP_SYSCALL;
+	assign is_fmadd = is_fmt_r && ifd_instruction[25:20] == OP_FMADD_F;
+	assign is_reduce = is_fmt_r && (ifd_instruction[25:20] == OP_HADD_I
+		|| ifd_instruction[25:20] == OP_HMIN_I
+		|| ifd_instruction[25:20] == OP_HMAX_I
+		|| ifd_instruction[25:20] == OP_HMIN_F
+		|| ifd_instruction[25:20] == OP_HMAX_F);
+	assign is_compress = is_fmt_r && ifd_instruction[25:20] == OP_COMPRESS;
+	assign is_packed = is_fmt_r && (ifd_instruction[25:20] == OP_ADDS_U8
+		|| ifd_instruction[25:20] == OP_SUBS_U8
+		|| ifd_instruction[25:20] == OP_ADDS_U16
+		|| ifd_instruction[25:20] == OP_SUBS_U16
+		|| ifd_instruction[25:20] == OP_MULHI_U8
+		|| ifd_instruction[25:20] == OP_MULHI_U16
+		|| ifd_instruction[25:20] == OP_UNPACK_U8
+		|| ifd_instruction[25:20] == OP_UNPACK_U16
+		|| ifd_instruction[25:20] == OP_PACK_U8
+		|| ifd_instruction[25:20] == OP_PACK_U16);
+	assign is_half_convert = is_fmt_r && (ifd_instruction[25:20] == OP_HTOF
+		|| ifd_instruction[25:20] == OP_FTOH);
+	assign is_sample = ifd_instruction[31:25] == 7'b10_1_1011;
 	assign is_nop = ifd_instruction == `INSTRUCTION_NOP;
 	assign is_legal_instruction = !dlut_out.illegal && !ifd_alignment_fault && !ifd_tlb_miss
 		&& !ifd_supervisor_fault;
@@ -252,6 +338,10 @@ module instruction_decode_stage(
 	begin
 		if (dlut_out.vector_sel2_is_9_5)
 			decoded_instr_nxt.vector_sel2 = ifd_instruction[9:5];
+		else if (is_fmadd && ifd_instruction[28:26] == 3'b001)
+			decoded_instr_nxt.vector_sel2 = ifd_instruction[14:10];	// Addend
+		else if (is_sample)
+			decoded_instr_nxt.vector_sel2 = ifd_instruction[24:20];	// v coordinates
 		else
 			decoded_instr_nxt.vector_sel2 = ifd_instruction[19:15];
 	end
@@ -260,7 +350,7 @@ module instruction_decode_stage(
 		&& !is_syscall;
 
 	assign decoded_instr_nxt.dest_is_vector = dlut_out.dest_is_vector && !is_compare
-		&& !is_getlane;
+		&& !is_getlane && !is_reduce;
 	assign decoded_instr_nxt.dest_reg = dlut_out.is_call ? `REG_RA : ifd_instruction[9:5];
 	always_comb
 	begin
@@ -309,6 +399,34 @@ module instruction_decode_stage(
 		&& is_legal_instruction;
 	assign decoded_instr_nxt.pc = ifd_pc;
 
+	// Static branch prediction. Don't predict if this instruction will take
+	// an interrupt or is being rolled back.
+	always_comb
+	begin
+		case (decoded_instr_nxt.branch_type)
+			BRANCH_ALWAYS,
+			BRANCH_CALL_OFFSET:
+				predict_taken = 1;
+
+			BRANCH_ALL,
+			BRANCH_ZERO,
+			BRANCH_NOT_ZERO,
+			BRANCH_NOT_ALL:
+				predict_taken = ifd_instruction[24];	// Backward branch
+
+			default:
+				predict_taken = 0;	// Target is in a register
+		endcase
+	end
+
+	assign decoded_instr_nxt.branch_predicted = decoded_instr_nxt.is_branch
+		&& predict_taken && !raise_interrupt;
+	assign id_branch_predict_en = decoded_instr_nxt.branch_predicted
+		&& ifd_instruction_valid
+		&& (!wb_rollback_en || wb_rollback_thread_idx != ifd_thread_idx);
+	assign id_branch_predict_thread_idx = ifd_thread_idx;
+	assign id_branch_predict_pc = ifd_pc + 4 + decoded_instr_nxt.immediate_value;
+
 	always_comb
 	begin
 		if (dlut_out.illegal || ifd_alignment_fault || ifd_tlb_miss || ifd_supervisor_fault
@@ -316,8 +434,9 @@ module instruction_decode_stage(
 			decoded_instr_nxt.pipeline_sel = PIPE_SCYCLE_ARITH;
 		else if (is_fmt_r || is_fmt_i)
 		begin
-			if (alu_op[5] || alu_op == OP_MULL_I || alu_op == OP_MULH_U
-				 || alu_op == OP_MULH_I || alu_op == OP_FTOI)
+			if ((alu_op[5] && !is_reduce && !is_compress && !is_packed && !is_half_convert)
+				|| alu_op == OP_MULL_I
+				|| alu_op == OP_MULH_U || alu_op == OP_MULH_I || alu_op == OP_FTOI)
 				decoded_instr_nxt.pipeline_sel = PIPE_MCYCLE_ARITH;
 			else
 				decoded_instr_nxt.pipeline_sel = PIPE_SCYCLE_ARITH;
@@ -330,21 +449,24 @@ module instruction_decode_stage(
 
 	assign memory_access_type = memory_op_t'(ifd_instruction[28:25]);
 	assign decoded_instr_nxt.memory_access_type = memory_access_type;
+	assign decoded_instr_nxt.atomic_op = atomic_op_t'(ifd_instruction[12:10]);
 	assign decoded_instr_nxt.is_memory_access = ifd_instruction[31:30] == 2'b10
 		&& is_legal_instruction;
 	assign decoded_instr_nxt.is_load = ifd_instruction[29]
 		&& is_fmt_m;
 	assign decoded_instr_nxt.is_cache_control = ifd_instruction[31:28] == 4'b1110
 		 && is_legal_instruction;
-	assign decoded_instr_nxt.cache_control_op = cache_op_t'(ifd_instruction[27:25]);
+	assign decoded_instr_nxt.cache_control_op = cache_op_t'({ifd_instruction[14],
+		ifd_instruction[27:25]});
 
 	always_comb
 	begin
 		if (ifd_instruction[31:30] == 2'b10
 			&& (memory_access_type == MEM_SCGATH
-			|| memory_access_type == MEM_SCGATH_M))
+			|| memory_access_type == MEM_SCGATH_M
+			|| memory_access_type == MEM_SAMPLE))
 		begin
-			// Scatter/Gather access
+			// Scatter/Gather access or texture sample
 			decoded_instr_nxt.last_subcycle = subcycle_t'(`VECTOR_LANES - 1);
 		end
 		else
@@ -20,7 +20,12 @@
 // Instruction Pipeline Integer Execute Stage
 // - Performs simple operations that only require a single stage like integer
 //   addition or bitwise logical operations.
-// - Detects branches
+// - Horizontal reductions and compress, which move data between lanes.
+// - Packed byte and halfword operations. These use small multipliers in
+//   this stage rather than the 32 bit multiplier in the floating point
+//   pipeline, which can't be split into independent byte products.
+// - Resolves branches. Rolls back if the branch is taken and the decode stage
+//   did not predict it, or if it was predicted taken and isn't.
 //
 
 module int_execute_stage(
@@ -58,9 +63,106 @@ module int_execute_stage(
 	output subcycle_t                 ix_subcycle,
 	output logic                      ix_privileged_op_fault);
 
+	typedef logic[$clog2(`VECTOR_LANES) - 1:0] lane_idx_t;
+
 	vector_t vector_result;
 	logic is_eret;
 	logic privileged_op_fault;
+	logic branch_taken;
+	scalar_t reduce_identity;
+	scalar_t reduce_node[2 * `VECTOR_LANES];
+	vector_lane_mask_t compress_select;
+	lane_idx_t compress_pos[`VECTOR_LANES];
+	vector_t compress_result;
+
+	//
+	// Horizontal reductions. This is a tree where node n combines nodes 2n + 1
+	// and 2n, the root is node 1, and lane l is leaf VECTOR_LANES + l. The
+	// emulator evaluates it in the same order, because the floating point
+	// forms can depend on it when there are NaNs. Lanes that are masked off
+	// are replaced with a value that doesn't change the result.
+	//
+	always_comb
+	begin
+		case (of_instruction.alu_op)
+			OP_HMIN_I: reduce_identity = 32'h7fffffff;
+			OP_HMAX_I: reduce_identity = 32'h80000000;
+			OP_HMIN_F: reduce_identity = 32'h7f800000;	// +inf
+			OP_HMAX_F: reduce_identity = 32'hff800000;	// -inf
+			default: reduce_identity = 0;
+		endcase
+	end
+
+	genvar node;
+	generate
+		for (node = 1; node < `VECTOR_LANES; node++)
+		begin : reduce_gen
+			scalar_t left;
+			scalar_t right;
+			logic left_nan;
+			logic right_nan;
+			logic both_zero;
+			logic left_mag_lt;
+			logic right_mag_lt;
+			logic left_lt_f;
+			logic right_lt_f;
+			scalar_t result;
+
+			assign left = reduce_node[node * 2 + 1];
+			assign right = reduce_node[node * 2];
+
+			// Floating point less than, with the same results as the
+			// comparison instructions: NaN is unordered and -0.0 == 0.0.
+			assign left_nan = left[30:23] == 8'hff && left[22:0] != 0;
+			assign right_nan = right[30:23] == 8'hff && right[22:0] != 0;
+			assign both_zero = left[30:0] == 0 && right[30:0] == 0;
+			assign left_mag_lt = left[30:0] < right[30:0];
+			assign right_mag_lt = right[30:0] < left[30:0];
+			assign left_lt_f = !left_nan && !right_nan && !both_zero
+				&& (left[31] != right[31] ? left[31] : (left[31] ? right_mag_lt : left_mag_lt));
+			assign right_lt_f = !left_nan && !right_nan && !both_zero
+				&& (left[31] != right[31] ? right[31] : (left[31] ? left_mag_lt : right_mag_lt));
+
+			always_comb
+			begin
+				case (of_instruction.alu_op)
+					OP_HMIN_I: result = $signed(right) < $signed(left) ? right : left;
+					OP_HMAX_I: result = $signed(left) < $signed(right) ? right : left;
+					OP_HMIN_F: result = right_lt_f ? right : left;
+					OP_HMAX_F: result = left_lt_f ? right : left;
+					default: result = left + right;	// OP_HADD_I
+				endcase
+			end
+
+			assign reduce_node[node] = result;
+		end
+	endgenerate
+
+	assign reduce_node[0] = 0;	// Unused
+
+	//
+	// Compress. Each lane selected by the mask in op2 is moved down to the
+	// next unused element, in element order (element 0 is lane 15). The
+	// remaining elements are zero.
+	//
+	assign compress_select = of_operand2[0][`VECTOR_LANES - 1:0];
+
+	always_comb
+	begin
+		compress_pos[`VECTOR_LANES - 1] = 0;
+		for (int i = `VECTOR_LANES - 2; i >= 0; i--)
+			compress_pos[i] = compress_pos[i + 1] + lane_idx_t'(compress_select[i + 1]);
+	end
+
+	always_comb
+	begin
+		compress_result = 0;
+		for (int i = 0; i < `VECTOR_LANES; i++)
+		begin
+			if (compress_select[i])
+				compress_result[~compress_pos[i]] = of_operand1[i];
+		end
+	end
 
 	genvar lane;
 	generate
@@ -80,11 +182,31 @@ module int_execute_stage(
 			scalar_t reciprocal;
 			ieee754_binary32_t fp_operand;
 			logic[5:0] reciprocal_estimate;
+			scalar_t rsqrt;
+			logic[5:0] rsqrt_estimate;
+			logic[8:0] rsqrt_exponent;
 			logic shift_in_sign;
 			scalar_t rshift;
+			logic[7:0] unorm_byte;
+			logic[2:0] unorm_lz;
+			scalar_t unorm_pattern;
+			scalar_t unorm;
+			scalar_t packed_u8;
+			scalar_t packed_u16;
+			scalar_t pack_clamp;
+			logic[15:0] half_in;
+			logic[3:0] half_lz;
+			scalar_t htof;
+			logic signed[9:0] ftoh_exponent;
+			logic[5:0] ftoh_shift;
+			logic[49:0] ftoh_shifted;
+			logic[14:0] ftoh_truncated;
+			logic ftoh_round;
+			logic[15:0] ftoh;
 
 			assign lane_operand1 = of_operand1[lane];
 			assign lane_operand2 = of_operand2[lane];
+			assign reduce_node[`VECTOR_LANES + lane] = of_mask_value[lane] ? lane_operand2 : reduce_identity;
 			assign {borrow, difference} = {1'b0, lane_operand1} - {1'b0, lane_operand2};
 			assign negative = difference[31];
 			assign overflow = lane_operand2[31] == negative && lane_operand1[31] != lane_operand2[31];
@@ -177,6 +299,153 @@ module int_execute_stage(
 			assign shift_in_sign = of_instruction.alu_op == OP_ASHR ? lane_operand1[31] : 1'd0;
 			assign rshift = scalar_t'({{32{shift_in_sign}}, lane_operand1} >> lane_operand2[4:0]);
 
+			// Unsigned normalized byte to float (byte / 255), used to unpack
+			// color channels. In binary, this is the byte repeated forever after
+			// the point, so normalizing only needs to shift the repeated pattern
+			// left. The remaining bits are never all zero, so rounding up when
+			// the next bit is set gives the correctly rounded result. For 255,
+			// this carries into the exponent and produces exactly 1.0.
+			assign unorm_byte = rshift[7:0];
+			always_comb
+			begin
+				casez (unorm_byte)
+					8'b1???????: unorm_lz = 0;
+					8'b01??????: unorm_lz = 1;
+					8'b001?????: unorm_lz = 2;
+					8'b0001????: unorm_lz = 3;
+					8'b00001???: unorm_lz = 4;
+					8'b000001??: unorm_lz = 5;
+					8'b0000001?: unorm_lz = 6;
+					default: unorm_lz = 7;
+				endcase
+			end
+
+			assign unorm_pattern = {4{unorm_byte}} << ({2'd0, unorm_lz} + 5'd1);
+			assign unorm = unorm_byte == 0 ? scalar_t'(0) : {1'b0, {8'd126 - 8'(unorm_lz),
+				unorm_pattern[31:9]} + 31'(unorm_pattern[8])};
+
+			// Packed bytes (four per lane). Each field is handled
+			// independently, with no carries between them.
+			always_comb
+			begin
+				for (int i = 0; i < 4; i++)
+				begin
+					logic[8:0] sum;
+					logic[8:0] diff;
+					logic[15:0] product;
+
+					sum = {1'b0, lane_operand1[i * 8+:8]} + {1'b0, lane_operand2[i * 8+:8]};
+					diff = {1'b0, lane_operand1[i * 8+:8]} - {1'b0, lane_operand2[i * 8+:8]};
+					product = lane_operand1[i * 8+:8] * lane_operand2[i * 8+:8];
+					case (of_instruction.alu_op)
+						OP_ADDS_U8: packed_u8[i * 8+:8] = sum[8] ? 8'hff : sum[7:0];
+						OP_SUBS_U8: packed_u8[i * 8+:8] = diff[8] ? 8'h00 : diff[7:0];
+						default: packed_u8[i * 8+:8] = product[15:8];	// OP_MULHI_U8
+					endcase
+				end
+			end
+
+			// Packed halfwords (two per lane)
+			always_comb
+			begin
+				for (int i = 0; i < 2; i++)
+				begin
+					logic[16:0] sum;
+					logic[16:0] diff;
+					logic[31:0] product;
+
+					sum = {1'b0, lane_operand1[i * 16+:16]} + {1'b0, lane_operand2[i * 16+:16]};
+					diff = {1'b0, lane_operand1[i * 16+:16]} - {1'b0, lane_operand2[i * 16+:16]};
+					product = lane_operand1[i * 16+:16] * lane_operand2[i * 16+:16];
+					case (of_instruction.alu_op)
+						OP_ADDS_U16: packed_u16[i * 16+:16] = sum[16] ? 16'hffff : sum[15:0];
+						OP_SUBS_U16: packed_u16[i * 16+:16] = diff[16] ? 16'h0000 : diff[15:0];
+						default: packed_u16[i * 16+:16] = product[31:16];	// OP_MULHI_U16
+					endcase
+				end
+			end
+
+			// Pack clamps op2 (signed) to the field size and inserts it below
+			// op1, so a pixel can be built from channels one at a time.
+			always_comb
+			begin
+				if (lane_operand2[31])
+					pack_clamp = 0;
+				else if (of_instruction.alu_op == OP_PACK_U8)
+					pack_clamp = lane_operand2 > 32'hff ? 32'hff : lane_operand2;
+				else
+					pack_clamp = lane_operand2 > 32'hffff ? 32'hffff : lane_operand2;
+			end
+
+			// Half precision to single. Every half value is exactly
+			// representable as a single, so this only rebiases the exponent
+			// and normalizes subnormals.
+			assign half_in = lane_operand1[lane_operand2[0] * 16+:16];
+			always_comb
+			begin
+				casez (half_in[9:0])
+					10'b1?????????: half_lz = 0;
+					10'b01????????: half_lz = 1;
+					10'b001???????: half_lz = 2;
+					10'b0001??????: half_lz = 3;
+					10'b00001?????: half_lz = 4;
+					10'b000001????: half_lz = 5;
+					10'b0000001???: half_lz = 6;
+					10'b00000001??: half_lz = 7;
+					10'b000000001?: half_lz = 8;
+					default: half_lz = 9;
+				endcase
+			end
+
+			always_comb
+			begin
+				if (half_in[14:10] == 5'h1f)
+					htof = {half_in[15], 8'hff, half_in[9:0], 13'd0};	// Inf or NaN
+				else if (half_in[14:0] == 0)
+					htof = {half_in[15], 31'd0};	// Zero
+				else if (half_in[14:10] == 0)
+				begin
+					// Subnormal
+					htof = {half_in[15], 8'd112 - 8'(half_lz),
+						10'(half_in[9:0] << (half_lz + 4'd1)), 13'd0};
+				end
+				else
+					htof = {half_in[15], 8'(half_in[14:10]) + 8'd112, half_in[9:0], 13'd0};
+			end
+
+			// Single precision to half, rounded to nearest even. The
+			// significand (with the implicit one) is shifted so the half
+			// significand is in bits 35:26 and the discarded bits are below
+			// it. For results that are subnormal halves, it is shifted further.
+			// Anything smaller than half the smallest subnormal is shifted out
+			// completely and rounds to zero. Rounding up may carry into the
+			// exponent, which also handles rounding up to infinity.
+			assign ftoh_exponent = {2'b00, fp_operand.exponent} - 10'sd112;
+			always_comb
+			begin
+				if (ftoh_exponent > 0)
+					ftoh_shift = 13;
+				else if (ftoh_exponent < -10'sd12)
+					ftoh_shift = 26;
+				else
+					ftoh_shift = 6'(10'sd14 - ftoh_exponent);
+			end
+
+			assign ftoh_shifted = {1'b1, fp_operand.significand, 26'd0} >> ftoh_shift;
+			assign ftoh_truncated = {ftoh_exponent > 0 ? ftoh_exponent[4:0] : 5'd0,
+				ftoh_shifted[35:26]};
+			assign ftoh_round = ftoh_shifted[25] && (ftoh_shifted[24:0] != 0 || ftoh_shifted[26]);
+
+			always_comb
+			begin
+				if (fp_operand.exponent == 8'hff && fp_operand.significand != 0)
+					ftoh = {fp_operand.sign, 5'h1f, 1'b1, fp_operand.significand[21:13]};	// NaN (quiet)
+				else if (ftoh_exponent >= 10'sd31)
+					ftoh = {fp_operand.sign, 5'h1f, 10'd0};	// Inf or overflow
+				else
+					ftoh = {fp_operand.sign, ftoh_truncated + 15'(ftoh_round)};
+			end
+
 			// Reciprocal estimate
 			assign fp_operand = lane_operand2;
 			reciprocal_rom rom(
@@ -205,6 +474,32 @@ module int_execute_stage(
 				end
 			end
 
+			// Reciprocal square root estimate. Halving the exponent depends on
+			// whether it is even or odd, so the low bit of the exponent is part
+			// of the ROM index. The result is only 1.0 (which isn't normalized
+			// the same way as the other estimates) when the index is
+			// {1, 000000}.
+			rsqrt_rom rsqrt_rom(
+				.index({fp_operand.exponent[0], fp_operand.significand[22:17]}),
+				.rsqrt_estimate);
+
+			assign rsqrt_exponent = 9'd380 - 9'(fp_operand.exponent);
+
+			always_comb
+			begin
+				if (fp_operand.exponent == 0)
+					rsqrt = {fp_operand.sign, 8'hff, 23'd0}; // Zero or subnormal = +/-inf
+				else if (fp_operand.sign || (fp_operand.exponent == 8'hff && fp_operand.significand != 0))
+					rsqrt = {1'b0, 8'hff, 23'h7fffff}; // Negative or NaN = NaN
+				else if (fp_operand.exponent == 8'hff)
+					rsqrt = 0; // +inf = 0
+				else
+				begin
+					rsqrt = {1'b0, rsqrt_exponent[8:1] + 8'({fp_operand.exponent[0],
+						fp_operand.significand[22:17]} == 7'b1000000), rsqrt_estimate, {17{1'b0}}};
+				end
+			end
+
 			always_comb
 			begin
 				case (of_instruction.alu_op)
@@ -234,6 +529,26 @@ module int_execute_stage(
 					OP_SHUFFLE,
 					OP_GETLANE: lane_result = of_operand1[~lane_operand2];
 					OP_RECIPROCAL: lane_result = reciprocal;
+					OP_RSQRT: lane_result = rsqrt;
+					OP_UNORM8_F: lane_result = unorm;
+					OP_HADD_I,
+					OP_HMIN_I,
+					OP_HMAX_I,
+					OP_HMIN_F,
+					OP_HMAX_F: lane_result = reduce_node[1];
+					OP_COMPRESS: lane_result = compress_result[lane];
+					OP_ADDS_U8,
+					OP_SUBS_U8,
+					OP_MULHI_U8: lane_result = packed_u8;
+					OP_ADDS_U16,
+					OP_SUBS_U16,
+					OP_MULHI_U16: lane_result = packed_u16;
+					OP_UNPACK_U8: lane_result = scalar_t'(lane_operand1[lane_operand2[1:0] * 8+:8]);
+					OP_UNPACK_U16: lane_result = scalar_t'(lane_operand1[lane_operand2[0] * 16+:16]);
+					OP_PACK_U8: lane_result = {lane_operand1[23:0], pack_clamp[7:0]};
+					OP_PACK_U16: lane_result = {lane_operand1[15:0], pack_clamp[15:0]};
+					OP_HTOF: lane_result = htof;
+					OP_FTOH: lane_result = {lane_operand1[15:0], ftoh};
 					default: lane_result = 0;
 				endcase
 			end
@@ -245,6 +560,20 @@ module int_execute_stage(
 	assign is_eret = of_instruction.is_branch && of_instruction.branch_type == BRANCH_ERET;
 	assign privileged_op_fault = is_eret && !cr_supervisor_en[of_thread_idx];
 
+	always_comb
+	begin
+		unique case (of_instruction.branch_type)
+			BRANCH_ALL:            branch_taken = of_operand1[0][15:0] == 16'hffff;
+			BRANCH_ZERO:           branch_taken = of_operand1[0] == 0;
+			BRANCH_NOT_ZERO:       branch_taken = of_operand1[0] != 0;
+			BRANCH_NOT_ALL:        branch_taken = of_operand1[0][15:0] != 16'hffff;
+			BRANCH_ALWAYS,
+			BRANCH_CALL_OFFSET,
+			BRANCH_CALL_REGISTER,
+			BRANCH_ERET:           branch_taken = 1'b1;
+		endcase
+	end
+
 	always_ff @(posedge clk, posedge reset)
 	begin
 		if (reset)
@@ -281,12 +610,17 @@ module int_execute_stage(
 				//
 				// Branch handling
 				//
-				unique case (of_instruction.branch_type)
-					BRANCH_CALL_REGISTER: ix_rollback_pc <= of_operand1[0];
-					BRANCH_ERET: ix_rollback_pc <= cr_eret_address[of_thread_idx];
-					default:
-						ix_rollback_pc <= of_instruction.pc + 4 + of_instruction.immediate_value;
-				endcase
+				if (of_instruction.branch_predicted)
+					ix_rollback_pc <= of_instruction.pc + 4;	// Mispredicted, not taken
+				else
+				begin
+					unique case (of_instruction.branch_type)
+						BRANCH_CALL_REGISTER: ix_rollback_pc <= of_operand1[0];
+						BRANCH_ERET: ix_rollback_pc <= cr_eret_address[of_thread_idx];
+						default:
+							ix_rollback_pc <= of_instruction.pc + 4 + of_instruction.immediate_value;
+					endcase
+				end
 
 				ix_is_eret <= is_eret && !privileged_op_fault;
 				ix_privileged_op_fault <= privileged_op_fault;
@@ -297,16 +631,7 @@ module int_execute_stage(
 					&& !of_instruction.ifetch_supervisor_fault
 					&& !privileged_op_fault)
 				begin
-					unique case (of_instruction.branch_type)
-						BRANCH_ALL:            ix_rollback_en <= of_operand1[0][15:0] == 16'hffff;
-						BRANCH_ZERO:           ix_rollback_en <= of_operand1[0] == 0;
-						BRANCH_NOT_ZERO:       ix_rollback_en <= of_operand1[0] != 0;
-						BRANCH_NOT_ALL:        ix_rollback_en <= of_operand1[0][15:0] != 16'hffff;
-						BRANCH_ALWAYS,
-						BRANCH_CALL_OFFSET,
-						BRANCH_CALL_REGISTER,
-						BRANCH_ERET:           ix_rollback_en <= 1'b1;
-					endcase
+					ix_rollback_en <= branch_taken != of_instruction.branch_predicted;
 				end
 				else
 					ix_rollback_en <= 0;
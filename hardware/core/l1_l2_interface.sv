@@ -24,6 +24,11 @@
 // - Tracks pending load misses from L1 instruction and data caches
 //   (l1_load_miss_queue).
 // - Tracks pending stores from pipeline (l1_store_queue).
+// - Prefetches strided data cache miss streams into the L2 cache
+//   (l1_stride_prefetcher), if enabled.
+// - Sends software prefetch (dtouch) requests to the L2 cache.
+// - Wakes threads suspended by dwait when the line they are waiting on is
+//   written (l1_wait_monitor).
 // - Arbitrates miss sources and sends L2 cache requests.
 // - Processes L2 responses, updating L1 instruction and data caches.
 //
@@ -109,19 +114,31 @@ module l1_l2_interface
 	input                                         dd_membar_en,
 	input                                         dd_iinvalidate_en,
 	input                                         dd_dinvalidate_en,
+	input                                         dd_prefetch_en,
+	input                                         dd_wait_en,
+	input scalar_t                                dd_prefetch_addr,
 	input [`CACHE_LINE_BYTES - 1:0]               dd_store_mask,
 	input scalar_t                                dd_store_addr,
 	input cache_line_data_t                       dd_store_data,
 	input thread_idx_t                            dd_store_thread_idx,
 	input                                         dd_store_synchronized,
+	input                                         dd_store_no_allocate,
+	input                                         dd_store_atomic,
+	input atomic_op_t                             dd_store_atomic_op,
 	input scalar_t                                dd_store_bypass_addr,
 	input thread_idx_t                            dd_store_bypass_thread_idx,
 
 	// To writeback_stage
 	output [`CACHE_LINE_BYTES - 1:0]              sq_store_bypass_mask,
 	output logic                                  sq_store_sync_success,
+	output scalar_t                               sq_store_atomic_value,
 	output cache_line_data_t                      sq_store_bypass_data,
-	output                                        sq_rollback_en);
+	output                                        sq_rollback_en,
+
+	// Performance events
+	output logic                                  perf_prefetch_useful,
+	output logic                                  perf_prefetch_late,
+	output logic                                  perf_store_combined);
 
 	logic[`L1D_WAYS - 1:0] snoop_hit_way_oh;	// Only snoops dcache
 	l1d_way_idx_t snoop_hit_way_idx;
@@ -146,6 +163,7 @@ module l1_l2_interface
 	logic [`CACHE_LINE_BYTES - 1:0] sq_dequeue_mask;
 	cache_line_data_t sq_dequeue_data;
 	logic sq_dequeue_synchronized;
+	logic sq_dequeue_no_allocate;
 	logic icache_dequeue_ready;
 	logic icache_dequeue_ack;
 	logic dcache_dequeue_ready;
@@ -164,11 +182,28 @@ module l1_l2_interface
 	logic sq_dequeue_flush;
 	logic sq_dequeue_iinvalidate;
 	logic sq_dequeue_dinvalidate;
+	logic sq_dequeue_atomic;
+	atomic_op_t sq_dequeue_atomic_op;
+	scalar_t storebuf_l2_atomic_value;
 	logic response_is_iinvalidate;
 	logic response_is_dinvalidate;
+	logic prefetch_dequeue_ready;
+	logic prefetch_dequeue_ack;
+	scalar_t prefetch_dequeue_addr;
+	logic prefetch_l2_response_valid;
+	logic sw_prefetch_pending;
+	scalar_t sw_prefetch_addr;
+	logic sw_prefetch_ack;
+	thread_bitmap_t wait_wake_bitmap;
+	logic wait_update_valid;
 
 	l1_store_queue l1_store_queue(.*);
 
+	l1_wait_monitor l1_wait_monitor(
+		.l2_update_valid(wait_update_valid),
+		.l2_update_addr(response_stage2.address),
+		.*);
+
 	l1_load_miss_queue l1_load_miss_queue_dcache(
 		// Enqueue requests
 		.cache_miss(dd_cache_miss),
@@ -189,7 +224,7 @@ module l1_l2_interface
 		.wake_bitmap(dcache_miss_wake_bitmap),
 		.*);
 
-	assign l2i_dcache_wake_bitmap = dcache_miss_wake_bitmap | sq_wake_bitmap;
+	assign l2i_dcache_wake_bitmap = dcache_miss_wake_bitmap | sq_wake_bitmap | wait_wake_bitmap;
 
 	l1_load_miss_queue l1_load_miss_queue_icache(
 		// Enqueue requests
@@ -211,6 +246,49 @@ module l1_l2_interface
 		.wake_bitmap(l2i_icache_wake_bitmap),
 		.*);
 
+	// Software prefetches are hints, so if one is already waiting to be sent,
+	// drop the new one rather than stalling the thread. They only fill the
+	// L2 cache, like the hardware prefetcher.
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			/*AUTORESET*/
+			// Beginning of autoreset for uninitialized flops
+			sw_prefetch_addr <= '0;
+			sw_prefetch_pending <= '0;
+			// End of automatics
+		end
+		else
+		begin
+			if (dd_prefetch_en && (!sw_prefetch_pending || sw_prefetch_ack))
+			begin
+				sw_prefetch_pending <= 1;
+				sw_prefetch_addr <= dd_prefetch_addr;
+			end
+			else if (sw_prefetch_ack)
+				sw_prefetch_pending <= 0;
+		end
+	end
+
+`ifdef HAS_STRIDE_PREFETCHER
+	l1_stride_prefetcher l1_stride_prefetcher(
+		// Next request
+		.dequeue_ready(prefetch_dequeue_ready),
+		.dequeue_ack(prefetch_dequeue_ack),
+		.dequeue_addr(prefetch_dequeue_addr),
+
+		// Track completed prefetches
+		.l2_response_valid(prefetch_l2_response_valid),
+		.l2_response_addr(response_stage2.address),
+		.*);
+`else
+	assign prefetch_dequeue_ready = 0;
+	assign prefetch_dequeue_addr = 0;
+	assign perf_prefetch_useful = 0;
+	assign perf_prefetch_late = 0;
+`endif
+
 	/////////////////////////////////////////////////
 	// Response pipeline stage 1
 	/////////////////////////////////////////////////
@@ -234,6 +312,7 @@ module l1_l2_interface
 		begin
 			// Should not get a wake from miss queue and store queue in the same cycle.
 			assert((dcache_miss_wake_bitmap & sq_wake_bitmap) == 0);
+			assert(((dcache_miss_wake_bitmap | sq_wake_bitmap) & wait_wake_bitmap) == 0);
 
 			response_stage2 <= l2_response;
 		end
@@ -320,10 +399,18 @@ module l1_l2_interface
 		|| response_stage2.packet_type == L2RSP_FLUSH_ACK
 		|| response_stage2.packet_type == L2RSP_IINVALIDATE_ACK
 		|| response_stage2.packet_type == L2RSP_DINVALIDATE_ACK);
+	assign prefetch_l2_response_valid = is_ack_for_me
+		&& response_stage2.packet_type == L2RSP_PREFETCH_ACK;
 	assign dcache_l2_response_idx = response_stage2.id;
 	assign icache_l2_response_idx = response_stage2.id;
 	assign storebuf_l2_response_idx = response_stage2.id;
 	assign storebuf_l2_sync_success = response_stage2.status;
+	assign storebuf_l2_atomic_value = response_stage2.atomic_value;
+
+	// Stores and invalidates from any core wake threads waiting on the line.
+	assign wait_update_valid = response_stage2.valid
+		&& (response_stage2.packet_type == L2RSP_STORE_ACK
+		|| response_stage2.packet_type == L2RSP_DINVALIDATE_ACK);
 
 	/////////////////////////////////////////////////
 	// Response pipeline stage 3
@@ -381,6 +468,8 @@ module l1_l2_interface
 		sq_dequeue_ack = 0;
 		icache_dequeue_ack = 0;
 		dcache_dequeue_ack = 0;
+		prefetch_dequeue_ack = 0;
+		sw_prefetch_ack = 0;
 
 		l2i_request.core = CORE_ID;
 
@@ -409,12 +498,16 @@ module l1_l2_interface
 			l2i_request.valid = 1;
 			if (sq_dequeue_flush)
 				l2i_request.packet_type = L2REQ_FLUSH;
+			else if (sq_dequeue_atomic)
+				l2i_request.packet_type = L2REQ_ATOMIC;
 			else if (sq_dequeue_synchronized)
 				l2i_request.packet_type = L2REQ_STORE_SYNC;
 			else if (sq_dequeue_iinvalidate)
 				l2i_request.packet_type = L2REQ_IINVALIDATE;
 			else if (sq_dequeue_dinvalidate)
 				l2i_request.packet_type = L2REQ_DINVALIDATE;
+			else if (sq_dequeue_no_allocate)
+				l2i_request.packet_type = L2REQ_STORE_NO_ALLOCATE;
 			else
 				l2i_request.packet_type = L2REQ_STORE;
 
@@ -422,6 +515,23 @@ module l1_l2_interface
 			l2i_request.address = sq_dequeue_addr;
 			l2i_request.data = sq_dequeue_data;
 			l2i_request.store_mask = sq_dequeue_mask;
+			l2i_request.atomic_op = sq_dequeue_atomic_op;
+			l2i_request.cache_type = CT_DCACHE;
+		end
+		else if (sw_prefetch_pending)
+		begin
+			// Prefetches have the lowest priority so they don't delay demand
+			// misses.
+			l2i_request.valid = 1;
+			l2i_request.packet_type = L2REQ_PREFETCH;
+			l2i_request.address = sw_prefetch_addr;
+			l2i_request.cache_type = CT_DCACHE;
+		end
+		else if (prefetch_dequeue_ready)
+		begin
+			l2i_request.valid = 1;
+			l2i_request.packet_type = L2REQ_PREFETCH;
+			l2i_request.address = prefetch_dequeue_addr;
 			l2i_request.cache_type = CT_DCACHE;
 		end
 
@@ -434,6 +544,10 @@ module l1_l2_interface
 				icache_dequeue_ack = 1;
 			else if (sq_dequeue_ready)
 				sq_dequeue_ack = 1;
+			else if (sw_prefetch_pending)
+				sw_prefetch_ack = 1;
+			else if (prefetch_dequeue_ready)
+				prefetch_dequeue_ack = 1;
 		end
 	end
 endmodule
@@ -24,6 +24,18 @@
 // It acts like a store for rollback logic, but doesn't enqueue anything if
 // the store buffer is empty.
 //
+// Stores from a thread to the same cache line are combined into one request
+// if the earlier one hasn't been sent yet. To give later stores a chance to
+// combine, a new normal store entry waits up to STORE_COMBINE_CYCLES before
+// it is sent. It is sent right away if all bytes in the line have been
+// written, or if the thread is waiting for it (because it tried to store to
+// a different line or issued a memory barrier). Synchronized stores and
+// cache control commands don't wait and never combine.
+//
+// Atomic operations are flagged as synchronized stores by dcache_data_stage,
+// so they go through the same suspend/restart sequence. The old memory value
+// from the response is returned to the restarted instruction.
+//
 
 module l1_store_queue(
 	input                                  clk,
@@ -39,6 +51,9 @@ module l1_store_queue(
 	input [`CACHE_LINE_BYTES - 1:0]        dd_store_mask,
 	input cache_line_data_t                dd_store_data,
 	input                                  dd_store_synchronized,
+	input                                  dd_store_no_allocate,
+	input                                  dd_store_atomic,
+	input atomic_op_t                      dd_store_atomic_op,
 	input thread_idx_t                     dd_store_thread_idx,
 	input l1d_addr_t                       dd_store_bypass_addr,
 	input thread_idx_t                     dd_store_bypass_thread_idx,
@@ -47,6 +62,7 @@ module l1_store_queue(
 	output logic [`CACHE_LINE_BYTES - 1:0] sq_store_bypass_mask,
 	output cache_line_data_t               sq_store_bypass_data,
 	output logic                           sq_store_sync_success,
+	output scalar_t                        sq_store_atomic_value,
 
 	// To l1_l2_interface
 	output logic                           sq_dequeue_ready,
@@ -55,9 +71,12 @@ module l1_store_queue(
 	output [`CACHE_LINE_BYTES - 1:0]       sq_dequeue_mask,
 	output cache_line_data_t               sq_dequeue_data,
 	output logic                           sq_dequeue_synchronized,
+	output logic                           sq_dequeue_no_allocate,
 	output logic                           sq_dequeue_flush,
 	output logic                           sq_dequeue_iinvalidate,
 	output logic                           sq_dequeue_dinvalidate,
+	output logic                           sq_dequeue_atomic,
+	output atomic_op_t                     sq_dequeue_atomic_op,
 	output logic                           sq_rollback_en,
 	output thread_bitmap_t                 sq_wake_bitmap,
 
@@ -65,16 +84,27 @@ module l1_store_queue(
 	input                                  sq_dequeue_ack,
 	input                                  storebuf_l2_response_valid,
 	input l1_miss_entry_idx_t              storebuf_l2_response_idx,
-	input                                  storebuf_l2_sync_success);
+	input                                  storebuf_l2_sync_success,
+	input scalar_t                         storebuf_l2_atomic_value,
+
+	// Performance events
+	output logic                           perf_store_combined);
+
+	// At least one bit, even if STORE_COMBINE_CYCLES is 0
+	localparam COMBINE_TIMER_WIDTH = $clog2(`STORE_COMBINE_CYCLES + 2);
 
 	struct packed {
 		logic synchronized;
+		logic no_allocate;
 		logic flush;
 		logic iinvalidate;
 		logic dinvalidate;
 		logic request_sent;
 		logic response_received;
 		logic sync_success;
+		logic atomic;
+		atomic_op_t atomic_op;
+		scalar_t atomic_value;
 		logic thread_waiting;
 		logic valid;
 		cache_line_data_t data;
@@ -83,6 +113,7 @@ module l1_store_queue(
 	} pending_stores[`THREADS_PER_CORE];
 	thread_bitmap_t rollback;
 	thread_bitmap_t send_request;
+	thread_bitmap_t store_combined;
 	thread_idx_t send_grant_idx;
 	thread_bitmap_t send_grant_oh;
 	l1d_addr_t cache_aligned_store_addr;
@@ -117,9 +148,15 @@ module l1_store_queue(
 			logic got_response_this_entry;
 			logic membar_requested_this_entry;
 			logic enqueue_cache_control;
+			logic[COMBINE_TIMER_WIDTH - 1:0] combine_timer;
+			logic combine_wait;
 
+			assign combine_wait = combine_timer != 0
+				&& pending_stores[thread_idx].mask != {`CACHE_LINE_BYTES{1'b1}}
+				&& !pending_stores[thread_idx].thread_waiting;
 			assign send_request[thread_idx] = pending_stores[thread_idx].valid
-				&& !pending_stores[thread_idx].request_sent;
+				&& !pending_stores[thread_idx].request_sent
+				&& !combine_wait;
 			assign store_requested_this_entry = dd_store_en && dd_store_thread_idx == thread_idx_t'(thread_idx);
 			assign membar_requested_this_entry = dd_membar_en && dd_store_thread_idx == thread_idx_t'(thread_idx);
 			assign send_this_cycle = send_grant_oh[thread_idx] && sq_dequeue_ack;
@@ -145,6 +182,7 @@ module l1_store_queue(
 				&& storebuf_l2_response_idx == thread_idx_t'(thread_idx);
 			assign sq_wake_bitmap[thread_idx] = got_response_this_entry
 				&& pending_stores[thread_idx].thread_waiting;
+			assign store_combined[thread_idx] = store_requested_this_entry && can_write_combine;
 			assign enqueue_cache_control = dd_store_thread_idx == thread_idx_t'(thread_idx)
 				&& (!pending_stores[thread_idx].valid || got_response_this_entry)
 				&& (dd_flush_en || dd_dinvalidate_en || dd_iinvalidate_en);
@@ -173,6 +211,22 @@ module l1_store_queue(
 					rollback[thread_idx] = 1;
 			end
 
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+					combine_timer <= '0;
+				else if (store_requested_this_entry && update_store_entry && !can_write_combine)
+				begin
+					// New store
+					combine_timer <= dd_store_synchronized ? COMBINE_TIMER_WIDTH'(0)
+						: COMBINE_TIMER_WIDTH'(`STORE_COMBINE_CYCLES);
+				end
+				else if (enqueue_cache_control)
+					combine_timer <= '0;
+				else if (combine_timer != 0)
+					combine_timer <= combine_timer - COMBINE_TIMER_WIDTH'(1);
+			end
+
 			always_ff @(posedge clk, posedge reset)
 			begin
 				if (reset)
@@ -194,10 +248,19 @@ module l1_store_queue(
 								pending_stores[thread_idx].data[byte_lane * 8+:8] <= dd_store_data[byte_lane * 8+:8];
 						end
 
+						// A non-allocating store always writes the whole line, so
+						// the combined entry does too.
 						if (can_write_combine)
+						begin
 							pending_stores[thread_idx].mask <= pending_stores[thread_idx].mask | dd_store_mask;
+							pending_stores[thread_idx].no_allocate <= pending_stores[thread_idx].no_allocate
+								|| dd_store_no_allocate;
+						end
 						else
+						begin
 							pending_stores[thread_idx].mask <= dd_store_mask;
+							pending_stores[thread_idx].no_allocate <= dd_store_no_allocate;
+						end
 					end
 
 					if (sq_wake_bitmap[thread_idx])
@@ -234,6 +297,8 @@ module l1_store_queue(
 							pending_stores[thread_idx].valid <= 1;
 							pending_stores[thread_idx].address <= cache_aligned_store_addr;
 							pending_stores[thread_idx].synchronized <= dd_store_synchronized;
+							pending_stores[thread_idx].atomic <= dd_store_atomic;
+							pending_stores[thread_idx].atomic_op <= dd_store_atomic_op;
 							pending_stores[thread_idx].flush <= 0;
 							pending_stores[thread_idx].iinvalidate <= 0;
 							pending_stores[thread_idx].dinvalidate <= 0;
@@ -248,6 +313,8 @@ module l1_store_queue(
 						pending_stores[thread_idx].valid <= 1;
 						pending_stores[thread_idx].address <= cache_aligned_store_addr;
 						pending_stores[thread_idx].synchronized <= 0;
+						pending_stores[thread_idx].atomic <= 0;
+						pending_stores[thread_idx].no_allocate <= 0;
 						pending_stores[thread_idx].flush <= dd_flush_en;
 						pending_stores[thread_idx].iinvalidate <= dd_iinvalidate_en;
 						pending_stores[thread_idx].dinvalidate <= dd_dinvalidate_en;
@@ -274,6 +341,7 @@ module l1_store_queue(
 						begin
 							pending_stores[thread_idx].response_received <= 1;
 							pending_stores[thread_idx].sync_success <= storebuf_l2_sync_success;
+							pending_stores[thread_idx].atomic_value <= storebuf_l2_atomic_value;
 						end
 						else
 							pending_stores[thread_idx].valid <= 0;
@@ -291,9 +359,13 @@ module l1_store_queue(
 	assign sq_dequeue_mask = pending_stores[send_grant_idx].mask;
 	assign sq_dequeue_data = pending_stores[send_grant_idx].data;
 	assign sq_dequeue_synchronized = pending_stores[send_grant_idx].synchronized;
+	assign sq_dequeue_no_allocate = pending_stores[send_grant_idx].no_allocate;
 	assign sq_dequeue_flush = pending_stores[send_grant_idx].flush;
 	assign sq_dequeue_iinvalidate = pending_stores[send_grant_idx].iinvalidate;
 	assign sq_dequeue_dinvalidate = pending_stores[send_grant_idx].dinvalidate;
+	assign sq_dequeue_atomic = pending_stores[send_grant_idx].atomic;
+	assign sq_dequeue_atomic_op = pending_stores[send_grant_idx].atomic_op;
+	assign perf_store_combined = |store_combined;
 
 	always_ff @(posedge clk, posedge reset)
 	begin
@@ -303,6 +375,7 @@ module l1_store_queue(
 			// Beginning of autoreset for uninitialized flops
 			sq_rollback_en <= '0;
 			sq_store_bypass_data <= '0;
+			sq_store_atomic_value <= '0;
 			sq_store_bypass_mask <= '0;
 			sq_store_sync_success <= '0;
 			// End of automatics
@@ -318,6 +391,13 @@ module l1_store_queue(
 				pending_stores[send_grant_idx].dinvalidate, pending_stores[send_grant_idx].iinvalidate,
 				pending_stores[send_grant_idx].synchronized}));
 
+			// A non-allocating store must replace the whole line
+			assert(!dd_store_en || !dd_store_no_allocate
+				|| dd_store_mask == {`CACHE_LINE_BYTES{1'b1}});
+
+			// Atomic operations must wait for a response
+			assert(!dd_store_en || !dd_store_atomic || dd_store_synchronized);
+
 			// Can't assert wake and sleep signals in same cycle
 			assert((sq_wake_bitmap & rollback) == 0);
 
@@ -325,9 +405,11 @@ module l1_store_queue(
 				&& pending_stores[dd_store_bypass_thread_idx].valid
 				&& !pending_stores[dd_store_bypass_thread_idx].flush
 				&& !pending_stores[dd_store_bypass_thread_idx].iinvalidate
-				&& !pending_stores[dd_store_bypass_thread_idx].dinvalidate)
+				&& !pending_stores[dd_store_bypass_thread_idx].dinvalidate
+				&& !pending_stores[dd_store_bypass_thread_idx].atomic)
 			begin
-				// There is a store for this address, set mask
+				// There is a store for this address, set mask. The data for an
+				// atomic operation is an operand, not the value stored.
 				sq_store_bypass_mask <= pending_stores[dd_store_bypass_thread_idx].mask;
 				sq_store_bypass_data <= pending_stores[dd_store_bypass_thread_idx].data;
 			end
@@ -335,6 +417,7 @@ module l1_store_queue(
 				sq_store_bypass_mask <= 0;
 
 			sq_store_sync_success <= pending_stores[dd_store_thread_idx].sync_success;
+			sq_store_atomic_value <= pending_stores[dd_store_thread_idx].atomic_value;
 			sq_rollback_en <= |rollback;
 		end
 	end
@@ -0,0 +1,218 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+`include "defines.sv"
+
+//
+// Watches L1 data cache load misses and, when a thread misses on cache lines
+// that are a constant distance apart, requests lines further along that
+// stream so they are already in the L2 cache when the thread reaches them.
+// - Each thread is trained separately, since threads are usually working on
+//   different parts of memory. A stream is detected when two consecutive
+//   misses from a thread have the same stride.
+// - Prefetches are issued STRIDE_PREFETCH_DISTANCE strides ahead of the
+//   current miss. They only fill the L2 cache, so they don't use L1 miss
+//   queue entries and don't wake threads.
+// - This won't prefetch across a page boundary, because the next physical
+//   page is usually unrelated to the next virtual page.
+// - Only one request waits to be sent to the L2 cache at a time. If a new
+//   prefetch is detected before the last one is sent, it replaces it, since
+//   the newer one is more likely to be useful.
+//
+// This also keeps a short history of recently prefetched lines to measure
+// how well this works. When a demand miss is for a line that was prefetched,
+// it counts as useful if the prefetch has completed (the data is in the L2
+// cache), or late if it is still in progress.
+//
+
+module l1_stride_prefetcher(
+	input                                   clk,
+	input                                   reset,
+
+	// From dcache_data_stage
+	input                                   dd_cache_miss,
+	input scalar_t                          dd_cache_miss_addr,
+	input thread_idx_t                      dd_cache_miss_thread_idx,
+	input                                   dd_cache_miss_synchronized,
+
+	// Dequeue request
+	output logic                            dequeue_ready,
+	input                                   dequeue_ack,
+	output scalar_t                         dequeue_addr,
+
+	// From L2 response
+	input                                   l2_response_valid,
+	input scalar_t                          l2_response_addr,
+
+	// Performance events
+	output logic                            perf_prefetch_useful,
+	output logic                            perf_prefetch_late);
+
+	localparam STRIDE_WIDTH = 4;	// Signed, in cache lines
+	localparam HISTORY_ENTRIES = 8;
+
+	typedef logic[STRIDE_WIDTH - 1:0] stride_t;
+	typedef logic[$clog2(HISTORY_ENTRIES) - 1:0] history_idx_t;
+
+	struct packed {
+		logic valid;
+		cache_line_index_t last_line;
+		stride_t stride;
+	} stream[`THREADS_PER_CORE];
+
+	struct packed {
+		logic valid;
+		logic complete;
+		cache_line_index_t line;
+	} history[HISTORY_ENTRIES];
+
+	cache_line_index_t miss_line;
+	cache_line_index_t line_delta;
+	cache_line_index_t prefetch_line;
+	cache_line_index_t response_line;
+	logic train_en;
+	logic delta_in_range;
+	logic stride_match;
+	logic same_page;
+	logic prefetch_en;
+	logic[HISTORY_ENTRIES - 1:0] miss_history_oh;
+	logic[HISTORY_ENTRIES - 1:0] prefetch_history_oh;
+	logic[HISTORY_ENTRIES - 1:0] response_history_oh;
+	logic[HISTORY_ENTRIES - 1:0] history_complete;
+	history_idx_t history_alloc_idx;
+	logic pending_valid;
+	cache_line_index_t pending_line;
+
+	assign miss_line = dd_cache_miss_addr[31:`CACHE_LINE_OFFSET_WIDTH];
+	assign response_line = l2_response_addr[31:`CACHE_LINE_OFFSET_WIDTH];
+
+	// Synchronized loads are usually to lock variables and would break up
+	// the stream.
+	assign train_en = dd_cache_miss && !dd_cache_miss_synchronized;
+
+	// The stride can only be tracked if it fits in STRIDE_WIDTH bits (the upper
+	// bits must all be copies of the sign bit).
+	assign line_delta = miss_line - stream[dd_cache_miss_thread_idx].last_line;
+	assign delta_in_range = &line_delta[$bits(cache_line_index_t) - 1:STRIDE_WIDTH - 1]
+		|| !(|line_delta[$bits(cache_line_index_t) - 1:STRIDE_WIDTH - 1]);
+	assign stride_match = stream[dd_cache_miss_thread_idx].valid
+		&& delta_in_range
+		&& stride_t'(line_delta) == stream[dd_cache_miss_thread_idx].stride
+		&& stream[dd_cache_miss_thread_idx].stride != 0;
+	assign prefetch_line = miss_line + cache_line_index_t'(`STRIDE_PREFETCH_DISTANCE)
+		* {{($bits(cache_line_index_t) - STRIDE_WIDTH){line_delta[STRIDE_WIDTH - 1]}},
+		stride_t'(line_delta)};
+	assign same_page = prefetch_line[$bits(cache_line_index_t) - 1-:`PAGE_NUM_BITS]
+		== miss_line[$bits(cache_line_index_t) - 1-:`PAGE_NUM_BITS];
+
+	genvar history_idx;
+	generate
+		for (history_idx = 0; history_idx < HISTORY_ENTRIES; history_idx++)
+		begin : history_match_gen
+			assign miss_history_oh[history_idx] = history[history_idx].valid
+				&& history[history_idx].line == miss_line;
+			assign prefetch_history_oh[history_idx] = history[history_idx].valid
+				&& history[history_idx].line == prefetch_line;
+			assign response_history_oh[history_idx] = history[history_idx].valid
+				&& history[history_idx].line == response_line;
+			assign history_complete[history_idx] = history[history_idx].complete;
+		end
+	endgenerate
+
+	// Don't request a line that was recently prefetched or is waiting to be.
+	assign prefetch_en = train_en
+		&& stride_match
+		&& same_page
+		&& !(|prefetch_history_oh)
+		&& !(pending_valid && pending_line == prefetch_line);
+
+	assign dequeue_ready = pending_valid;
+	assign dequeue_addr = {pending_line, {`CACHE_LINE_OFFSET_WIDTH{1'b0}}};
+
+	assign perf_prefetch_useful = dd_cache_miss && |(miss_history_oh & history_complete);
+	assign perf_prefetch_late = dd_cache_miss && |(miss_history_oh & ~history_complete);
+
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+				stream[i] <= 0;
+
+			for (int i = 0; i < HISTORY_ENTRIES; i++)
+				history[i] <= 0;
+
+			/*AUTORESET*/
+			// Beginning of autoreset for uninitialized flops
+			history_alloc_idx <= '0;
+			pending_line <= '0;
+			pending_valid <= '0;
+			// End of automatics
+		end
+		else
+		begin
+			// Ensure the same line isn't in the history more than once
+			assert($onehot0(miss_history_oh));
+
+			// Update stream for this thread. If a thread misses on the same
+			// line more than once (for example, if it was evicted before
+			// the thread could be restarted), leave the stream alone.
+			if (train_en && line_delta != 0)
+			begin
+				stream[dd_cache_miss_thread_idx].valid <= 1;
+				stream[dd_cache_miss_thread_idx].last_line <= miss_line;
+				stream[dd_cache_miss_thread_idx].stride <= delta_in_range
+					? stride_t'(line_delta) : stride_t'(0);
+			end
+
+			// If the thread missed on the line before the prefetch could be
+			// sent, it is no longer needed.
+			if (prefetch_en)
+			begin
+				pending_valid <= 1;
+				pending_line <= prefetch_line;
+			end
+			else if (dequeue_ack || (dd_cache_miss && pending_line == miss_line))
+				pending_valid <= 0;
+
+			for (int i = 0; i < HISTORY_ENTRIES; i++)
+			begin
+				if (dequeue_ack && history_alloc_idx == history_idx_t'(i))
+				begin
+					// Record the request that was just sent
+					history[i].valid <= 1;
+					history[i].complete <= 0;
+					history[i].line <= pending_line;
+				end
+				else if (dd_cache_miss && miss_history_oh[i])
+				begin
+					// Demand miss for this line. Only count it once.
+					history[i].valid <= 0;
+				end
+				else if (l2_response_valid && response_history_oh[i])
+					history[i].complete <= 1;
+			end
+
+			if (dequeue_ack)
+				history_alloc_idx <= history_alloc_idx + history_idx_t'(1);
+		end
+	end
+endmodule
+
+// Local Variables:
+// verilog-typedef-regexp:"_t$"
+// verilog-auto-reset-widths:unbased
+// End:
@@ -0,0 +1,111 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+`include "defines.sv"
+
+//
+// Tracks threads that are suspended by a dwait instruction. A thread is woken
+// when another store to the cache line it is waiting on (or an invalidate)
+// completes in the L2 cache, or after WAIT_TIMEOUT_CYCLES. Responses are
+// broadcast to all cores, so this sees stores from other cores as well.
+// Software must check the condition it is waiting for again after it wakes
+// up, because the line may have been written before the wait started. The
+// timeout bounds how long the thread sleeps in that case.
+//
+
+module l1_wait_monitor(
+	input                     clk,
+	input                     reset,
+
+	// From dcache_data_stage
+	input                     dd_wait_en,
+	input l1d_addr_t          dd_store_addr,
+	input thread_idx_t        dd_store_thread_idx,
+
+	// From L2 response
+	input                     l2_update_valid,
+	input scalar_t            l2_update_addr,
+
+	// To thread_select_stage
+	output thread_bitmap_t    wait_wake_bitmap);
+
+	localparam TIMER_WIDTH = $clog2(`WAIT_TIMEOUT_CYCLES + 1);
+
+	typedef logic[TIMER_WIDTH - 1:0] wait_timer_t;
+
+	cache_line_index_t wait_line;
+	cache_line_index_t update_line;
+
+	assign wait_line = {dd_store_addr.tag, dd_store_addr.set_idx};
+	assign update_line = l2_update_addr[31:`CACHE_LINE_OFFSET_WIDTH];
+
+	genvar thread_idx;
+	generate
+		for (thread_idx = 0; thread_idx < `THREADS_PER_CORE; thread_idx++)
+		begin : wait_thread_gen
+			logic waiting;
+			cache_line_index_t line;
+			wait_timer_t timer;
+			logic start_this_thread;
+
+			assign start_this_thread = dd_wait_en
+				&& dd_store_thread_idx == thread_idx_t'(thread_idx);
+			assign wait_wake_bitmap[thread_idx] = waiting
+				&& (timer == 0 || (l2_update_valid && update_line == line));
+
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+				begin
+					/*AUTORESET*/
+					// Beginning of autoreset for uninitialized flops
+					line <= '0;
+					timer <= '0;
+					waiting <= '0;
+					// End of automatics
+				end
+				else
+				begin
+					if (start_this_thread)
+					begin
+						// The thread can't wait on more than one line
+						assert(!waiting);
+
+						waiting <= 1;
+						line <= wait_line;
+
+						// If the line is written this cycle, the thread was
+						// suspended too late to see it. Wake it up right
+						// away.
+						if (l2_update_valid && update_line == wait_line)
+							timer <= '0;
+						else
+							timer <= wait_timer_t'(`WAIT_TIMEOUT_CYCLES - 1);
+					end
+					else if (wait_wake_bitmap[thread_idx])
+						waiting <= 0;
+					else if (waiting)
+						timer <= timer - wait_timer_t'(1);
+				end
+			end
+		end
+	endgenerate
+endmodule
+
+// Local Variables:
+// verilog-typedef-regexp:"_t$"
+// verilog-auto-reset-widths:unbased
+// End:
@@ -26,12 +26,17 @@
 // causes it to reissue the request to the L2 pipeline, but doesn't read
 // or write system memory.
 //
+// Read addresses are issued independently of read data, so up to
+// L2_MAX_OUTSTANDING_READS reads can be in flight at once. Read data
+// returns in the order the addresses were issued, because this doesn't use
+// AXI IDs. Requests move from the load queue to the pending read queue when
+// their address is issued, and are reissued to the L2 pipeline from there
+// when their data arrives. Requests that don't need to read memory also go
+// through the pending read queue, so they are reissued after earlier reads.
+//
 // The interface to system memory is the AMBA AXI interface.
 // http://www.arm.com/products/system-ip/amba-specifications.php
 //
-// XXX This does not overlap address and data phases, but it should to improve
-// bus utilization.
-//
 
 module l2_axi_bus_interface(
 	input                                  clk,
@@ -45,6 +50,9 @@ module l2_axi_bus_interface(
 	output logic                           l2bi_stall,
 	output                                 l2bi_collided_miss,
 
+	// To l2_cache_update_stage
+	output logic                           l2bi_store_bypass,
+
 	// From l2_cache_read_stage
 	input                                  l2r_needs_writeback,
 	input l2_tag_t                         l2r_writeback_tag,
@@ -54,16 +62,18 @@ module l2_axi_bus_interface(
 	input                                  l2r_cache_hit,
 	input l2req_packet_t                   l2r_request,
 
-	// Performance event
-	output logic                           perf_l2_writeback);
+	// Performance events
+	output logic                           perf_l2_writeback,
+	output logic                           perf_l2_queue_stall,
+	output logic                           perf_axi_read_beat,
+	output logic                           perf_axi_write_beat);
 
 	typedef enum {
 		STATE_IDLE,
 		STATE_WRITE_ISSUE_ADDRESS,
 		STATE_WRITE_TRANSFER,
-		STATE_READ_ISSUE_ADDRESS,
-		STATE_READ_TRANSFER,
-		STATE_READ_COMPLETE
+		STATE_WRITE_COMPLETE,
+		STATE_READ_ISSUE_ADDRESS
 	} bus_interface_state_t;
 
 	typedef struct packed {
@@ -74,7 +84,8 @@ module l2_axi_bus_interface(
 		l1_miss_entry_idx_t id;
 	} writeback_queue_entry_t;
 
-	localparam REQUEST_QUEUE_LENGTH = 8;
+	localparam REQUEST_QUEUE_LENGTH = `L2_REQUEST_QUEUE_LENGTH;
+	localparam MAX_OUTSTANDING_READS = `L2_MAX_OUTSTANDING_READS;
 
 	// This is the number of stages before this one in the pipeline. Assert the
 	// signal to stop accepting new packets this number of cycles early so
@@ -99,14 +110,25 @@ module l2_axi_bus_interface(
 	logic load_queue_almost_full;
 	bus_interface_state_t state_ff;
 	bus_interface_state_t state_nxt;
-	logic[BURST_OFFSET_WIDTH - 1:0] burst_offset_ff;
-	logic[BURST_OFFSET_WIDTH - 1:0] burst_offset_nxt;
+	logic[BURST_OFFSET_WIDTH - 1:0] write_burst_offset_ff;
+	logic[BURST_OFFSET_WIDTH - 1:0] write_burst_offset_nxt;
+	logic[BURST_OFFSET_WIDTH - 1:0] read_burst_offset;
 	logic[`AXI_DATA_WIDTH - 1:0] bif_load_buffer[0:BURST_BEATS - 1];
 	logic restart_flush_request;
+	logic restart_read_request;
 	logic load_dequeue_en;
+	logic lmq_out_collided;
+	logic lmq_skip_read;
 	l2req_packet_t lmq_out_request;
+	logic pending_read_full;
+	logic pending_read_empty;
+	logic pending_read_skip;
+	l2req_packet_t pending_read_request;
+	logic read_beat;
+	logic load_complete;
 	writeback_queue_entry_t writeback_queue_in;
 	writeback_queue_entry_t writeback_queue_out;
+	logic wait_axi_write_response;
 
 	assign miss_addr = l2r_request.address;
 	assign enqueue_writeback_request = l2r_request.valid && l2r_needs_writeback
@@ -116,19 +138,41 @@ module l2_axi_bus_interface(
 		&& (l2r_request.packet_type == L2REQ_LOAD
 		|| l2r_request.packet_type == L2REQ_STORE
 		|| l2r_request.packet_type == L2REQ_LOAD_SYNC
-		|| l2r_request.packet_type == L2REQ_STORE_SYNC);
+		|| l2r_request.packet_type == L2REQ_STORE_SYNC
+		|| l2r_request.packet_type == L2REQ_PREFETCH
+		|| l2r_request.packet_type == L2REQ_ATOMIC
+		|| (l2r_request.packet_type == L2REQ_STORE_NO_ALLOCATE && duplicate_request));
+
+	// A non-allocating store replaces the entire line, so when it misses, it
+	// is put directly into the writeback queue and isn't filled into the L2
+	// cache. If a miss for the line is already pending, it goes through the load
+	// queue like a normal store instead, so it is ordered after that request.
+	// Because writebacks are issued before loads, a later miss on this line
+	// will read the new data.
+	assign l2bi_store_bypass = l2r_request.valid && !l2r_cache_hit && !l2r_is_l2_fill
+		&& l2r_request.packet_type == L2REQ_STORE_NO_ALLOCATE
+		&& !duplicate_request;
 	assign writeback_pending = !writeback_queue_empty;
 	assign load_request_pending = !load_queue_empty;
 
-	l2_cache_pending_miss_cam l2_cache_pending_miss_cam(
+	// Misses may be in the load queue, the pending read queue, or the
+	// L2 pipeline while they are being filled.
+	l2_cache_pending_miss_cam #(
+		.QUEUE_SIZE(REQUEST_QUEUE_LENGTH + MAX_OUTSTANDING_READS + L2REQ_LATENCY)
+	) l2_cache_pending_miss_cam(
 						    .request_valid(l2r_request.valid),
 						    .request_addr({miss_addr.tag, miss_addr.set_idx}),
 							.*);
 
 	assign perf_l2_writeback = enqueue_writeback_request && !writeback_queue_almost_full;
-
-	assign writeback_queue_in.address = {l2r_writeback_tag, miss_addr.set_idx}; // Old address
-	assign writeback_queue_in.data = l2r_data; // Old line to writeback
+	assign perf_l2_queue_stall = l2bi_stall;
+	assign perf_axi_read_beat = read_beat;
+	assign perf_axi_write_beat = state_ff == STATE_WRITE_TRANSFER && axi_bus.s_wready;
+
+	// The old line to write back, or the new data for a non-allocating store
+	assign writeback_queue_in.address = l2bi_store_bypass ? {miss_addr.tag, miss_addr.set_idx}
+		: {l2r_writeback_tag, miss_addr.set_idx};
+	assign writeback_queue_in.data = l2bi_store_bypass ? l2r_request.data : l2r_data;
 	assign writeback_queue_in.is_flush = l2r_request.packet_type == L2REQ_FLUSH;
 	assign writeback_queue_in.core = l2r_request.core;
 	assign writeback_queue_in.id = l2r_request.id;
@@ -140,7 +184,7 @@ module l2_axi_bus_interface(
 		.reset(reset),
 		.flush_en(1'b0),
 		.almost_full(writeback_queue_almost_full),
-		.enqueue_en(enqueue_writeback_request),
+		.enqueue_en(enqueue_writeback_request || l2bi_store_bypass),
 		.value_i(writeback_queue_in),
 		.almost_empty(),
 		.empty(writeback_queue_empty),
@@ -167,11 +211,49 @@ module l2_axi_bus_interface(
 		.almost_empty(),
 		.dequeue_en(load_dequeue_en),
 		.value_o({
-			l2bi_collided_miss,
+			lmq_out_collided,
 			lmq_out_request
 		}),
 		.full(/* ignore */));
 
+	// Skip the read and restart the request without reading system memory if:
+	// 1. If there is already a pending L2 miss for this cache
+	//    line. Some other request has filled it, so
+	//    don't need to do anything but (try to) pick up the
+	//    result. That could result in another miss in some
+	//    cases, in which case must make another pass through
+	//    here.
+	// 2. It is a store that replaces the entire line.
+	//    Let this flow through the read miss queue instead
+	//    of handling it immediately in the pipeline
+	//    because it must go through the pending miss unit
+	//    to reconcile any other misses that may be in progress.
+	assign lmq_skip_read = lmq_out_collided
+		|| (lmq_out_request.store_mask == {`CACHE_LINE_BYTES{1'b1}}
+		&& lmq_out_request.packet_type == L2REQ_STORE);
+
+	sync_fifo #(.WIDTH($bits(l2req_packet_t) + 2),
+		.SIZE(MAX_OUTSTANDING_READS)) sync_fifo_pending_read(
+		.clk(clk),
+		.reset(reset),
+		.flush_en(1'b0),
+		.almost_full(),
+		.full(pending_read_full),
+		.enqueue_en(load_dequeue_en),
+		.value_i({
+			lmq_skip_read,
+			lmq_out_collided,
+			lmq_out_request
+		}),
+		.empty(pending_read_empty),
+		.almost_empty(),
+		.dequeue_en(restart_read_request),
+		.value_o({
+			pending_read_skip,
+			l2bi_collided_miss,
+			pending_read_request
+		}));
+
 	// Stop accepting new L2 packets until space is available in the queues
 	assign l2bi_stall = load_queue_almost_full || writeback_queue_almost_full;
 
@@ -203,14 +285,24 @@ module l2_axi_bus_interface(
 		end
 	endgenerate
 
-	logic wait_axi_write_response;
-
-	// Bus state machine
+	//
+	// Read data. Restarting a request whose data has arrived takes priority
+	// over everything else, so the load buffer is always free to accept
+	// the next beat in the cycle after it fills. The only exception is if a
+	// request that doesn't need data is ahead of it in the queue, in which case
+	// this stops accepting data until that has been restarted.
+	//
+	assign restart_read_request = !pending_read_empty
+		&& (pending_read_skip || load_complete);
+	assign axi_bus.m_rready = !load_complete || (restart_read_request && !pending_read_skip);
+	assign read_beat = axi_bus.s_rvalid && axi_bus.m_rready;
+
+	// Bus state machine. This handles writes and read addresses.
 	always_comb
 	begin
 		state_nxt = state_ff;
 		load_dequeue_en = 0;
-		burst_offset_nxt = burst_offset_ff;
+		write_burst_offset_nxt = write_burst_offset_ff;
 		writeback_complete = 0;
 		restart_flush_request = 0;
 
@@ -225,26 +317,10 @@ module l2_axi_bus_interface(
 					if (!wait_axi_write_response)
 						state_nxt = STATE_WRITE_ISSUE_ADDRESS;
 				end
-				else if (load_request_pending)
+				else if (load_request_pending && !pending_read_full)
 				begin
-					if (l2bi_collided_miss
-						|| (lmq_out_request.store_mask == {`CACHE_LINE_BYTES{1'b1}}
-						&& lmq_out_request.packet_type == L2REQ_STORE))
-					begin
-						// Skip the read and restart the request immediately if:
-						// 1. If there is already a pending L2 miss for this cache
-						//    line. Some other request has filled it, so
-						//    don't need to do anything but (try to) pick up the
-						//    result. That could result in another miss in some
-						//    cases, in which case must make another pass through
-						//    here.
-						// 2. It is a store that replaces the entire line.
-						//    Let this flow through the read miss queue instead
-						//    of handling it immediately in the pipeline
-						//    because it must go through the pending miss unit
-						//    to reconcile any other misses that may be in progress.
-						state_nxt = STATE_READ_COMPLETE;
-					end
+					if (lmq_skip_read)
+						load_dequeue_en = 1'b1;
 					else
 						state_nxt = STATE_READ_ISSUE_ADDRESS;
 				end
@@ -252,7 +328,7 @@ module l2_axi_bus_interface(
 
 			STATE_WRITE_ISSUE_ADDRESS:
 			begin
-				burst_offset_nxt = 0;
+				write_burst_offset_nxt = 0;
 				if (axi_bus.s_awready)
 					state_nxt = STATE_WRITE_TRANSFER;
 			end
@@ -261,40 +337,34 @@ module l2_axi_bus_interface(
 			begin
 				if (axi_bus.s_wready)
 				begin
-					if (burst_offset_ff == {BURST_OFFSET_WIDTH{1'b1}})
-					begin
-						writeback_complete = 1;
-						restart_flush_request = writeback_queue_out.is_flush;
-						state_nxt = STATE_IDLE;
-					end
-
-					burst_offset_nxt = burst_offset_ff + BURST_OFFSET_WIDTH'(1);
-				end
-			end
+					if (write_burst_offset_ff == {BURST_OFFSET_WIDTH{1'b1}})
+						state_nxt = STATE_WRITE_COMPLETE;
 
-			STATE_READ_ISSUE_ADDRESS:
-			begin
-				burst_offset_nxt = 0;
-				if (axi_bus.s_arready)
-					state_nxt = STATE_READ_TRANSFER;
+					write_burst_offset_nxt = write_burst_offset_ff + BURST_OFFSET_WIDTH'(1);
+				end
 			end
 
-			STATE_READ_TRANSFER:
+			STATE_WRITE_COMPLETE:
 			begin
-				if (axi_bus.s_rvalid)
+				// A flush request is restarted to send its response. Wait if
+				// a read request is being restarted this cycle.
+				if (!restart_read_request)
 				begin
-					if (burst_offset_ff == {BURST_OFFSET_WIDTH{1'b1}})
-						state_nxt = STATE_READ_COMPLETE;
-
-					burst_offset_nxt = burst_offset_ff + BURST_OFFSET_WIDTH'(1);
+					writeback_complete = 1;
+					restart_flush_request = writeback_queue_out.is_flush;
+					state_nxt = STATE_IDLE;
 				end
 			end
 
-			STATE_READ_COMPLETE:
+			STATE_READ_ISSUE_ADDRESS:
 			begin
-				// Push the response back into the L2 pipeline
-				state_nxt = STATE_IDLE;
-				load_dequeue_en = 1'b1;
+				// Move the request to the pending read queue once the
+				// address is accepted.
+				if (axi_bus.s_arready)
+				begin
+					load_dequeue_en = 1'b1;
+					state_nxt = STATE_IDLE;
+				end
 			end
 		endcase
 	end
@@ -310,12 +380,12 @@ module l2_axi_bus_interface(
 
 	always_comb
 	begin
-		l2bi_request = lmq_out_request;
+		l2bi_request = pending_read_request;
 		if (restart_flush_request)
 		begin
 			// For this request, the other fields in the request packet are ignored.
 			// To avoid creating a mux for them, we just leave them assigned to
-			// the load_reuqest fields.
+			// the pending read fields.
 			l2bi_request.valid = 1'b1;
 			l2bi_request.packet_type = L2REQ_FLUSH;
 			l2bi_request.core = writeback_queue_out.core;
@@ -323,7 +393,7 @@ module l2_axi_bus_interface(
 			l2bi_request.cache_type = CT_DCACHE;
 		end
 		else
-			l2bi_request.valid = load_dequeue_en;
+			l2bi_request.valid = restart_read_request;
 	end
 
 	always_ff @(posedge clk, posedge reset)
@@ -340,20 +410,35 @@ module l2_axi_bus_interface(
 			axi_bus.m_arvalid <= '0;
 			axi_bus.m_awaddr <= '0;
 			axi_bus.m_awvalid <= '0;
-			axi_bus.m_rready <= '0;
 			axi_bus.m_wdata <= '0;
 			axi_bus.m_wlast <= '0;
 			axi_bus.m_wvalid <= '0;
-			burst_offset_ff <= '0;
+			load_complete <= '0;
+			read_burst_offset <= '0;
 			wait_axi_write_response <= '0;
+			write_burst_offset_ff <= '0;
 			// End of automatics
 		end
 		else
 		begin
+			// The flush and read restarts share the same output
+			assert(!(restart_flush_request && restart_read_request));
+
 			state_ff <= state_nxt;
-			burst_offset_ff <= burst_offset_nxt;
-			if (state_ff == STATE_READ_TRANSFER && axi_bus.s_rvalid)
-				bif_load_buffer[burst_offset_ff] <= axi_bus.s_rdata;
+			write_burst_offset_ff <= write_burst_offset_nxt;
+
+			// Read data
+			if (read_beat)
+			begin
+				assert(!pending_read_empty);
+				bif_load_buffer[read_burst_offset] <= axi_bus.s_rdata;
+				read_burst_offset <= read_burst_offset + BURST_OFFSET_WIDTH'(1);
+			end
+
+			if (read_beat && read_burst_offset == {BURST_OFFSET_WIDTH{1'b1}})
+				load_complete <= 1;
+			else if (restart_read_request && !pending_read_skip)
+				load_complete <= 0;
 
 			// Write response state machine
 			if (state_ff == STATE_WRITE_ISSUE_ADDRESS)
@@ -363,16 +448,14 @@ module l2_axi_bus_interface(
 
 			// Register AXI output signals
 			axi_bus.m_arvalid <= state_nxt == STATE_READ_ISSUE_ADDRESS;
-			axi_bus.m_araddr <= {l2bi_request.address[31:`CACHE_LINE_OFFSET_WIDTH],
+			axi_bus.m_araddr <= {lmq_out_request.address[31:`CACHE_LINE_OFFSET_WIDTH],
 				{`CACHE_LINE_OFFSET_WIDTH{1'b0}}};
-			axi_bus.m_rready <= state_nxt == STATE_READ_TRANSFER;
 			axi_bus.m_awvalid <= state_nxt == STATE_WRITE_ISSUE_ADDRESS;
 			axi_bus.m_awaddr <= {bif_writeback_address, {`CACHE_LINE_OFFSET_WIDTH{1'b0}}};
 			axi_bus.m_wvalid <= state_nxt == STATE_WRITE_TRANSFER;
-			axi_bus.m_wdata <= bif_writeback_lanes[~burst_offset_nxt];
+			axi_bus.m_wdata <= bif_writeback_lanes[~write_burst_offset_nxt];
 			axi_bus.m_wlast <= state_nxt == STATE_WRITE_TRANSFER
-				&& axi_bus.s_wready
-				&& burst_offset_ff == BURST_OFFSET_WIDTH'(BURST_BEATS) - 2;
+				&& write_burst_offset_nxt == {BURST_OFFSET_WIDTH{1'b1}};
 		end
 	end
 endmodule
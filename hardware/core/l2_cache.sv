@@ -1,5 +1,6 @@
 //
 // Copyright 2011-2015 Jeff Bush
+// Copyright 2026 agent
 //
 // Licensed under the Apache License, Version 2.0 (the "License");
 // you may not use this file except in compliance with the License.
@@ -17,88 +18,436 @@
 `include "defines.sv"
 
 //
-// The L2 cache has a four stage pipeline:
-//  - Arbitrate: selects one request from cores, or a restarted request
-//    (described below) to send to the next stage.
-//  - Tag: issues address to tag ram ways, checks LRU.
-//  - Read: checks for cache hit, reads cache memory
-//  - Update: generates signals to update cache memory and broadcasts response
-//    to cores.
-// When the cache detects a cache miss (after the read stage), it puts it into
-// a fill request queue. The system memory interface fetches the data, then
-// restarts the request (with the new data) at the beginning of the L2 pipeline.
-// If the evicted line has unwritten data, the read stage reads it from cache
-// memory and puts it into a writeback queue in the system memory interface.
+// The L2 cache is split into L2_BANKS independent banks (l2_cache_bank.sv),
+// each with its own pipeline and system memory interface. The low bits of
+// the set index select the bank, so consecutive cache lines are in different
+// banks and requests for them can be processed in parallel. All requests for
+// a line go to the same bank, which preserves ordering for it.
+//
+// With more than one bank:
+//  - Each bank queues its responses. Since all cores snoop every response,
+//    they are broadcast one per cycle, selected round robin from the bank
+//    queues. A bank stops accepting requests from cores when its queue
+//    doesn't have room for responses to all requests it is already
+//    processing.
+//  - AXI bursts from the banks are merged onto axi_bus. Addresses are
+//    forwarded round robin, and queues record which bank issued each burst
+//    so responses and read data go back to it. Write data for a burst is
+//    sent before the next write address.
+//  - A bank that records a synchronized load reservation for a thread clears
+//    the reservation for that thread in other banks.
+//  - Performance events are combined, so events that happen in multiple
+//    banks in the same cycle are counted once.
 //
 
 module l2_cache(
 	input                                 clk,
 	input                                 reset,
 	input l2req_packet_t                  l2i_request[`NUM_CORES],
-	output                                l2_ready[`NUM_CORES],
+	output logic                          l2_ready[`NUM_CORES],
 	output l2rsp_packet_t                 l2_response,
 	axi4_interface.master                 axi_bus,
 	output logic[`L2_PERF_EVENTS - 1:0]   l2_perf_events);
 
-	// XXX AUTOLOGIC not generating these.
-	l2req_packet_t l2bi_request;
-	cache_line_data_t l2bi_data_from_memory;
-
-	/*AUTOLOGIC*/
-	// Beginning of automatic wires (for undeclared instantiated-module outputs)
-	cache_line_data_t l2a_data_from_memory;	// From l2_cache_arb_stage of l2_cache_arb_stage.v
-	logic		l2a_is_l2_fill;		// From l2_cache_arb_stage of l2_cache_arb_stage.v
-	logic		l2a_is_restarted_flush;	// From l2_cache_arb_stage of l2_cache_arb_stage.v
-	l2req_packet_t	l2a_request;		// From l2_cache_arb_stage of l2_cache_arb_stage.v
-	logic		l2bi_collided_miss;	// From l2_axi_bus_interface of l2_axi_bus_interface.v
-	logic		l2bi_stall;		// From l2_axi_bus_interface of l2_axi_bus_interface.v
-	logic		l2r_cache_hit;		// From l2_cache_read_stage of l2_cache_read_stage.v
-	cache_line_data_t l2r_data;		// From l2_cache_read_stage of l2_cache_read_stage.v
-	cache_line_data_t l2r_data_from_memory;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic [$clog2(`L2_WAYS*`L2_SETS)-1:0] l2r_hit_cache_idx;// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_is_l2_fill;		// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_is_restarted_flush;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_needs_writeback;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	l2req_packet_t	l2r_request;		// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_store_sync_success;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic [`L2_WAYS-1:0] l2r_update_dirty_en;// From l2_cache_read_stage of l2_cache_read_stage.v
-	l2_set_idx_t	l2r_update_dirty_set;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_update_dirty_value;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_update_lru_en;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	l2_way_idx_t	l2r_update_lru_hit_way;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic [`L2_WAYS-1:0] l2r_update_tag_en;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	l2_set_idx_t	l2r_update_tag_set;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		l2r_update_tag_valid;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	l2_tag_t	l2r_update_tag_value;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	l2_tag_t	l2r_writeback_tag;	// From l2_cache_read_stage of l2_cache_read_stage.v
-	cache_line_data_t l2t_data_from_memory;	// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	logic		l2t_dirty [`L2_WAYS];	// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	l2_way_idx_t	l2t_fill_way;		// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	logic		l2t_is_l2_fill;		// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	logic		l2t_is_restarted_flush;	// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	l2req_packet_t	l2t_request;		// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	l2_tag_t	l2t_tag [`L2_WAYS];	// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	logic		l2t_valid [`L2_WAYS];	// From l2_cache_tag_stage of l2_cache_tag_stage.v
-	logic [$clog2(`L2_WAYS*`L2_SETS)-1:0] l2u_write_addr;// From l2_cache_update_stage of l2_cache_update_stage.v
-	cache_line_data_t l2u_write_data;	// From l2_cache_update_stage of l2_cache_update_stage.v
-	logic		l2u_write_en;		// From l2_cache_update_stage of l2_cache_update_stage.v
-	logic		perf_l2_hit;		// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		perf_l2_miss;		// From l2_cache_read_stage of l2_cache_read_stage.v
-	logic		perf_l2_writeback;	// From l2_axi_bus_interface of l2_axi_bus_interface.v
-	// End of automatics
-
-	l2_cache_arb_stage l2_cache_arb_stage(.*);
-	l2_cache_tag_stage l2_cache_tag_stage(.*);
-	l2_cache_read_stage l2_cache_read_stage(.*);
-	l2_cache_update_stage l2_cache_update_stage(.*);
-
-	l2_axi_bus_interface l2_axi_bus_interface(.*);
-
-	assign l2_perf_events = {
-		perf_l2_hit,
-		perf_l2_miss,
-		perf_l2_writeback
-	};
+	typedef enum {
+		STATE_ARBITRATE,
+		STATE_ISSUE_ADDRESS,
+		STATE_ACTIVE_BURST
+	} burst_state_t;
+
+	l2rsp_packet_t bank_response[`L2_BANKS];
+	logic bank_response_stall[`L2_BANKS];
+	logic[`TOTAL_THREADS - 1:0] bank_sync_load_oh[`L2_BANKS];
+	logic[`TOTAL_THREADS - 1:0] bank_sync_load_other_oh[`L2_BANKS];
+	logic[`L2_PERF_EVENTS - 1:0] bank_perf_events[`L2_BANKS];
+	logic[`L2_BANKS - 1:0] core_bank_ready[`NUM_CORES];
+	axi4_interface bank_axi_bus[`L2_BANKS]();
+
+	genvar bank_idx;
+	genvar core_idx;
+	generate
+		for (bank_idx = 0; bank_idx < `L2_BANKS; bank_idx++)
+		begin : bank_gen
+			l2req_packet_t bank_request[`NUM_CORES];
+			logic bank_ready[`NUM_CORES];
+
+			always_comb
+			begin
+				for (int i = 0; i < `NUM_CORES; i++)
+				begin
+					bank_request[i] = l2i_request[i];
+					bank_request[i].valid = l2i_request[i].valid
+						&& int'(l2_addr_t'(l2i_request[i].address).set_idx) % `L2_BANKS == bank_idx;
+				end
+			end
+
+			for (core_idx = 0; core_idx < `NUM_CORES; core_idx++)
+			begin : ready_gen
+				assign core_bank_ready[core_idx][bank_idx] = bank_ready[core_idx];
+			end
+
+			l2_cache_bank l2_cache_bank(
+				.l2i_request(bank_request),
+				.l2_ready(bank_ready),
+				.l2_response(bank_response[bank_idx]),
+				.l2_response_stall(bank_response_stall[bank_idx]),
+				.l2r_sync_load_oh(bank_sync_load_oh[bank_idx]),
+				.sync_load_other_bank_oh(bank_sync_load_other_oh[bank_idx]),
+				.l2_perf_events(bank_perf_events[bank_idx]),
+				.axi_bus(bank_axi_bus[bank_idx]),
+				.*);
+		end
+
+		for (core_idx = 0; core_idx < `NUM_CORES; core_idx++)
+		begin : core_ready_gen
+			// Only the bank that holds the line sees a valid request.
+			assign l2_ready[core_idx] = |core_bank_ready[core_idx];
+		end
+
+		if (`L2_BANKS == 1)
+		begin : single_bank_gen
+			assign l2_response = bank_response[0];
+			assign bank_response_stall[0] = 0;
+			assign bank_sync_load_other_oh[0] = '0;
+			assign l2_perf_events = bank_perf_events[0];
+
+			assign axi_bus.m_awaddr = bank_axi_bus[0].m_awaddr;
+			assign axi_bus.m_awlen = bank_axi_bus[0].m_awlen;
+			assign axi_bus.m_awsize = bank_axi_bus[0].m_awsize;
+			assign axi_bus.m_awburst = bank_axi_bus[0].m_awburst;
+			assign axi_bus.m_awcache = bank_axi_bus[0].m_awcache;
+			assign axi_bus.m_awvalid = bank_axi_bus[0].m_awvalid;
+			assign axi_bus.m_wdata = bank_axi_bus[0].m_wdata;
+			assign axi_bus.m_wstrb = bank_axi_bus[0].m_wstrb;
+			assign axi_bus.m_wlast = bank_axi_bus[0].m_wlast;
+			assign axi_bus.m_wvalid = bank_axi_bus[0].m_wvalid;
+			assign axi_bus.m_bready = bank_axi_bus[0].m_bready;
+			assign axi_bus.m_araddr = bank_axi_bus[0].m_araddr;
+			assign axi_bus.m_arlen = bank_axi_bus[0].m_arlen;
+			assign axi_bus.m_arsize = bank_axi_bus[0].m_arsize;
+			assign axi_bus.m_arburst = bank_axi_bus[0].m_arburst;
+			assign axi_bus.m_arcache = bank_axi_bus[0].m_arcache;
+			assign axi_bus.m_arvalid = bank_axi_bus[0].m_arvalid;
+			assign axi_bus.m_rready = bank_axi_bus[0].m_rready;
+			assign bank_axi_bus[0].s_awready = axi_bus.s_awready;
+			assign bank_axi_bus[0].s_wready = axi_bus.s_wready;
+			assign bank_axi_bus[0].s_bvalid = axi_bus.s_bvalid;
+			assign bank_axi_bus[0].s_arready = axi_bus.s_arready;
+			assign bank_axi_bus[0].s_rvalid = axi_bus.s_rvalid;
+			assign bank_axi_bus[0].s_rdata = axi_bus.s_rdata;
+		end
+		else
+		begin : multi_bank_gen
+			localparam BANK_IDX_WIDTH = $clog2(`L2_BANKS);
+
+			// Each request a bank has accepted produces one response. It may be
+			// in the pipeline (including the response register), a load or
+			// writeback queue, or the pending read queue.
+			localparam RESPONSE_QUEUE_HEADROOM = 4 + 2 * `L2_REQUEST_QUEUE_LENGTH
+				+ `L2_MAX_OUTSTANDING_READS;
+			localparam RESPONSE_QUEUE_LENGTH = 2 ** $clog2(RESPONSE_QUEUE_HEADROOM + 4);
+			localparam BURST_BEATS = `CACHE_LINE_BITS / `AXI_DATA_WIDTH;
+
+			// Each bank waits for the response to a write before issuing
+			// another.
+			localparam WRITE_QUEUE_LENGTH = `L2_BANKS < 4 ? 4 : `L2_BANKS;
+
+			logic[`L2_BANKS - 1:0] response_pending;
+			logic[`L2_BANKS - 1:0] response_grant_oh;
+			logic[BANK_IDX_WIDTH - 1:0] response_grant_idx;
+			l2rsp_packet_t queued_response[`L2_BANKS];
+			logic[`L2_BANKS - 1:0] bank_awvalid;
+			logic[`L2_BANKS - 1:0] bank_wvalid;
+			logic[`L2_BANKS - 1:0] bank_wlast;
+			logic[`L2_BANKS - 1:0] bank_bready;
+			logic[`L2_BANKS - 1:0] bank_arvalid;
+			logic[`L2_BANKS - 1:0] bank_rready;
+			logic[31:0] bank_awaddr[`L2_BANKS];
+			logic[31:0] bank_araddr[`L2_BANKS];
+			logic[`AXI_DATA_WIDTH - 1:0] bank_wdata[`L2_BANKS];
+			burst_state_t write_state;
+			logic[BANK_IDX_WIDTH - 1:0] write_bank;
+			logic[`L2_BANKS - 1:0] write_grant_oh;
+			logic[BANK_IDX_WIDTH - 1:0] write_grant_idx;
+			logic write_queue_full;
+			logic write_queue_empty;
+			logic[BANK_IDX_WIDTH - 1:0] write_response_bank;
+			logic write_address_accepted;
+			burst_state_t read_state;
+			logic[BANK_IDX_WIDTH - 1:0] read_bank;
+			logic[`L2_BANKS - 1:0] read_grant_oh;
+			logic[BANK_IDX_WIDTH - 1:0] read_grant_idx;
+			logic read_queue_full;
+			logic read_queue_empty;
+			logic[BANK_IDX_WIDTH - 1:0] active_read_bank;
+			logic read_address_accepted;
+			logic read_beat;
+			logic read_burst_done;
+			logic[7:0] read_beat_count;
+
+			//
+			// Responses
+			//
+			for (bank_idx = 0; bank_idx < `L2_BANKS; bank_idx++)
+			begin : response_queue_gen
+				logic empty;
+				logic almost_full;
+
+				sync_fifo #(
+					.WIDTH($bits(l2rsp_packet_t)),
+					.SIZE(RESPONSE_QUEUE_LENGTH),
+					.ALMOST_FULL_THRESHOLD(RESPONSE_QUEUE_LENGTH - RESPONSE_QUEUE_HEADROOM)
+				) response_queue(
+					.clk(clk),
+					.reset(reset),
+					.flush_en(1'b0),
+					.full(),
+					.almost_full(almost_full),
+					.enqueue_en(bank_response[bank_idx].valid),
+					.value_i(bank_response[bank_idx]),
+					.empty(empty),
+					.almost_empty(),
+					.dequeue_en(response_grant_oh[bank_idx]),
+					.value_o(queued_response[bank_idx]));
+
+				assign response_pending[bank_idx] = !empty;
+				assign bank_response_stall[bank_idx] = almost_full;
+			end
+
+			arbiter #(.NUM_REQUESTERS(`L2_BANKS)) arbiter_response(
+				.request(response_pending),
+				.update_lru(1'b1),
+				.grant_oh(response_grant_oh),
+				.*);
+
+			oh_to_idx #(.NUM_SIGNALS(`L2_BANKS)) oh_to_idx_response(
+				.one_hot(response_grant_oh),
+				.index(response_grant_idx));
+
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+					l2_response <= 0;
+				else if (|response_pending)
+					l2_response <= queued_response[response_grant_idx];
+				else
+					l2_response <= 0;
+			end
+
+			always_comb
+			begin
+				for (int i = 0; i < `L2_BANKS; i++)
+				begin
+					bank_sync_load_other_oh[i] = '0;
+					for (int j = 0; j < `L2_BANKS; j++)
+					begin
+						if (j != i)
+							bank_sync_load_other_oh[i] |= bank_sync_load_oh[j];
+					end
+				end
+			end
+
+			always_comb
+			begin
+				l2_perf_events = '0;
+				for (int i = 0; i < `L2_BANKS; i++)
+					l2_perf_events |= bank_perf_events[i];
+			end
+
+			//
+			// System memory
+			//
+			for (bank_idx = 0; bank_idx < `L2_BANKS; bank_idx++)
+			begin : bank_axi_gen
+				assign bank_awvalid[bank_idx] = bank_axi_bus[bank_idx].m_awvalid;
+				assign bank_awaddr[bank_idx] = bank_axi_bus[bank_idx].m_awaddr;
+				assign bank_wvalid[bank_idx] = bank_axi_bus[bank_idx].m_wvalid;
+				assign bank_wdata[bank_idx] = bank_axi_bus[bank_idx].m_wdata;
+				assign bank_wlast[bank_idx] = bank_axi_bus[bank_idx].m_wlast;
+				assign bank_bready[bank_idx] = bank_axi_bus[bank_idx].m_bready;
+				assign bank_arvalid[bank_idx] = bank_axi_bus[bank_idx].m_arvalid;
+				assign bank_araddr[bank_idx] = bank_axi_bus[bank_idx].m_araddr;
+				assign bank_rready[bank_idx] = bank_axi_bus[bank_idx].m_rready;
+
+				assign bank_axi_bus[bank_idx].s_awready = axi_bus.s_awready
+					&& write_state == STATE_ISSUE_ADDRESS
+					&& write_bank == BANK_IDX_WIDTH'(bank_idx);
+				assign bank_axi_bus[bank_idx].s_wready = axi_bus.s_wready
+					&& write_state == STATE_ACTIVE_BURST
+					&& write_bank == BANK_IDX_WIDTH'(bank_idx);
+				assign bank_axi_bus[bank_idx].s_bvalid = axi_bus.s_bvalid
+					&& !write_queue_empty
+					&& write_response_bank == BANK_IDX_WIDTH'(bank_idx);
+				assign bank_axi_bus[bank_idx].s_arready = axi_bus.s_arready
+					&& read_state == STATE_ISSUE_ADDRESS
+					&& read_bank == BANK_IDX_WIDTH'(bank_idx);
+				assign bank_axi_bus[bank_idx].s_rvalid = axi_bus.s_rvalid
+					&& !read_queue_empty
+					&& active_read_bank == BANK_IDX_WIDTH'(bank_idx);
+				assign bank_axi_bus[bank_idx].s_rdata = axi_bus.s_rdata;
+			end
+
+			// All banks use the same burst parameters.
+			assign axi_bus.m_awlen = bank_axi_bus[0].m_awlen;
+			assign axi_bus.m_awsize = bank_axi_bus[0].m_awsize;
+			assign axi_bus.m_awburst = bank_axi_bus[0].m_awburst;
+			assign axi_bus.m_awcache = bank_axi_bus[0].m_awcache;
+			assign axi_bus.m_wstrb = bank_axi_bus[0].m_wstrb;
+			assign axi_bus.m_arlen = bank_axi_bus[0].m_arlen;
+			assign axi_bus.m_arsize = bank_axi_bus[0].m_arsize;
+			assign axi_bus.m_arburst = bank_axi_bus[0].m_arburst;
+			assign axi_bus.m_arcache = bank_axi_bus[0].m_arcache;
+
+			// Writes. The bank is selected when the address is issued and
+			// keeps the bus until the last beat of data.
+			arbiter #(.NUM_REQUESTERS(`L2_BANKS)) arbiter_write(
+				.request(bank_awvalid),
+				.update_lru(write_state == STATE_ARBITRATE && !write_queue_full),
+				.grant_oh(write_grant_oh),
+				.*);
+
+			oh_to_idx #(.NUM_SIGNALS(`L2_BANKS)) oh_to_idx_write(
+				.one_hot(write_grant_oh),
+				.index(write_grant_idx));
+
+			assign write_address_accepted = write_state == STATE_ISSUE_ADDRESS
+				&& axi_bus.s_awready;
+			assign axi_bus.m_awvalid = write_state == STATE_ISSUE_ADDRESS
+				&& bank_awvalid[write_bank];
+			assign axi_bus.m_awaddr = bank_awaddr[write_bank];
+			assign axi_bus.m_wvalid = write_state == STATE_ACTIVE_BURST
+				&& bank_wvalid[write_bank];
+			assign axi_bus.m_wdata = bank_wdata[write_bank];
+			assign axi_bus.m_wlast = bank_wlast[write_bank];
+			assign axi_bus.m_bready = !write_queue_empty && bank_bready[write_response_bank];
+
+			sync_fifo #(.WIDTH(BANK_IDX_WIDTH), .SIZE(WRITE_QUEUE_LENGTH)) write_queue(
+				.clk(clk),
+				.reset(reset),
+				.flush_en(1'b0),
+				.full(write_queue_full),
+				.almost_full(),
+				.enqueue_en(write_address_accepted),
+				.value_i(write_bank),
+				.empty(write_queue_empty),
+				.almost_empty(),
+				.dequeue_en(axi_bus.s_bvalid && axi_bus.m_bready),
+				.value_o(write_response_bank));
+
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+				begin
+					write_state <= STATE_ARBITRATE;
+					/*AUTORESET*/
+					// Beginning of autoreset for uninitialized flops
+					write_bank <= '0;
+					// End of automatics
+				end
+				else
+				begin
+					unique case (write_state)
+						STATE_ARBITRATE:
+						begin
+							if (|bank_awvalid && !write_queue_full)
+							begin
+								write_bank <= write_grant_idx;
+								write_state <= STATE_ISSUE_ADDRESS;
+							end
+						end
+
+						STATE_ISSUE_ADDRESS:
+						begin
+							if (axi_bus.s_awready)
+								write_state <= STATE_ACTIVE_BURST;
+						end
+
+						STATE_ACTIVE_BURST:
+						begin
+							if (axi_bus.m_wvalid && axi_bus.s_wready && axi_bus.m_wlast)
+								write_state <= STATE_ARBITRATE;
+						end
+					endcase
+				end
+			end
+
+			// Reads. Data comes back in the order addresses were accepted.
+			arbiter #(.NUM_REQUESTERS(`L2_BANKS)) arbiter_read(
+				.request(bank_arvalid),
+				.update_lru(read_state == STATE_ARBITRATE && !read_queue_full),
+				.grant_oh(read_grant_oh),
+				.*);
+
+			oh_to_idx #(.NUM_SIGNALS(`L2_BANKS)) oh_to_idx_read(
+				.one_hot(read_grant_oh),
+				.index(read_grant_idx));
+
+			assign read_address_accepted = read_state == STATE_ISSUE_ADDRESS
+				&& axi_bus.s_arready;
+			assign axi_bus.m_arvalid = read_state == STATE_ISSUE_ADDRESS
+				&& bank_arvalid[read_bank];
+			assign axi_bus.m_araddr = bank_araddr[read_bank];
+			assign axi_bus.m_rready = !read_queue_empty && bank_rready[active_read_bank];
+			assign read_beat = axi_bus.s_rvalid && axi_bus.m_rready;
+			assign read_burst_done = read_beat && read_beat_count == 8'(BURST_BEATS - 1);
+
+			sync_fifo #(
+				.WIDTH(BANK_IDX_WIDTH),
+				.SIZE(`L2_MAX_OUTSTANDING_READS * `L2_BANKS)
+			) read_queue(
+				.clk(clk),
+				.reset(reset),
+				.flush_en(1'b0),
+				.full(read_queue_full),
+				.almost_full(),
+				.enqueue_en(read_address_accepted),
+				.value_i(read_bank),
+				.empty(read_queue_empty),
+				.almost_empty(),
+				.dequeue_en(read_burst_done),
+				.value_o(active_read_bank));
+
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+				begin
+					read_state <= STATE_ARBITRATE;
+					/*AUTORESET*/
+					// Beginning of autoreset for uninitialized flops
+					read_bank <= '0;
+					read_beat_count <= '0;
+					// End of automatics
+				end
+				else
+				begin
+					unique case (read_state)
+						STATE_ARBITRATE:
+						begin
+							if (|bank_arvalid && !read_queue_full)
+							begin
+								read_bank <= read_grant_idx;
+								read_state <= STATE_ISSUE_ADDRESS;
+							end
+						end
+
+						STATE_ISSUE_ADDRESS:
+						begin
+							if (axi_bus.s_arready)
+								read_state <= STATE_ARBITRATE;
+						end
+
+						default:
+							;
+					endcase
+
+					if (read_burst_done)
+						read_beat_count <= '0;
+					else if (read_beat)
+						read_beat_count <= read_beat_count + 8'd1;
+				end
+			end
+		end
+	endgenerate
 endmodule
 
 // Local Variables:
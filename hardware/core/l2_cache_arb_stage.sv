@@ -21,7 +21,9 @@
 // request from fill interface. Restarted requests take precedence to avoid
 // the miss queue filling up. l2_ready depends combinationally on the valid
 // signals in the request packets, so valid bits must not be dependent on
-// l2_ready to avoid a combinational loop.
+// l2_ready to avoid a combinational loop. If there are multiple L2 banks,
+// l2_response_stall stops accepting requests from cores when this bank's
+// response queue is almost full.
 //
 
 module l2_cache_arb_stage(
@@ -42,7 +44,10 @@ module l2_cache_arb_stage(
 	input l2req_packet_t                  l2bi_request,
 	input cache_line_data_t               l2bi_data_from_memory,
 	input                                 l2bi_stall,
-	input                                 l2bi_collided_miss);
+	input                                 l2bi_collided_miss,
+
+	// From l2_cache
+	input                                 l2_response_stall);
 
 	logic[`NUM_CORES - 1:0] arb_request;
 	logic can_accept_request;
@@ -50,7 +55,7 @@ module l2_cache_arb_stage(
 	logic[`NUM_CORES - 1:0] grant_oh;
 	logic is_restarted_flush;
 
-	assign can_accept_request = !l2bi_request.valid && !l2bi_stall;
+	assign can_accept_request = !l2bi_request.valid && !l2bi_stall && !l2_response_stall;
 	assign is_restarted_flush = l2bi_request.packet_type == L2REQ_FLUSH;
 
 	genvar request_idx;
@@ -35,53 +35,58 @@
 //
 
 module l2_cache_read_stage(
-	input                                     clk,
-	input                                     reset,
+	input                                          clk,
+	input                                          reset,
 
 	// From l2_cache_tag_stage
-	input l2req_packet_t                      l2t_request,
-	input                                     l2t_valid[`L2_WAYS],
-	input l2_tag_t                            l2t_tag[`L2_WAYS],
-	input                                     l2t_dirty[`L2_WAYS],
-	input                                     l2t_is_l2_fill,
-	input                                     l2t_is_restarted_flush,
-	input l2_way_idx_t                        l2t_fill_way,
-	input cache_line_data_t                   l2t_data_from_memory,
+	input l2req_packet_t                           l2t_request,
+	input                                          l2t_valid[`L2_WAYS],
+	input l2_tag_t                                 l2t_tag[`L2_WAYS],
+	input                                          l2t_dirty[`L2_WAYS],
+	input                                          l2t_is_l2_fill,
+	input                                          l2t_is_restarted_flush,
+	input l2_way_idx_t                             l2t_fill_way,
+	input cache_line_data_t                        l2t_data_from_memory,
 
 	// To l2_cache_tag_stage
 	// Update metadata.
-	output logic[`L2_WAYS - 1:0]              l2r_update_dirty_en,
-	output l2_set_idx_t                       l2r_update_dirty_set,
-	output logic                              l2r_update_dirty_value,
-	output logic[`L2_WAYS - 1:0]              l2r_update_tag_en,
-	output l2_set_idx_t                       l2r_update_tag_set,
-	output logic                              l2r_update_tag_valid,
-	output l2_tag_t                           l2r_update_tag_value,
-	output logic                              l2r_update_lru_en,
-	output l2_way_idx_t                       l2r_update_lru_hit_way,
+	output logic[`L2_WAYS - 1:0]                   l2r_update_dirty_en,
+	output l2_bank_set_idx_t                       l2r_update_dirty_set,
+	output logic                                   l2r_update_dirty_value,
+	output logic[`L2_WAYS - 1:0]                   l2r_update_tag_en,
+	output l2_bank_set_idx_t                       l2r_update_tag_set,
+	output logic                                   l2r_update_tag_valid,
+	output l2_tag_t                                l2r_update_tag_value,
+	output logic                                   l2r_update_lru_en,
+	output l2_way_idx_t                            l2r_update_lru_hit_way,
+	output logic                                   l2r_update_lru_demote,
 
 	// From l2_cache_update_stage
-	input                                     l2u_write_en,
-	input [$clog2(`L2_WAYS * `L2_SETS) - 1:0] l2u_write_addr,
-	input cache_line_data_t                   l2u_write_data,
+	input                                          l2u_write_en,
+	input [$clog2(`L2_WAYS * `L2_BANK_SETS) - 1:0] l2u_write_addr,
+	input cache_line_data_t                        l2u_write_data,
 
 	// To l2_cache_update_stage
-	output l2req_packet_t                     l2r_request,
-	output cache_line_data_t                  l2r_data,	// Also to bus interface unit
-	output logic                              l2r_cache_hit,
-	output logic[$clog2(`L2_WAYS * `L2_SETS) - 1:0] l2r_hit_cache_idx,
-	output logic                              l2r_is_l2_fill,
-	output logic                              l2r_is_restarted_flush,
-	output cache_line_data_t                  l2r_data_from_memory,
-	output logic                              l2r_store_sync_success,
+	output l2req_packet_t                          l2r_request,
+	output cache_line_data_t                       l2r_data,	// Also to bus interface unit
+	output logic                                   l2r_cache_hit,
+	output logic[$clog2(`L2_WAYS * `L2_BANK_SETS) - 1:0] l2r_hit_cache_idx,
+	output logic                                   l2r_is_l2_fill,
+	output logic                                   l2r_is_restarted_flush,
+	output cache_line_data_t                       l2r_data_from_memory,
+	output logic                                   l2r_store_sync_success,
 
 	// To l2_axi_bus_interface
-	output l2_tag_t                           l2r_writeback_tag,
-	output logic                              l2r_needs_writeback,
+	output l2_tag_t                                l2r_writeback_tag,
+	output logic                                   l2r_needs_writeback,
+
+	// To/from other L2 banks
+	output logic[`TOTAL_THREADS - 1:0]             l2r_sync_load_oh,
+	input [`TOTAL_THREADS - 1:0]                   sync_load_other_bank_oh,
 
 	// Performance counters
-	output logic                              perf_l2_miss,
-	output logic                              perf_l2_hit);
+	output logic                                   perf_l2_miss,
+	output logic                                   perf_l2_hit);
 
 	// Track synchronized load/stores, and determine if a synchronized store
 	// was successful.
@@ -91,9 +96,10 @@ module l2_cache_read_stage(
 
 	logic[`L2_WAYS - 1:0] hit_way_oh;
 	l2_addr_t l2_addr;
+	l2_bank_set_idx_t bank_set_idx;
 	logic cache_hit;
 	l2_way_idx_t hit_way_idx;
-	logic[$clog2(`L2_WAYS * `L2_SETS) - 1:0] read_address;
+	logic[$clog2(`L2_WAYS * `L2_BANK_SETS) - 1:0] read_address;
 	logic is_load;
 	logic is_store;
 	logic update_dirty;
@@ -106,10 +112,13 @@ module l2_cache_read_stage(
 	logic[$clog2(`TOTAL_THREADS) - 1:0] request_sync_slot;
 
 	assign l2_addr = l2t_request.address;
+	assign bank_set_idx = l2_bank_set_idx_t'(l2_addr.set_idx / `L2_BANKS);
 	assign is_load = l2t_request.packet_type == L2REQ_LOAD
 		|| l2t_request.packet_type == L2REQ_LOAD_SYNC;
 	assign is_store = l2t_request.packet_type == L2REQ_STORE
-		|| l2t_request.packet_type == L2REQ_STORE_SYNC;
+		|| l2t_request.packet_type == L2REQ_STORE_SYNC
+		|| l2t_request.packet_type == L2REQ_STORE_NO_ALLOCATE
+		|| l2t_request.packet_type == L2REQ_ATOMIC;
 	assign writeback_way = l2t_request.packet_type == L2REQ_FLUSH
 		? hit_way_idx : l2t_fill_way;
 	assign is_dinvalidate = l2t_request.packet_type == L2REQ_DINVALIDATE;
@@ -133,14 +142,14 @@ module l2_cache_read_stage(
 
 	// If this is a fill, read the old (potentially dirty line) so it can be written back.
 	// If it is a cache hit, read the line data.
-	assign read_address = {(l2t_is_l2_fill ? l2t_fill_way : hit_way_idx), l2_addr.set_idx};
+	assign read_address = {(l2t_is_l2_fill ? l2t_fill_way : hit_way_idx), bank_set_idx};
 
 	//
 	// Cache memory
 	//
 	sram_1r1w #(
 		.DATA_WIDTH(`CACHE_LINE_BITS),
-		.SIZE(`L2_WAYS * `L2_SETS),
+		.SIZE(`L2_WAYS * `L2_BANK_SETS),
 		.READ_DURING_WRITE("NEW_DATA")
 	) sram_l2_data(
 		.read_en(l2t_request.valid && (cache_hit || l2t_is_l2_fill)),
@@ -160,7 +169,7 @@ module l2_cache_read_stage(
 		&& !l2t_is_restarted_flush;
 	assign update_dirty = l2t_request.valid && (l2t_is_l2_fill
 		|| (cache_hit && (is_store || is_flush_first_pass)));
-	assign l2r_update_dirty_set = l2_addr.set_idx;
+	assign l2r_update_dirty_set = bank_set_idx;
 	assign l2r_update_dirty_value = is_store;	// This is zero if this is a flush
 
 	genvar dirty_update_idx;
@@ -187,20 +196,32 @@ module l2_cache_read_stage(
 		end
 	endgenerate
 
-	assign l2r_update_tag_set = l2_addr.set_idx;
+	assign l2r_update_tag_set = bank_set_idx;
 	assign l2r_update_tag_valid = !is_dinvalidate;
 	assign l2r_update_tag_value = l2_addr.tag;
 
 	//
 	// Update LRU
+	// Lines that are flushed, invalidated, or written by a streaming store
+	// are demoted so they are replaced before the working set. A flush is
+	// only counted on the first pass.
 	//
-	assign l2r_update_lru_en = cache_hit && (is_load || is_store);
+	assign l2r_update_lru_en = cache_hit && (is_load || is_store || is_flush_first_pass
+		|| is_dinvalidate);
 	assign l2r_update_lru_hit_way = hit_way_idx;
+	assign l2r_update_lru_demote = l2t_request.packet_type == L2REQ_FLUSH
+		|| is_dinvalidate
+		|| l2t_request.packet_type == L2REQ_STORE_NO_ALLOCATE;
 
 	//
 	// Synchronized requests
+	// Each thread has one reservation. If there are multiple banks, the one
+	// that records a new reservation tells the others to clear theirs.
 	//
 	assign request_sync_slot = $size(request_sync_slot)'({l2t_request.core, l2t_request.id});
+	assign l2r_sync_load_oh = l2t_request.valid && (cache_hit || l2t_is_l2_fill)
+		&& l2t_request.packet_type == L2REQ_LOAD_SYNC
+		? `TOTAL_THREADS'(1) << request_sync_slot : '0;
 	assign can_store_sync = sync_load_address[request_sync_slot]
 		== {l2_addr.tag, l2_addr.set_idx}
 		&& sync_load_address_valid[request_sync_slot]
@@ -208,6 +229,8 @@ module l2_cache_read_stage(
 
 	// Performance events
 	assign is_hit_or_miss = l2t_request.valid && (l2t_request.packet_type == L2REQ_STORE || can_store_sync
+		|| l2t_request.packet_type == L2REQ_STORE_NO_ALLOCATE
+		|| l2t_request.packet_type == L2REQ_ATOMIC
 		|| l2t_request.packet_type == L2REQ_LOAD ) && !l2t_is_l2_fill;
 	assign perf_l2_miss = is_hit_or_miss && !(|hit_way_oh);
 	assign perf_l2_hit = is_hit_or_miss && |hit_way_oh;
@@ -252,7 +275,17 @@ module l2_cache_read_stage(
 			l2r_hit_cache_idx <= read_address;
 			l2r_is_restarted_flush <= l2t_is_restarted_flush;
 
-			if (l2t_request.valid && (cache_hit || l2t_is_l2_fill))
+			for (int entry_idx = 0; entry_idx < `TOTAL_THREADS; entry_idx++)
+			begin
+				if (sync_load_other_bank_oh[entry_idx])
+					sync_load_address_valid[entry_idx] <= 0;
+			end
+
+			// A non-allocating store that misses may be written directly to
+			// system memory without passing through here again, so it must
+			// invalidate synchronized loads for the line either way.
+			if (l2t_request.valid && (cache_hit || l2t_is_l2_fill
+				|| l2t_request.packet_type == L2REQ_STORE_NO_ALLOCATE))
 			begin
 				// Track synchronized load/stores
 				case (l2t_request.packet_type)
@@ -263,11 +296,13 @@ module l2_cache_read_stage(
 					end
 
 					L2REQ_STORE,
-					L2REQ_STORE_SYNC:
+					L2REQ_STORE_SYNC,
+					L2REQ_STORE_NO_ALLOCATE,
+					L2REQ_ATOMIC:
 					begin
 						// Don't invalidate if the sync store is not successful. Otherwise
 						// threads can livelock.
-						if (l2t_request.packet_type == L2REQ_STORE || can_store_sync)
+						if (l2t_request.packet_type != L2REQ_STORE_SYNC || can_store_sync)
 						begin
 							// Invalidate
 							for (int entry_idx = 0; entry_idx < `TOTAL_THREADS; entry_idx++)
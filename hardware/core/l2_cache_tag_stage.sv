@@ -34,14 +34,15 @@ module l2_cache_tag_stage(
 
 	// From l2_cache_read_stage
 	input [`L2_WAYS - 1:0]                l2r_update_dirty_en,
-	input l2_set_idx_t                    l2r_update_dirty_set,
+	input l2_bank_set_idx_t               l2r_update_dirty_set,
 	input                                 l2r_update_dirty_value,
 	input [`L2_WAYS - 1:0]                l2r_update_tag_en,
-	input l2_set_idx_t                    l2r_update_tag_set,
+	input l2_bank_set_idx_t               l2r_update_tag_set,
 	input                                 l2r_update_tag_valid,
 	input l2_tag_t                        l2r_update_tag_value,
 	input                                 l2r_update_lru_en,
 	input l2_way_idx_t                    l2r_update_lru_hit_way,
+	input                                 l2r_update_lru_demote,
 
 	// To l2_cache_read_stage
 	output l2req_packet_t                 l2t_request,
@@ -54,17 +55,23 @@ module l2_cache_tag_stage(
 	output logic                          l2t_is_restarted_flush);
 
 	l2_addr_t l2_addr;
+	l2_bank_set_idx_t bank_set_idx;
 
 	assign l2_addr = l2a_request.address;
 
-	cache_lru #(.NUM_SETS(`L2_SETS), .NUM_WAYS(`L2_WAYS)) cache_lru(
+	// The low bits of the set index select the bank, so they are the
+	// same for every request this bank sees.
+	assign bank_set_idx = l2_bank_set_idx_t'(l2_addr.set_idx / `L2_BANKS);
+
+	cache_lru #(.NUM_SETS(`L2_BANK_SETS), .NUM_WAYS(`L2_WAYS)) cache_lru(
 		.fill_en(l2a_is_l2_fill),
-		.fill_set(l2_addr.set_idx),
+		.fill_set(bank_set_idx),
 		.fill_way(l2t_fill_way),	// Output to next stage
 		.access_en(l2a_request.valid),
-		.access_set(l2_addr.set_idx),
+		.access_set(bank_set_idx),
 		.access_update_en(l2r_update_lru_en),
 		.access_update_way(l2r_update_lru_hit_way),
+		.access_update_demote(l2r_update_lru_demote),
 		.*);
 
 	//
@@ -74,15 +81,15 @@ module l2_cache_tag_stage(
 	generate
 		for (way_idx = 0; way_idx < `L2_WAYS; way_idx++)
 		begin : way_tags_gen
-			logic line_valid[`L2_SETS];
+			logic line_valid[`L2_BANK_SETS];
 
 			sram_1r1w #(
 				.DATA_WIDTH($bits(l2_tag_t)),
-				.SIZE(`L2_SETS),
+				.SIZE(`L2_BANK_SETS),
 				.READ_DURING_WRITE("NEW_DATA")
 			) sram_tags(
 				.read_en(l2a_request.valid),
-				.read_addr(l2_addr.set_idx),
+				.read_addr(bank_set_idx),
 				.read_data(l2t_tag[way_idx]),
 				.write_en(l2r_update_tag_en[way_idx]),
 				.write_addr(l2r_update_tag_set),
@@ -91,11 +98,11 @@ module l2_cache_tag_stage(
 
 			sram_1r1w #(
 				.DATA_WIDTH(1),
-				.SIZE(`L2_SETS),
+				.SIZE(`L2_BANK_SETS),
 				.READ_DURING_WRITE("NEW_DATA")
 			) sram_dirty_flags(
 				.read_en(l2a_request.valid),
-				.read_addr(l2_addr.set_idx),
+				.read_addr(bank_set_idx),
 				.read_data(l2t_dirty[way_idx]),
 				.write_en(l2r_update_dirty_en[way_idx]),
 				.write_addr(l2r_update_dirty_set),
@@ -106,7 +113,7 @@ module l2_cache_tag_stage(
 			begin
 				if (reset)
 				begin
-					for (int set_idx = 0; set_idx < `L2_SETS; set_idx++)
+					for (int set_idx = 0; set_idx < `L2_BANK_SETS; set_idx++)
 						line_valid[set_idx] <= 0;
 				end
 				else
@@ -114,10 +121,10 @@ module l2_cache_tag_stage(
 					if (l2a_request.valid)
 					begin
 						if (l2r_update_tag_en[way_idx] && l2r_update_tag_set
-							== l2_addr.set_idx)
+							== bank_set_idx)
 							l2t_valid[way_idx] <= l2r_update_tag_valid;	// Bypass
 						else
-							l2t_valid[way_idx] <= line_valid[l2_addr.set_idx];
+							l2t_valid[way_idx] <= line_valid[bank_set_idx];
 					end
 
 					if (l2r_update_tag_en[way_idx])
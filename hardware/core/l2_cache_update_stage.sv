@@ -20,54 +20,117 @@
 // L2 cache pipeline - update stage.
 // - Generates signals to update cache data if this is a cache fill or store.
 //   This applies the store mask and requested data to the original data.
-// - Sends response packet to cores.
+// - Sends response packet to cores. A non-allocating store that missed is
+//   acknowledged here when the bus interface queues it to be written to
+//   system memory. It replaces the whole line, so the response data is just
+//   the store data.
+// - Performs atomic operations. The request has one word set in the store
+//   mask and the operand in that word. This computes the new value from the
+//   original data and stores it like a normal store. The old value is
+//   returned in the response.
 //
 
 module l2_cache_update_stage(
-	input                                          clk,
-	input                                          reset,
+	input                                               clk,
+	input                                               reset,
 
 	// From l2_cache_read_stage
-	input l2req_packet_t                           l2r_request,
-	input cache_line_data_t                        l2r_data,
-	input                                          l2r_cache_hit,
-	input logic[$clog2(`L2_WAYS * `L2_SETS) - 1:0] l2r_hit_cache_idx,
-	input                                          l2r_is_l2_fill,
-	input                                          l2r_is_restarted_flush,
-	input cache_line_data_t                        l2r_data_from_memory,
-	input                                          l2r_store_sync_success,
-	input                                          l2r_needs_writeback,
+	input l2req_packet_t                                l2r_request,
+	input cache_line_data_t                             l2r_data,
+	input                                               l2r_cache_hit,
+	input logic[$clog2(`L2_WAYS * `L2_BANK_SETS) - 1:0] l2r_hit_cache_idx,
+	input                                               l2r_is_l2_fill,
+	input                                               l2r_is_restarted_flush,
+	input cache_line_data_t                             l2r_data_from_memory,
+	input                                               l2r_store_sync_success,
+	input                                               l2r_needs_writeback,
+
+	// From l2_axi_bus_interface
+	input                                               l2bi_store_bypass,
 
 	// To l2_cache_read_stage
-	output logic                                   l2u_write_en,
-	output [$clog2(`L2_WAYS * `L2_SETS) - 1:0]     l2u_write_addr,
-	output cache_line_data_t                       l2u_write_data,
+	output logic                                        l2u_write_en,
+	output [$clog2(`L2_WAYS * `L2_BANK_SETS) - 1:0]     l2u_write_addr,
+	output cache_line_data_t                            l2u_write_data,
 
 	// To cores
-	output l2rsp_packet_t                          l2_response);
+	output l2rsp_packet_t                               l2_response);
 
 	cache_line_data_t original_data;
 	logic update_data;
 	l2rsp_packet_type_t response_type;
 	logic is_completed_flush;
+	logic is_atomic;
+	scalar_t atomic_old_value;
+	scalar_t atomic_operand;
+	scalar_t atomic_new_value;
+	cache_line_data_t store_data;
 
 	assign original_data = l2r_is_l2_fill ? l2r_data_from_memory : l2r_data;
+	assign is_atomic = l2r_request.packet_type == L2REQ_ATOMIC;
 	assign update_data = l2r_request.packet_type == L2REQ_STORE
+		|| l2r_request.packet_type == L2REQ_STORE_NO_ALLOCATE
+		|| is_atomic
 		|| (l2r_request.packet_type == L2REQ_STORE_SYNC && l2r_store_sync_success);
 
+	// Find the word for an atomic operation. The data in the line is
+	// big endian, so swap it to perform arithmetic.
+	always_comb
+	begin
+		atomic_old_value = 0;
+		atomic_operand = 0;
+		for (int word_idx = 0; word_idx < `CACHE_LINE_WORDS; word_idx++)
+		begin
+			if (l2r_request.store_mask[word_idx * 4])
+			begin
+				atomic_old_value = {original_data[word_idx * 32+:8],
+					original_data[word_idx * 32 + 8+:8],
+					original_data[word_idx * 32 + 16+:8],
+					original_data[word_idx * 32 + 24+:8]};
+				atomic_operand = {l2r_request.data[word_idx * 32+:8],
+					l2r_request.data[word_idx * 32 + 8+:8],
+					l2r_request.data[word_idx * 32 + 16+:8],
+					l2r_request.data[word_idx * 32 + 24+:8]};
+			end
+		end
+	end
+
+	always_comb
+	begin
+		case (l2r_request.atomic_op)
+			ATOMIC_ADD: atomic_new_value = atomic_old_value + atomic_operand;
+			ATOMIC_AND: atomic_new_value = atomic_old_value & atomic_operand;
+			ATOMIC_OR: atomic_new_value = atomic_old_value | atomic_operand;
+			ATOMIC_XOR: atomic_new_value = atomic_old_value ^ atomic_operand;
+			ATOMIC_XCHG: atomic_new_value = atomic_operand;
+			ATOMIC_MIN: atomic_new_value = $signed(atomic_operand) < $signed(atomic_old_value)
+				? atomic_operand : atomic_old_value;
+			ATOMIC_MAX: atomic_new_value = $signed(atomic_operand) > $signed(atomic_old_value)
+				? atomic_operand : atomic_old_value;
+			default: atomic_new_value = atomic_old_value;
+		endcase
+	end
+
+	assign store_data = is_atomic
+		? {`CACHE_LINE_WORDS{atomic_new_value[7:0], atomic_new_value[15:8],
+			atomic_new_value[23:16], atomic_new_value[31:24]}}
+		: l2r_request.data;
+
 	genvar byte_lane;
 	generate
 		for (byte_lane = 0; byte_lane < `CACHE_LINE_BYTES; byte_lane++)
 		begin : lane_mask_gen
 			assign l2u_write_data[byte_lane * 8+:8] = (l2r_request.store_mask[byte_lane] && update_data)
-				? l2r_request.data[byte_lane * 8+:8]
+				? store_data[byte_lane * 8+:8]
 				: original_data[byte_lane * 8+:8];
 		end
 	endgenerate
 
 	assign l2u_write_en = l2r_request.valid
 		&& (l2r_is_l2_fill || (l2r_cache_hit && (l2r_request.packet_type == L2REQ_STORE
-		|| l2r_request.packet_type == L2REQ_STORE_SYNC)));
+		|| l2r_request.packet_type == L2REQ_STORE_SYNC
+		|| l2r_request.packet_type == L2REQ_STORE_NO_ALLOCATE
+		|| is_atomic)));
 	assign l2u_write_addr = l2r_hit_cache_idx;
 
 	// Response packet type
@@ -79,7 +142,9 @@ module l2_cache_update_stage(
 				response_type = L2RSP_LOAD_ACK;
 
 			L2REQ_STORE,
-			L2REQ_STORE_SYNC:
+			L2REQ_STORE_SYNC,
+			L2REQ_STORE_NO_ALLOCATE,
+			L2REQ_ATOMIC:
 				response_type = L2RSP_STORE_ACK;
 
 			L2REQ_FLUSH:
@@ -91,6 +156,9 @@ module l2_cache_update_stage(
 			L2REQ_DINVALIDATE:
 				response_type = L2RSP_DINVALIDATE_ACK;
 
+			L2REQ_PREFETCH:
+				response_type = L2RSP_PREFETCH_ACK;
+
 			default:
 				response_type = L2RSP_LOAD_ACK;
 		endcase
@@ -111,6 +179,7 @@ module l2_cache_update_stage(
 			if (l2r_request.valid
 				&& ((l2r_cache_hit && l2r_request.packet_type != L2REQ_FLUSH)
 				|| l2r_is_l2_fill
+				|| l2bi_store_bypass
 				|| is_completed_flush
 				|| l2r_request.packet_type == L2REQ_DINVALIDATE
 				|| l2r_request.packet_type == L2REQ_IINVALIDATE))
@@ -129,6 +198,7 @@ module l2_cache_update_stage(
 				l2_response.cache_type <= l2r_request.cache_type;
 				l2_response.data <= l2u_write_data;
 				l2_response.address <= l2r_request.address;
+				l2_response.atomic_value <= atomic_old_value;
 			end
 			else
 				l2_response <= 0;
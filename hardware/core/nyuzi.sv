@@ -40,6 +40,8 @@ module nyuzi
 	l2req_packet_t l2i_request[`NUM_CORES];
 	ioreq_packet_t io_request[`NUM_CORES];
 	logic[`TOTAL_PERF_EVENTS - 1:0] perf_events;
+	logic[`TOTAL_THREADS - 1:0][`TOTAL_PERF_EVENTS - 1:0] perf_thread_events;
+	logic[`TOTAL_THREADS - 1:0][`CORE_PERF_EVENTS - 1:0] core_perf_thread_events;
 	logic[`TOTAL_THREADS - 1:0] ic_interrupt_pending;
 	logic[`TOTAL_THREADS - 1:0] wb_interrupt_ack;
 	scalar_t ic_io_read_data;	// Currently not used
@@ -78,7 +80,7 @@ module nyuzi
 
 	always_ff @(posedge clk)
 	begin
-		if (io_address >= 'h130 && io_address <= 'h13c)
+		if (io_address >= 'h140 && io_address <= 'h17c)
 			io_read_source <= IO_PERF_COUNTERS;
 		else
 			io_read_source <= IO_ARBITER;
@@ -100,8 +102,23 @@ module nyuzi
 		.io_read_data(selected_io_read_data),
 		.*);
 
+	// L2 events aren't associated with a thread, so they are counted
+	// regardless of the thread filter. Core events are only set for threads
+	// in that core.
+	always_comb
+	begin
+		for (int thread_idx = 0; thread_idx < `TOTAL_THREADS; thread_idx++)
+		begin
+			perf_thread_events[thread_idx] = '0;
+			perf_thread_events[thread_idx][`L2_PERF_EVENTS - 1:0] = perf_events[`L2_PERF_EVENTS - 1:0];
+			perf_thread_events[thread_idx][`L2_PERF_EVENTS + `CORE_PERF_EVENTS
+				* (thread_idx / `THREADS_PER_CORE)+:`CORE_PERF_EVENTS] = core_perf_thread_events[thread_idx];
+		end
+	end
+
 	performance_counters #(
 		.NUM_EVENTS(`TOTAL_PERF_EVENTS),
+		.NUM_THREADS(`TOTAL_THREADS),
 		.BASE_ADDRESS('h120)
 	) performance_counters(
 		.io_read_data(perf_io_read_data),
@@ -121,6 +138,7 @@ module nyuzi
 				.ia_ready(ia_ready[core_idx]),
 				.ia_response(ia_response),
 				.core_perf_events(perf_events[`L2_PERF_EVENTS + `CORE_PERF_EVENTS * core_idx+:`CORE_PERF_EVENTS]),
+				.core_perf_thread_events(core_perf_thread_events[core_idx * `THREADS_PER_CORE+:`THREADS_PER_CORE]),
 				.*);
 		end
 	endgenerate
@@ -166,9 +166,11 @@ module operand_fetch_stage(
 			default:          of_mask_value <= {`VECTOR_LANES{1'b1}};	// MASK_SRC_ALL_ONES
 		endcase
 
+		// A scalar value is copied to all lanes, because it can be the addend
+		// for a vector fused multiply-add.
 		of_store_value <= cyc1_instruction.store_value_is_vector
 			? vector_val2
-			: {{`VECTOR_LANES - 1{32'd0}}, scalar_val2};
+			: {`VECTOR_LANES{scalar_val2}};
 	end
 endmodule
 
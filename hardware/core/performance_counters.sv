@@ -16,18 +16,23 @@
 
 //
 // Collects statistics from various modules used for performance measuring and tuning.
-// Counts the number of discrete events in each category.
+// Counts the number of discrete events in each category. Counters are 64 bits
+// wide and can be restricted to events caused by a single hardware thread.
 //
 
 module performance_counters
 	#(parameter BASE_ADDRESS = 0,
-	parameter NUM_EVENTS = 1)
+	parameter NUM_EVENTS = 1,
+	parameter NUM_THREADS = 1)
 
 	(input                           clk,
 	input                            reset,
 
 	input[NUM_EVENTS - 1:0]          perf_events,
 
+	// Events that are not associated with a thread are set for all threads.
+	input[NUM_THREADS - 1:0][NUM_EVENTS - 1:0] perf_thread_events,
+
 	// IO bus interface
 	input [31:0]                     io_address,
 	input                            io_read_en,
@@ -35,21 +40,36 @@ module performance_counters
 	input                            io_write_en,
 	output logic[31:0]               io_read_data);
 
-	localparam NUM_COUNTERS = 4;
+	localparam NUM_COUNTERS = 8;
 	localparam COUNTER_IDX_WIDTH = $clog2(NUM_COUNTERS);
 	localparam EVENT_IDX_WIDTH = $clog2(NUM_EVENTS);
+	localparam THREAD_IDX_WIDTH = NUM_THREADS > 1 ? $clog2(NUM_THREADS) : 1;
+	localparam COUNT_BASE = BASE_ADDRESS + NUM_COUNTERS * 4;
 
 	// Address 0 to (NUM_COUNTERS - 1): event select (write)
-	// Address NUM_COUNTERS to (NUM_COUNTERS * 2 - 1): event count (read)
+	//    bits 7-0: event index
+	//    bits 23-16: thread index
+	//    bit 31: only count events for the selected thread
+	// Address NUM_COUNTERS + n * 2: event count, low 32 bits (read)
+	// Address NUM_COUNTERS + n * 2 + 1: event count, high 32 bits (read). This
+	//    returns the value latched when the low half was last read, so software
+	//    can read a 64-bit value without it changing between the two accesses.
 
-	logic[31:0] event_counter[NUM_COUNTERS];
+	logic[63:0] event_counter[NUM_COUNTERS];
 	logic[EVENT_IDX_WIDTH - 1:0] event_select[NUM_COUNTERS];
-	logic[31:0] read_counter_value;
+	logic[THREAD_IDX_WIDTH - 1:0] thread_select[NUM_COUNTERS];
+	logic thread_filter_en[NUM_COUNTERS];
+	logic[31:0] count_high_latched;
 	logic[31:0] read_addr;
 	logic[COUNTER_IDX_WIDTH - 1:0] read_idx;
+	logic read_high;
+	logic count_read_en;
 
-	assign read_addr = io_address - (BASE_ADDRESS + NUM_COUNTERS * 4);
-	assign read_idx = read_addr[2+:COUNTER_IDX_WIDTH];
+	assign read_addr = io_address - COUNT_BASE;
+	assign read_idx = read_addr[3+:COUNTER_IDX_WIDTH];
+	assign read_high = read_addr[2];
+	assign count_read_en = io_read_en && io_address >= COUNT_BASE
+		&& io_address < COUNT_BASE + NUM_COUNTERS * 8;
 
 	always_ff @(posedge clk, posedge reset)
 	begin : update
@@ -59,20 +79,36 @@ module performance_counters
 			begin
 				event_counter[i] <= 0;
 				event_select[i] <= 0;
+				thread_select[i] <= 0;
+				thread_filter_en[i] <= 0;
 			end
+
+			count_high_latched <= 0;
 		end
 		else
 		begin
 			for (int i = 0; i < NUM_COUNTERS; i++)
 			begin
-				if (perf_events[event_select[COUNTER_IDX_WIDTH'(i)]])
-					event_counter[COUNTER_IDX_WIDTH'(i)] <= event_counter[COUNTER_IDX_WIDTH'(i)] + 1;
+				if (thread_filter_en[i]
+					? perf_thread_events[thread_select[i]][event_select[i]]
+					: perf_events[event_select[i]])
+					event_counter[i] <= event_counter[i] + 1;
 
 				if (io_write_en && io_address == BASE_ADDRESS + (i * 4))
+				begin
 					event_select[i] <= io_write_data[EVENT_IDX_WIDTH - 1:0];
+					thread_select[i] <= io_write_data[16+:THREAD_IDX_WIDTH];
+					thread_filter_en[i] <= io_write_data[31];
+				end
 			end
 
-			io_read_data <= event_counter[read_idx];
+			if (read_high)
+				io_read_data <= count_high_latched;
+			else
+				io_read_data <= event_counter[read_idx][31:0];
+
+			if (count_read_en && !read_high)
+				count_high_latched <= event_counter[read_idx][63:32];
 		end
 	end
 endmodule
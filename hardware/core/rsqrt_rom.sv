@@ -0,0 +1,160 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+//
+// This file is autogenerated by make_rsqrt_rom.py
+//
+
+module rsqrt_rom(
+	input [6:0] index,
+	output logic[5:0] rsqrt_estimate);
+
+	always_comb
+	begin
+		case (index)
+			7'h0: rsqrt_estimate = 6'h1a;
+			7'h1: rsqrt_estimate = 6'h19;
+			7'h2: rsqrt_estimate = 6'h19;
+			7'h3: rsqrt_estimate = 6'h18;
+			7'h4: rsqrt_estimate = 6'h17;
+			7'h5: rsqrt_estimate = 6'h17;
+			7'h6: rsqrt_estimate = 6'h16;
+			7'h7: rsqrt_estimate = 6'h15;
+			7'h8: rsqrt_estimate = 6'h15;
+			7'h9: rsqrt_estimate = 6'h14;
+			7'ha: rsqrt_estimate = 6'h14;
+			7'hb: rsqrt_estimate = 6'h13;
+			7'hc: rsqrt_estimate = 6'h13;
+			7'hd: rsqrt_estimate = 6'h12;
+			7'he: rsqrt_estimate = 6'h11;
+			7'hf: rsqrt_estimate = 6'h11;
+			7'h10: rsqrt_estimate = 6'h10;
+			7'h11: rsqrt_estimate = 6'h10;
+			7'h12: rsqrt_estimate = 6'hf;
+			7'h13: rsqrt_estimate = 6'hf;
+			7'h14: rsqrt_estimate = 6'hf;
+			7'h15: rsqrt_estimate = 6'he;
+			7'h16: rsqrt_estimate = 6'he;
+			7'h17: rsqrt_estimate = 6'hd;
+			7'h18: rsqrt_estimate = 6'hd;
+			7'h19: rsqrt_estimate = 6'hc;
+			7'h1a: rsqrt_estimate = 6'hc;
+			7'h1b: rsqrt_estimate = 6'hb;
+			7'h1c: rsqrt_estimate = 6'hb;
+			7'h1d: rsqrt_estimate = 6'hb;
+			7'h1e: rsqrt_estimate = 6'ha;
+			7'h1f: rsqrt_estimate = 6'ha;
+			7'h20: rsqrt_estimate = 6'h9;
+			7'h21: rsqrt_estimate = 6'h9;
+			7'h22: rsqrt_estimate = 6'h9;
+			7'h23: rsqrt_estimate = 6'h8;
+			7'h24: rsqrt_estimate = 6'h8;
+			7'h25: rsqrt_estimate = 6'h8;
+			7'h26: rsqrt_estimate = 6'h7;
+			7'h27: rsqrt_estimate = 6'h7;
+			7'h28: rsqrt_estimate = 6'h7;
+			7'h29: rsqrt_estimate = 6'h6;
+			7'h2a: rsqrt_estimate = 6'h6;
+			7'h2b: rsqrt_estimate = 6'h5;
+			7'h2c: rsqrt_estimate = 6'h5;
+			7'h2d: rsqrt_estimate = 6'h5;
+			7'h2e: rsqrt_estimate = 6'h5;
+			7'h2f: rsqrt_estimate = 6'h4;
+			7'h30: rsqrt_estimate = 6'h4;
+			7'h31: rsqrt_estimate = 6'h4;
+			7'h32: rsqrt_estimate = 6'h3;
+			7'h33: rsqrt_estimate = 6'h3;
+			7'h34: rsqrt_estimate = 6'h3;
+			7'h35: rsqrt_estimate = 6'h2;
+			7'h36: rsqrt_estimate = 6'h2;
+			7'h37: rsqrt_estimate = 6'h2;
+			7'h38: rsqrt_estimate = 6'h2;
+			7'h39: rsqrt_estimate = 6'h1;
+			7'h3a: rsqrt_estimate = 6'h1;
+			7'h3b: rsqrt_estimate = 6'h1;
+			7'h3c: rsqrt_estimate = 6'h1;
+			7'h3d: rsqrt_estimate = 6'h0;
+			7'h3e: rsqrt_estimate = 6'h0;
+			7'h3f: rsqrt_estimate = 6'h0;
+			7'h40: rsqrt_estimate = 6'h0;
+			7'h41: rsqrt_estimate = 6'h3f;
+			7'h42: rsqrt_estimate = 6'h3e;
+			7'h43: rsqrt_estimate = 6'h3d;
+			7'h44: rsqrt_estimate = 6'h3c;
+			7'h45: rsqrt_estimate = 6'h3b;
+			7'h46: rsqrt_estimate = 6'h3a;
+			7'h47: rsqrt_estimate = 6'h39;
+			7'h48: rsqrt_estimate = 6'h38;
+			7'h49: rsqrt_estimate = 6'h37;
+			7'h4a: rsqrt_estimate = 6'h37;
+			7'h4b: rsqrt_estimate = 6'h36;
+			7'h4c: rsqrt_estimate = 6'h35;
+			7'h4d: rsqrt_estimate = 6'h34;
+			7'h4e: rsqrt_estimate = 6'h33;
+			7'h4f: rsqrt_estimate = 6'h33;
+			7'h50: rsqrt_estimate = 6'h32;
+			7'h51: rsqrt_estimate = 6'h31;
+			7'h52: rsqrt_estimate = 6'h31;
+			7'h53: rsqrt_estimate = 6'h30;
+			7'h54: rsqrt_estimate = 6'h2f;
+			7'h55: rsqrt_estimate = 6'h2f;
+			7'h56: rsqrt_estimate = 6'h2e;
+			7'h57: rsqrt_estimate = 6'h2d;
+			7'h58: rsqrt_estimate = 6'h2d;
+			7'h59: rsqrt_estimate = 6'h2c;
+			7'h5a: rsqrt_estimate = 6'h2b;
+			7'h5b: rsqrt_estimate = 6'h2b;
+			7'h5c: rsqrt_estimate = 6'h2a;
+			7'h5d: rsqrt_estimate = 6'h2a;
+			7'h5e: rsqrt_estimate = 6'h29;
+			7'h5f: rsqrt_estimate = 6'h29;
+			7'h60: rsqrt_estimate = 6'h28;
+			7'h61: rsqrt_estimate = 6'h27;
+			7'h62: rsqrt_estimate = 6'h27;
+			7'h63: rsqrt_estimate = 6'h26;
+			7'h64: rsqrt_estimate = 6'h26;
+			7'h65: rsqrt_estimate = 6'h25;
+			7'h66: rsqrt_estimate = 6'h25;
+			7'h67: rsqrt_estimate = 6'h24;
+			7'h68: rsqrt_estimate = 6'h24;
+			7'h69: rsqrt_estimate = 6'h23;
+			7'h6a: rsqrt_estimate = 6'h23;
+			7'h6b: rsqrt_estimate = 6'h22;
+			7'h6c: rsqrt_estimate = 6'h22;
+			7'h6d: rsqrt_estimate = 6'h22;
+			7'h6e: rsqrt_estimate = 6'h21;
+			7'h6f: rsqrt_estimate = 6'h21;
+			7'h70: rsqrt_estimate = 6'h20;
+			7'h71: rsqrt_estimate = 6'h20;
+			7'h72: rsqrt_estimate = 6'h1f;
+			7'h73: rsqrt_estimate = 6'h1f;
+			7'h74: rsqrt_estimate = 6'h1f;
+			7'h75: rsqrt_estimate = 6'h1e;
+			7'h76: rsqrt_estimate = 6'h1e;
+			7'h77: rsqrt_estimate = 6'h1d;
+			7'h78: rsqrt_estimate = 6'h1d;
+			7'h79: rsqrt_estimate = 6'h1d;
+			7'h7a: rsqrt_estimate = 6'h1c;
+			7'h7b: rsqrt_estimate = 6'h1c;
+			7'h7c: rsqrt_estimate = 6'h1b;
+			7'h7d: rsqrt_estimate = 6'h1b;
+			7'h7e: rsqrt_estimate = 6'h1b;
+			7'h7f: rsqrt_estimate = 6'h1a;
+			default: rsqrt_estimate = 6'h0;
+		endcase
+	end
+endmodule
+
@@ -19,13 +19,18 @@
 //
 // Instruction Pipeline Thread Select Stage
 // - Contains an instruction FIFO for each thread
-// - Each cycle, picks a thread to issue using a round robin scheduling
-//   algorithm, avoid various types of conflicts:
+// - Each cycle, picks a thread to issue, avoiding various types of conflicts:
 //   * inter-instruction register dependencies, tracked using a scoreboard
 //     for each thread.
 //   * writeback hazards between the pipelines of different lengths, tracked
 //     with a shared shift register.
 // - Tracks dcache misses and suspends threads until they are resolved.
+// - Among threads that can issue, only those with the highest rank are
+//   considered. The rank is the priority software set in the
+//   CR_THREAD_PRIORITY control register, except that a thread that recently
+//   executed a pause instruction ranks below every thread that hasn't.
+//   Threads of equal rank are picked round robin, or greedy-then-oldest if
+//   THREAD_SELECT_GTO is defined (see config.sv).
 //
 
 module thread_select_stage(
@@ -57,6 +62,9 @@ module thread_select_stage(
 	input pipeline_sel_t               wb_rollback_pipeline,
 	input subcycle_t                   wb_rollback_subcycle,
 
+	// From l1_store_queue
+	input                              sq_rollback_en,
+
 	// From top level module
 	input thread_bitmap_t              ic_thread_en,
 
@@ -65,8 +73,17 @@ module thread_select_stage(
 	input thread_bitmap_t              l2i_dcache_wake_bitmap,
 	input thread_bitmap_t              ior_wake_bitmap,
 
+	// From control_registers
+	input thread_priority_t            cr_thread_priority[`THREADS_PER_CORE],
+
 	// Performace counters
-	output logic                       perf_instruction_issue);
+	output thread_bitmap_t             perf_instruction_issue,
+	output thread_bitmap_t             perf_stall_icache,
+	output thread_bitmap_t             perf_stall_dcache,
+	output thread_bitmap_t             perf_stall_store_queue,
+	output thread_bitmap_t             perf_stall_raw,
+	output thread_bitmap_t             perf_stall_writeback_conflict,
+	output thread_bitmap_t             perf_stall_schedule);
 
 	localparam THREAD_FIFO_SIZE = 8;
 
@@ -76,11 +93,17 @@ module thread_select_stage(
 	// Difference between longest and shortest execution pipeline
 	localparam WRITEBACK_ALLOC_STAGES = 4;
 
+	// Paused bit (inverted) concatenated with the thread priority
+	typedef logic[$bits(thread_priority_t):0] issue_rank_t;
+
 	decoded_instruction_t thread_instr[`THREADS_PER_CORE];
 	decoded_instruction_t issue_instr;
 	thread_bitmap_t thread_blocked;
+	thread_bitmap_t thread_blocked_store;	// Blocked because store queue was full
 	thread_bitmap_t can_issue_thread;
+	thread_bitmap_t issue_candidate;
 	thread_bitmap_t thread_issue_oh;
+	issue_rank_t thread_rank[`THREADS_PER_CORE];
 	thread_idx_t issue_thread_idx;
 	logic[WRITEBACK_ALLOC_STAGES - 1:0] writeback_allocate;
 	logic[WRITEBACK_ALLOC_STAGES - 1:0] writeback_allocate_nxt;
@@ -127,8 +150,10 @@ module thread_select_stage(
 			decoded_instruction_t thread_instr_nxt;
 			logic instruction_latched;
 			logic writeback_conflict;
+			logic scoreboard_conflict;
 			logic rollback_this_thread;
 			logic instruction_latch_en;
+			logic[$clog2(`PAUSE_CYCLES + 1) - 1:0] pause_count;
 
 			assign rollback_this_thread = wb_rollback_en && wb_rollback_thread_idx == thread_idx_t'(thread_idx);
 
@@ -282,8 +307,10 @@ module thread_select_stage(
 			// cases, this is fine, but with a multi-cycle operation (like a gather
 			// load), which writes back to the same register multiple times, this
 			// would delay the load.
+			assign scoreboard_conflict = (scoreboard[thread_idx] & scoreboard_dep_bitmap) != 0
+				&& current_subcycle[thread_idx] == 0;
 			assign can_issue_thread[thread_idx] = instruction_latched
-				&& ((scoreboard[thread_idx] & scoreboard_dep_bitmap) == 0 || current_subcycle[thread_idx] != 0)
+				&& !scoreboard_conflict
 				&& ic_thread_en[thread_idx]
 				&& !rollback_this_thread
 				&& !writeback_conflict
@@ -312,6 +339,43 @@ module thread_select_stage(
 				end
 			end
 
+			// A pause instruction is a hint that this thread is spinning,
+			// waiting for another thread. Move it behind threads that are doing
+			// useful work for a while. This only affects scheduling, so it
+			// doesn't matter if the pause is later rolled back.
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+					pause_count <= 0;
+				else if (thread_issue_oh[thread_idx] && thread_instr[thread_idx].is_cache_control
+					&& thread_instr[thread_idx].cache_control_op == CACHE_PAUSE)
+				begin
+					pause_count <= `PAUSE_CYCLES;
+				end
+				else if (pause_count != 0)
+					pause_count <= pause_count - 1;
+			end
+
+			assign thread_rank[thread_idx] = {pause_count == 0, cr_thread_priority[thread_idx]};
+
+			// Performance events for cycles where this thread can't issue. These
+			// use the same priority as thread_state below, so only one is
+			// asserted at a time.
+			assign perf_stall_icache[thread_idx] = ic_thread_en[thread_idx] && !instruction_latched;
+			assign perf_stall_dcache[thread_idx] = ic_thread_en[thread_idx] && instruction_latched
+				&& thread_blocked[thread_idx] && !thread_blocked_store[thread_idx];
+			assign perf_stall_store_queue[thread_idx] = ic_thread_en[thread_idx] && instruction_latched
+				&& thread_blocked[thread_idx] && thread_blocked_store[thread_idx];
+			assign perf_stall_raw[thread_idx] = ic_thread_en[thread_idx] && instruction_latched
+				&& !thread_blocked[thread_idx] && scoreboard_conflict;
+			assign perf_stall_writeback_conflict[thread_idx] = ic_thread_en[thread_idx]
+				&& instruction_latched && !thread_blocked[thread_idx] && !scoreboard_conflict
+				&& writeback_conflict;
+
+			// This thread could have issued, but another one was picked.
+			assign perf_stall_schedule[thread_idx] = can_issue_thread[thread_idx]
+				&& !thread_issue_oh[thread_idx];
+
 `ifdef SIMULATION
 			// Used for visualizer app. There can be multiple events that prevent
 			// a thread from executing, but I picked a order that seemed logical
@@ -356,18 +420,91 @@ module thread_select_stage(
 	//
 	// Choose which thread to issue
 	//
+
+	// Only threads with the highest rank of those that can issue compete
+	// for the issue slot.
+	always_comb
+	begin
+		issue_rank_t top_rank;
+
+		top_rank = 0;
+		for (int i = 0; i < `THREADS_PER_CORE; i++)
+		begin
+			if (can_issue_thread[i] && thread_rank[i] > top_rank)
+				top_rank = thread_rank[i];
+		end
+
+		for (int i = 0; i < `THREADS_PER_CORE; i++)
+			issue_candidate[i] = can_issue_thread[i] && thread_rank[i] == top_rank;
+	end
+
+`ifdef THREAD_SELECT_GTO
+	// Greedy then oldest: keep issuing from the thread that issued last as
+	// long as it is a candidate. Otherwise pick the candidate that has gone
+	// the longest without issuing. issued_before[i][j] is set if thread i
+	// issued less recently than thread j. This is a total order, so exactly
+	// one candidate is picked.
+	thread_bitmap_t issued_before[`THREADS_PER_CORE];
+	thread_bitmap_t last_issue_oh;
+
+	always_comb
+	begin
+		if ((issue_candidate & last_issue_oh) != 0)
+			thread_issue_oh = last_issue_oh;
+		else
+		begin
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+			begin
+				thread_issue_oh[i] = issue_candidate[i];
+				for (int j = 0; j < `THREADS_PER_CORE; j++)
+				begin
+					if (j != i && issue_candidate[j] && !issued_before[i][j])
+						thread_issue_oh[i] = 0;
+				end
+			end
+		end
+	end
+
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+			begin
+				for (int j = 0; j < `THREADS_PER_CORE; j++)
+					issued_before[i][j] <= i < j;
+			end
+
+			last_issue_oh <= 0;
+		end
+		else if (|thread_issue_oh)
+		begin
+			assert($onehot(thread_issue_oh));
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+			begin
+				if (thread_issue_oh[i])
+					issued_before[i] <= 0;
+				else
+					issued_before[i] <= issued_before[i] | thread_issue_oh;
+			end
+
+			last_issue_oh <= thread_issue_oh;
+		end
+	end
+`else
 	arbiter #(.NUM_REQUESTERS(`THREADS_PER_CORE)) thread_select_arbiter(
-		.request(can_issue_thread),
+		.request(issue_candidate),
 		.update_lru(1'b1),
 		.grant_oh(thread_issue_oh),
 		.*);
+`endif
 
 	oh_to_idx #(.NUM_SIGNALS(`THREADS_PER_CORE)) thread_oh_to_idx(
 		.one_hot(thread_issue_oh),
 		.index(issue_thread_idx));
 
 	assign issue_instr = thread_instr[issue_thread_idx];
-	assign perf_instruction_issue = |thread_issue_oh;
+	assign perf_instruction_issue = thread_issue_oh;
 
 	always_ff @(posedge clk, posedge reset)
 	begin
@@ -387,6 +524,7 @@ module thread_select_stage(
 			/*AUTORESET*/
 			// Beginning of autoreset for uninitialized flops
 			thread_blocked <= '0;
+			thread_blocked_store <= '0;
 			ts_instruction_valid <= '0;
 			ts_subcycle <= '0;
 			ts_thread_idx <= '0;
@@ -423,6 +561,11 @@ module thread_select_stage(
 			// cache data is now available and the thread won't be rolled back.
 			thread_blocked <= (thread_blocked | wb_suspend_thread_oh) & ~(l2i_dcache_wake_bitmap
 				| ior_wake_bitmap);
+			if (|wb_suspend_thread_oh)
+			begin
+				thread_blocked_store <= sq_rollback_en ? thread_blocked_store | wb_suspend_thread_oh
+					: thread_blocked_store & ~wb_suspend_thread_oh;
+			end
 
 			// Track issued instructions for scoreboard clearing
 			for (int i = 1; i < ROLLBACK_STAGES; i++)
@@ -19,11 +19,17 @@
 //
 // Translation lookaside buffer.
 // Caches virtual to physical address translations.
+// 4k page entries are stored in a set associative SRAM, indexed by the low
+// bits of the virtual page number. Superpage (4MB) entries span many sets,
+// so they are stored in a small fully associative array of flops instead,
+// which is checked in parallel. If an address matches both, the 4k page
+// entry is used.
 //
 
 module tlb
 	#(parameter NUM_ENTRIES = 64,
-	parameter NUM_WAYS = 4)
+	parameter NUM_WAYS = 4,
+	parameter NUM_SUPERPAGE_ENTRIES = 4)
 
 	(input                    clk,
 	input                     reset,
@@ -39,6 +45,7 @@ module tlb
 	input                     update_writable,
 	input                     update_supervisor,
 	input                     update_global,
+	input                     update_superpage,
 
 	// Response
 	output page_index_t       lookup_ppage_idx,
@@ -49,6 +56,19 @@ module tlb
 	localparam NUM_SETS = NUM_ENTRIES / NUM_WAYS;
 	localparam SET_INDEX_WIDTH = $clog2(NUM_SETS);
 	localparam WAY_INDEX_WIDTH = $clog2(NUM_WAYS);
+	localparam SUPERPAGE_OFFSET_BITS = `PAGE_NUM_BITS - `SUPERPAGE_NUM_BITS;
+
+	typedef logic[`SUPERPAGE_NUM_BITS - 1:0] superpage_index_t;
+
+	struct packed {
+		logic valid;
+		superpage_index_t vpage_idx;
+		superpage_index_t ppage_idx;
+		logic[`ASID_WIDTH - 1:0] asid;
+		logic writable;
+		logic supervisor;
+		logic global;
+	} superpages[NUM_SUPERPAGE_ENTRIES];
 
 	logic[NUM_WAYS - 1:0] way_hit_oh;
 	page_index_t way_ppage_idx[NUM_WAYS];
@@ -67,7 +87,20 @@ module tlb
 	logic update_writable_latched;
 	logic update_supervisor_latched;
 	logic update_global_latched;
+	logic update_superpage_latched;
 	logic[`ASID_WIDTH - 1:0] request_asid_latched;
+	logic tlb_read_en_latched;
+	logic[NUM_SUPERPAGE_ENTRIES - 1:0] superpage_hit_oh;
+	logic[NUM_SUPERPAGE_ENTRIES - 1:0] superpage_update_oh;
+	logic[NUM_SUPERPAGE_ENTRIES - 1:0] next_superpage_oh;
+	logic way_hit;
+	logic superpage_hit;
+	page_index_t way_lookup_ppage_idx;
+	logic way_lookup_writable;
+	logic way_lookup_supervisor;
+	superpage_index_t superpage_lookup_ppage_idx;
+	logic superpage_lookup_writable;
+	logic superpage_lookup_supervisor;
 
 	//
 	// Stage 1: lookup
@@ -155,9 +188,11 @@ module tlb
 			invalidate_en_latched <= '0;
 			request_asid_latched <= '0;
 			request_vpage_idx_latched <= '0;
+			tlb_read_en_latched <= '0;
 			update_en_latched <= '0;
 			update_global_latched <= '0;
 			update_ppage_idx_latched <= '0;
+			update_superpage_latched <= '0;
 			update_supervisor_latched <= '0;
 			update_writable_latched <= '0;
 			// End of automatics
@@ -168,12 +203,14 @@ module tlb
 			if (tlb_read_en)
 				request_vpage_idx_latched <= request_vpage_idx;
 
+			tlb_read_en_latched <= tlb_read_en;
 			update_en_latched <= update_en;
 			invalidate_en_latched <= invalidate_en;
 			update_ppage_idx_latched <= update_ppage_idx;
 			update_writable_latched <= update_writable;
 			update_supervisor_latched <= update_supervisor;
 			update_global_latched <= update_global;
+			update_superpage_latched <= update_superpage;
 			request_asid_latched <= request_asid;
 		end
 	end
@@ -181,29 +218,82 @@ module tlb
 	//
 	// Stage 2: output/update
 	//
-	assign lookup_hit = |way_hit_oh;
+
+	// Superpage entries are flops, so they are compared in this stage. That
+	// way, an update in the previous cycle is visible without a bypass.
+	genvar superpage_idx;
+	generate
+		for (superpage_idx = 0; superpage_idx < NUM_SUPERPAGE_ENTRIES; superpage_idx++)
+		begin : superpage_gen
+			assign superpage_hit_oh[superpage_idx] = tlb_read_en_latched
+				&& superpages[superpage_idx].valid
+				&& superpages[superpage_idx].vpage_idx
+				== request_vpage_idx_latched[`PAGE_NUM_BITS - 1-:`SUPERPAGE_NUM_BITS]
+				&& (superpages[superpage_idx].asid == request_asid_latched
+				|| superpages[superpage_idx].global);
+		end
+	endgenerate
+
+	assign way_hit = |way_hit_oh;
+	assign superpage_hit = |superpage_hit_oh;
+	assign lookup_hit = way_hit || superpage_hit;
+
 	always_comb
 	begin
 		// Enabled mux. Use OR to avoid inferring priority encoder.
-		lookup_ppage_idx = 0;
-		lookup_writable = 0;
-		lookup_supervisor = 0;
+		way_lookup_ppage_idx = 0;
+		way_lookup_writable = 0;
+		way_lookup_supervisor = 0;
 		for (int i = 0; i < NUM_WAYS; i++)
 		begin
 			if (way_hit_oh[i])
 			begin
-				lookup_ppage_idx |= way_ppage_idx[i];
-				lookup_writable |= way_writable[i];
-				lookup_supervisor |= way_supervisor[i];
+				way_lookup_ppage_idx |= way_ppage_idx[i];
+				way_lookup_writable |= way_writable[i];
+				way_lookup_supervisor |= way_supervisor[i];
+			end
+		end
+
+		superpage_lookup_ppage_idx = 0;
+		superpage_lookup_writable = 0;
+		superpage_lookup_supervisor = 0;
+		for (int i = 0; i < NUM_SUPERPAGE_ENTRIES; i++)
+		begin
+			if (superpage_hit_oh[i])
+			begin
+				superpage_lookup_ppage_idx |= superpages[i].ppage_idx;
+				superpage_lookup_writable |= superpages[i].writable;
+				superpage_lookup_supervisor |= superpages[i].supervisor;
 			end
 		end
 	end
 
 	always_comb
 	begin
-		if (update_en_latched || invalidate_en_latched)
+		if (way_hit)
+		begin
+			lookup_ppage_idx = way_lookup_ppage_idx;
+			lookup_writable = way_lookup_writable;
+			lookup_supervisor = way_lookup_supervisor;
+		end
+		else
 		begin
-			if (lookup_hit)
+			// The low bits of the virtual page number are the offset into
+			// the superpage.
+			lookup_ppage_idx = {superpage_lookup_ppage_idx,
+				request_vpage_idx_latched[SUPERPAGE_OFFSET_BITS - 1:0]};
+			lookup_writable = superpage_lookup_writable;
+			lookup_supervisor = superpage_lookup_supervisor;
+		end
+	end
+
+	// An invalidate removes both 4k page and superpage entries that match the
+	// address.
+	always_comb
+	begin
+		if ((update_en_latched && !update_superpage_latched) || invalidate_en_latched)
+		begin
+			if (way_hit)
 				way_update_oh = way_hit_oh;
 			else
 				way_update_oh = next_way_oh;
@@ -212,6 +302,21 @@ module tlb
 			way_update_oh = '0;
 	end
 
+	always_comb
+	begin
+		if ((update_en_latched && update_superpage_latched) || invalidate_en_latched)
+		begin
+			if (superpage_hit)
+				superpage_update_oh = superpage_hit_oh;
+			else if (update_en_latched)
+				superpage_update_oh = next_superpage_oh;
+			else
+				superpage_update_oh = '0;
+		end
+		else
+			superpage_update_oh = '0;
+	end
+
 	// If there is an invalidate, clear the valid bit
 	assign update_valid = update_en_latched;
 
@@ -220,17 +325,44 @@ module tlb
 		if (reset)
 		begin
 			next_way_oh <= NUM_WAYS'(1);
+			next_superpage_oh <= NUM_SUPERPAGE_ENTRIES'(1);
+			for (int i = 0; i < NUM_SUPERPAGE_ENTRIES; i++)
+				superpages[i] <= 0;
+
 			/*AUTORESET*/
 		end
 		else
 		begin
 			// Make sure we don't have duplicate entries in a set
 			assert($onehot0(way_hit_oh));
-			if (update_en)
+			assert($onehot0(superpage_hit_oh));
+			if (update_en && !update_superpage)
 			begin
 				// Rotate
 				next_way_oh <= {next_way_oh[NUM_WAYS - 2:0], next_way_oh[NUM_WAYS - 1]};
 			end
+
+			if (update_en && update_superpage)
+			begin
+				next_superpage_oh <= {next_superpage_oh[NUM_SUPERPAGE_ENTRIES - 2:0],
+					next_superpage_oh[NUM_SUPERPAGE_ENTRIES - 1]};
+			end
+
+			for (int i = 0; i < NUM_SUPERPAGE_ENTRIES; i++)
+			begin
+				if (invalidate_all_en)
+					superpages[i].valid <= 0;
+				else if (superpage_update_oh[i])
+				begin
+					superpages[i].valid <= update_valid;
+					superpages[i].vpage_idx <= request_vpage_idx_latched[`PAGE_NUM_BITS - 1-:`SUPERPAGE_NUM_BITS];
+					superpages[i].ppage_idx <= update_ppage_idx_latched[`PAGE_NUM_BITS - 1-:`SUPERPAGE_NUM_BITS];
+					superpages[i].asid <= request_asid_latched;
+					superpages[i].writable <= update_writable_latched;
+					superpages[i].supervisor <= update_supervisor_latched;
+					superpages[i].global <= update_global_latched;
+				end
+			end
 		end
 	end
 endmodule
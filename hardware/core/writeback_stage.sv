@@ -77,11 +77,20 @@ module writeback_stage(
 	input                                 dd_tlb_miss,
 	input                                 dd_supervisor_fault,
 	input                                 dd_privilege_op_fault,
+	input                                 dd_scgath_coalesce_en,
+	input vector_lane_mask_t              dd_scgath_lane_mask,
+	input [$clog2(`CACHE_LINE_WORDS) - 1:0] dd_scgath_data_lane[`VECTOR_LANES],
+	input subcycle_t                      dd_scgath_resume_subcycle,
+	input                                 dd_scgath_complete,
+	input sample_texel_mask_t             dd_sample_texels_read,
+	input [$clog2(`CACHE_LINE_WORDS) - 1:0] dd_sample_data_lane[`SAMPLE_TEXELS],
+	input [16:0]                          dd_sample_weight[`SAMPLE_TEXELS],
 
 	// From l1_store_queue
 	input [`CACHE_LINE_BYTES - 1:0]       sq_store_bypass_mask,
 	input cache_line_data_t               sq_store_bypass_data,
 	input                                 sq_store_sync_success,
+	input scalar_t                        sq_store_atomic_value,
 	input                                 sq_rollback_en,
 
 	// From io_request_queue
@@ -112,6 +121,11 @@ module writeback_stage(
 	output pipeline_sel_t                 wb_rollback_pipeline,
 	output subcycle_t                     wb_rollback_subcycle,
 
+	// To dcache_data_stage
+	output vector_lane_mask_t             wb_scgath_done_mask[`THREADS_PER_CORE],
+	output sample_texel_mask_t            wb_sample_texels_read[`THREADS_PER_CORE],
+	output subcycle_t                     wb_sample_subcycle[`THREADS_PER_CORE],
+
 	// To operand_fetch_stage/thread_select_stage
 	output logic                          wb_writeback_en,
 	output thread_idx_t                   wb_writeback_thread_idx,
@@ -126,7 +140,11 @@ module writeback_stage(
 
 	// Performance counters
 	output logic                          perf_instruction_retire,
-	output logic                          perf_store_rollback);
+	output logic                          perf_store_rollback,
+	output logic                          perf_rollback_branch,
+	output logic                          perf_rollback_dcache_miss,
+	output logic                          perf_rollback_sync,
+	output logic                          perf_branch_mispredict);
 
 	scalar_t mem_load_lane;
 	logic[$clog2(`CACHE_LINE_WORDS) - 1:0] mem_load_lane_idx;
@@ -135,6 +153,13 @@ module writeback_stage(
 	logic[31:0] swapped_word_value;
 	memory_op_t memory_op;
 	cache_line_data_t endian_twiddled_data;
+	vector_t scgath_load_value;
+	logic scgath_skip_en;
+	logic is_sample_dd;
+	scalar_t sample_texels[`THREADS_PER_CORE][`SAMPLE_TEXELS];
+	scalar_t sample_texel_value[`SAMPLE_TEXELS];
+	scalar_t sample_value;
+	logic[23:0] sample_channel_sum;
 `ifdef SIMULATION
 	scalar_t __debug_wb_pc;	// Used by testbench
 	pipeline_sel_t __debug_wb_pipeline;
@@ -174,6 +199,11 @@ module writeback_stage(
 		wb_interrupt_ack = '0;
 		wb_fault_access_vaddr = 0;
 		wb_fault_subcycle = dd_subcycle;
+		perf_rollback_branch = 0;
+		perf_rollback_dcache_miss = 0;
+		perf_rollback_sync = 0;
+		perf_branch_mispredict = 0;
+		scgath_skip_en = 0;
 
 		if (ix_instruction_valid && (ix_instruction.illegal || ix_instruction.ifetch_alignment_fault
 			|| ix_instruction.tlb_miss || ix_privileged_op_fault || ix_instruction.is_syscall
@@ -250,6 +280,7 @@ module writeback_stage(
 			wb_rollback_pc = ix_result[0];
 			wb_rollback_thread_idx = ix_thread_idx;
 			wb_rollback_pipeline = PIPE_SCYCLE_ARITH;
+			perf_rollback_branch = 1;
 		end
 		else if (dd_instruction_valid && dd_instruction.has_dest && dd_instruction.dest_reg == `REG_PC
 			&& !dd_instruction.dest_is_vector && !dd_rollback_en)
@@ -260,6 +291,7 @@ module writeback_stage(
 			wb_rollback_pc = swapped_word_value;
 			wb_rollback_thread_idx = dd_thread_idx;
 			wb_rollback_pipeline = PIPE_MEM;
+			perf_rollback_branch = 1;
 		end
 		else if (ix_instruction_valid && ix_rollback_en)
 		begin
@@ -269,6 +301,11 @@ module writeback_stage(
 			wb_rollback_thread_idx = ix_thread_idx;
 			wb_rollback_pc = ix_rollback_pc;
 			wb_rollback_pipeline = PIPE_SCYCLE_ARITH;
+			perf_rollback_branch = 1;
+
+			// Branches to a register target are never predicted.
+			perf_branch_mispredict = ix_instruction.branch_type != BRANCH_CALL_REGISTER
+				&& ix_instruction.branch_type != BRANCH_ERET;
 			if (ix_instruction.branch_type == BRANCH_ERET)
 				wb_rollback_subcycle = cr_eret_subcycle[ix_thread_idx];
 			else
@@ -284,6 +321,102 @@ module writeback_stage(
 			wb_rollback_pc = dd_rollback_pc;
 			wb_rollback_pipeline = PIPE_MEM;
 			wb_rollback_subcycle = dd_subcycle;
+			if (dd_instruction.is_memory_access && dd_instruction.memory_access_type == MEM_SYNC)
+				perf_rollback_sync = 1;
+			else if (dd_rollback_en && !dd_instruction.is_cache_control	// Not dwait
+				&& dd_sample_texels_read == 0)	// Not a texture sample going to the next line
+				perf_rollback_dcache_miss = 1;
+		end
+		else if (dd_instruction_valid && dd_scgath_coalesce_en)
+		begin
+			// A scatter/gather subcycle serviced the lanes for the following
+			// subcycles too. Skip over them, or go to the next instruction if
+			// they were the last ones. Unlike other rollbacks, this instruction
+			// still writes back.
+			wb_rollback_en = 1;
+			wb_rollback_thread_idx = dd_thread_idx;
+			wb_rollback_pipeline = PIPE_MEM;
+			scgath_skip_en = 1;
+			if (dd_scgath_complete)
+			begin
+				wb_rollback_pc = dd_instruction.pc + 32'd4;
+				wb_rollback_subcycle = 0;
+			end
+			else
+			begin
+				wb_rollback_pc = dd_rollback_pc;
+				wb_rollback_subcycle = dd_scgath_resume_subcycle;
+			end
+		end
+	end
+
+	// Track which lanes of the current scatter/gather instruction have been
+	// serviced by a coalesced access, so later subcycles skip them. This is
+	// cleared when the instruction finishes. An eret can return to the middle
+	// of an instruction after the fault handler has run others, so clear it
+	// then too. The lanes after the return subcycle will be accessed again,
+	// which gives the same result.
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+				wb_scgath_done_mask[i] <= 0;
+		end
+		else if (dd_instruction_valid && is_last_subcycle_dd && (!wb_rollback_en || scgath_skip_en))
+			wb_scgath_done_mask[dd_thread_idx] <= 0;
+		else if (scgath_skip_en)
+		begin
+			wb_scgath_done_mask[dd_thread_idx] <= dd_scgath_lane_mask
+				| (dd_subcycle == 0 ? vector_lane_mask_t'(0) : wb_scgath_done_mask[dd_thread_idx]);
+		end
+		else if (ix_instruction_valid && ix_instruction.is_branch
+			&& ix_instruction.branch_type == BRANCH_ERET)
+			wb_scgath_done_mask[ix_thread_idx] <= 0;
+	end
+
+	// Track which texels of the current texture sample lane have been read
+	// from earlier cache lines and their values. They are only valid for the
+	// subcycle that read them. This is cleared when the lane finishes or the
+	// thread takes a fault or interrupt.
+	assign is_sample_dd = dd_instruction.is_memory_access
+		&& dd_instruction.memory_access_type == MEM_SAMPLE;
+
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+			begin
+				wb_sample_texels_read[i] <= '0;
+				wb_sample_subcycle[i] <= '0;
+			end
+		end
+		else if (wb_fault)
+			wb_sample_texels_read[wb_fault_thread_idx] <= '0;
+		else if (dd_instruction_valid && is_sample_dd)
+		begin
+			if (dd_rollback_en)
+			begin
+				wb_sample_texels_read[dd_thread_idx] <= dd_sample_texels_read
+					| (wb_sample_subcycle[dd_thread_idx] == dd_subcycle
+					? wb_sample_texels_read[dd_thread_idx] : sample_texel_mask_t'(0));
+				wb_sample_subcycle[dd_thread_idx] <= dd_subcycle;
+			end
+			else
+				wb_sample_texels_read[dd_thread_idx] <= '0;
+		end
+	end
+
+	always_ff @(posedge clk)
+	begin
+		if (dd_instruction_valid && is_sample_dd && dd_rollback_en)
+		begin
+			for (int i = 0; i < `SAMPLE_TEXELS; i++)
+			begin
+				if (dd_sample_texels_read[i])
+					sample_texels[dd_thread_idx][i] <= sample_texel_value[i];
+			end
 		end
 	end
 
@@ -351,6 +484,42 @@ module writeback_stage(
 		end
 	endgenerate
 
+	// Select the word from the cache line for each lane of a coalesced gather.
+	genvar gather_lane;
+	generate
+		for (gather_lane = 0; gather_lane < `VECTOR_LANES; gather_lane++)
+		begin : gather_lane_gen
+			assign scgath_load_value[gather_lane] = endian_twiddled_data[
+				dd_scgath_data_lane[gather_lane] * 32+:32];
+		end
+	endgenerate
+
+	// Bilinear filter for a texture sample. Texels this access read come from
+	// the cache line, the rest from earlier ones. Each 8 bit channel is the
+	// sum of the texels weighted by dd_sample_weight, rounded.
+	always_comb
+	begin
+		for (int i = 0; i < `SAMPLE_TEXELS; i++)
+		begin
+			if (dd_sample_texels_read[i])
+				sample_texel_value[i] = endian_twiddled_data[dd_sample_data_lane[i] * 32+:32];
+			else
+				sample_texel_value[i] = sample_texels[dd_thread_idx][i];
+		end
+
+		for (int channel = 0; channel < 4; channel++)
+		begin
+			sample_channel_sum = 24'd32768;
+			for (int i = 0; i < `SAMPLE_TEXELS; i++)
+			begin
+				sample_channel_sum += 24'(sample_texel_value[i][channel * 8+:8])
+					* 24'(dd_sample_weight[i]);
+			end
+
+			sample_value[channel * 8+:8] = sample_channel_sum[23:16];
+		end
+	end
+
 	// Compress vector comparisons to one bit per lane.
 	genvar mask_lane;
 	generate
@@ -365,7 +534,8 @@ module writeback_stage(
 		.one_hot(dd_vector_lane_oh),
 		.index(dd_subcycle));
 
- 	assign is_last_subcycle_dd = dd_subcycle == dd_instruction.last_subcycle;
+ 	assign is_last_subcycle_dd = dd_subcycle == dd_instruction.last_subcycle
+		|| (dd_scgath_coalesce_en && dd_scgath_complete);
 	assign is_last_subcycle_sx = ix_subcycle == ix_instruction.last_subcycle;
 	assign is_last_subcycle_mx = fx5_subcycle == fx5_instruction.last_subcycle;
 
@@ -475,7 +645,7 @@ module writeback_stage(
 				//
 				3'b001:
 				begin
-					wb_writeback_en <= dd_instruction.has_dest && !wb_rollback_en;
+					wb_writeback_en <= dd_instruction.has_dest && (!wb_rollback_en || scgath_skip_en);
 					wb_writeback_thread_idx <= dd_thread_idx;
 					wb_writeback_is_vector <= dd_instruction.dest_is_vector;
 					wb_writeback_reg <= dd_instruction.dest_reg;
@@ -527,12 +697,30 @@ module writeback_stage(
 									assert(dd_instruction.dest_is_vector);
 								end
 
+								MEM_SAMPLE:
+								begin
+									// Texture sample. Masked off lanes don't
+									// access memory and don't write back.
+									wb_writeback_value <= {`VECTOR_LANES{sample_value}};
+									wb_writeback_mask <= dd_vector_lane_oh & dd_lane_mask;
+									assert(dd_instruction.dest_is_vector);
+								end
+
 								default:
 								begin
 									// gather load
-									// Grab the appropriate lane.
-									wb_writeback_value <= {`VECTOR_LANES{swapped_word_value}};
-									wb_writeback_mask <= dd_vector_lane_oh & dd_lane_mask;
+									if (dd_scgath_coalesce_en)
+									begin
+										// Several lanes from the same cache line
+										wb_writeback_value <= scgath_load_value;
+										wb_writeback_mask <= dd_scgath_lane_mask;
+									end
+									else
+									begin
+										// Grab the appropriate lane.
+										wb_writeback_value <= {`VECTOR_LANES{swapped_word_value}};
+										wb_writeback_mask <= dd_vector_lane_oh & dd_lane_mask;
+									end
 								end
 							endcase
 						end
@@ -543,6 +731,12 @@ module writeback_stage(
 							assert(dd_instruction.has_dest && !dd_instruction.dest_is_vector);
 							wb_writeback_value[0] <= scalar_t'(sq_store_sync_success);
 						end
+						else if (dd_instruction.memory_access_type == MEM_ATOMIC)
+						begin
+							// Atomic operations write back the old value of the memory word
+							assert(dd_instruction.has_dest && !dd_instruction.dest_is_vector);
+							wb_writeback_value[0] <= sq_store_atomic_value;
+						end
 					end
 
 `ifdef SIMULATION
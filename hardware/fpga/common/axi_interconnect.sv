@@ -21,9 +21,15 @@
 // This routes AXI transactions between two masters and two slaves
 // mapped into different regions of a common address space.
 //
+// Up to MAX_OUTSTANDING_READS read bursts may be in progress at once. Read
+// addresses are forwarded in the order they are accepted, and a queue records
+// where each burst was sent, so read data is routed back in the same order.
+// If a master has data that isn't for the oldest burst, it waits.
+//
 
 module axi_interconnect
-	#(parameter M1_BASE_ADDRESS = 32'hffffeee0)
+	#(parameter M1_BASE_ADDRESS = 32'hffffeee0,
+	parameter MAX_OUTSTANDING_READS = 4)
 
 	(input                   clk,
 	input                    reset,
@@ -50,6 +56,12 @@ module axi_interconnect
 		STATE_ACTIVE_BURST
 	} burst_state_t;
 
+	typedef struct packed {
+		logic slave;
+		logic master;
+		logic[7:0] length;
+	} read_burst_t;
+
 	burst_state_t write_state;
 	logic[31:0] write_burst_address;
 	logic[7:0] write_burst_length;	// Like axi_awlen, this is number of transfers minus 1
@@ -62,6 +74,13 @@ module axi_interconnect
 	logic axi_arready_m;
 	logic axi_rready_m;
 	logic axi_rvalid_m;
+	read_burst_t read_queue_in;
+	read_burst_t active_read;
+	logic read_queue_full;
+	logic read_queue_empty;
+	logic read_address_accepted;
+	logic read_burst_done;
+	logic[7:0] read_beat_count;
 
 	//
 	// Write handling. Only slave interface 0 does writes.
@@ -155,9 +174,30 @@ module axi_interconnect
 	// Read handling.  Slave interface 1 has priority.
 	//
 	assign axi_arready_m = read_selected_master ? axi_bus_m1.s_arready : axi_bus_m0.s_arready;
-	assign axi_rready_m = read_selected_master ? axi_bus_m1.m_rready : axi_bus_m0.m_rready;
-	assign axi_rvalid_m = read_selected_master ? axi_bus_m1.s_rvalid : axi_bus_m0.s_rvalid;
+	assign axi_rready_m = active_read.master ? axi_bus_m1.m_rready : axi_bus_m0.m_rready;
+	assign axi_rvalid_m = active_read.master ? axi_bus_m1.s_rvalid : axi_bus_m0.s_rvalid;
+	assign read_address_accepted = read_state == STATE_ISSUE_ADDRESS && axi_arready_m;
+	assign read_burst_done = !read_queue_empty && axi_rready_m && axi_rvalid_m
+		&& read_beat_count == active_read.length;
+
+	assign read_queue_in.slave = read_selected_slave;
+	assign read_queue_in.master = read_selected_master;
+	assign read_queue_in.length = read_burst_length;
 
+	sync_fifo #(.WIDTH($bits(read_burst_t)), .SIZE(MAX_OUTSTANDING_READS)) read_queue(
+		.clk(clk),
+		.reset(reset),
+		.flush_en(1'b0),
+		.full(read_queue_full),
+		.almost_full(),
+		.enqueue_en(read_address_accepted),
+		.value_i(read_queue_in),
+		.empty(read_queue_empty),
+		.almost_empty(),
+		.dequeue_en(read_burst_done),
+		.value_o(active_read));
+
+	// Read address
 	always_ff @(posedge clk, posedge reset)
 	begin
 		if (reset)
@@ -172,70 +212,72 @@ module axi_interconnect
 			read_selected_slave <= '0;
 			// End of automatics
 		end
-		else if (read_state == STATE_ACTIVE_BURST)
-		begin
-			// Burst is active.  Check to see when it is finished.
-			if (axi_rready_m && axi_rvalid_m)
-			begin
-				read_burst_length <= read_burst_length - 8'd1;
-				if (read_burst_length == 0)
-					read_state <= STATE_ARBITRATE;
-			end
-		end
 		else if (read_state == STATE_ISSUE_ADDRESS)
 		begin
 			// Wait for the slave to accept the address and length
 			if (axi_arready_m)
-				read_state <= STATE_ACTIVE_BURST;
-		end
-		else if (axi_bus_s1.m_arvalid)
-		begin
-			// Start a read burst from slave 1
-			read_state <= STATE_ISSUE_ADDRESS;
-			read_burst_address <= axi_bus_s1.m_araddr;
-			read_burst_length <= axi_bus_s1.m_arlen;
-			read_selected_slave <= 1'b1;
-			read_selected_master <= axi_bus_s1.m_araddr >= M1_BASE_ADDRESS;
+				read_state <= STATE_ARBITRATE;
 		end
-		else if (axi_bus_s0.m_arvalid)
+		else if (!read_queue_full)
 		begin
-			// Start a read burst from slave 0
-			read_state <= STATE_ISSUE_ADDRESS;
-			read_burst_address <= axi_bus_s0.m_araddr;
-			read_burst_length <= axi_bus_s0.m_arlen;
-			read_selected_slave <= 1'b0;
-			read_selected_master <= axi_bus_s0.m_araddr[31:28] != 0;
+			if (axi_bus_s1.m_arvalid)
+			begin
+				// Start a read burst from slave 1
+				read_state <= STATE_ISSUE_ADDRESS;
+				read_burst_address <= axi_bus_s1.m_araddr;
+				read_burst_length <= axi_bus_s1.m_arlen;
+				read_selected_slave <= 1'b1;
+				read_selected_master <= axi_bus_s1.m_araddr >= M1_BASE_ADDRESS;
+			end
+			else if (axi_bus_s0.m_arvalid)
+			begin
+				// Start a read burst from slave 0
+				read_state <= STATE_ISSUE_ADDRESS;
+				read_burst_address <= axi_bus_s0.m_araddr;
+				read_burst_length <= axi_bus_s0.m_arlen;
+				read_selected_slave <= 1'b0;
+				read_selected_master <= axi_bus_s0.m_araddr[31:28] != 0;
+			end
 		end
 	end
 
+	// Read data. Count beats in the oldest burst.
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+			read_beat_count <= '0;
+		else if (read_burst_done)
+			read_beat_count <= '0;
+		else if (!read_queue_empty && axi_rready_m && axi_rvalid_m)
+			read_beat_count <= read_beat_count + 8'd1;
+	end
+
 	always_comb
 	begin
-		if (read_state == STATE_ARBITRATE)
+		axi_bus_s0.s_arready = axi_arready_m && read_state == STATE_ISSUE_ADDRESS
+			&& read_selected_slave == 0;
+		axi_bus_s1.s_arready = axi_arready_m && read_state == STATE_ISSUE_ADDRESS
+			&& read_selected_slave == 1;
+		if (read_queue_empty)
 		begin
 			axi_bus_s0.s_rvalid = 0;
 			axi_bus_s1.s_rvalid = 0;
 			axi_bus_m0.m_rready = 0;
 			axi_bus_m1.m_rready = 0;
-			axi_bus_s0.s_arready = 0;
-			axi_bus_s1.s_arready = 0;
 		end
-		else if (read_selected_slave == 0)
+		else if (active_read.slave == 0)
 		begin
 			axi_bus_s0.s_rvalid = axi_rvalid_m;
 			axi_bus_s1.s_rvalid = 0;
-			axi_bus_m0.m_rready = axi_bus_s0.m_rready && read_selected_master == 0;
-			axi_bus_m1.m_rready = axi_bus_s0.m_rready && read_selected_master == 1;
-			axi_bus_s0.s_arready = axi_arready_m && read_state == STATE_ISSUE_ADDRESS;
-			axi_bus_s1.s_arready = 0;
+			axi_bus_m0.m_rready = axi_bus_s0.m_rready && active_read.master == 0;
+			axi_bus_m1.m_rready = axi_bus_s0.m_rready && active_read.master == 1;
 		end
 		else
 		begin
 			axi_bus_s0.s_rvalid = 0;
 			axi_bus_s1.s_rvalid = axi_rvalid_m;
-			axi_bus_m0.m_rready = axi_bus_s1.m_rready && read_selected_master == 0;
-			axi_bus_m1.m_rready = axi_bus_s1.m_rready && read_selected_master == 1;
-			axi_bus_s0.s_arready = 0;
-			axi_bus_s1.s_arready = axi_arready_m && read_state == STATE_ISSUE_ADDRESS;
+			axi_bus_m0.m_rready = axi_bus_s1.m_rready && active_read.master == 0;
+			axi_bus_m1.m_rready = axi_bus_s1.m_rready && active_read.master == 1;
 		end
 	end
 
@@ -243,14 +285,10 @@ module axi_interconnect
 	assign axi_bus_m1.m_arvalid = read_state == STATE_ISSUE_ADDRESS && read_selected_master == 1;
 	assign axi_bus_m0.m_araddr = read_burst_address;
 	assign axi_bus_m1.m_araddr = read_burst_address - M1_BASE_ADDRESS;
-	assign axi_bus_s0.s_rdata = read_selected_master ? axi_bus_m1.s_rdata : axi_bus_m0.s_rdata;
+	assign axi_bus_s0.s_rdata = active_read.master ? axi_bus_m1.s_rdata : axi_bus_m0.s_rdata;
 	assign axi_bus_s1.s_rdata = axi_bus_s0.s_rdata;
 	assign axi_bus_m0.m_arburst = read_selected_master ? axi_bus_s1.m_arburst : axi_bus_s0.m_arburst;
 	assign axi_bus_m0.m_arsize = read_selected_master ? axi_bus_s1.m_arsize : axi_bus_s0.m_arsize;
-
-	// We end up reusing read_burst_length to track how many beats are left
-	// later.  At this point, the value of ARLEN should be ignored by slave
-	// we are driving, so it won't break anything.
 	assign axi_bus_m0.m_arlen = read_burst_length;
 	assign axi_bus_m1.m_arlen = read_burst_length;
 endmodule
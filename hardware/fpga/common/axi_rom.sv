@@ -19,7 +19,9 @@
 `include "defines.sv"
 
 //
-// Read only memory that uses AMBA AXI bus interface
+// Read only memory that uses AMBA AXI bus interface. The ROM is organized
+// as 32-bit words. When the bus is wider, each beat contains consecutive
+// words, with the lowest address in the most significant bits.
 //
 
 module axi_rom
@@ -32,6 +34,7 @@ module axi_rom
 	axi4_interface.slave        axi_bus);
 
 	localparam MAX_SIZE = 'h2000;
+	localparam BEAT_WORDS = `AXI_DATA_WIDTH / 32;
 
 	logic[29:0] burst_address;
 	logic[7:0] burst_count;
@@ -68,10 +71,15 @@ module axi_rom
 			else
 			begin
 				axi_bus.s_rvalid <= 1;
-				axi_bus.s_rdata <= rom_data[burst_address[$clog2(MAX_SIZE) - 1:0]];
+				for (int i = 0; i < BEAT_WORDS; i++)
+				begin
+					axi_bus.s_rdata[(BEAT_WORDS - 1 - i) * 32+:32] <= rom_data[
+						burst_address[$clog2(MAX_SIZE) - 1:0] + $clog2(MAX_SIZE)'(i)];
+				end
+
 				if (axi_bus.m_rready)
 				begin
-					burst_address <= burst_address + 1;
+					burst_address <= burst_address + 30'(BEAT_WORDS);
 					burst_count <= burst_count - 1;
 				end
 			end
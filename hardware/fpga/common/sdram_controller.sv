@@ -23,6 +23,9 @@
 // reads and writes.
 // For performance, this lazily keeps rows open after accesses, tracking them
 // independently for each bank and closing them only when necessary.
+// The AXI bus may be wider than the SDRAM data bus (DATA_WIDTH), as long as
+// an AXI beat is no larger than an SDRAM burst. Each beat is transferred as
+// several SDRAM words, with the lowest address in the most significant bits.
 //
 
 module sdram_controller
@@ -63,6 +66,10 @@ module sdram_controller
 
 	localparam SDRAM_BURST_LENGTH = 8;
 	localparam SDRAM_BURST_IDX_WIDTH = $clog2(SDRAM_BURST_LENGTH);
+	localparam AXI_BEAT_WORDS = `AXI_DATA_WIDTH / DATA_WIDTH;
+	localparam BEAT_WORD_IDX_WIDTH = AXI_BEAT_WORDS == 1 ? 1 : $clog2(AXI_BEAT_WORDS);
+	localparam BURST_BEATS = SDRAM_BURST_LENGTH / AXI_BEAT_WORDS;
+	localparam LENGTH_WIDTH = 8 + $clog2(AXI_BEAT_WORDS);
 	localparam NUM_BANKS = 4;
 	localparam MEMORY_SIZE = (1 << (ROW_ADDR_WIDTH + COL_ADDR_WIDTH)) * NUM_BANKS
 		* (DATA_WIDTH / 8);
@@ -95,7 +102,8 @@ module sdram_controller
 		CMD_NOP               = 4'b1000
 	} sdram_cmd_t;
 
-	// latched addresses and lengths are in terms of DATA_WIDTH beats, not bytes.
+	// latched addresses and lengths are in terms of DATA_WIDTH words, not bytes
+	// or AXI beats.
 	logic[11:0] refresh_timer_ff;
 	logic[11:0] refresh_timer_nxt;
 	logic[14:0] timer_ff;
@@ -110,10 +118,10 @@ module sdram_controller
 	logic output_enable;
 	logic[DATA_WIDTH - 1:0] write_data;
 	logic[INTERNAL_ADDR_WIDTH - 1:0] write_address;
-	logic[7:0] write_length; // Like axi_bus.m_awlen, is num transfers - 1
+	logic[LENGTH_WIDTH - 1:0] write_length; // Like axi_bus.m_awlen, is num transfers - 1
 	logic write_pending;
 	logic[INTERNAL_ADDR_WIDTH - 1:0] read_address;
-	logic[7:0] read_length;	// Like axi_bus.m_arlen, is num_transfers - 1
+	logic[LENGTH_WIDTH - 1:0] read_length;	// Like axi_bus.m_arlen, is num_transfers - 1
 	logic read_pending;
 	logic lfifo_empty;
 	logic sfifo_full;
@@ -124,6 +132,11 @@ module sdram_controller
 	logic[COL_ADDR_WIDTH - 1:0] read_column;
 	logic[ROW_ADDR_WIDTH - 1:0] read_row;
 	logic lfifo_enqueue;
+	logic lfifo_enqueue_beat;
+	logic[`AXI_DATA_WIDTH - 1:0] lfifo_in;
+	logic[`AXI_DATA_WIDTH - 1:0] sfifo_out;
+	logic sfifo_dequeue;
+	logic[BEAT_WORD_IDX_WIDTH - 1:0] beat_word_idx;
 	logic access_is_read_ff;
 	logic access_is_read_nxt;
 
@@ -134,9 +147,10 @@ module sdram_controller
 	assign axi_bus.s_bvalid = 1;	// Hack: pretend we always have a write result
 
 	// Each fifo can hold an entire SDRAM burst to avoid delays due
-	// to the external bus.
+	// to the external bus. Entries are AXI beats. The store FIFO only accepts
+	// one SDRAM burst at a time, and sfifo_full indicates that it has one.
 
-	sync_fifo #(.WIDTH(DATA_WIDTH), .SIZE(SDRAM_BURST_LENGTH)) load_fifo(
+	sync_fifo #(.WIDTH(`AXI_DATA_WIDTH), .SIZE(SDRAM_BURST_LENGTH)) load_fifo(
 		.clk(clk),
 		.reset(reset),
 		.flush_en(1'b0),
@@ -144,24 +158,59 @@ module sdram_controller
 		.almost_empty(),
 		.almost_full(),
 		.empty(lfifo_empty),
-		.value_i(dram_dq),
-		.enqueue_en(lfifo_enqueue),
+		.value_i(lfifo_in),
+		.enqueue_en(lfifo_enqueue_beat),
 		.dequeue_en(axi_bus.m_rready && axi_bus.s_rvalid),
 		.value_o(axi_bus.s_rdata));
 
-	sync_fifo #(.WIDTH(DATA_WIDTH), .SIZE(SDRAM_BURST_LENGTH)) store_fifo(
+	sync_fifo #(.WIDTH(`AXI_DATA_WIDTH), .SIZE(SDRAM_BURST_LENGTH),
+		.ALMOST_FULL_THRESHOLD(BURST_BEATS)) store_fifo(
 		.clk(clk),
 		.reset(reset),
 		.flush_en(1'b0),
-		.full(sfifo_full),
+		.full(),
 		.almost_empty(),
-		.almost_full(),
-		.value_o(write_data),
-		.dequeue_en(output_enable),
+		.almost_full(sfifo_full),
+		.value_o(sfifo_out),
+		.dequeue_en(sfifo_dequeue),
 		.value_i(axi_bus.m_wdata),
 		.enqueue_en(axi_bus.s_wready && axi_bus.m_wvalid),
 		.empty());
 
+	// Convert between AXI beats and SDRAM words. Within a burst, the low bits
+	// of burst_offset_ff are the index of the word in the current beat.
+	generate
+		if (AXI_BEAT_WORDS == 1)
+		begin
+			assign beat_word_idx = 0;
+			assign lfifo_in = dram_dq;
+			assign lfifo_enqueue_beat = lfifo_enqueue;
+			assign write_data = sfifo_out;
+			assign sfifo_dequeue = output_enable;
+		end
+		else
+		begin
+			logic[`AXI_DATA_WIDTH - DATA_WIDTH - 1:0] read_words;
+
+			assign beat_word_idx = burst_offset_ff[BEAT_WORD_IDX_WIDTH - 1:0];
+			assign lfifo_in = {read_words, dram_dq};
+			assign lfifo_enqueue_beat = lfifo_enqueue
+				&& beat_word_idx == BEAT_WORD_IDX_WIDTH'(AXI_BEAT_WORDS - 1);
+			assign write_data = sfifo_out[(AXI_BEAT_WORDS - 1 - int'(beat_word_idx)) * DATA_WIDTH+:DATA_WIDTH];
+			assign sfifo_dequeue = output_enable
+				&& beat_word_idx == BEAT_WORD_IDX_WIDTH'(AXI_BEAT_WORDS - 1);
+
+			// Collect the earlier words of the beat being read
+			always_ff @(posedge clk, posedge reset)
+			begin
+				if (reset)
+					read_words <= '0;
+				else if (lfifo_enqueue)
+					read_words <= lfifo_in[`AXI_DATA_WIDTH - DATA_WIDTH - 1:0];
+			end
+		end
+	endgenerate
+
 	assign {dram_cs_n, dram_ras_n, dram_cas_n, dram_we_n} = command;
 	assign dram_cke = 1;
 	assign dram_clk = clk;
@@ -462,7 +511,7 @@ module sdram_controller
 			else if (axi_bus.m_awvalid && !write_pending)
 			begin
 				// Ensure the the burst is aligned on an SDRAM burst boundary.
-				assert(((axi_bus.m_awlen + 1) & (SDRAM_BURST_LENGTH - 1)) == 0);
+				assert((((axi_bus.m_awlen + 1) * AXI_BEAT_WORDS) & (SDRAM_BURST_LENGTH - 1)) == 0);
 				assert((axi_bus.m_awaddr & (SDRAM_BURST_LENGTH - 1)) == 0);
 
 				// Make sure memory address is in memory range
@@ -474,7 +523,7 @@ module sdram_controller
 
 				// axi_bus.m_awaddr is in terms of bytes.  Convert to beats.
 				write_address <= INTERNAL_ADDR_WIDTH'(axi_bus.m_awaddr[31:$clog2(DATA_WIDTH / 8)]);
-				write_length <= axi_bus.m_awlen;
+				write_length <= (LENGTH_WIDTH'(axi_bus.m_awlen) + 1'b1) * LENGTH_WIDTH'(AXI_BEAT_WORDS) - 1'b1;
 				write_pending <= 1'b1;
 			end
 
@@ -489,7 +538,7 @@ module sdram_controller
 			else if (axi_bus.m_arvalid && !read_pending)
 			begin
 				// Ensure the the burst is aligned on an SDRAM burst boundary.
-				assert(((axi_bus.m_arlen + 1) & (SDRAM_BURST_LENGTH - 1)) == 0);
+				assert((((axi_bus.m_arlen + 1) * AXI_BEAT_WORDS) & (SDRAM_BURST_LENGTH - 1)) == 0);
 				assert((axi_bus.m_araddr & (SDRAM_BURST_LENGTH - 1)) == 0);
 
 `ifdef SIMULATION
@@ -503,7 +552,7 @@ module sdram_controller
 
 				// axi_bus.m_araddr is in terms of bytes.  Convert to beats.
 				read_address <= INTERNAL_ADDR_WIDTH'(axi_bus.m_araddr[31:$clog2(DATA_WIDTH / 8)]);
-				read_length <= axi_bus.m_arlen;
+				read_length <= (LENGTH_WIDTH'(axi_bus.m_arlen) + 1'b1) * LENGTH_WIDTH'(AXI_BEAT_WORDS) - 1'b1;
 				read_pending <= 1'b1;
 			end
 		end
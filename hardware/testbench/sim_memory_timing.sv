@@ -0,0 +1,381 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+`include "defines.sv"
+
+//
+// Sits between the AXI interconnect and the memory controller and adds
+// configurable delays to model slower or faster memory systems. This is
+// controlled by plusargs:
+//
+// +memlatency=<cycles>         Extra cycles before forwarding each read request.
+// +membeatcycles=<cycles>      Minimum cycles between data beats (limits bandwidth).
+// +membankpenalty=<cycles>     Extra cycles when a request goes to a bank that
+//                              has a different row open.
+// +memrefreshinterval=<cycles> How often to hold off new requests for refresh.
+// +memrefreshcycles=<cycles>   How long each refresh stall lasts.
+// +memstats                    Print statistics at the end of simulation.
+//
+// Delays only hold off a VALID signal that hasn't been forwarded yet. AXI
+// doesn't allow VALID to be deasserted before the handshake, so once it is
+// forwarded, it stays asserted until the receiver accepts it. Refresh only
+// holds off new read and write requests. Bursts that have already started
+// continue.
+//
+// When none of the timing parameters are set, all signals pass straight
+// through and this doesn't change timing.
+//
+
+module sim_memory_timing(
+	input                       clk,
+	input                       reset,
+	axi4_interface.slave        axi_bus_in,
+	axi4_interface.master       axi_bus_out);
+
+	localparam NUM_BANKS = 8;
+	localparam BANK_SHIFT = 11;	// 2KB rows
+	localparam ROW_SHIFT = BANK_SHIFT + $clog2(NUM_BANKS);
+	localparam ROW_WIDTH = 32 - ROW_SHIFT;
+	localparam MAX_PENDING_READS = 8;
+	localparam BEAT_BYTES = `AXI_DATA_WIDTH / 8;
+
+	int read_latency;
+	int beat_cycles;
+	int bank_penalty;
+	int refresh_interval;
+	int refresh_cycles;
+	bit timing_en;
+	bit stats_en;
+
+	logic[ROW_WIDTH - 1:0] open_row[NUM_BANKS];
+	logic[NUM_BANKS - 1:0] row_open;
+	int refresh_count;
+	int refresh_stall_count;
+	logic refresh_stall;
+	bit ar_started;
+	int ar_delay;
+	bit aw_started;
+	int aw_delay;
+	int r_delay;
+	int w_delay;
+	logic ar_go;
+	logic aw_go;
+	logic r_go;
+	logic w_go;
+	logic ar_forwarded;
+	logic aw_forwarded;
+	logic r_forwarded;
+	logic w_forwarded;
+	logic ar_handshake;
+	logic aw_handshake;
+	logic r_handshake;
+	logic w_handshake;
+
+	// Statistics
+	longint cycle_count;
+	longint ar_wait_start;
+	bit ar_waiting;
+	longint pending_start[MAX_PENDING_READS];
+	int pending_beats[MAX_PENDING_READS];
+	int pending_head;
+	int pending_tail;
+	int pending_count;
+	int current_beat;
+	longint read_bursts;
+	longint read_beats;
+	longint write_bursts;
+	longint write_beats;
+	longint total_read_latency;
+	longint max_read_latency;
+	longint bank_conflicts;
+	longint refresh_stall_cycles;
+
+	initial
+	begin
+		if ($value$plusargs("memlatency=%d", read_latency) == 0)
+			read_latency = 0;
+
+		if ($value$plusargs("membeatcycles=%d", beat_cycles) == 0)
+			beat_cycles = 1;
+
+		if ($value$plusargs("membankpenalty=%d", bank_penalty) == 0)
+			bank_penalty = 0;
+
+		if ($value$plusargs("memrefreshinterval=%d", refresh_interval) == 0)
+			refresh_interval = 0;
+
+		if ($value$plusargs("memrefreshcycles=%d", refresh_cycles) == 0)
+			refresh_cycles = 0;
+
+		timing_en = read_latency != 0 || beat_cycles > 1 || bank_penalty != 0
+			|| (refresh_interval != 0 && refresh_cycles != 0);
+		stats_en = timing_en || $test$plusargs("memstats") != 0;
+		if (timing_en)
+		begin
+			$display("memory timing: latency %0d beat cycles %0d bank penalty %0d refresh %0d/%0d",
+				read_latency, beat_cycles, bank_penalty, refresh_cycles, refresh_interval);
+		end
+	end
+
+	function int conflict_penalty(input logic[31:0] address);
+		if (row_open[address[BANK_SHIFT+:$clog2(NUM_BANKS)]]
+			&& open_row[address[BANK_SHIFT+:$clog2(NUM_BANKS)]] != address[31:ROW_SHIFT])
+			return bank_penalty;
+		else
+			return 0;
+	endfunction
+
+	//
+	// Gate the handshake signals on each channel. Everything else passes
+	// through unmodified. The *_forwarded flags mean VALID was asserted on the
+	// outgoing side in the last cycle without a handshake, so it must stay
+	// asserted.
+	//
+	assign refresh_stall = refresh_stall_count != 0;
+	assign ar_go = !timing_en || ar_forwarded
+		|| (ar_started && ar_delay == 0 && !refresh_stall);
+	assign aw_go = !timing_en || aw_forwarded
+		|| (aw_started && aw_delay == 0 && !refresh_stall);
+	assign r_go = !timing_en || r_forwarded || r_delay == 0;
+	assign w_go = !timing_en || w_forwarded || w_delay == 0;
+
+	assign axi_bus_out.m_araddr = axi_bus_in.m_araddr;
+	assign axi_bus_out.m_arlen = axi_bus_in.m_arlen;
+	assign axi_bus_out.m_arsize = axi_bus_in.m_arsize;
+	assign axi_bus_out.m_arburst = axi_bus_in.m_arburst;
+	assign axi_bus_out.m_arcache = axi_bus_in.m_arcache;
+	assign axi_bus_out.m_arvalid = axi_bus_in.m_arvalid && ar_go;
+	assign axi_bus_in.s_arready = axi_bus_out.s_arready && ar_go;
+
+	assign axi_bus_in.s_rdata = axi_bus_out.s_rdata;
+	assign axi_bus_in.s_rvalid = axi_bus_out.s_rvalid && r_go;
+	assign axi_bus_out.m_rready = axi_bus_in.m_rready && r_go;
+
+	assign axi_bus_out.m_awaddr = axi_bus_in.m_awaddr;
+	assign axi_bus_out.m_awlen = axi_bus_in.m_awlen;
+	assign axi_bus_out.m_awsize = axi_bus_in.m_awsize;
+	assign axi_bus_out.m_awburst = axi_bus_in.m_awburst;
+	assign axi_bus_out.m_awcache = axi_bus_in.m_awcache;
+	assign axi_bus_out.m_awvalid = axi_bus_in.m_awvalid && aw_go;
+	assign axi_bus_in.s_awready = axi_bus_out.s_awready && aw_go;
+
+	assign axi_bus_out.m_wdata = axi_bus_in.m_wdata;
+	assign axi_bus_out.m_wstrb = axi_bus_in.m_wstrb;
+	assign axi_bus_out.m_wlast = axi_bus_in.m_wlast;
+	assign axi_bus_out.m_wvalid = axi_bus_in.m_wvalid && w_go;
+	assign axi_bus_in.s_wready = axi_bus_out.s_wready && w_go;
+
+	assign axi_bus_in.s_bvalid = axi_bus_out.s_bvalid;
+	assign axi_bus_out.m_bready = axi_bus_in.m_bready;
+
+	assign ar_handshake = axi_bus_in.m_arvalid && axi_bus_in.s_arready;
+	assign aw_handshake = axi_bus_in.m_awvalid && axi_bus_in.s_awready;
+	assign r_handshake = axi_bus_in.s_rvalid && axi_bus_in.m_rready;
+	assign w_handshake = axi_bus_in.m_wvalid && axi_bus_in.s_wready;
+
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			row_open <= '0;
+			refresh_count <= 0;
+			refresh_stall_count <= 0;
+			ar_started <= 0;
+			ar_delay <= 0;
+			aw_started <= 0;
+			aw_delay <= 0;
+			r_delay <= 0;
+			w_delay <= 0;
+			ar_forwarded <= 0;
+			aw_forwarded <= 0;
+			r_forwarded <= 0;
+			w_forwarded <= 0;
+		end
+		else
+		begin
+			// VALID must stay asserted until the handshake
+			assert(!ar_forwarded || axi_bus_out.m_arvalid);
+			assert(!aw_forwarded || axi_bus_out.m_awvalid);
+			assert(!r_forwarded || axi_bus_in.s_rvalid);
+			assert(!w_forwarded || axi_bus_out.m_wvalid);
+
+			ar_forwarded <= axi_bus_out.m_arvalid && !axi_bus_out.s_arready;
+			aw_forwarded <= axi_bus_out.m_awvalid && !axi_bus_out.s_awready;
+			r_forwarded <= axi_bus_in.s_rvalid && !axi_bus_in.m_rready;
+			w_forwarded <= axi_bus_out.m_wvalid && !axi_bus_out.s_wready;
+
+			// Refresh
+			if (refresh_stall_count != 0)
+				refresh_stall_count <= refresh_stall_count - 1;
+			else if (refresh_interval != 0 && refresh_cycles != 0)
+			begin
+				if (refresh_count >= refresh_interval)
+				begin
+					refresh_count <= 0;
+					refresh_stall_count <= refresh_cycles;
+				end
+				else
+					refresh_count <= refresh_count + 1;
+			end
+
+			// Read address. The delay starts when the request is first seen.
+			// This opens the row, which determines if later accesses conflict.
+			if (ar_handshake)
+				ar_started <= 0;
+			else if (!ar_started && axi_bus_in.m_arvalid)
+			begin
+				ar_started <= 1;
+				ar_delay <= read_latency + conflict_penalty(axi_bus_in.m_araddr);
+				row_open[axi_bus_in.m_araddr[BANK_SHIFT+:$clog2(NUM_BANKS)]] <= 1;
+				open_row[axi_bus_in.m_araddr[BANK_SHIFT+:$clog2(NUM_BANKS)]]
+					<= axi_bus_in.m_araddr[31:ROW_SHIFT];
+			end
+			else if (ar_delay != 0)
+				ar_delay <= ar_delay - 1;
+
+			// Write address
+			if (aw_handshake)
+				aw_started <= 0;
+			else if (!aw_started && axi_bus_in.m_awvalid)
+			begin
+				aw_started <= 1;
+				aw_delay <= conflict_penalty(axi_bus_in.m_awaddr);
+				row_open[axi_bus_in.m_awaddr[BANK_SHIFT+:$clog2(NUM_BANKS)]] <= 1;
+				open_row[axi_bus_in.m_awaddr[BANK_SHIFT+:$clog2(NUM_BANKS)]]
+					<= axi_bus_in.m_awaddr[31:ROW_SHIFT];
+			end
+			else if (aw_delay != 0)
+				aw_delay <= aw_delay - 1;
+
+			// Data beats
+			if (r_handshake)
+				r_delay <= beat_cycles - 1;
+			else if (r_delay != 0)
+				r_delay <= r_delay - 1;
+
+			if (w_handshake)
+				w_delay <= beat_cycles - 1;
+			else if (w_delay != 0)
+				w_delay <= w_delay - 1;
+		end
+	end
+
+	//
+	// Statistics
+	//
+	always_ff @(posedge clk, posedge reset)
+	begin
+		if (reset)
+		begin
+			cycle_count <= 0;
+			ar_waiting <= 0;
+			pending_head <= 0;
+			pending_tail <= 0;
+			pending_count <= 0;
+			current_beat <= 0;
+			read_bursts <= 0;
+			read_beats <= 0;
+			write_bursts <= 0;
+			write_beats <= 0;
+			total_read_latency <= 0;
+			max_read_latency <= 0;
+			bank_conflicts <= 0;
+			refresh_stall_cycles <= 0;
+		end
+		else
+		begin
+			cycle_count <= cycle_count + 1;
+			if (refresh_stall)
+				refresh_stall_cycles <= refresh_stall_cycles + 1;
+
+			if ((!ar_started && axi_bus_in.m_arvalid && conflict_penalty(axi_bus_in.m_araddr) != 0)
+				|| (!aw_started && axi_bus_in.m_awvalid && conflict_penalty(axi_bus_in.m_awaddr) != 0))
+				bank_conflicts <= bank_conflicts + 1;
+
+			// Latency is measured from when the request is first asserted until
+			// the last beat of data is returned.
+			if (axi_bus_in.m_arvalid && !ar_waiting)
+			begin
+				ar_waiting <= !ar_handshake;
+				ar_wait_start <= cycle_count;
+			end
+			else if (ar_handshake)
+				ar_waiting <= 0;
+
+			if (ar_handshake)
+			begin
+				assert(pending_count < MAX_PENDING_READS);
+				pending_start[pending_tail] <= ar_waiting ? ar_wait_start : cycle_count;
+				pending_beats[pending_tail] <= int'(axi_bus_in.m_arlen) + 1;
+				pending_tail <= (pending_tail + 1) % MAX_PENDING_READS;
+				read_bursts <= read_bursts + 1;
+			end
+
+			if (r_handshake)
+			begin
+				read_beats <= read_beats + 1;
+				if (current_beat == pending_beats[pending_head] - 1)
+				begin
+					total_read_latency <= total_read_latency + cycle_count
+						- pending_start[pending_head] + 1;
+					if (cycle_count - pending_start[pending_head] + 1 > max_read_latency)
+						max_read_latency <= cycle_count - pending_start[pending_head] + 1;
+
+					pending_head <= (pending_head + 1) % MAX_PENDING_READS;
+					current_beat <= 0;
+				end
+				else
+					current_beat <= current_beat + 1;
+			end
+
+			if (ar_handshake && !(r_handshake && current_beat == pending_beats[pending_head] - 1))
+				pending_count <= pending_count + 1;
+			else if (!ar_handshake && r_handshake && current_beat == pending_beats[pending_head] - 1)
+				pending_count <= pending_count - 1;
+
+			if (aw_handshake)
+				write_bursts <= write_bursts + 1;
+
+			if (w_handshake)
+				write_beats <= write_beats + 1;
+		end
+	end
+
+	final
+	begin
+		longint total_bytes;
+
+		if (stats_en && cycle_count != 0)
+		begin
+			total_bytes = (read_beats + write_beats) * BEAT_BYTES;
+			$display("memory: %0d read bursts (%0d bytes), %0d write bursts (%0d bytes)",
+				read_bursts, read_beats * BEAT_BYTES, write_bursts, write_beats * BEAT_BYTES);
+			if (read_bursts != 0)
+			begin
+				$display("memory: average read latency %0d.%02d cycles, max %0d cycles",
+					total_read_latency / read_bursts,
+					(total_read_latency * 100 / read_bursts) % 100,
+					max_read_latency);
+			end
+
+			$display("memory: achieved bandwidth %0d.%02d bytes/cycle over %0d cycles",
+				total_bytes / cycle_count, (total_bytes * 100 / cycle_count) % 100,
+				cycle_count);
+			$display("memory: %0d bank conflicts, %0d refresh stall cycles", bank_conflicts,
+				refresh_stall_cycles);
+		end
+	end
+endmodule
@@ -237,6 +237,13 @@ module trace_logger(
 				&& !sq_store_sync_success)
 				trace_reorder_queue[4].event_type <= EVENT_INVALID;
 
+			// An atomic operation is checked by the old value it writes back.
+			// The store data is only the operand, so don't log it.
+			if (dd_instruction_valid
+				&& dd_instruction_memory_access_type == MEM_ATOMIC
+				&& !dd_instruction_is_load)
+				trace_reorder_queue[4].event_type <= EVENT_INVALID;
+
 			// Signal interrupt to emulator. These are piggybacked on instructions
 			// and flow down the integer pipeline.
 			if (wb_interrupt_ack != 0)
@@ -15,10 +15,21 @@
 //
 
 #include <iostream>
+#include <stdlib.h>
+#include <string.h>
 #include "Vverilator_tb.h"
 #include "verilated.h"
+#include "verilated_save.h"
 #if VM_TRACE
+#if TRACE_FST
+#include <verilated_fst_c.h>
+#define TRACE_CLASS VerilatedFstC
+#define TRACE_FILE "trace.fst"
+#else
 #include <verilated_vcd_c.h>
+#define TRACE_CLASS VerilatedVcdC
+#define TRACE_FILE "trace.vcd"
+#endif
 #endif
 using namespace std;
 
@@ -33,10 +44,72 @@ double sc_time_stamp()
 	return currentTime;
 }
 
+//
+// Checkpoints use Verilator's serialization support (the model must be built
+// with --savable). This captures all state in the model, including the
+// contents of sim_sdram and testbench variables like the cycle count.
+// It does not capture state outside the model, like open files. The
+// testbench opens its output files and reads its plusargs in initial blocks,
+// which don't run again after a restore. A restored model would write to
+// file handles from the process that saved it, so options that open files
+// are rejected when checkpointing or restoring. The other testbench plusargs
+// keep the values from the saving run.
+//
+static const char * const kCheckpointUnsafeArgs[] = {
+	"statetrace",
+	"profile",
+	"perfseries"
+};
+
+static bool checkCheckpointArgs()
+{
+	for (size_t i = 0; i < sizeof(kCheckpointUnsafeArgs) / sizeof(kCheckpointUnsafeArgs[0]); i++)
+	{
+		if (Verilated::commandArgsPlusMatch(kCheckpointUnsafeArgs[i])[0] != '\0')
+		{
+			VL_PRINTF("+%s can't be used with +checkpoint or +restore\n",
+				kCheckpointUnsafeArgs[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void saveCheckpoint(Vverilator_tb *testbench, const char *filename)
+{
+	VL_PRINTF("Saving checkpoint at cycle %llu to %s\n",
+		static_cast<unsigned long long>(currentTime / 2), filename);
+	VerilatedSave os;
+	os.open(filename);
+	os << currentTime;
+	os << *testbench;
+	os.close();
+}
+
+static void restoreCheckpoint(Vverilator_tb *testbench, const char *filename)
+{
+	VerilatedRestore os;
+	os.open(filename);
+	os >> currentTime;
+	os >> *testbench;
+	os.close();
+	VL_PRINTF("Restored checkpoint from %s at cycle %llu\n", filename,
+		static_cast<unsigned long long>(currentTime / 2));
+}
+
 int main(int argc, char **argv, char **env)
 {
 	unsigned int randomSeed;
 	unsigned int randomizeRegs;
+	const char *arg;
+	vluint64_t checkpointCycle = 0;
+	char checkpointFile[256];
+	bool checkpointEn = false;
+#if VM_TRACE
+	unsigned int dumpStartCycle = 0;
+	unsigned int dumpEndCycle = 0xffffffff;
+#endif
 
 	Verilated::commandArgs(argc, argv);
 	Verilated::debug(0);
@@ -62,20 +135,63 @@ int main(int argc, char **argv, char **env)
 	else
 		Verilated::randReset(0);
 
+#if VM_TRACE
+	// Limit waveform output to a window of cycles. The testbench also reads
+	// these to limit +statetrace output.
+	VL_VALUEPLUSARGS_II(32, "dumpstart=", 'd', dumpStartCycle);
+	VL_VALUEPLUSARGS_II(32, "dumpend=", 'd', dumpEndCycle);
+#endif
+
+	// +checkpoint=<cycle>,<filename>
+	arg = Verilated::commandArgsPlusMatch("checkpoint=");
+	if (arg[0] != '\0')
+	{
+		const char *separator = strchr(arg, ',');
+		if (separator == NULL)
+		{
+			VL_PRINTF("bad format for +checkpoint, expected <cycle>,<filename>\n");
+			return 1;
+		}
+
+		checkpointCycle = strtoull(arg + strlen("+checkpoint="), NULL, 10);
+		strncpy(checkpointFile, separator + 1, sizeof(checkpointFile) - 1);
+		checkpointFile[sizeof(checkpointFile) - 1] = '\0';
+		checkpointEn = true;
+	}
+
+	if ((checkpointEn || Verilated::commandArgsPlusMatch("restore=")[0] != '\0')
+		&& !checkCheckpointArgs())
+	{
+		return 1;
+	}
+
 	Vverilator_tb* testbench = new Vverilator_tb;
 	testbench->reset = 1;
 	testbench->clk = 0;
 
-#if VM_TRACE			// If verilator was invoked with --trace
+	// This must happen before the first call to eval, otherwise initial
+	// blocks would reload memory and reset testbench state.
+	arg = Verilated::commandArgsPlusMatch("restore=");
+	if (arg[0] != '\0')
+		restoreCheckpoint(testbench, arg + strlen("+restore="));
+
+#if VM_TRACE			// If verilator was invoked with --trace or --trace-fst
 	Verilated::traceEverOn(true);
-	VL_PRINTF("Writing waveform to trace.vcd\n");
-	VerilatedVcdC* tfp = new VerilatedVcdC;
+	VL_PRINTF("Writing waveform to " TRACE_FILE "\n");
+	TRACE_CLASS* tfp = new TRACE_CLASS;
 	testbench->trace(tfp, 99);
-	tfp->open("trace.vcd");
+	tfp->open(TRACE_FILE);
 #endif
 
 	while (!Verilated::gotFinish())
 	{
+		// Take the checkpoint on a cycle boundary, before the rising edge.
+		if (checkpointEn && (currentTime & 1) == 0 && currentTime / 2 == checkpointCycle)
+		{
+			saveCheckpoint(testbench, checkpointFile);
+			checkpointEn = false;
+		}
+
 		if (currentTime > 10)
 			testbench->reset = 0;   // Deassert reset
 
@@ -83,7 +199,9 @@ int main(int argc, char **argv, char **env)
 		testbench->clk = !testbench->clk;
 		testbench->eval();
 #if VM_TRACE
-		tfp->dump(currentTime);	// Create waveform trace for this timestamp
+		// Create waveform trace for this timestamp
+		if (currentTime / 2 >= dumpStartCycle && currentTime / 2 <= dumpEndCycle)
+			tfp->dump(currentTime);
 #endif
 
 		currentTime++;
@@ -25,11 +25,36 @@ module verilator_tb(
 
 	localparam MEM_SIZE = 'h1000000;
 
+	// Layout of the architectural state file written by the emulator's -s
+	// option. This must match saveArchState in tools/emulator/core.c.
+	localparam STATE_HEADER_WORDS = 16;
+	localparam STATE_THREAD_WORDS = 48 + `NUM_REGISTERS * `VECTOR_LANES;
+	localparam STATE_SCALAR_OFFSET = 16;
+	localparam STATE_VECTOR_OFFSET = 48;
+	localparam MAX_WARM_LINES = `L2_SETS * `L2_WAYS;
+	localparam STATE_TRACE_VERSION = 1;
+	localparam STATE_TRACE_MAX_RUN = 'hffff;
+
 	int total_cycles = 0;
 	logic[1000:0] filename;
 	bit state_dump_en;
 	int state_dump_fd;
+	int dump_start_cycle;
+	int dump_end_cycle;
+	logic[`THREADS_PER_CORE - 1:0][7:0] state_trace_last;
+	logic[`THREADS_PER_CORE - 1:0][7:0] state_trace_current;
+	int state_trace_run;
+	longint perf_event_count[`TOTAL_PERF_EVENTS];
+	longint perf_thread_count[`CORE_PERF_EVENTS][`THREADS_PER_CORE];
+	longint dram_page_hit_count;
+	longint dram_page_miss_count;
+	bit perf_thread_en;
+	bit perf_series_en;
+	int perf_series_fd;
+	int perf_series_interval;
+	int perf_series_countdown;
 	int finish_cycles;
+	bit flush_l2_en;
 	bit profile_en;
 	int profile_fd;
 	scalar_t io_read_data;
@@ -41,6 +66,7 @@ module verilator_tb(
 	axi4_interface axi_bus_m1();
 	axi4_interface axi_bus_s0();
 	axi4_interface axi_bus_s1();
+	axi4_interface axi_bus_mem();
 	scalar_t loopback_uart_read_data;
 	logic loopback_uart_tx;
 	logic loopback_uart_rx;
@@ -48,6 +74,13 @@ module verilator_tb(
 	logic sd_cs_n;
 	logic sd_di;
 	logic sd_sclk;
+	scalar_t restore_state[STATE_HEADER_WORDS + STATE_THREAD_WORDS * `THREADS_PER_CORE];
+	bit restore_en;
+	int restore_base;
+	scalar_t warm_lines[MAX_WARM_LINES];
+	l2_way_idx_t warm_way[MAX_WARM_LINES];
+	int num_warm_lines;
+	int warm_set_count[`L2_SETS];
 
 	/*AUTOLOGIC*/
 	// Beginning of automatic wires (for undeclared instantiated-module outputs)
@@ -120,13 +153,18 @@ module verilator_tb(
 
 	`define MEMORY memory.memory
 
+	sim_memory_timing sim_memory_timing(
+		.axi_bus_in(axi_bus_m0.slave),
+		.axi_bus_out(axi_bus_mem.master),
+		.*);
+
 	sdram_controller #(
 		.DATA_WIDTH(SDRAM_DATA_WIDTH),
 		.ROW_ADDR_WIDTH(SDRAM_ROW_ADDR_WIDTH),
 		.COL_ADDR_WIDTH(SDRAM_COL_ADDR_WIDTH),
 		.T_REFRESH(750),
 		.T_POWERUP(5)) sdram_controller(
-			.axi_bus(axi_bus_m0.slave),
+			.axi_bus(axi_bus_mem.slave),
 			.*);
 
 	sim_sdram #(
@@ -216,72 +254,239 @@ module verilator_tb(
 	task flush_l2_line;
 		input l2_tag_t tag;
 		input l2_set_idx_t set;
-		input l2_way_idx_t way;
+		input cache_line_data_t data;
 	begin
 		for (int line_offset = 0; line_offset < `CACHE_LINE_WORDS; line_offset++)
 		begin
 			`MEMORY[(int'(tag) * `L2_SETS + int'(set)) * `CACHE_LINE_WORDS + line_offset] =
-				int'(nyuzi.l2_cache.l2_cache_read_stage.sram_l2_data.data[{way, set}]
-				 >> ((`CACHE_LINE_WORDS - 1 - line_offset) * 32));
+				int'(data >> ((`CACHE_LINE_WORDS - 1 - line_offset) * 32));
 		end
 	end
 	endtask
 
-	// Manually copy lines from the L2 cache back to memory so we can
-	// validate it there.
-	`define L2_TAG_WAY nyuzi.l2_cache.l2_cache_tag_stage.way_tags_gen
+	`define L2_BANK(bank) nyuzi.l2_cache.bank_gen[bank].l2_cache_bank
+
+	function l2_bank_set_idx_t l2_bank_set(input scalar_t address);
+		return l2_bank_set_idx_t'(l2_addr_t'(address).set_idx / `L2_BANKS);
+	endfunction
+
+	function string core_perf_event_name(input int event_idx);
+		case (event_idx)
+			CORE_PERF_STORE_ROLLBACK: return "store_rollback";
+			CORE_PERF_STORE: return "store";
+			CORE_PERF_INSTRUCTION_RETIRE: return "instruction_retire";
+			CORE_PERF_INSTRUCTION_ISSUE: return "instruction_issue";
+			CORE_PERF_ICACHE_MISS: return "icache_miss";
+			CORE_PERF_ICACHE_HIT: return "icache_hit";
+			CORE_PERF_ITLB_MISS: return "itlb_miss";
+			CORE_PERF_DCACHE_MISS: return "dcache_miss";
+			CORE_PERF_DCACHE_HIT: return "dcache_hit";
+			CORE_PERF_DTLB_MISS: return "dtlb_miss";
+			CORE_PERF_STALL_ICACHE: return "stall_icache";
+			CORE_PERF_STALL_DCACHE: return "stall_dcache";
+			CORE_PERF_STALL_STORE_QUEUE: return "stall_store_queue";
+			CORE_PERF_STALL_RAW: return "stall_raw";
+			CORE_PERF_STALL_WRITEBACK_CONFLICT: return "stall_writeback_conflict";
+			CORE_PERF_ROLLBACK_BRANCH: return "rollback_branch";
+			CORE_PERF_ROLLBACK_DCACHE_MISS: return "rollback_dcache_miss";
+			CORE_PERF_ROLLBACK_SYNC: return "rollback_sync";
+			CORE_PERF_PREFETCH_USEFUL: return "prefetch_useful";
+			CORE_PERF_PREFETCH_LATE: return "prefetch_late";
+			CORE_PERF_BRANCH_MISPREDICT: return "branch_mispredict";
+			CORE_PERF_STORE_COMBINED: return "store_combined";
+			CORE_PERF_SCGATH_ACCESS: return "scgath_access";
+			CORE_PERF_STALL_SCHEDULE: return "stall_schedule";
+			default: return "unknown";
+		endcase
+	endfunction
+
+	function string l2_perf_event_name(input int event_idx);
+		case (event_idx)
+			L2_PERF_WRITEBACK: return "l2_writeback";
+			L2_PERF_MISS: return "l2_miss";
+			L2_PERF_HIT: return "l2_hit";
+			L2_PERF_QUEUE_STALL: return "l2_queue_stall";
+			L2_PERF_AXI_READ_BEAT: return "axi_read_beat";
+			L2_PERF_AXI_WRITE_BEAT: return "axi_write_beat";
+			default: return "unknown";
+		endcase
+	endfunction
+
+	function longint core_perf_event_count(input int core_idx, input int event_idx);
+		return perf_event_count[`L2_PERF_EVENTS + core_idx * `CORE_PERF_EVENTS + event_idx];
+	endfunction
+
+	function real hit_rate(input longint hits, input longint misses);
+		if (hits + misses == 0)
+			return 0.0;
+
+		return 100.0 * real'(hits) / real'(hits + misses);
+	endfunction
+
+	task print_perf_counts;
+		$display("performance events:");
+		for (int i = 0; i < `L2_PERF_EVENTS; i++)
+			$display("    %s %0d", l2_perf_event_name(i), perf_event_count[i]);
+
+		$display("    dram_page_hit %0d", dram_page_hit_count);
+		$display("    dram_page_miss %0d", dram_page_miss_count);
+		for (int core_idx = 0; core_idx < `NUM_CORES; core_idx++)
+		begin
+			for (int i = 0; i < `CORE_PERF_EVENTS; i++)
+			begin
+				$display("    core%0d %s %0d", core_idx, core_perf_event_name(i),
+					core_perf_event_count(core_idx, i));
+			end
+		end
+
+		$display("    l2_hit_rate %.2f%%", hit_rate(perf_event_count[L2_PERF_HIT],
+			perf_event_count[L2_PERF_MISS]));
+		for (int core_idx = 0; core_idx < `NUM_CORES; core_idx++)
+		begin
+			$display("    core%0d icache_hit_rate %.2f%%", core_idx,
+				hit_rate(core_perf_event_count(core_idx, CORE_PERF_ICACHE_HIT),
+				core_perf_event_count(core_idx, CORE_PERF_ICACHE_MISS)));
+			$display("    core%0d dcache_hit_rate %.2f%%", core_idx,
+				hit_rate(core_perf_event_count(core_idx, CORE_PERF_DCACHE_HIT),
+				core_perf_event_count(core_idx, CORE_PERF_DCACHE_MISS)));
+		end
 
-	task flush_l2_cache;
-	begin
-		for (int set = 0; set < `L2_SETS; set++)
+		if (perf_thread_en)
 		begin
-			// XXX these need to be manually commented out when changing
-			// the number of L2 ways, since (per IEEE 1800-2012) an
-			// instance select must be a constant expression.
-			if (`L2_TAG_WAY[0].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[0].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(0));
+			$display("core0 events by thread:");
+			for (int i = 0; i < `CORE_PERF_EVENTS; i++)
+			begin
+				$write("    %s", core_perf_event_name(i));
+				for (int thread = 0; thread < `THREADS_PER_CORE; thread++)
+					$write(" %0d", perf_thread_count[i][thread]);
 
-			if (`L2_TAG_WAY[1].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[1].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(1));
+				$write("\n");
+			end
 
-			if (`L2_TAG_WAY[2].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[2].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(2));
+			// Percentage of instructions issued by each thread
+			$write("    issue_share");
+			for (int thread = 0; thread < `THREADS_PER_CORE; thread++)
+			begin
+				if (core_perf_event_count(0, CORE_PERF_INSTRUCTION_ISSUE) == 0)
+					$write(" 0.00%%");
+				else
+				begin
+					$write(" %.2f%%", 100.0
+						* real'(perf_thread_count[CORE_PERF_INSTRUCTION_ISSUE][thread])
+						/ real'(core_perf_event_count(0, CORE_PERF_INSTRUCTION_ISSUE)));
+				end
+			end
 
-			if (`L2_TAG_WAY[3].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[3].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(3));
+			$write("\n");
+		end
+	endtask
 
-			if (`L2_TAG_WAY[4].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[4].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(4));
+	// Write one comma separated row of cumulative event counts.
+	task write_perf_series;
+		$fwrite(perf_series_fd, "%0d,%0d,%0d", total_cycles, dram_page_hit_count,
+			dram_page_miss_count);
+		for (int i = 0; i < `TOTAL_PERF_EVENTS; i++)
+			$fwrite(perf_series_fd, ",%0d", perf_event_count[i]);
 
-			if (`L2_TAG_WAY[5].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[5].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(5));
+		$fwrite(perf_series_fd, "\n");
+	endtask
 
-			if (`L2_TAG_WAY[6].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[6].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(6));
+	task write_state_trace_byte(input logic[7:0] value);
+		$c("fputc(", value, ", VL_CVT_I_FP(", state_dump_fd, "));");
+	endtask
 
-			if (`L2_TAG_WAY[7].line_valid[set])
-				flush_l2_line(`L2_TAG_WAY[7].sram_tags.data[set], l2_set_idx_t'(set), l2_way_idx_t'(7));
+	// Each record is a 16 bit repeat count followed by one byte per thread
+	// for a run of identical cycles. The low three bits of the thread byte are
+	// the thread_state value, bit 3 indicates the thread issued an
+	// instruction, and bit 4 indicates it was rolled back.
+	task flush_state_trace;
+		if (state_trace_run != 0)
+		begin
+			write_state_trace_byte(state_trace_run[15:8]);
+			write_state_trace_byte(state_trace_run[7:0]);
+			for (int i = 0; i < `THREADS_PER_CORE; i++)
+				write_state_trace_byte(state_trace_last[i]);
 		end
-	end
 	endtask
 
+	genvar state_trace_thread;
+	generate
+		for (state_trace_thread = 0; state_trace_thread < `THREADS_PER_CORE; state_trace_thread++)
+		begin : state_trace_gen
+			assign state_trace_current[state_trace_thread] = {3'd0,
+				`CORE0.wb_rollback_en && `CORE0.wb_rollback_thread_idx == thread_idx_t'(state_trace_thread),
+				`CORE0.ts_instruction_valid && `CORE0.ts_thread_idx == thread_idx_t'(state_trace_thread),
+				3'(`CORE0.thread_select_stage.thread_state[state_trace_thread])};
+		end
+	endgenerate
+
 	initial
 	begin
-		$display("cores %0d|threads per core %0d|l1i$ %0dk %0d ways|l1d$ %0dk %0d ways|l2$ %0dk %0d ways|itlb %0d entries|dtlb %0d entries",
+		$display("cores %0d|threads per core %0d|l1i$ %0dk %0d ways|l1d$ %0dk %0d ways|l2$ %0dk %0d ways %0d banks|itlb %0d entries|dtlb %0d entries|replacement %s",
 			`NUM_CORES, `THREADS_PER_CORE,
 			`L1I_WAYS * `L1I_SETS * `CACHE_LINE_BYTES / 1024, `L1I_WAYS,
 			`L1D_WAYS * `L1D_SETS * `CACHE_LINE_BYTES / 1024, `L1D_WAYS,
-			`L2_WAYS * `L2_SETS * `CACHE_LINE_BYTES / 1024, `L2_WAYS,
-			`ITLB_ENTRIES, `DTLB_ENTRIES);
+			`L2_WAYS * `L2_SETS * `CACHE_LINE_BYTES / 1024, `L2_WAYS, `L2_BANKS,
+			`ITLB_ENTRIES, `DTLB_ENTRIES,
+`ifdef CACHE_RRIP
+			"rrip");
+`else
+			"plru");
+`endif
+
+		if ($value$plusargs("dumpstart=%d", dump_start_cycle) == 0)
+			dump_start_cycle = 0;
+
+		if ($value$plusargs("dumpend=%d", dump_end_cycle) == 0)
+			dump_end_cycle = 32'h7fffffff;
 
 		if ($test$plusargs("statetrace") != 0)
 		begin
 			state_dump_en = 1;
-			state_dump_fd = $fopen("statetrace.txt", "w");
+			state_dump_fd = $fopen("statetrace.bin", "wb");
+
+			// Header: magic, version, thread count, first cycle
+			write_state_trace_byte("N");
+			write_state_trace_byte("Y");
+			write_state_trace_byte("S");
+			write_state_trace_byte("T");
+			write_state_trace_byte(STATE_TRACE_VERSION);
+			write_state_trace_byte(`THREADS_PER_CORE);
+			write_state_trace_byte(0);
+			write_state_trace_byte(0);
+			write_state_trace_byte(dump_start_cycle[31:24]);
+			write_state_trace_byte(dump_start_cycle[23:16]);
+			write_state_trace_byte(dump_start_cycle[15:8]);
+			write_state_trace_byte(dump_start_cycle[7:0]);
+			state_trace_run = 0;
 		end
 		else
 			state_dump_en = 0;
 
+		perf_thread_en = $test$plusargs("perfthreads") != 0;
+		flush_l2_en = $test$plusargs("autoflushl2") != 0;
+		if ($value$plusargs("perfseries=%s", filename) != 0)
+		begin
+			perf_series_en = 1;
+			perf_series_fd = $fopen(filename, "w");
+			if ($value$plusargs("perfinterval=%d", perf_series_interval) == 0)
+				perf_series_interval = 10000;
+
+			$fwrite(perf_series_fd, "cycle,dram_page_hit,dram_page_miss");
+			for (int i = 0; i < `L2_PERF_EVENTS; i++)
+				$fwrite(perf_series_fd, ",%s", l2_perf_event_name(i));
+
+			for (int core_idx = 0; core_idx < `NUM_CORES; core_idx++)
+			begin
+				for (int i = 0; i < `CORE_PERF_EVENTS; i++)
+					$fwrite(perf_series_fd, ",core%0d_%s", core_idx, core_perf_event_name(i));
+			end
+
+			$fwrite(perf_series_fd, "\n");
+		end
+		else
+			perf_series_en = 0;
+
 		if ($value$plusargs("profile=%s", filename) != 0)
 		begin
 			profile_en = 1;
@@ -300,6 +505,39 @@ module verilator_tb(
 			$display("error opening file");
 			$finish;
 		end
+
+		if ($value$plusargs("restorestate=%s", filename) != 0)
+		begin
+			$readmemh(filename, restore_state);
+			restore_en = 1;
+		end
+		else
+			restore_en = 0;
+
+		num_warm_lines = 0;
+		if ($value$plusargs("warml2=%s", filename) != 0)
+		begin
+			// The file contains physical addresses of cache lines. Addresses
+			// are line aligned, so an unaligned value marks the end of the list.
+			for (int i = 0; i < MAX_WARM_LINES; i++)
+				warm_lines[i] = '1;
+
+			for (int i = 0; i < `L2_SETS; i++)
+				warm_set_count[i] = 0;
+
+			$readmemh(filename, warm_lines);
+			for (int i = 0; i < MAX_WARM_LINES && warm_lines[i] != '1; i++)
+			begin
+				// Assign ways in order. Drop lines if the set is already full.
+				if (warm_set_count[l2_addr_t'(warm_lines[i]).set_idx] < `L2_WAYS)
+				begin
+					warm_lines[num_warm_lines] = warm_lines[i];
+					warm_way[num_warm_lines] = l2_way_idx_t'(warm_set_count[l2_addr_t'(warm_lines[i]).set_idx]);
+					warm_set_count[l2_addr_t'(warm_lines[i]).set_idx]++;
+					num_warm_lines++;
+				end
+			end
+		end
 	end
 
 	final
@@ -309,13 +547,17 @@ module verilator_tb(
 		int dump_fp;
 
 		$display("ran for %0d cycles", total_cycles);
+		print_perf_counts;
+		if (perf_series_en)
+		begin
+			write_perf_series;
+			$fclose(perf_series_fd);
+		end
+
 		if ($value$plusargs("memdumpbase=%x", mem_dump_start) != 0
 			&& $value$plusargs("memdumplen=%x", mem_dump_length) != 0
 			&& $value$plusargs("memdumpfile=%s", filename) != 0)
 		begin
-			if ($test$plusargs("autoflushl2") != 0)
-				flush_l2_cache;
-
 			dump_fp = $fopen(filename, "wb");
 			for (int i = 0; i < mem_dump_length; i += 4)
 			begin
@@ -329,7 +571,10 @@ module verilator_tb(
 		end
 
 		if (state_dump_en)
+		begin
+			flush_state_trace;
 			$fclose(state_dump_fd);
+		end
 
 		if (profile_en)
 			$fclose(profile_fd);
@@ -339,6 +584,140 @@ module verilator_tb(
 			$display("***HALTED***");
 	end
 
+	//
+	// Hybrid simulation: load architectural state saved by the emulator
+	// (+restorestate) and optionally fill the L2 cache with lines it
+	// accessed (+warml2). This happens on the falling clock edge after reset
+	// is deasserted. None of the core's flops update on that edge, so this
+	// overrides their reset values without racing with the pipeline.
+	// TLBs and L1 caches start empty.
+	//
+	/* verilator lint_off MULTIDRIVEN */
+	/* verilator lint_off BLKSEQ */
+	always @(negedge clk)
+	begin
+		if (restore_en && !reset)
+		begin
+			restore_en <= 0;
+			nyuzi.interrupt_controller.ic_thread_en <= restore_state[0][`THREADS_PER_CORE - 1:0];
+			`CORE0.control_registers.cr_fault_handler <= restore_state[2];
+			`CORE0.control_registers.cr_tlb_miss_handler <= restore_state[3];
+			for (int thread = 0; thread < `THREADS_PER_CORE; thread++)
+			begin
+				restore_base = STATE_HEADER_WORDS + thread * STATE_THREAD_WORDS;
+				`CORE0.ifetch_tag_stage.next_program_counter[thread] <= restore_state[restore_base];
+				`CORE0.control_registers.cr_interrupt_en[thread] <= restore_state[restore_base + 1][0];
+				`CORE0.control_registers.cr_mmu_en[thread] <= restore_state[restore_base + 1][1];
+				`CORE0.control_registers.cr_supervisor_en[thread] <= restore_state[restore_base + 1][2];
+				`CORE0.control_registers.interrupt_en_saved[thread] <= restore_state[restore_base + 2][0];
+				`CORE0.control_registers.mmu_en_saved[thread] <= restore_state[restore_base + 2][1];
+				`CORE0.control_registers.supervisor_en_saved[thread] <= restore_state[restore_base + 2][2];
+				`CORE0.control_registers.cr_eret_address[thread] <= restore_state[restore_base + 3];
+				`CORE0.control_registers.fault_reason[thread] <= fault_reason_t'(restore_state[restore_base + 4]);
+				`CORE0.control_registers.fault_access_addr[thread] <= restore_state[restore_base + 5];
+				`CORE0.control_registers.cr_current_asid[thread] <= restore_state[restore_base + 6][`ASID_WIDTH - 1:0];
+				`CORE0.control_registers.scratchpad[{1'b0, thread_idx_t'(thread)}] <= restore_state[restore_base + 7];
+				`CORE0.control_registers.scratchpad[{1'b1, thread_idx_t'(thread)}] <= restore_state[restore_base + 8];
+				`CORE0.control_registers.cr_eret_subcycle[thread] <= subcycle_t'(restore_state[restore_base + 9]);
+				`CORE0.control_registers.cr_thread_priority[thread] <= thread_priority_t'(restore_state[restore_base + 10]);
+				for (int reg_idx = 0; reg_idx < `NUM_REGISTERS - 1; reg_idx++)
+				begin
+					`CORE0.operand_fetch_stage.scalar_registers.data[{thread_idx_t'(thread), register_idx_t'(reg_idx)}]
+						<= restore_state[restore_base + STATE_SCALAR_OFFSET + reg_idx];
+				end
+			end
+		end
+	end
+
+	genvar restore_lane;
+	generate
+		for (restore_lane = 0; restore_lane < `VECTOR_LANES; restore_lane++)
+		begin : restore_vector_gen
+			always @(negedge clk)
+			begin
+				if (restore_en && !reset)
+				begin
+					for (int thread = 0; thread < `THREADS_PER_CORE; thread++)
+					begin
+						for (int reg_idx = 0; reg_idx < `NUM_REGISTERS; reg_idx++)
+						begin
+							`CORE0.operand_fetch_stage.vector_lane_gen[restore_lane].vector_registers.data[
+								{thread_idx_t'(thread), register_idx_t'(reg_idx)}]
+								<= restore_state[STATE_HEADER_WORDS + thread * STATE_THREAD_WORDS
+								+ STATE_VECTOR_OFFSET + reg_idx * `VECTOR_LANES + restore_lane];
+						end
+					end
+				end
+			end
+		end
+	endgenerate
+
+	// The low bits of the set index select the L2 bank, and the rest select
+	// a set within it. An instance select must be a constant expression, so
+	// this generates a block for each bank and way.
+	genvar l2_bank_idx;
+	genvar l2_way_idx;
+	generate
+		for (l2_bank_idx = 0; l2_bank_idx < `L2_BANKS; l2_bank_idx++)
+		begin : l2_bank_gen
+			for (l2_way_idx = 0; l2_way_idx < `L2_WAYS; l2_way_idx++)
+			begin : l2_way_gen
+				always @(negedge clk)
+				begin
+					cache_line_data_t warm_line_data;
+
+					// Fill the L2 cache with lines from +warml2
+					if (restore_en && !reset)
+					begin
+						for (int i = 0; i < num_warm_lines; i++)
+						begin
+							if (warm_way[i] == l2_way_idx_t'(l2_way_idx)
+								&& int'(l2_addr_t'(warm_lines[i]).set_idx) % `L2_BANKS == l2_bank_idx)
+							begin
+								for (int line_offset = 0; line_offset < `CACHE_LINE_WORDS; line_offset++)
+								begin
+									warm_line_data[(`CACHE_LINE_WORDS - 1 - line_offset) * 32+:32] =
+										`MEMORY[warm_lines[i] / 4 + line_offset];
+								end
+
+								`L2_BANK(l2_bank_idx).l2_cache_read_stage.sram_l2_data.data[{
+									l2_way_idx_t'(l2_way_idx), l2_bank_set(warm_lines[i])}]
+									<= warm_line_data;
+								`L2_BANK(l2_bank_idx).l2_cache_tag_stage.way_tags_gen[l2_way_idx].sram_tags.data[
+									l2_bank_set(warm_lines[i])] <= l2_addr_t'(warm_lines[i]).tag;
+								`L2_BANK(l2_bank_idx).l2_cache_tag_stage.way_tags_gen[l2_way_idx].sram_dirty_flags.data[
+									l2_bank_set(warm_lines[i])] <= 0;
+								`L2_BANK(l2_bank_idx).l2_cache_tag_stage.way_tags_gen[l2_way_idx].line_valid[
+									l2_bank_set(warm_lines[i])] <= 1;
+							end
+						end
+					end
+
+					// +autoflushl2: manually copy lines from the L2 cache back to
+					// memory so we can validate it there. This happens on the last
+					// falling edge before $finish, so it is before the final block
+					// dumps memory.
+					if (flush_l2_en && processor_halt && finish_cycles == 1)
+					begin
+						for (int set = 0; set < `L2_BANK_SETS; set++)
+						begin
+							if (`L2_BANK(l2_bank_idx).l2_cache_tag_stage.way_tags_gen[l2_way_idx].line_valid[set])
+							begin
+								flush_l2_line(
+									`L2_BANK(l2_bank_idx).l2_cache_tag_stage.way_tags_gen[l2_way_idx].sram_tags.data[set],
+									l2_set_idx_t'(set * `L2_BANKS + l2_bank_idx),
+									`L2_BANK(l2_bank_idx).l2_cache_read_stage.sram_l2_data.data[{
+										l2_way_idx_t'(l2_way_idx), l2_bank_set_idx_t'(set)}]);
+							end
+						end
+					end
+				end
+			end
+		end
+	endgenerate
+	/* verilator lint_on BLKSEQ */
+	/* verilator lint_on MULTIDRIVEN */
+
 	always_ff @(posedge clk, posedge reset)
 	begin
 		if (reset)
@@ -363,6 +742,18 @@ module verilator_tb(
 		if (reset)
 		begin
 			loopback_uart_mask <= 1;
+			for (int i = 0; i < `TOTAL_PERF_EVENTS; i++)
+				perf_event_count[i] <= 0;
+
+			for (int i = 0; i < `CORE_PERF_EVENTS; i++)
+			begin
+				for (int thread = 0; thread < `THREADS_PER_CORE; thread++)
+					perf_thread_count[i][thread] <= 0;
+			end
+
+			dram_page_hit_count <= 0;
+			dram_page_miss_count <= 0;
+			perf_series_countdown <= 0;
 		end
 		else
 		begin
@@ -421,17 +812,50 @@ module verilator_tb(
 				endcase
 			end
 
-			if (state_dump_en)
+			if (state_dump_en && total_cycles >= dump_start_cycle
+				&& total_cycles <= dump_end_cycle)
 			begin
-				for (int i = 0; i < `THREADS_PER_CORE; i++)
+				if (state_trace_run == 0 || state_trace_run == STATE_TRACE_MAX_RUN
+					|| state_trace_current != state_trace_last)
 				begin
-					if (i != 0)
-						$fwrite(state_dump_fd, ",");
+					flush_state_trace;
+					state_trace_last <= state_trace_current;
+					state_trace_run <= 1;
+				end
+				else
+					state_trace_run <= state_trace_run + 1;
+			end
 
-					$fwrite(state_dump_fd, "%d", `CORE0.thread_select_stage.thread_state[i]);
+			for (int i = 0; i < `TOTAL_PERF_EVENTS; i++)
+			begin
+				if (nyuzi.perf_events[i])
+					perf_event_count[i] <= perf_event_count[i] + 1;
+			end
+
+			for (int i = 0; i < `CORE_PERF_EVENTS; i++)
+			begin
+				for (int thread = 0; thread < `THREADS_PER_CORE; thread++)
+				begin
+					if (nyuzi.core_perf_thread_events[thread][i])
+						perf_thread_count[i][thread] <= perf_thread_count[i][thread] + 1;
 				end
+			end
 
-				$fwrite(state_dump_fd, "\n");
+			if (pc_event_dram_page_hit)
+				dram_page_hit_count <= dram_page_hit_count + 1;
+
+			if (pc_event_dram_page_miss)
+				dram_page_miss_count <= dram_page_miss_count + 1;
+
+			if (perf_series_en)
+			begin
+				if (perf_series_countdown == 0)
+				begin
+					write_perf_series;
+					perf_series_countdown <= perf_series_interval - 1;
+				end
+				else
+					perf_series_countdown <= perf_series_countdown - 1;
 			end
 
 			// Randomly sample a program counter for a thread and output to profile file
@@ -158,23 +158,44 @@ void I_UpdateNoBlit (void)
 //
 void I_FinishUpdate (void)
 {
-	int x, y, offs;
+	int x, y;
 	veci16_t *dest = (veci16_t*) 0x200000;
-	const unsigned char *src = screens[0];
 	veci16_t pixelVals;
+#ifdef NYUZI_ISA_EXTENSIONS
+	const unsigned int *src = (const unsigned int*) screens[0];
+	const veci16_t byteIndex = { 0, 0, 1, 1, 2, 2, 3, 3, 0, 0, 1, 1, 2, 2, 3, 3 };
+	const veci16_t paletteBase = __builtin_nyuzi_makevectori((int) gPalette);
+	veci16_t packed;
+	veci16_t offsets;
+#else
+	const unsigned char *src = screens[0];
+	int offs;
 	int mask;
+#endif
 
-	// Copy to framebuffer and expand palette
+	// Copy to framebuffer and expand palette. Each source pixel is two
+	// pixels wide.
 	for (y = 0; y < SCREENHEIGHT; y++)
 	{
 		for (x = 0; x < SCREENWIDTH; x += 8)
 		{
+#ifdef NYUZI_ISA_EXTENSIONS
+			// Eight source pixels (two words) are spread across the lanes,
+			// then each lane unpacks its byte and looks up the color.
+			packed = __builtin_nyuzi_vector_mixi(0xff00, __builtin_nyuzi_makevectori(src[0]),
+				__builtin_nyuzi_makevectori(src[1]));
+			src += 2;
+			asm("unpack_u8 %0, %1, %2" : "=v" (offsets) : "v" (packed), "v" (byteIndex));
+			pixelVals = __builtin_nyuzi_gather_loadi(paletteBase + (offsets
+				<< __builtin_nyuzi_makevectori(2)));
+#else
 			mask = 0xc000;
 			for (offs = 0; offs < 8; offs++, mask >>= 2)
 			{
 				pixelVals = __builtin_nyuzi_vector_mixi(mask, __builtin_nyuzi_makevectori(gPalette[*src++]),
 					pixelVals);
 			}
+#endif
 
 			dest[0] = pixelVals;
 			dest[40] = pixelVals;
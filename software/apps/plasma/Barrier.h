@@ -18,6 +18,9 @@
 #ifndef __BARRIER_H
 #define __BARRIER_H
 
+#include <atomic.h>
+#include <nyuzi.h>
+
 //
 // Each thread that calls wait() will wait until all threads have called it.
 // At that point, they are all released.
@@ -36,12 +39,12 @@ public:
     // If that wasn't the case, this would livelock.
     void wait()
     {
-        if (__sync_add_and_fetch(&fWaitCount, 1) == NUM_THREADS)
+        if (atomic_add(&fWaitCount, 1) == NUM_THREADS - 1)
             fWaitCount = 0;
         else
         {
             while (fWaitCount)
-                ;	// Wait busily
+                waitForWrite(&fWaitCount);
         }
     }
 
@@ -17,11 +17,22 @@
 
 float total(const vecf16 &v1)
 {
+#ifdef __NYUZI__
+	// Fold the vector in half until the sum is in one lane, rather than
+	// extracting each lane into a scalar register.
+	vecf16 sum = v1;
+	sum += __builtin_shufflevector(sum, sum, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+	sum += __builtin_shufflevector(sum, sum, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11);
+	sum += __builtin_shufflevector(sum, sum, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+	sum += __builtin_shufflevector(sum, sum, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	return sum[0];
+#else
 	int i;
 	float sum = 0;
 	for (i = 0; i < 16; i++)
 		sum += v1[i];
 	return sum;
+#endif
 }
 
 float dot(const vecf16 &v1, const vecf16 &v2)
@@ -0,0 +1,135 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#pragma once
+
+//
+// Atomic read-modify-write operations. These are performed by the L2 cache,
+// so they don't need a load_sync/store_sync retry loop and can't fail when
+// other threads access the same cache line. All return the old value.
+// The compiler expands the __sync builtins into retry loops, so use these
+// for counters and locks that may be contended.
+//
+// The atomic_* instructions are only used when NYUZI_ISA_EXTENSIONS is
+// defined (make ISA_EXTENSIONS=1), because the toolchain may not assemble
+// them. Otherwise these fall back to the __sync builtins.
+//
+
+#ifdef NYUZI_ISA_EXTENSIONS
+
+static inline int atomic_add(volatile int *ptr, int value)
+{
+	asm volatile("atomic_add %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+static inline int atomic_and(volatile int *ptr, int value)
+{
+	asm volatile("atomic_and %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+static inline int atomic_or(volatile int *ptr, int value)
+{
+	asm volatile("atomic_or %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+static inline int atomic_xor(volatile int *ptr, int value)
+{
+	asm volatile("atomic_xor %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+static inline int atomic_xchg(volatile int *ptr, int value)
+{
+	asm volatile("atomic_xchg %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+// Signed comparison
+static inline int atomic_min(volatile int *ptr, int value)
+{
+	asm volatile("atomic_min %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+// Signed comparison
+static inline int atomic_max(volatile int *ptr, int value)
+{
+	asm volatile("atomic_max %0, (%1)" : "+s" (value) : "s" (ptr) : "memory");
+	return value;
+}
+
+#else
+
+static inline int atomic_add(volatile int *ptr, int value)
+{
+	return __sync_fetch_and_add(ptr, value);
+}
+
+static inline int atomic_and(volatile int *ptr, int value)
+{
+	return __sync_fetch_and_and(ptr, value);
+}
+
+static inline int atomic_or(volatile int *ptr, int value)
+{
+	return __sync_fetch_and_or(ptr, value);
+}
+
+static inline int atomic_xor(volatile int *ptr, int value)
+{
+	return __sync_fetch_and_xor(ptr, value);
+}
+
+static inline int atomic_xchg(volatile int *ptr, int value)
+{
+	return __sync_lock_test_and_set(ptr, value);
+}
+
+// Signed comparison
+static inline int atomic_min(volatile int *ptr, int value)
+{
+	int old;
+	do
+	{
+		old = *ptr;
+		if (old <= value)
+			return old;
+	}
+	while (!__sync_bool_compare_and_swap(ptr, old, value));
+
+	return old;
+}
+
+// Signed comparison
+static inline int atomic_max(volatile int *ptr, int value)
+{
+	int old;
+	do
+	{
+		old = *ptr;
+		if (old >= value)
+			return old;
+	}
+	while (!__sync_bool_compare_and_swap(ptr, old, value));
+
+	return old;
+}
+
+#endif
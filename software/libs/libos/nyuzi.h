@@ -27,4 +27,38 @@ inline unsigned int getCycleCount()
 	return __builtin_nyuzi_read_control_reg(6);
 }
 
+// Suspend this thread until the cache line containing address is written by
+// any thread, so it doesn't take issue slots from other threads while it
+// spins. This may return before the line is written (for example, after a
+// timeout), so the caller must check the condition again. Without
+// NYUZI_ISA_EXTENSIONS, this returns immediately and the caller just spins.
+inline void waitForWrite(const volatile void *address)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	asm volatile("dwait %0" : : "s" (address) : "memory");
+#else
+	(void) address;
+	asm volatile("" : : : "memory");
+#endif
+}
+
+// Hint that this thread is spinning on a condition another thread will
+// change. The hardware issues instructions from other threads first for a
+// short time. This does nothing without NYUZI_ISA_EXTENSIONS.
+inline void spinPause()
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	asm volatile("pause");
+#endif
+}
+
+// Threads with a higher priority (0-3) issue instructions before other
+// threads when more than one is ready, so a busy high priority thread can
+// starve the others. All threads start at priority 0.
+// This is only a scheduling hint and has no effect on the emulator.
+inline void setThreadPriority(int priority)
+{
+	__builtin_nyuzi_write_control_reg(14, priority);
+}
+
 #endif
@@ -23,11 +23,24 @@ void set_perf_counter_event(int counter, enum performance_event event)
 		REGISTERS[REG_PERF0_SEL + counter] = event;
 }
 
-unsigned int read_perf_counter(int counter)
+void set_perf_counter_thread_event(int counter, enum performance_event event,
+	int thread)
 {
 	if (counter >= 0 && counter < NUM_COUNTERS)
-		return REGISTERS[REG_PERF0_VAL + counter];
-	else
-		return 0;
+		REGISTERS[REG_PERF0_SEL + counter] = event | (thread << 16) | 0x80000000;
 }
 
+unsigned long long read_perf_counter(int counter)
+{
+	unsigned int low;
+	unsigned int high;
+
+	if (counter < 0 || counter >= NUM_COUNTERS)
+		return 0;
+
+	// Reading the low half latches the high half, so this doesn't need to
+	// retry if the counter carries between the two reads.
+	low = REGISTERS[REG_PERF0_VAL + counter * 2];
+	high = REGISTERS[REG_PERF0_VAL + counter * 2 + 1];
+	return ((unsigned long long) high << 32) | low;
+}
@@ -20,13 +20,16 @@
 extern "C" {
 #endif
 
-#define NUM_COUNTERS 4
+#define NUM_COUNTERS 8
 
 enum performance_event
 {
 	PERF_L2_WRITEBACK,
 	PERF_L2_MISS,
 	PERF_L2_HIT,
+	PERF_L2_QUEUE_STALL,		// L2 miss/writeback queue full, pipeline stalled
+	PERF_AXI_READ_BEAT,
+	PERF_AXI_WRITE_BEAT,
 	PERF_STORE_ROLLBACK,
 	PERF_STORE,
 	PERF_INSTRUCTION_RETIRED,
@@ -36,11 +39,35 @@ enum performance_event
 	PERF_ITLB_MISS,
 	PERF_DCACHE_MISS,
 	PERF_DCACHE_HIT,
-	PERF_DTLB_MISS
+	PERF_DTLB_MISS,
+	PERF_STALL_ICACHE,			// No instruction available
+	PERF_STALL_DCACHE,			// Waiting for L1 data cache miss
+	PERF_STALL_STORE_QUEUE,		// Waiting for store queue entry
+	PERF_STALL_RAW,				// Waiting on register dependency (scoreboard)
+	PERF_STALL_WRITEBACK_CONFLICT,
+	PERF_ROLLBACK_BRANCH,
+	PERF_ROLLBACK_DCACHE_MISS,
+	PERF_ROLLBACK_SYNC,
+	PERF_PREFETCH_USEFUL,		// Load miss on a line already prefetched into L2
+	PERF_PREFETCH_LATE,			// Load miss on a line still being prefetched
+	PERF_BRANCH_MISPREDICT,		// Conditional branch predicted the wrong way
+	PERF_STORE_COMBINED,		// Store combined with a pending store to the same line
+	PERF_SCGATH_ACCESS,			// Scatter/gather cache access, may service several lanes
+	PERF_STALL_SCHEDULE			// Could issue, but another thread was picked
 };
 
+// Events starting at PERF_STORE_ROLLBACK are repeated for each core. The stall
+// events count cycles where that condition prevents a thread from issuing.
+// Without a thread filter, each cycle counts once even if several threads are
+// stalled.
 void set_perf_counter_event(int counter, enum performance_event event);
-unsigned int read_perf_counter(int counter);
+
+// Only count events caused by the given hardware thread. Events that aren't
+// associated with a thread (L2 and AXI) are counted regardless.
+void set_perf_counter_thread_event(int counter, enum performance_event event,
+	int thread);
+
+unsigned long long read_perf_counter(int counter);
 
 #ifdef __cplusplus
 }
@@ -50,9 +50,17 @@ enum RegisterIndex
 	REG_PERF1_SEL           = 0x0124 / 4,
 	REG_PERF2_SEL           = 0x0128 / 4,
 	REG_PERF3_SEL           = 0x012c / 4,
-	REG_PERF0_VAL           = 0x0130 / 4,
-	REG_PERF1_VAL           = 0x0134 / 4,
-	REG_PERF2_VAL           = 0x0138 / 4,
-	REG_PERF3_VAL           = 0x013c / 4
+	REG_PERF4_SEL           = 0x0130 / 4,
+	REG_PERF5_SEL           = 0x0134 / 4,
+	REG_PERF6_SEL           = 0x0138 / 4,
+	REG_PERF7_SEL           = 0x013c / 4,
+	REG_PERF0_VAL           = 0x0140 / 4,	// Low 32 bits, high word follows
+	REG_PERF1_VAL           = 0x0148 / 4,
+	REG_PERF2_VAL           = 0x0150 / 4,
+	REG_PERF3_VAL           = 0x0158 / 4,
+	REG_PERF4_VAL           = 0x0160 / 4,
+	REG_PERF5_VAL           = 0x0168 / 4,
+	REG_PERF6_VAL           = 0x0170 / 4,
+	REG_PERF7_VAL           = 0x0178 / 4
 };
 
@@ -14,11 +14,12 @@
 // limitations under the License.
 //
 
+#include <atomic.h>
 #include <stdlib.h>
 
-volatile unsigned int gNextAlloc = 0x500000;
+volatile int gNextAlloc = 0x500000;
 
 void *sbrk(ptrdiff_t size)
 {
-	return (void*) __sync_fetch_and_add(&gNextAlloc, size);
+	return (void*) atomic_add(&gNextAlloc, size);
 }
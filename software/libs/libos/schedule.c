@@ -14,7 +14,9 @@
 // limitations under the License.
 //
 
+#include <atomic.h>
 #include <stdio.h>
+#include "nyuzi.h"
 #include "schedule.h"
 
 static ParallelFunc gCurrentFunc;
@@ -23,17 +25,13 @@ static volatile int gMaxIndex;
 static volatile int gActiveJobs;
 static void * volatile gContext;
 
+// gCurrentIndex may be incremented past gMaxIndex when several threads
+// find the batch is finished at the same time.
 static int dispatchJob()
 {
-	int thisIndex;
-
-	do
-	{
-		thisIndex = gCurrentIndex;
-		if (thisIndex == gMaxIndex)
-			return 0;	// No more jobs in this batch
-	}
-	while (!__sync_bool_compare_and_swap(&gCurrentIndex, thisIndex, thisIndex + 1));
+	int thisIndex = atomic_add(&gCurrentIndex, 1);
+	if (thisIndex >= gMaxIndex)
+		return 0;	// No more jobs in this batch
 
 	gCurrentFunc(gContext, thisIndex);
 
@@ -47,23 +45,23 @@ void parallelExecute(ParallelFunc func, void *context, int numElements)
 	gCurrentIndex = 0;
 	gMaxIndex = numElements;
 
-	while (gCurrentIndex != gMaxIndex)
-		dispatchJob();
+	while (dispatchJob())
+		;
 
 	while (gActiveJobs)
-		; // Wait for threads to finish
+		waitForWrite(&gActiveJobs); // Wait for threads to finish
 }
 
 void workerThread()
 {
 	while (1)
 	{
-		while (gCurrentIndex == gMaxIndex)
-			;
+		while (gCurrentIndex >= gMaxIndex)
+			waitForWrite(&gCurrentIndex);
 
-		__sync_fetch_and_add(&gActiveJobs, 1);
+		atomic_add(&gActiveJobs, 1);
 		dispatchJob();
-		__sync_fetch_and_add(&gActiveJobs, -1);
+		atomic_add(&gActiveJobs, -1);
 	}
 }
 
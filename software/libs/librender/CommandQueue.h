@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <atomic.h>
+#include <nyuzi.h>
 #include "RegionAllocator.h"
 
 namespace librender
@@ -197,15 +199,15 @@ private:
 		// Lock
 		do
 		{
-			// Busy wait without calling the sync version of compare and swap.
-			// This avoids creating traffic on the L2 interface, because it
-			// only reads the L1 cached copy of the variable. When another thread
-			// writes to the lock, the coherence broadcast will update the L1
-			// cache and knock this out of the loop.
+			// Wait without calling the atomic exchange. This avoids
+			// creating traffic on the L2 interface, because it only reads the
+			// L1 cached copy of the variable. When another thread writes to
+			// the lock, the coherence broadcast will update the L1 cache and
+			// wake this thread.
 			while (fSpinLock)
-				;
+				waitForWrite(&fSpinLock);
 		}
-		while (!__sync_bool_compare_and_swap(&fSpinLock, 0, 1));
+		while (atomic_xchg(&fSpinLock, 1));
 
 		// Check that someone didn't beat us to allocating the bucket.
 		if (fNextBucketIndex == BUCKET_SIZE || fLastBucket == nullptr)
@@ -37,10 +37,15 @@ public:
 	}
 
 	// Return values of this parameter at 16 locations given by the vectors
-	// x and y.
+	// x and y. Without NYUZI_ISA_EXTENSIONS, this adds in the original order
+	// so the rounding doesn't change.
 	inline vecf16_t getValuesAt(vecf16_t x, vecf16_t y) const
 	{
+#ifdef NYUZI_ISA_EXTENSIONS
+		return fmaddfv(x, fXGradient, fmaddfv(y, fYGradient, splatf(fC00)));
+#else
 		return x * splatf(fXGradient) + y * splatf(fYGradient) + splatf(fC00);
+#endif
 	}
 
 private:
@@ -94,7 +94,7 @@ public:
 		{
 			vecf16_t sum = splatf(0.0f);
 			for (int col = 0; col < 4; col++)
-				sum += splatf(fValues[row][col]) * inVec[col];
+				sum = fmaddfv(inVec[col], fValues[row][col], sum);
 
 			outVec[row] = sum;
 		}
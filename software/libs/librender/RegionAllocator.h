@@ -18,6 +18,7 @@
 #pragma once
 
 #include <assert.h>
+#include <atomic.h>
 #include <stddef.h>
 
 namespace librender
@@ -46,20 +47,17 @@ public:
 		delete [] fArenaBase;
 	}
 
-	// This is thread safe and lock-free. Alignment must be a power of 2
+	// This is thread safe and lock-free. Alignment must be a power of 2.
+	// fNextAlloc is always a multiple of 4, so this reserves alignment - 4
+	// extra bytes to be able to align the result without retrying.
 	void *alloc(size_t size, size_t alignment = 4)
 	{
-		char *nextAlloc;
-		char *alignedAlloc;
-
-		do
-		{
-			nextAlloc = fNextAlloc;
-			alignedAlloc = reinterpret_cast<char*>((reinterpret_cast<unsigned int>(nextAlloc)
-				+ alignment - 1) & ~(alignment - 1));
-			assert(alignedAlloc + size < fArenaBase + fTotalSize);
-		}
-		while (!__sync_bool_compare_and_swap(&fNextAlloc, nextAlloc, alignedAlloc + size));
+		size_t roundedSize = (size + 3) & ~size_t(3);
+		size_t padding = alignment > 4 ? alignment - 4 : 0;
+		unsigned int nextAlloc = static_cast<unsigned int>(atomic_add(
+			reinterpret_cast<volatile int*>(&fNextAlloc), static_cast<int>(roundedSize + padding)));
+		char *alignedAlloc = reinterpret_cast<char*>((nextAlloc + alignment - 1) & ~(alignment - 1));
+		assert(alignedAlloc + size < fArenaBase + fTotalSize);
 
 		return alignedAlloc;
 	}
@@ -31,20 +31,32 @@ namespace librender
 class RenderBuffer
 {
 public:
+	// Format of elements read with gatherElements. Half precision floats
+	// use half the memory and bandwidth of single precision, which is
+	// usually enough for texture coordinates, normals, and colors. They
+	// are converted to single precision when they are loaded.
+	enum ElementFormat
+	{
+		kFloat32,
+		kFloat16
+	};
+
 	RenderBuffer()
 		:	fData(0),
 			fNumElements(0),
 			fStride(0),
+			fFormat(kFloat32),
 			fBaseStepPointers(static_cast<vecu16_t*>(memalign(sizeof(vecu16_t), sizeof(vecu16_t))))
 	{
 	}
 
 	RenderBuffer(const RenderBuffer &) = delete;
 
-	RenderBuffer(const void *data, int numElements, int stride)
+	RenderBuffer(const void *data, int numElements, int stride,
+		ElementFormat format = kFloat32)
 		:	fBaseStepPointers(static_cast<vecu16_t*>(memalign(sizeof(vecu16_t), sizeof(vecu16_t))))
 	{
-		setData(data, numElements, stride);
+		setData(data, numElements, stride, format);
 	}
 
 	~RenderBuffer()
@@ -58,11 +70,15 @@ public:
 	// a separate buffer.  The caller must ensure the memory remains around
 	// as long as the RenderBuffer is active.
 	// XXX should there be a concept of owned and not-owned data like Surface?
-	void setData(const void *data, int numElements, int stride)
+	// For kFloat16, the stride must be a multiple of four bytes (pad with
+	// an unused element if there are an odd number per vertex).
+	void setData(const void *data, int numElements, int stride,
+		ElementFormat format = kFloat32)
 	{
 		fData = data;
 		fNumElements = numElements;
 		fStride = stride;
+		fFormat = format;
 
 		const veci16_t kStepVector = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
 		*fBaseStepPointers = kStepVector * splati(fStride)
@@ -89,6 +105,11 @@ public:
 		return fData;
 	}
 
+	ElementFormat getFormat() const
+	{
+		return fFormat;
+	}
+
 	// Given a packed array of the form a0b0 a0b1... a_1b_0 a_1b_1...
 	// Return up to 16 elements packed in a vector: a_mb_n, a_mb_(n+1)...
 	veci16_t gatherElements(int index1, int index2, int count) const
@@ -99,6 +120,15 @@ public:
 		else
 			mask = 0xffff;
 
+		if (fFormat == kFloat16)
+		{
+			// There are two elements in each word. Load the word that
+			// contains this one and convert the correct half.
+			const vecu16_t ptrVec = *fBaseStepPointers + splati(index1 * fStride + (index2 & ~1)
+				* sizeof(unsigned short));
+			return htofv(__builtin_nyuzi_gather_loadi_masked(ptrVec, mask), index2 & 1);
+		}
+
 		const vecu16_t ptrVec = *fBaseStepPointers + splati(index1 * fStride + index2
 			* sizeof(unsigned int));
 		return __builtin_nyuzi_gather_loadf_masked(ptrVec, mask);
@@ -108,6 +138,7 @@ private:
 	const void *fData;
 	int fNumElements;
 	int fStride;
+	ElementFormat fFormat;
 
 	vecu16_t *fBaseStepPointers;
 };
@@ -426,8 +426,14 @@ void RenderContext::fillTile(int index)
 	TriangleArray &tile = fTiles[y * fTileColumns + x];
 	Surface *colorBuffer = fRenderTarget->getColorBuffer();
 
+	// If the color buffer isn't cleared, blending will read the old contents.
+	// Start loading them now so it overlaps with triangle setup. If no
+	// triangles touch this tile, the clear color is the final output, so
+	// write it directly to memory.
 	if (fClearColorBuffer)
-		colorBuffer->clearTile(tileX, tileY, fClearColor);
+		colorBuffer->clearTile(tileX, tileY, fClearColor, tile.begin() == tile.end());
+	else
+		colorBuffer->prefetchTile(tileX, tileY);
 
 	// Initialize Z-Buffer to -infinity
 	if (fRenderTarget->getDepthBuffer())
@@ -80,6 +80,37 @@ inline vecf16_t maxfv(vecf16_t a, vecf16_t b)
 	return __builtin_nyuzi_vector_mixf(__builtin_nyuzi_mask_cmpf_lt(a, b), b, a);
 }
 
+// Fused multiply-add: a * b + c, with a single rounding. The compiler doesn't
+// know about this instruction, so it is emitted with inline assembly. The
+// addend is in the mask register field of the instruction, so one of the
+// three operands must be a scalar. Without NYUZI_ISA_EXTENSIONS, this is a
+// separate multiply and add, which round twice.
+#ifdef NYUZI_ISA_EXTENSIONS
+inline vecf16_t fmaddfv(vecf16_t a, float b, vecf16_t c)
+{
+	vecf16_t result;
+	asm("fmadd_f %0, %1, %2, %3" : "=v" (result) : "v" (a), "s" (b), "v" (c));
+	return result;
+}
+
+inline vecf16_t fmaddfv(vecf16_t a, vecf16_t b, float c)
+{
+	vecf16_t result;
+	asm("fmadd_f %0, %1, %2, %3" : "=v" (result) : "v" (a), "v" (b), "s" (c));
+	return result;
+}
+#else
+inline vecf16_t fmaddfv(vecf16_t a, float b, vecf16_t c)
+{
+	return a * splatf(b) + c;
+}
+
+inline vecf16_t fmaddfv(vecf16_t a, vecf16_t b, float c)
+{
+	return a * b + splatf(c);
+}
+#endif
+
 // Ensure all values in this vector are between 0.0 and 1.0
 inline vecf16_t clampfv(vecf16_t in)
 {
@@ -103,25 +134,348 @@ inline vecf16_t absfv(vecf16_t in)
 	return veci16_t(in) & splati(0x7fffffff);
 }
 
-// Newton's method vector square root.
-inline vecf16_t sqrtfv(vecf16_t value)
+// Reciprocal square root estimate, with 6 bits of accuracy. Without
+// NYUZI_ISA_EXTENSIONS, this uses the "Quake" bit trick, which is about as
+// accurate. The integer casts reinterpret the bits and don't convert.
+inline vecf16_t rsqrtestfv(vecf16_t value)
 {
-	vecf16_t guess = value;
-	for (int iteration = 0; iteration < 6; iteration++)
-		guess = ((value / guess) + guess) / splatf(2.0f);
+#ifdef NYUZI_ISA_EXTENSIONS
+	vecf16_t result;
+	asm("rsqrt %0, %1" : "=v" (result) : "v" (value));
+	return result;
+#else
+	return vecf16_t(splati(0x5f3759df) - (veci16_t(value) >> splati(1)));
+#endif
+}
 
-	return guess;
+// Horizontal operations, which combine all lanes of a vector into one value
+// without moving them through scalar registers. Without NYUZI_ISA_EXTENSIONS,
+// these loop over the lanes.
+#ifdef NYUZI_ISA_EXTENSIONS
+inline int hsumiv(veci16_t v)
+{
+	int result;
+	asm("hadd_i %0, %1" : "=s" (result) : "v" (v));
+	return result;
+}
+
+inline int hminiv(veci16_t v)
+{
+	int result;
+	asm("hmin_i %0, %1" : "=s" (result) : "v" (v));
+	return result;
+}
+
+inline int hmaxiv(veci16_t v)
+{
+	int result;
+	asm("hmax_i %0, %1" : "=s" (result) : "v" (v));
+	return result;
+}
+
+inline float hminfv(vecf16_t v)
+{
+	float result;
+	asm("hmin_f %0, %1" : "=s" (result) : "v" (v));
+	return result;
 }
 
-// "Quake" fast inverse square root
-// The integer casts here do not perform float/int conversions
-// but just interpret the numbers directly as the opposite type.
+inline float hmaxfv(vecf16_t v)
+{
+	float result;
+	asm("hmax_f %0, %1" : "=s" (result) : "v" (v));
+	return result;
+}
+#else
+inline int hsumiv(veci16_t v)
+{
+	int result = v[0];
+	for (int i = 1; i < 16; i++)
+		result += v[i];
+
+	return result;
+}
+
+inline int hminiv(veci16_t v)
+{
+	int result = v[0];
+	for (int i = 1; i < 16; i++)
+		result = min(result, v[i]);
+
+	return result;
+}
+
+inline int hmaxiv(veci16_t v)
+{
+	int result = v[0];
+	for (int i = 1; i < 16; i++)
+		result = max(result, v[i]);
+
+	return result;
+}
+
+inline float hminfv(vecf16_t v)
+{
+	float result = v[0];
+	for (int i = 1; i < 16; i++)
+		result = min(result, v[i]);
+
+	return result;
+}
+
+inline float hmaxfv(vecf16_t v)
+{
+	float result = v[0];
+	for (int i = 1; i < 16; i++)
+		result = max(result, v[i]);
+
+	return result;
+}
+#endif
+
+// There is no floating point horizontal add instruction, so fold the vector
+// in half four times. This is eight instructions instead of fifteen lane
+// extractions and adds.
+inline float hsumfv(vecf16_t v)
+{
+	v += __builtin_shufflevector(v, v, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+	v += __builtin_shufflevector(v, v, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11);
+	v += __builtin_shufflevector(v, v, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+	v += __builtin_shufflevector(v, v, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	return v[0];
+}
+
+// Move the elements selected by mask (bit 15 is element 0) to the start of
+// the vector, keeping them in order. The remaining elements are zero.
+inline veci16_t compressiv(veci16_t v, int mask)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	veci16_t result;
+	asm("compress %0, %1, %2" : "=v" (result) : "v" (v), "s" (mask));
+	return result;
+#else
+	veci16_t result = splati(0);
+	int count = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask & (0x8000 >> i))
+			result[count++] = v[i];
+	}
+
+	return result;
+#endif
+}
+
+// Packed unsigned byte arithmetic. Each lane holds four 8 bit fields, which
+// are handled independently. Without NYUZI_ISA_EXTENSIONS, these shift and
+// mask each field.
+#ifdef NYUZI_ISA_EXTENSIONS
+inline veci16_t addsu8v(veci16_t a, veci16_t b)
+{
+	veci16_t result;
+	asm("adds_u8 %0, %1, %2" : "=v" (result) : "v" (a), "v" (b));
+	return result;
+}
+
+// (a * b) >> 8 for each field
+inline veci16_t mulhiu8v(veci16_t a, veci16_t b)
+{
+	veci16_t result;
+	asm("mulhi_u8 %0, %1, %2" : "=v" (result) : "v" (a), "v" (b));
+	return result;
+}
+
+// Zero extend the byte at index in each lane (0 is the least significant).
+inline veci16_t unpacku8v(veci16_t packed, veci16_t index)
+{
+	veci16_t result;
+	asm("unpack_u8 %0, %1, %2" : "=v" (result) : "v" (packed), "v" (index));
+	return result;
+}
+
+// (high << 8) | low, where low is clamped to 0-255.
+inline veci16_t packu8v(veci16_t high, veci16_t low)
+{
+	veci16_t result;
+	asm("pack_u8 %0, %1, %2" : "=v" (result) : "v" (high), "v" (low));
+	return result;
+}
+#else
+inline veci16_t addsu8v(veci16_t a, veci16_t b)
+{
+	vecu16_t result = splatu(0);
+	for (unsigned int shift = 0; shift < 32; shift += 8)
+	{
+		vecu16_t sum = ((vecu16_t(a) >> splatu(shift)) & splatu(0xff))
+			+ ((vecu16_t(b) >> splatu(shift)) & splatu(0xff));
+		result |= saturateuv<0xff>(sum) << splatu(shift);
+	}
+
+	return veci16_t(result);
+}
+
+// (a * b) >> 8 for each field
+inline veci16_t mulhiu8v(veci16_t a, veci16_t b)
+{
+	vecu16_t result = splatu(0);
+	for (unsigned int shift = 0; shift < 32; shift += 8)
+	{
+		vecu16_t product = ((vecu16_t(a) >> splatu(shift)) & splatu(0xff))
+			* ((vecu16_t(b) >> splatu(shift)) & splatu(0xff));
+		result |= (product >> splatu(8)) << splatu(shift);
+	}
+
+	return veci16_t(result);
+}
+
+// Zero extend the byte at index in each lane (0 is the least significant).
+inline veci16_t unpacku8v(veci16_t packed, veci16_t index)
+{
+	return veci16_t((vecu16_t(packed) >> (vecu16_t(index & splati(3)) * splatu(8)))
+		& splatu(0xff));
+}
+
+// (high << 8) | low, where low is clamped to 0-255.
+inline veci16_t packu8v(veci16_t high, veci16_t low)
+{
+	veci16_t clamped = __builtin_nyuzi_vector_mixi(__builtin_nyuzi_mask_cmpi_sgt(splati(0), low),
+		splati(0), low);
+	return (high << splati(8)) | veci16_t(saturateuv<0xff>(vecu16_t(clamped)));
+}
+#endif
+
+// Take the byte at bit offset shift in each lane and convert it to a float
+// from 0.0 to 1.0 (byte / 255.0). This is used to unpack color channels.
+// Without NYUZI_ISA_EXTENSIONS, this multiplies by 1 / 255, which may be
+// one bit less accurate.
+inline vecf16_t unorm8fv(veci16_t packed, int shift)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	vecf16_t result;
+	asm("unorm8_f %0, %1, %2" : "=v" (result) : "v" (packed), "s" (shift));
+	return result;
+#else
+	return __builtin_convertvector((packed >> splati(shift)) & splati(255), vecf16_t)
+		* splatf(1.0f / 255.0f);
+#endif
+}
+
+// Convert the half precision float in the low (select = 0) or high (select = 1)
+// 16 bits of each lane to single precision. Without NYUZI_ISA_EXTENSIONS,
+// this rebiases the exponent with integer operations.
+inline vecf16_t htofv(veci16_t packed, int select)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	vecf16_t result;
+	asm("htof %0, %1, %2" : "=v" (result) : "v" (packed), "s" (select));
+	return result;
+#else
+	veci16_t half = (packed >> splati((select & 1) * 16)) & splati(0xffff);
+	veci16_t magnitude = half & splati(0x7fff);
+	veci16_t sign = (half & splati(0x8000)) << splati(16);
+	veci16_t normal = (magnitude << splati(13)) + splati(112 << 23);
+	veci16_t infNan = (magnitude << splati(13)) | splati(0x7f800000);
+
+	// Subnormals (and zero) are the significand times 2^-24
+	veci16_t subnormal = veci16_t(__builtin_convertvector(magnitude, vecf16_t)
+		* splatf(1.0f / 16777216.0f));
+	veci16_t result = __builtin_nyuzi_vector_mixi(__builtin_nyuzi_mask_cmpi_sge(magnitude,
+		splati(0x7c00)), infNan, normal);
+	result = __builtin_nyuzi_vector_mixi(__builtin_nyuzi_mask_cmpi_sgt(splati(0x400),
+		magnitude), subnormal, result);
+	return vecf16_t(result | sign);
+#endif
+}
+
+// (high << 16) | value, where value is rounded to half precision. Calling
+// this twice packs two vectors of floats. Without NYUZI_ISA_EXTENSIONS, this
+// converts each lane with integer operations.
+inline veci16_t ftohv(veci16_t high, vecf16_t value)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	veci16_t result;
+	asm("ftoh %0, %1, %2" : "=v" (result) : "v" (high), "v" (value));
+	return result;
+#else
+	vecu16_t bits = vecu16_t(value);
+	veci16_t result = high << splati(16);
+	for (int lane = 0; lane < 16; lane++)
+	{
+		unsigned int sign = (bits[lane] >> 16) & 0x8000;
+		unsigned int magnitude = bits[lane] & 0x7fffffff;
+		unsigned int exponent = magnitude >> 23;
+		unsigned int half;
+
+		if (magnitude > 0x7f800000)
+			half = 0x7e00 | ((magnitude >> 13) & 0x3ff);	// NaN (quiet)
+		else if (magnitude >= 0x477ff000)
+			half = 0x7c00;	// Rounds to infinity
+		else if (exponent < 113)
+		{
+			// Subnormal. Shift the significand so the result is in units of
+			// 2^-24, then round to nearest even.
+			unsigned int shift = 126 - exponent;
+			unsigned int significand = (magnitude & 0x7fffff) | 0x800000;
+			if (shift > 24)
+				half = 0;
+			else
+			{
+				unsigned int remainder = significand & ((1u << shift) - 1);
+				unsigned int halfway = 1u << (shift - 1);
+				half = significand >> shift;
+				if (remainder > halfway || (remainder == halfway && (half & 1)))
+					half++;
+			}
+		}
+		else
+		{
+			// Normal. A carry out of the significand increments the exponent.
+			unsigned int remainder = magnitude & 0x1fff;
+			half = (magnitude - (112 << 23)) >> 13;
+			if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+				half++;
+		}
+
+		result[lane] |= static_cast<int>(sign | half);
+	}
+
+	return result;
+#endif
+}
+
+// Refine the reciprocal square root estimate with Newton's method. Each
+// iteration roughly doubles the number of accurate bits. With
+// NYUZI_ISA_EXTENSIONS, this does two, which gives almost full single
+// precision. Otherwise it does one, as the original "Quake" version did, so
+// results don't change.
 inline vecf16_t isqrtfv(vecf16_t number)
 {
 	vecf16_t x2 = number * splatf(0.5f);
-	vecf16_t y = vecf16_t(splati(0x5f3759df) - (veci16_t(number) >> splati(1)));
+	vecf16_t y = rsqrtestfv(number);
 	y = y * (splatf(1.5f) - (x2 * y * y));
+#ifdef NYUZI_ISA_EXTENSIONS
+	y = y * (splatf(1.5f) - (x2 * y * y));
+#endif
 	return y;
 }
 
+#ifdef NYUZI_ISA_EXTENSIONS
+// sqrt(x) = x * (1 / sqrt(x)). The reciprocal square root of zero is
+// infinity, so that case is handled separately.
+inline vecf16_t sqrtfv(vecf16_t value)
+{
+	return __builtin_nyuzi_vector_mixf(__builtin_nyuzi_mask_cmpf_gt(value, splatf(0.0f)),
+		value * isqrtfv(value), splatf(0.0f));
+}
+#else
+inline vecf16_t sqrtfv(vecf16_t value)
+{
+	vecf16_t guess = value;
+	for (int iteration = 0; iteration < 6; iteration++)
+		guess = ((value / guess) + guess) / splatf(2.0f);
+
+	return guess;
+}
+#endif
+
 }
@@ -123,3 +123,21 @@ void Surface::flushTile(int left, int top)
 		ptr += kStride;
 	}
 }
+
+void Surface::prefetchTile(int left, int top) const
+{
+	unsigned int ptr = fBaseAddress + (left + top * fWidth) * kBytesPerPixel;
+	int right = min(kTileSize, fWidth - left);
+	int bottom = min(kTileSize, fHeight - top);
+	const int kStride = (fWidth - right) * kBytesPerPixel;
+	for (int y = 0; y < bottom; y++)
+	{
+		for (int x = 0; x < right; x += 16)
+		{
+			prefetchLine(ptr);
+			ptr += kCacheLineSize;
+		}
+
+		ptr += kStride;
+	}
+}
@@ -29,6 +29,30 @@ const int kCacheLineSize = 64;
 const int kBytesPerPixel = 4;
 const int kTileSize = 64;
 
+// Start loading the cache line that contains this address into the L2
+// cache. This doesn't wait for the load to finish and doesn't fault if the
+// address is invalid. This does nothing without NYUZI_ISA_EXTENSIONS.
+inline void prefetchLine(unsigned int address)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	asm("dtouch %0" : : "s" (address));
+#else
+	(void) address;
+#endif
+}
+
+// Write an entire cache line without allocating it in the L2 cache. If the
+// line isn't already cached, the data goes directly to system memory.
+// Without NYUZI_ISA_EXTENSIONS, this is a normal vector store.
+inline void storeLineNoAllocate(veci16_t *ptr, veci16_t value)
+{
+#ifdef NYUZI_ISA_EXTENSIONS
+	asm("store_v_na %0, (%1)" : : "v" (value), "s" (ptr) : "memory");
+#else
+	*ptr = value;
+#endif
+}
+
 static_assert(__builtin_clz(kTileSize) & 1, "Tile size must be power of four");
 
 //
@@ -71,8 +95,10 @@ public:
 		return __builtin_nyuzi_gather_loadi(ptrs);
 	}
 
-	// Set all 32-bit values in a tile to a predefined value.
-	void clearTile(int left, int top, unsigned int value)
+	// Set all 32-bit values in a tile to a predefined value. If noAllocate
+	// is set, the tile isn't loaded into the L2 cache. This is faster if
+	// nothing else will be drawn into the tile, but slower otherwise.
+	void clearTile(int left, int top, unsigned int value, bool noAllocate = false)
 	{
 		if (kTileSize == 64 && fWidth - left >= 64 && fHeight - top >= 64)
 		{
@@ -82,10 +108,21 @@ public:
 			const int kStride = fStride / kCacheLineSize;
 			for (int y = 0; y < 64; y++)
 			{
-				ptr[0] = vval;
-				ptr[1] = vval;
-				ptr[2] = vval;
-				ptr[3] = vval;
+				if (noAllocate)
+				{
+					storeLineNoAllocate(ptr, vval);
+					storeLineNoAllocate(ptr + 1, vval);
+					storeLineNoAllocate(ptr + 2, vval);
+					storeLineNoAllocate(ptr + 3, vval);
+				}
+				else
+				{
+					ptr[0] = vval;
+					ptr[1] = vval;
+					ptr[2] = vval;
+					ptr[3] = vval;
+				}
+
 				ptr += kStride;
 			}
 		}
@@ -96,6 +133,9 @@ public:
 	// Push a tile from the L2 cache back to system memory
 	void flushTile(int left, int top);
 
+	// Start loading a tile into the L2 cache without waiting for it.
+	void prefetchTile(int left, int top) const;
+
 	veci16_t readPixels(veci16_t tx, veci16_t ty, unsigned short mask) const
 	{
 		veci16_t pointers = (ty * splati(fStride) + tx * splati(kBytesPerPixel))
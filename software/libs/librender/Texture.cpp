@@ -25,20 +25,14 @@ using namespace librender;
 
 namespace {
 
-const float kOneOver255 = 1.0 / 255.0;
-
 // Convert a 32-bit RGBA color (packed in an integer) into four floating point (0.0 - 1.0)
 // color channels.
-void unpackRGBA(veci16_t packedColor, vecf16_t outColor[3])
+void unpackRGBA(veci16_t packedColor, vecf16_t outColor[4])
 {
-	outColor[kColorR] = __builtin_convertvector(packedColor & splati(255), vecf16_t)
-		* splatf(kOneOver255);
-	outColor[kColorG] = __builtin_convertvector((packedColor >> splati(8)) & splati(255),
-		vecf16_t) * splatf(kOneOver255);
-	outColor[kColorB] = __builtin_convertvector((packedColor >> splati(16)) & splati(255),
-		vecf16_t) * splatf(kOneOver255);
-	outColor[kColorA] = __builtin_convertvector((packedColor >> splati(24)) & splati(255),
-		vecf16_t) * splatf(kOneOver255);
+	outColor[kColorR] = unorm8fv(packedColor, 0);
+	outColor[kColorG] = unorm8fv(packedColor, 8);
+	outColor[kColorB] = unorm8fv(packedColor, 16);
+	outColor[kColorA] = unorm8fv(packedColor, 24);
 }
 
 }
@@ -88,6 +82,30 @@ namespace
 		return __builtin_nyuzi_vector_mixi(__builtin_nyuzi_mask_cmpf_lt(in, splati(max)),
 			in, splati(0));
 	}
+
+#ifdef NYUZI_ISA_EXTENSIONS
+	// Bilinear filtered sample of each lane with the load_sample instruction.
+	// Bits 23-0 of u and v are the fraction of the width and height and bits
+	// 27-24 are log2 of them. The result is packed RGBA, like a texel.
+	inline veci16_t sampleBilinear(const Surface *surface, veci16_t u, veci16_t v,
+		unsigned short mask)
+	{
+		veci16_t result;
+		asm("load_sample %0, %1, %2, %3, %4" : "=v" (result) : "s" (mask), "v" (u),
+			"v" (v), "s" (surface->bits()));
+		return result;
+	}
+
+	// The sampler requires rows of packed texels with power of two dimensions.
+	inline bool canSampleBilinear(const Surface *surface)
+	{
+		int width = surface->getWidth();
+		int height = surface->getHeight();
+		return (width & (width - 1)) == 0 && width <= 0x8000
+			&& (height & (height - 1)) == 0 && height <= 0x8000
+			&& surface->getStride() == width * kBytesPerPixel;
+	}
+#endif
 }
 
 void Texture::readPixels(vecf16_t u, vecf16_t v, unsigned short mask,
@@ -106,6 +124,23 @@ void Texture::readPixels(vecf16_t u, vecf16_t v, unsigned short mask,
 	int mipWidth = surface->getWidth();
 	int mipHeight = surface->getHeight();
 
+#ifdef NYUZI_ISA_EXTENSIONS
+	if (fEnableBilinearFiltering && canSampleBilinear(surface))
+	{
+		// Scale the coordinates so the texel positions and weights are the
+		// same as below: the sampler multiplies by the size, not size - 1.
+		const int widthBits = 31 - __builtin_clz(mipWidth);
+		const int heightBits = 31 - __builtin_clz(mipHeight);
+		vecf16_t uScaled = wrapfv(fracfv(u)) * splatf((mipWidth - 1) * (16777216.0f / mipWidth));
+		vecf16_t vScaled = (splatf(1.0) - wrapfv(fracfv(v)))
+			* splatf((mipHeight - 1) * (16777216.0f / mipHeight));
+		veci16_t uFixed = __builtin_convertvector(uScaled, veci16_t) | splati(widthBits << 24);
+		veci16_t vFixed = __builtin_convertvector(vScaled, veci16_t) | splati(heightBits << 24);
+		unpackRGBA(sampleBilinear(surface, uFixed, vFixed, mask), outColor);
+		return;
+	}
+#endif
+
 	// Convert from texture space (0.0-1.0, 1.0-0.0) to raster coordinates
 	// (0-(width - 1), 0-(height - 1)). Note that the top of the texture corresponds
 	// to v of 1.0. Coordinates wrap.
@@ -126,6 +161,14 @@ void Texture::readPixels(vecf16_t u, vecf16_t v, unsigned short mask,
 		veci16_t xPlusOne = wrapiv(tx + splati(1), mipWidth);
 		veci16_t yPlusOne = wrapiv(ty + splati(1), mipHeight);
 
+		// The bottom row of texels is usually on different cache lines than
+		// the top. Start loading the first and last ones so they are on the
+		// way while the top row is gathered.
+		const unsigned int bitsBase = reinterpret_cast<unsigned int>(surface->bits());
+		const int stride = surface->getStride();
+		prefetchLine(bitsBase + yPlusOne[0] * stride + tx[0] * kBytesPerPixel);
+		prefetchLine(bitsBase + yPlusOne[15] * stride + tx[15] * kBytesPerPixel);
+
 		unpackRGBA(surface->readPixels(tx, ty, mask), tlColor);
 		unpackRGBA(surface->readPixels(tx, yPlusOne, mask), blColor);
 		unpackRGBA(surface->readPixels(xPlusOne, ty, mask), trColor);
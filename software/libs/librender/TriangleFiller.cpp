@@ -185,7 +185,7 @@ void TriangleFiller::fillMasked(int left, int top, unsigned short mask)
 	veci16_t gS = __builtin_convertvector(clampfv(color[kColorG]) * splatf(255.0f), veci16_t);
 	veci16_t bS = __builtin_convertvector(clampfv(color[kColorB]) * splatf(255.0f), veci16_t);
 
-	veci16_t pixelValues;
+	veci16_t pixelValues = splati(0xff000000) | rS | (gS << splati(8)) | (bS << splati(16));
 
 	// If all pixels are fully opaque, don't bother trying to blend them.
 	if (fState->fEnableBlend
@@ -195,19 +195,12 @@ void TriangleFiller::fillMasked(int left, int top, unsigned short mask)
 			& splati(0xff);
 		veci16_t oneMinusAS = splati(255) - aS;
 
+		// Premultiplied alpha. All channels of the destination are scaled by
+		// 1 - alpha at once with packed byte operations, then the source is
+		// added with saturation. Alpha saturates to 0xff.
 		veci16_t destColors = fTarget->getColorBuffer()->readBlock(left, top);
-		veci16_t rD = destColors & splati(0xff);
-		veci16_t gD = (destColors >> splati(8)) & splati(0xff);
-		veci16_t bD = (destColors >> splati(16)) & splati(0xff);
-
-		// Premultiplied alpha
-		veci16_t newR = saturateuv<255>(((rS << splati(8)) + (rD * oneMinusAS)) >> splati(8));
-		veci16_t newG = saturateuv<255>(((gS << splati(8)) + (gD * oneMinusAS)) >> splati(8));
-		veci16_t newB = saturateuv<255>(((bS << splati(8)) + (bD * oneMinusAS)) >> splati(8));
-		pixelValues = splati(0xff000000) | newR | (newG << splati(8)) | (newB << splati(16));
+		pixelValues = addsu8v(pixelValues, mulhiu8v(destColors, oneMinusAS * splati(0x01010101)));
 	}
-	else
-		pixelValues = splati(0xff000000) | rS | (gS << splati(8)) | (bS << splati(16));
 
 	fTarget->getColorBuffer()->writeBlockMasked(left, top, mask, pixelValues);
 }
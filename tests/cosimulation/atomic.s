@@ -0,0 +1,94 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Atomic read-modify-write instructions. These return the old value in the
+# source register. The first access to each variable misses in the L2 cache,
+# so this checks both the fill and hit paths. Loading the variable afterward
+# checks the value that was stored.
+#
+
+			.globl _start
+_start:		lea s0, counter
+			move s1, 5
+			atomic_add s1, (s0)		# Miss
+			move s2, -7
+			atomic_add s2, (s0)		# Hit
+			load_32 s3, (s0)
+
+			lea s0, bits
+			move s4, 0xf0f
+			atomic_and s4, (s0)
+			move s5, 0x300
+			atomic_or s5, 4(s0)
+			move s6, 0x55
+			atomic_xor s6, 8(s0)
+			load_32 s7, (s0)
+			load_32 s8, 4(s0)
+			load_32 s9, 8(s0)
+
+			# Exchange
+			lea s0, lock
+			move s10, 1
+			atomic_xchg s10, (s0)		# Gets lock
+			move s11, 1
+			atomic_xchg s11, (s0)		# Already held
+			load_32 s12, (s0)
+
+			# Signed minimum and maximum
+			lea s0, minmax
+			move s13, -3
+			atomic_min s13, (s0)		# Smaller
+			move s14, 2
+			atomic_min s14, (s0)		# Larger, unchanged
+			move s15, 100
+			atomic_max s15, 4(s0)		# Larger
+			move s16, -100
+			atomic_max s16, 4(s0)		# Smaller, unchanged
+			load_32 s17, (s0)
+			load_32 s18, 4(s0)
+
+			# Other words in the line are unchanged
+			load_32 s19, 8(s0)
+
+			# An atomic operation breaks a synchronized load/store pair
+			lea s0, sync_var
+			load_sync s20, (s0)
+			move s21, 1
+			atomic_add s21, (s0)
+			move s22, 12
+			store_sync s22, (s0)		# Should fail
+			load_32 s23, (s0)
+
+			HALT_CURRENT_THREAD
+
+			.align 64
+counter:	.long 10
+
+			.align 64
+bits:		.long 0x12345678, 0x00000ff0, 0xffff0000
+
+			.align 64
+lock:		.long 0
+
+			.align 64
+minmax:		.long 7, 50, 0xdeadbeef
+
+			.align 64
+sync_var:	.long 3
@@ -0,0 +1,45 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Cache hint instructions. These don't change register or memory contents, so
+# this checks that the instructions around them see the expected values.
+#
+
+		.globl _start
+_start:	lea s1, bar
+		dtouch s1		; Prefetch hint, should not have any visible effect
+		load_32 s2, (s1)
+		dtouch s1		; Line is already in L1 cache, should do nothing
+		load_32 s3, 4(s1)
+		dwait s1		; No other thread writes this line, wakes after timeout
+		add_i s4, s3, 1	; Resumes at the following instruction
+		store_32 s4, (s1)
+		dwait s1		; Wakes when this store is acknowledged, or after timeout
+		load_32 s5, (s1)
+		pause			; Scheduling hint, no visible effect
+		move s6, 7
+		setcr s6, CR_THREAD_PRIORITY
+		getcr s7, CR_THREAD_PRIORITY	; Only low two bits are stored, reads back 3
+		pause
+
+		HALT_CURRENT_THREAD
+
+		.align 64
+bar: .long 0x12345678, 0x9abcdef0
@@ -0,0 +1,81 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Fused multiply-add. Each test vector row is a multiplicand, multiplier,
+# and addend. The cases avoid subnormal results, which the hardware flushes
+# to zero.
+#
+
+			.globl _start
+_start:		lea s0, multiplicands
+			load_v v0, (s0)
+			load_v v1, 64(s0)
+			load_v v2, 128(s0)
+			load_v v12, 192(s0)
+
+			# Vector/scalar form, vector addend
+			lea s0, scalars
+			load_32 s1, (s0)
+			load_32 s2, 4(s0)
+			load_32 s3, 8(s0)
+			load_32 s4, 12(s0)
+			fmadd_f v3, v0, s1, v2
+			fmadd_f v4, v1, s2, v2
+			fmadd_f v5, v0, s3, v1
+
+			# Vector/vector form, scalar addend
+			fmadd_f v6, v0, v1, s1
+			fmadd_f v7, v0, v1, s2
+			fmadd_f v8, v1, v2, s3
+
+			# Result is used as an addend (checks the dependency on the
+			# third source register).
+			fmadd_f v9, v0, v1, v2
+			fmadd_f v10, v0, s1, v9
+			fmadd_f v11, v10, v0, s3
+
+			# Cancellation, both forms
+			fmadd_f v13, v12, v12, s3
+			move v14, s3
+			fmadd_f v15, v12, s4, v14
+
+			HALT_CURRENT_THREAD
+
+			.align 64
+multiplicands:
+			.float 1.0, 2.0, -3.5, 17.79, 0.34, 44.23, -1.0, 5.0
+			.float 0.0, -0.0, 1000000.0, 0.0000001, inf, nan, 1.5, 2.25
+			.float 2.0, 3.0, 1.25, 19.32, 44.23, 0.034, 5.0, -1.0
+			.float 5.0, 2.323, 10000000.0, 0.00000001, 0.0, 1.0, -1.5, 0.5
+			.float 1.0, -6.0, 4.375, 0.5, -15.0, 1.0, 5.0, -5.0
+			.float -0.0, 0.0, -1.0, 1.0, -inf, 3.0, 2.25, -1.125
+
+			# Cancellation. The square of this is 1 + 2^-11 + 2^-24, which
+			# isn't representable. When the addend is -(1 + 2^-11), the
+			# result is exactly 2^-24 with a single rounding, but would be 0
+			# if the product was rounded first.
+			.long 0x3f800800, 0x3f800800, 0x3f800800, 0x3f800800
+			.long 0x3f800800, 0x3f800800, 0x3f800800, 0x3f800800
+			.long 0x3f800800, 0x3f800800, 0x3f800800, 0x3f800800
+			.long 0x3f800800, 0x3f800800, 0x3f800800, 0x3f800800
+
+scalars:	.float 1.5, -0.75
+			.long 0xbf801000			; -(1 + 2^-11)
+			.long 0x3f800800			; 1 + 2^-12
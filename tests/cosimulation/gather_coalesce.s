@@ -0,0 +1,123 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Scatter/gather accesses where several lanes use the same cache line. These
+# are serviced together, even if lanes for other lines are between them, so
+# this checks the lanes are split into the same groups as the emulator.
+# Offsets are listed in subcycle order (the first one is lane 15).
+#
+
+			.globl _start
+_start:		lea s0, data
+			lea s1, offsets
+
+			# Two lines, eight lanes each
+			load_v v0, (s1)
+			add_i v0, v0, s0
+			load_gath v1, (v0)
+
+			# Alternating lines. The first subcycle services every other lane
+			# and the second one services the rest.
+			load_v v2, 64(s1)
+			add_i v2, v2, s0
+			load_gath v3, (v2)
+
+			# Four lanes from one line, four from another, then the first line
+			# again. The first subcycle services all lanes from the first line.
+			load_v v4, 128(s1)
+			add_i v4, v4, s0
+			load_gath v5, (v4)
+
+			# Masked off lanes point at another line, but don't break up the
+			# run
+			load_32 s2, mask
+			load_v v6, 192(s1)
+			add_i v6, v6, s0
+			move v7, 0
+			load_gath_mask v7, s2, (v6)
+
+			# Scatters using the same addresses
+			lea s3, scatter_data
+			sub_i v8, v0, s0
+			add_i v8, v8, s3
+			store_scat v1, (v8)
+			sub_i v9, v6, s0
+			add_i v9, v9, s3
+			store_scat_mask v5, s2, (v9)
+
+			# Several lanes write the same word. The last one in subcycle order
+			# must win.
+			load_v v10, 256(s1)
+			add_i v10, v10, s3
+			store_scat v3, (v10)
+
+			# Three lines in turn. Each of the first three subcycles services
+			# one line.
+			load_v v14, 320(s1)
+			add_i v14, v14, s0
+			load_gath v15, (v14)
+
+			# Four lines in turn. Each line has too few lanes to combine.
+			load_v v16, 384(s1)
+			add_i v16, v16, s0
+			load_gath v17, (v16)
+
+			# Alternating lines for a scatter, which overwrites the earlier
+			# scatters. Then four lines in turn.
+			sub_i v18, v2, s0
+			add_i v18, v18, s3
+			store_scat v15, (v18)
+			sub_i v19, v16, s0
+			add_i v19, v19, s3
+			store_scat v1, (v19)
+
+			load_v v11, (s3)
+			load_v v12, 64(s3)
+			load_v v13, 128(s3)
+			load_v v20, 192(s3)
+
+			HALT_CURRENT_THREAD
+
+mask:		.long 0xf0f3
+
+			.align 64
+offsets:	.long 0, 4, 8, 12, 16, 20, 24, 28, 64, 68, 72, 76, 80, 84, 88, 92
+			.long 0, 64, 4, 68, 8, 72, 12, 76, 16, 80, 20, 84, 24, 88, 28, 92
+			.long 60, 56, 52, 48, 124, 120, 116, 112, 32, 36, 40, 44, 0, 4, 8, 12
+			.long 4, 8, 12, 16, 128, 132, 20, 24, 28, 32, 36, 40, 136, 140, 44, 48
+			.long 0, 4, 0, 8, 4, 8, 12, 0, 12, 16, 16, 20, 4, 24, 28, 0
+			.long 0, 64, 128, 4, 68, 132, 8, 72, 136, 12, 76, 140, 16, 80, 144, 20
+			.long 0, 64, 128, 192, 4, 68, 132, 196, 8, 72, 136, 200, 12, 76, 140, 204
+
+			.align 64
+data:		.long 0x2aa7d2c1, 0xeeb91caf, 0x304010ad, 0x96981e0d, 0x3a03b41f, 0x81363fee, 0x32d7bd42, 0xeaa8df61
+			.long 0x9228d73e, 0xfcf12265, 0x2515fbeb, 0x6cd307a0, 0x2c18c1b8, 0xda8e48d5, 0x1f5c4bd2, 0xace51435
+			.long 0x6e8ac4c6, 0x3e6f3d31, 0x56b46c3f, 0xa9e4bd6c, 0x7f2d8b81, 0x14ff2a4b, 0x0a3c5e9d, 0xc39e17c2
+			.long 0x5d6a0de4, 0x8bd7f3a1, 0x4419ac0e, 0xf5e12bb7, 0x23c9d5e6, 0xb70c4f18, 0x9e3a6271, 0x61f0d84a
+			.long 0xd1b3e825, 0x07a95c3e, 0x38f4e16b, 0xe24d9a07, 0x11112222, 0x33334444, 0x55556666, 0x77778888
+			.long 0x9999aaaa, 0xbbbbcccc, 0xddddeeee, 0xffff0000, 0x12121212, 0x34343434, 0x56565656, 0x78787878
+			.long 0x4b2e91d7, 0xa06c3f58, 0x17d9e4b2, 0xc8f1057a, 0x6293ad0e, 0xf47b18c6, 0x2e05d973, 0x89ac6b21
+			.long 0x53f8c40d, 0xbd1e7a96, 0x0c67f2e8, 0xe9a4513b, 0x75d03c8f, 0x3182be54, 0xda4f6019, 0x46e7c3a2
+
+			.align 64
+scatter_data: .long 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+			.long 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+			.long 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+			.long 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
@@ -84,6 +84,23 @@ BINARY_OPS = [
 #   'mul_f'
 ]
 
+# Only generated with -x, because the released toolchain can't assemble them
+EXTENSION_BINARY_OPS = [
+	'unorm8_f',
+	'adds_u8',
+	'subs_u8',
+	'adds_u16',
+	'subs_u16',
+	'mulhi_u8',
+	'mulhi_u16',
+	'unpack_u8',
+	'unpack_u16',
+	'pack_u8',
+	'pack_u16',
+	'htof',
+	'ftoh'
+]
+
 
 def generate_binary_arith(file):
 	mnemonic = random.choice(BINARY_OPS)
@@ -97,7 +114,9 @@ def generate_binary_arith(file):
 		typea = 'v'
 		typeb = 's' if random.randint(0, 1) == 0 else 'i'
 		suffix = ''
-	elif mnemonic.endswith('_f'):
+	elif mnemonic.endswith('_f') or mnemonic[-3:] in ('_u8', 'u16') \
+		or mnemonic in ('htof', 'ftoh'):
+		# No immediate forms
 		typed, typea, typeb, suffix = random.choice(FP_FORMS)
 	else:
 		typed, typea, typeb, suffix = random.choice(INT_FORMS)
@@ -124,6 +143,10 @@ UNARY_OPS = [
 	'move'
 ]
 
+EXTENSION_UNARY_OPS = [
+	'rsqrt'
+]
+
 
 def generate_unary_arith(file):
 	mnemonic = random.choice(UNARY_OPS)
@@ -177,6 +200,34 @@ def generate_compare(file):
 
 	file.write(opstr + '\n')
 
+REDUCE_OPS = [
+	'hadd_i',
+	'hmin_i',
+	'hmax_i',
+	'hmin_f',
+	'hmax_f'
+]
+
+
+def generate_lane_op(file):
+	dest = generate_arith_reg()
+	rega = generate_arith_reg()
+	maskreg = generate_arith_reg()
+	masked = random.randint(0, 1) == 0
+	if random.randint(0, 3) == 0:
+		# Compress, selected by a scalar register
+		if masked:
+			file.write('\t\tcompress_mask v%d, s%d, v%d, s%d\n' % (dest, maskreg, rega,
+				generate_arith_reg()))
+		else:
+			file.write('\t\tcompress v%d, v%d, s%d\n' % (dest, rega, generate_arith_reg()))
+	else:
+		mnemonic = random.choice(REDUCE_OPS)
+		if masked:
+			file.write('\t\t%s_mask s%d, s%d, v%d\n' % (mnemonic, dest, maskreg, rega))
+		else:
+			file.write('\t\t%s s%d, v%d\n' % (mnemonic, dest, rega))
+
 LOAD_OPS = [
 	('_sync', 4),
 	('_32', 4),
@@ -279,6 +330,12 @@ CACHE_CONTROL_INSTRS = [
 	'membar'
 ]
 
+# Only generated with -x, because the released toolchain can't assemble them
+EXTENSION_CACHE_CONTROL_INSTRS = [
+	'dtouch s1',
+	'pause'
+]
+
 
 def generate_cache_control(file):
 	file.write('\t\t%s\n' % random.choice(CACHE_CONTROL_INSTRS))
@@ -431,11 +488,22 @@ parser.add_argument('-n', help='number of instructions to generate per thread',
 	default=60000)
 parser.add_argument('-i', help='Enable interrupts', action='store_true')
 parser.add_argument('-t', help='Number of threads', type=int, default=4)
+parser.add_argument('-x', help='Use instructions from the ISA extensions', action='store_true')
 args = vars(parser.parse_args())
 numInstructions = args['n']
 enableInterrupts = args['i']
 numThreads = args['t']
 
+if args['x']:
+	# Lane operations take their share from binary arithmetic, so branches
+	# are generated as often as before.
+	generate_funcs = [(prob - 0.03 if func == generate_binary_arith else prob, func)
+		for prob, func in generate_funcs]
+	generate_funcs.insert(0, (0.03, generate_lane_op))
+	BINARY_OPS += EXTENSION_BINARY_OPS
+	UNARY_OPS += EXTENSION_UNARY_OPS
+	CACHE_CONTROL_INSTRS += EXTENSION_CACHE_CONTROL_INSTRS
+
 if (numInstructions + 120) * numThreads * 4 > 0x800000:
 	print('Instruction space exceeds available memory.')
 
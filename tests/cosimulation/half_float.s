@@ -0,0 +1,108 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Half precision conversions. The halves cover zeroes, subnormals, the
+# largest and smallest normals, infinities, and NaNs. The floats include
+# values that overflow, underflow, and are exactly halfway between two
+# halves, to check rounding to nearest even.
+#
+
+			.globl _start
+_start:		lea s0, halves
+			load_v v0, (s0)
+			load_v v1, 64(s0)
+
+			# Select the low or high half of each word
+			move s1, 0
+			move s2, 1
+			htof v2, v0, s1
+			htof v3, v0, s2
+			htof v4, v1, s1
+			htof v5, v1, s2
+
+			# Different half in each lane (only bit 0 is used)
+			lea s3, selectors
+			load_v v6, (s3)
+			htof v7, v0, v6
+
+			# Single precision to half. The first converts into the low half,
+			# the second shifts it up and puts the next value below it.
+			lea s4, floats
+			load_v v8, (s4)
+			load_v v9, 64(s4)
+			ftoh v10, v8, v8
+			ftoh v11, v10, v9
+
+			# Round trip
+			htof v12, v11, s1
+			htof v13, v11, s2
+
+			# Scalar and masked forms
+			load_32 s5, (s0)
+			htof s6, s5, s2
+			load_32 s7, 4(s4)
+			ftoh s8, s5, s7
+			load_32 s9, mask
+			htof_mask v14, s9, v1, v6
+			ftoh_mask v15, s9, v0, v9
+
+			HALT_CURRENT_THREAD
+
+mask:		.long 0x5a3c
+
+			.align 64
+halves:		.short 0x0000, 0x8000, 0x3c00, 0xbc00, 0x7bff, 0xfbff, 0x0400, 0x8400
+			.short 0x0001, 0x8001, 0x03ff, 0x0200, 0x0155, 0x8010, 0x7c00, 0xfc00
+			.short 0x7e00, 0xfe00, 0x7c01, 0x7d55, 0x3555, 0xc000, 0x5640, 0x1234
+			.short 0xabcd, 0x4248, 0x0003, 0x07ff, 0x3bff, 0x3c01, 0x2e66, 0xcd00
+			.short 0x0bad, 0xf00d, 0x8123, 0x3800, 0x0041, 0x6000, 0x4900, 0xfd01
+			.short 0x7801, 0x8200, 0x1c00, 0x9c00, 0x3e00, 0xbe00, 0x4000, 0x0002
+			.short 0x5555, 0xaaaa, 0x7fff, 0xffff, 0x0100, 0x8300, 0x33ff, 0x3401
+			.short 0x7000, 0xe400, 0x0180, 0x0080, 0x3a00, 0x4e00, 0x5800, 0x8003
+
+			.align 64
+selectors:	.long 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+
+			.align 64
+floats:		.float 1.0, -1.0, 65504.0, 65519.0, 65520.0, -100000.0, 0.1, 3.14159
+			.long 0x33800000			; 2^-24, smallest subnormal half
+			.long 0x33000000			; 2^-25, halfway to zero, rounds to even (0)
+			.long 0x33000001			; Just over halfway, rounds up
+			.long 0x33c00000			; 1.5 * 2^-24, halfway, rounds up to even
+			.long 0x387fc000			; Largest subnormal half
+			.long 0x387ff000			; Rounds up to the smallest normal half
+			.long 0x3f801000			; 1 + 2^-11, halfway, rounds down to even
+			.long 0x3f803000			; 1 + 3 * 2^-11, halfway, rounds up to even
+			.long 0x7fc00000			; NaN
+			.long 0x7f800001			; Signaling NaN, becomes quiet
+			.long 0xff812345			; NaN with payload
+			.long 0x7f800000			; Inf
+			.long 0xff800000			; -Inf
+			.long 0x80000000			; -0.0
+			.long 0x00000001			; Single precision subnormal
+			.long 0xae000000			; Too small, -0.0
+			.long 0x477fe000			; 65504, largest half
+			.long 0x477fefff			; Just under halfway to 65536, rounds down
+			.long 0x477ff000			; Halfway, rounds up to infinity
+			.long 0x38800000			; 2^-14, smallest normal half
+			.long 0x3a800fff			; Rounds down
+			.long 0x3a801001			; Rounds up
+			.long 0x34000000			; 2^-23, subnormal half 2
+			.long 0x34400000			; 3 * 2^-24, exactly representable
@@ -0,0 +1,71 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Horizontal reductions and compress. The floating point reductions depend
+# on the order lanes are combined when there are NaNs, so they must match
+# the emulator exactly.
+#
+
+			.globl _start
+_start:		lea s0, ints
+			load_v v0, (s0)
+			load_v v1, 64(s0)
+			lea s19, mask
+			load_32 s1, (s19)
+
+			hadd_i s2, v0
+			hmin_i s3, v0
+			hmax_i s4, v0
+			hadd_i_mask s5, s1, v0
+			hmin_i_mask s6, s1, v0
+			hmax_i_mask s7, s1, v0
+			move s8, 0
+			hmin_i_mask s9, s8, v0				; No lanes, returns identity
+
+			hmin_f s10, v1
+			hmax_f s11, v1
+			hmin_f_mask s12, s1, v1
+			hmax_f_mask s13, s1, v1
+			lea s14, nans
+			load_v v2, (s14)
+			hmin_f s15, v2
+			hmax_f s16, v2
+
+			compress v3, v0, s1
+			move s17, -1
+			compress v4, v0, s17				; Nothing moves
+			compress v5, v0, s8					; All zero
+			load_32 s18, 4(s19)
+			compress_mask v6, s18, v0, s1
+
+			HALT_CURRENT_THREAD
+
+mask:		.long 0x3c71, 0x5a5a
+
+			.align 64
+ints:		.long 5, -17, 99, 0x7fffffff, -1, 0, 42, 0x80000000
+			.long 8, 1000, -1000, 3, 77, -77, 12, 65535
+floats:		.float 1.0, -2.5, 3.75, -0.0, 0.0, 100.0, -100.0, 0.001
+			.float inf, -inf, 7.5, -7.5, 2.0, 1e30, -1e30, 6.25
+
+			# NaNs in different positions of the tree
+			.align 64
+nans:		.float 1.0, nan, -3.0, 4.0, nan, 2.0, 8.0, -8.0
+			.float 0.5, 0.25, nan, nan, -0.0, 0.0, 16.0, -16.0
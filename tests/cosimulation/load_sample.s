@@ -0,0 +1,73 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Bilinear texture samples, which checks the texel addresses and filter
+# rounding against the emulator. The texture is 8x4, which is two cache lines,
+# so samples on the second or last row read texels from both. Some lanes
+# use smaller sizes, including 1 texel wide and high. Coordinates near 1.0
+# wrap to the left column and top row.
+#
+
+			.globl _start
+_start:		lea s0, texture
+			lea s1, coords
+			load_v v0, (s1)					; u
+			load_v v1, 64(s1)				; v
+			move s2, -1
+			load_sample v2, s2, v0, v1, s0
+
+			# Masked off lanes keep the old value
+			load_v v3, (s0)
+			move s3, 0x5a5a
+			load_sample v3, s3, v0, v1, s0
+
+			# Texture not aligned to a cache line, so more texels of each
+			# sample are on different lines.
+			add_i s4, s0, 4
+			load_sample v4, s2, v0, v1, s4
+
+			# Masked off lanes don't access memory, so an unaligned base
+			# doesn't fault.
+			move s5, 0
+			add_i s6, s0, 2
+			load_sample v5, s5, v0, v1, s6
+
+			HALT_CURRENT_THREAD
+
+			.align 64
+coords:		.long 0x03000000, 0x03ffffff, 0x03800000, 0x03123456
+			.long 0x03e00000, 0x03e80000, 0x033ab1c0, 0x037fffff
+			.long 0x02010000, 0x02f00001, 0x03555555, 0x03aaaaaa
+			.long 0x001fffff, 0x03c00000, 0x019d0f00, 0x03640000
+			.long 0x02000000, 0x02ffffff, 0x02400000, 0x02654321
+			.long 0x02e00000, 0x027f0000, 0x02c08000, 0x02200000
+			.long 0x015fffff, 0x02a00000, 0x02333333, 0x02deadbe
+			.long 0x020c0000, 0x00900000, 0x02f80000, 0x014a0000
+
+			.align 64
+texture:	.long 0x6895cea8, 0x85201011, 0x8abead78, 0xb39cfd4b
+			.long 0xdcae6e9f, 0x1ddd2106, 0x2d39f5ab, 0x612b6cd5
+			.long 0x39a40dfe, 0x4a212290, 0x0772eaea, 0x39850d17
+			.long 0x1ddccf2d, 0x91959d9d, 0x024115e4, 0x19a56746
+			.long 0x281cdb93, 0xc64235eb, 0x8382b56e, 0xb0567812
+			.long 0xfd4f6854, 0x4d90437b, 0xb189e370, 0xa24eb80d
+			.long 0x60e09044, 0x974b9753, 0x67b13551, 0xc41edca6
+			.long 0xb0f9aafc, 0xab8755c5, 0x537c9792, 0x5bb88633
+			.long 0x12d465da, 0x56bcf77c, 0xd76e0b6f, 0x4860f7d0	; For the unaligned texture
@@ -0,0 +1,76 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Packed byte and halfword operations. Each lane has fields that overflow,
+# underflow, and don't, to check that carries don't cross fields.
+#
+
+			.globl _start
+_start:		lea s0, values
+			load_v v0, (s0)
+			load_v v1, 64(s0)
+
+			adds_u8 v2, v0, v1
+			subs_u8 v3, v0, v1
+			adds_u16 v4, v0, v1
+			subs_u16 v5, v0, v1
+			mulhi_u8 v6, v0, v1
+			mulhi_u16 v7, v0, v1
+
+			# Unpack with a different field in each lane
+			lea s1, indices
+			load_v v8, (s1)
+			unpack_u8 v9, v0, v8
+			unpack_u16 v10, v0, v8
+
+			# Build pixels one channel at a time. Channels that are out of
+			# range are clamped.
+			load_v v11, 64(s1)
+			move v12, 0xff
+			pack_u8 v12, v12, v11
+			pack_u8 v12, v12, v1
+			pack_u16 v13, v0, v11
+
+			# Scalar and masked forms
+			load_32 s2, (s0)
+			load_32 s3, 64(s0)
+			adds_u8 s4, s2, s3
+			mulhi_u16 s5, s2, s3
+			load_32 s6, mask
+			subs_u8_mask v14, s6, v0, s3
+
+			HALT_CURRENT_THREAD
+
+mask:		.long 0xa5c3
+
+			.align 64
+values:		.long 0xff7f8001, 0x12345678, 0xffffffff, 0x00000000
+			.long 0x80808080, 0x7f7f7f7f, 0x01020304, 0xfedcba98
+			.long 0x0000ffff, 0xffff0000, 0x7fff8000, 0x8000ffff
+			.long 0xdeadbeef, 0xc0ffee00, 0x55aa55aa, 0xaa55aa55
+			.long 0x01ff7f80, 0x87654321, 0x00000001, 0xffffffff
+			.long 0x80808080, 0x81818181, 0x04030201, 0x01020304
+			.long 0xffff0001, 0x0001ffff, 0x80017fff, 0x8000ffff
+			.long 0x12345678, 0x3ff11200, 0xaa55aa55, 0xaa55aa55
+
+			.align 64
+indices:	.long 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+clamped:	.long 0, 255, 256, -1, 0x7fffffff, 0x80000000, 128, 65535
+			.long 65536, 1, -255, 300, 0x10000, 254, 0xffff, 70000
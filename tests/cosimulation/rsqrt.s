@@ -0,0 +1,52 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# Reciprocal square root estimate. Covers both halves of the lookup table
+# (even and odd exponents) and the special cases.
+#
+
+			.globl _start
+_start:		lea s0, ops
+			lea s15, end
+test_loop:	load_32 s1, (s0)
+			rsqrt s2, s1
+			add_i s0, s0, 4
+			cmpge_i s3, s0, s15
+			bfalse s3, test_loop
+
+			load_v v0, vecops
+			rsqrt v1, v0
+
+			HALT_CURRENT_THREAD
+
+ops:		.float 1.0, 2.0, 4.0, 0.25, 3.0, 100.0, 12345.678
+			.float 1e-30, 1e30
+			.long 0x3f7fffff				; Largest value below 1.0
+			.long 0x7f7fffff				; Largest finite value
+			.long 0x00000001				; Smallest subnormal
+			.long 0x007fffff				; Largest subnormal
+			.float 0.0, -0.0				; Infinity with the same sign
+			.float -1.0						; Negative, NaN
+			.float inf, nan
+end: 		.long 0
+
+			.align 64
+vecops:		.float 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5
+			.float 8.5, 9.5, 10.5, 11.5, 12.5, 13.5, 14.5, 15.5
@@ -0,0 +1,43 @@
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+.include "macros.inc"
+
+#
+# store_v_na writes a full cache line without allocating it in the L2 cache.
+# Check that later loads see the stored data, both when the line isn't cached
+# and when it already is.
+#
+
+		.globl _start
+_start:	lea s10, srcline
+		load_v v1, (s10)
+		lea s11, dest1
+		store_v_na v1, (s11)	# Line not cached
+		load_v v2, (s11)
+		lea s12, dest2
+		load_v v3, (s12)		# Bring line into the caches
+		store_v_na v1, (s12)	# Line already cached
+		load_v v4, (s12)
+
+		HALT_CURRENT_THREAD
+
+		.align 64
+srcline: .long 0x2aa7d2c1, 0xeeb91caf, 0x304010ad, 0x96981e0d, 0x3a03b41f, 0x81363fee, 0x32d7bd42, 0xeaa8df61
+		.long 0x9b8f0b3e, 0x1f6e5c27, 0x7d3a4c90, 0xc4e21b58, 0x5a0f93d6, 0x08b7e4a1, 0xe36c2f1d, 0x61d9a8b4
+dest1: .long 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+dest2: .long 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16
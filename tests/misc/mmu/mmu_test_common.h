@@ -17,11 +17,13 @@
 #pragma once
 
 #define PAGE_SIZE 0x1000
+#define SUPERPAGE_SIZE 0x400000
 #define IO_REGION_BASE 0xffff0000
 
 #define TLB_WRITABLE (1 << 1)
 #define TLB_SUPERVISOR (1 << 3)
 #define TLB_GLOBAL (1 << 4)
+#define TLB_SUPERPAGE (1 << 5)
 
 #define CR_FAULT_HANDLER 1
 #define CR_FAULT_PC 2
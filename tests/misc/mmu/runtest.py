@@ -129,4 +129,5 @@ register_generic_test('io_supervisor_fault_write')
 register_generic_test('io_write_fault')
 register_generic_test('dtlbinsert_user')
 register_generic_test('itlbinsert_user')
+register_generic_test('superpage')
 test_harness.execute_tests()
@@ -0,0 +1,73 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <stdio.h>
+#include <unistd.h>
+#include "mmu_test_common.h"
+
+//
+// Map a 4MB superpage and ensure addresses at both ends of it are translated
+// correctly by comparing against an identity mapped superpage with the same
+// physical address. Then invalidate an address in the middle of the
+// superpage and ensure the whole superpage is removed.
+//
+
+#define SUPERPAGE_BASE 0x800000
+#define PHYS_BASE 0x400000
+
+volatile unsigned int *super_start = (unsigned int*) (SUPERPAGE_BASE + 0x1234);
+volatile unsigned int *super_end = (unsigned int*) (SUPERPAGE_BASE + SUPERPAGE_SIZE - 4);
+volatile unsigned int *phys_start = (unsigned int*) (PHYS_BASE + 0x1234);
+volatile unsigned int *phys_end = (unsigned int*) (PHYS_BASE + SUPERPAGE_SIZE - 4);
+
+void tlb_miss_handler()
+{
+	printf("%cTLB miss %08x\n", __builtin_nyuzi_read_control_reg(CR_FAULT_REASON) == 5 ? 'I' : 'D',
+		 __builtin_nyuzi_read_control_reg(CR_FAULT_ADDRESS));
+	exit(0);
+}
+
+int main(void)
+{
+	unsigned int va;
+	unsigned int stack_addr = (unsigned int) &va & ~(PAGE_SIZE - 1);
+
+	// Map code & data
+	for (va = 0; va < 0x10000; va += PAGE_SIZE)
+	{
+		add_itlb_mapping(va, va);
+		add_dtlb_mapping(va, va | TLB_WRITABLE);
+	}
+
+	add_dtlb_mapping(stack_addr, stack_addr | TLB_WRITABLE);
+	add_dtlb_mapping(IO_REGION_BASE, IO_REGION_BASE | TLB_WRITABLE);
+	add_dtlb_mapping(SUPERPAGE_BASE, PHYS_BASE | TLB_WRITABLE | TLB_SUPERPAGE);
+	add_dtlb_mapping(PHYS_BASE, PHYS_BASE | TLB_WRITABLE | TLB_SUPERPAGE);
+
+	// Enable MMU in flags register
+	__builtin_nyuzi_write_control_reg(CR_TLB_MISS_HANDLER, tlb_miss_handler);
+	__builtin_nyuzi_write_control_reg(CR_FLAGS, FLAG_MMU_EN | FLAG_SUPERVISOR_EN);
+
+	*super_start = 0x5b1d0c27;
+	*super_end = 0x9e2f7a13;
+	printf("start %08x\n", *phys_start); // CHECK: start 5b1d0c27
+	printf("end %08x\n", *phys_end); // CHECK: end 9e2f7a13
+
+	asm("tlbinval %0" : : "s" (SUPERPAGE_BASE + 0x123000));
+
+	printf("FAIL: read value %08x\n", *super_start);	// CHECK: DTLB miss 00801234
+	return 0;
+}
@@ -18,13 +18,20 @@
 #include <stdio.h>
 
 //
-// This test only works with 8 cores enabled
-// In hardware/core/config.sv, set NUM_CORES to 8. Each core prints its
-// identifier round-robin.
+// Threads on all cores update shared counters with synchronized loads and
+// stores, then take turns printing their identifiers. This needs 8 threads,
+// so the Verilator model must be built with NUM_CORES=2 (the test_configs
+// target in tests/Makefile does this). runtest.py checks the counters and
+// the order of the output.
 //
 
-static volatile int gCurrentThread = 0;
-const int kNumThreads = 32;
+const int kNumThreads = 8;
+const int kNumSlots = 256;
+const int kNumRounds = 4;
+volatile int gIndex;
+volatile int *gSlots = (volatile int*) 0x100000;
+volatile int gCurrentTurn;
+volatile int gEndSync = kNumThreads;
 
 int main(int argc, const char *argv[])
 {
@@ -32,12 +39,31 @@ int main(int argc, const char *argv[])
 
 	startAllThreads();
 
-	for (;;)
+	// Increment each slot 10 times. Slots are spread across cache lines, and
+	// so across L2 banks.
+	const int kTotalIncrements = kNumSlots * 10;
+	while (1)
 	{
-		while (gCurrentThread != myThreadId)
+		int mySlot = __sync_fetch_and_add(&gIndex, 1);
+		if (mySlot >= kTotalIncrements)
+			break;
+
+		__sync_fetch_and_add(&gSlots[mySlot % kNumSlots], 1);
+	}
+
+	for (int round = 0; round < kNumRounds; round++)
+	{
+		while (gCurrentTurn != round * kNumThreads + myThreadId)
 			;
 
 		printf("%d\n", myThreadId);
-		gCurrentThread = (gCurrentThread + 1) % kNumThreads;
+		gCurrentTurn = gCurrentTurn + 1;
 	}
+
+	__sync_synchronize();
+	__sync_fetch_and_add(&gEndSync, -1);
+	while (gEndSync)
+		;
+
+	return 0;
 }
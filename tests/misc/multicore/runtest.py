@@ -0,0 +1,50 @@
+#!/usr/bin/env python
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import sys
+import struct
+
+# Test synchronized loads and stores and cache coherence between cores. This
+# must run on a model built with NUM_CORES=2.
+
+sys.path.insert(0, '../..')
+import test_harness
+
+NUM_THREADS = 8
+NUM_ROUNDS = 4
+
+def multicore_test(name):
+	test_harness.compile_test('multicore.c')
+	result = test_harness.run_verilator(dump_file='obj/vmem.bin', dump_base=0x100000,
+		dump_length=0x400, extra_args=['+autoflushl2=1'])
+
+	with open('obj/vmem.bin', 'rb') as f:
+		while True:
+			val = f.read(4)
+			if len(val) == 0:
+				break
+
+			numVal = struct.unpack('<L', val)[0]
+			if numVal != 10:
+				raise test_harness.TestException('FAIL: mismatch: ' + str(numVal))
+
+	expected = ''.join(['%d\n' % (i % NUM_THREADS) for i in range(NUM_THREADS * NUM_ROUNDS)])
+	if result.replace('\\n', '\n').find(expected) == -1:
+		raise test_harness.TestException('FAIL: threads did not print in order\n' + result)
+
+test_harness.register_tests(multicore_test, ['multicore'])
+test_harness.execute_tests()
@@ -15,13 +15,14 @@
 //
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <performance_counters.h>
 
 //
 // Check performance counters to ensure they basically look correct
 //
 
-#define NUM_EVENTS 13
+#define NUM_EVENTS 30
 #define CHECK(cond) if (!(cond)) { printf("TEST FAILED: %s:%d: %s\n", __FILE__, __LINE__, \
 	#cond); abort(); }
 
@@ -51,16 +52,33 @@ int main(int argc, const char *argv[])
 		0, 0,		// PERF_L2_WRITEBACK
 		2, 2,		// PERF_L2_MISS
 		4, 4,		// PERF_L2_HIT
+		0, 0,		// PERF_L2_QUEUE_STALL
+		4, 32,		// PERF_AXI_READ_BEAT, depends on AXI_DATA_WIDTH (see below)
+		0, 0,		// PERF_AXI_WRITE_BEAT
 		0, 0,		// PERF_STORE_ROLLBACK
 		5, 10,		// PERF_STORE
 		80, 120,	// PERF_INSTRUCTION_RETIRED
 		80, 120,	// PERF_INSTRUCTION_ISSUED
 		0, 0,		// PERF_ICACHE_MISS
-		200, 300,	// PERF_ICACHE_HIT
+		100, 300,	// PERF_ICACHE_HIT
 		0, 0,		// PERF_ITLB_MISS
 		0, 0,		// PERF_DCACHE_MISS
 		5, 20,		// PERF_DCACHE_HIT
 		0, 0,		// PERF_DTLB_MISS
+		0, 200,		// PERF_STALL_ICACHE
+		0, 0,		// PERF_STALL_DCACHE
+		0, 0,		// PERF_STALL_STORE_QUEUE
+		0, 100,		// PERF_STALL_RAW
+		0, 20,		// PERF_STALL_WRITEBACK_CONFLICT
+		2, 20,		// PERF_ROLLBACK_BRANCH
+		0, 0,		// PERF_ROLLBACK_DCACHE_MISS
+		0, 0,		// PERF_ROLLBACK_SYNC
+		0, 0,		// PERF_PREFETCH_USEFUL
+		0, 0,		// PERF_PREFETCH_LATE
+		1, 10,		// PERF_BRANCH_MISPREDICT
+		0, 10,		// PERF_STORE_COMBINED
+		0, 0,		// PERF_SCGATH_ACCESS
+		0, 0,		// PERF_STALL_SCHEDULE
 	};
 
 	for (base_event = 0; base_event < NUM_EVENTS; base_event += NUM_COUNTERS)
@@ -86,6 +104,23 @@ int main(int argc, const char *argv[])
 		}
 	}
 
+	// Two L2 misses each read a 64 byte line. That is 16 beats per line on a
+	// 32 bit AXI bus, down to 2 on a 256 bit bus. Software can't read
+	// AXI_DATA_WIDTH, but the total must be a power of two in that range.
+	CHECK((perf_count[PERF_AXI_READ_BEAT] & (perf_count[PERF_AXI_READ_BEAT] - 1)) == 0);
+
+	// Only thread 0 is running, so filtering on another thread should
+	// not count anything.
+	set_perf_counter_thread_event(0, PERF_INSTRUCTION_ISSUED, 0);
+	set_perf_counter_thread_event(1, PERF_INSTRUCTION_ISSUED, 1);
+	perf_count[0] = read_perf_counter(0);
+	perf_count[1] = read_perf_counter(1);
+	do_stuff(values, 10);
+	perf_count[0] = read_perf_counter(0) - perf_count[0];
+	perf_count[1] = read_perf_counter(1) - perf_count[1];
+	CHECK(perf_count[0] >= 80 && perf_count[0] <= 120);
+	CHECK(perf_count[1] == 0);
+
 	printf("PASS\n");
 
 	return 0;
@@ -0,0 +1,50 @@
+#!/usr/bin/env python
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import sys
+
+# Test store combining in the L1 store queue. Four threads do back-to-back
+# byte stores to a shared line and to their own lines. Check that every byte
+# was written and that the store_combined counter went up.
+
+sys.path.insert(0, '../..')
+import test_harness
+
+NUM_THREADS = 4
+LINE_SIZE = 64
+
+def store_combine_test(name):
+	test_harness.compile_test('store_combine.c')
+	result = test_harness.run_verilator(dump_file='obj/vmem.bin', dump_base=0x100000,
+		dump_length=LINE_SIZE * (NUM_THREADS + 1), extra_args=['+autoflushl2=1'])
+	if result.find('PASS') == -1:
+		raise test_harness.TestException('test program did not indicate pass\n' + result)
+
+	expected = bytearray(range(LINE_SIZE))
+	for thread in range(NUM_THREADS):
+		expected += bytearray([((thread + 1) << 6) + i & 0xff for i in range(LINE_SIZE)])
+
+	with open('obj/vmem.bin', 'rb') as f:
+		actual = bytearray(f.read())
+
+	for offset in range(len(expected)):
+		if actual[offset] != expected[offset]:
+			raise test_harness.TestException('FAIL: mismatch at offset ' + hex(offset)
+				+ ': expected ' + str(expected[offset]) + ' got ' + str(actual[offset]))
+
+test_harness.register_tests(store_combine_test, ['store_combine'])
+test_harness.execute_tests()
@@ -0,0 +1,106 @@
+//
+// Copyright 2026 agent
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <performance_counters.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//
+// Each thread issues runs of back-to-back byte stores, first to every fourth
+// byte of a line shared by all threads, then to every byte of its own line.
+// These should combine in the store queue. runtest.py checks the memory
+// contents.
+//
+
+#define STORE4(ptr, index, value) \
+	ptr[index] = value; \
+	ptr[index + 4] = value + 4; \
+	ptr[index + 8] = value + 8; \
+	ptr[index + 12] = value + 12;
+
+const int kNumThreads = 4;
+const int kLineSize = 64;
+volatile unsigned char *gSharedLine = (volatile unsigned char*) 0x100000;
+volatile unsigned char *gThreadLines = (volatile unsigned char*) 0x100040;
+volatile int gStartSync = kNumThreads;
+volatile int gEndSync = kNumThreads;
+
+// Stores are unrolled so there are no branches between them.
+__attribute__((noinline)) void fillShared(int threadId)
+{
+	STORE4(gSharedLine, threadId, threadId);
+	STORE4(gSharedLine, threadId + 16, threadId + 16);
+	STORE4(gSharedLine, threadId + 32, threadId + 32);
+	STORE4(gSharedLine, threadId + 48, threadId + 48);
+}
+
+__attribute__((noinline)) void fillPrivate(int threadId)
+{
+	volatile unsigned char *line = gThreadLines + threadId * kLineSize;
+	unsigned char base = (threadId + 1) << 6;
+
+	for (int i = 0; i < kLineSize; i += 16)
+	{
+		STORE4(line, i, base + i);
+		STORE4(line, i + 1, base + i + 1);
+		STORE4(line, i + 2, base + i + 2);
+		STORE4(line, i + 3, base + i + 3);
+	}
+}
+
+int main()
+{
+	int myThreadId = __builtin_nyuzi_read_control_reg(0);
+	unsigned int startCount;
+	unsigned int combined;
+
+	if (myThreadId == 0)
+	{
+		set_perf_counter_event(0, PERF_STORE_COMBINED);
+		startCount = read_perf_counter(0);
+
+		// Start worker threads
+		*((unsigned int*) 0xffff0060) = (1 << kNumThreads) - 1;
+	}
+
+	// Wait until all threads are running so their stores overlap.
+	__sync_fetch_and_add(&gStartSync, -1);
+	while (gStartSync)
+		;
+
+	fillShared(myThreadId);
+	fillPrivate(myThreadId);
+
+	__sync_synchronize();
+	__sync_fetch_and_add(&gEndSync, -1);
+	while (gEndSync)
+		;
+
+	if (myThreadId == 0)
+	{
+		combined = read_perf_counter(0) - startCount;
+		printf("store_combined %u\n", combined);
+		if (combined == 0)
+		{
+			printf("FAIL: no stores combined\n");
+			exit(1);
+		}
+
+		printf("PASS\n");
+	}
+
+	return 0;
+}
@@ -33,6 +33,11 @@ OBJ_DIR = 'obj/'
 ELF_FILE = OBJ_DIR + 'test.elf'
 HEX_FILE = OBJ_DIR + 'test.hex'
 
+# Set ISA_EXTENSIONS=1 in the environment to run tests that use instructions
+# the released toolchain can't assemble, and to compile test programs with
+# NYUZI_ISA_EXTENSIONS defined (as build/target.mk does for the libraries).
+ISA_EXTENSIONS = os.environ.get('ISA_EXTENSIONS') == '1'
+
 
 class TestException(Exception):
 	def __init__(self, output):
@@ -67,6 +72,9 @@ def compile_test(source_file, optlevel='3'):
 		'-I' + LIB_DIR + 'libc/include',
 		'-I' + LIB_DIR + 'libos']
 
+	if ISA_EXTENSIONS:
+		compiler_args += ['-DNYUZI_ISA_EXTENSIONS=1']
+
 	if isinstance(source_file, list):
 		compiler_args += source_file		# List of files
 	else:
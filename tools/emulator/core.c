@@ -35,6 +35,10 @@
 #define PAGE_SIZE 0x1000u
 #define ROUND_TO_PAGE(addr) ((addr) & ~(PAGE_SIZE - 1u))
 #define PAGE_OFFSET(addr) ((addr) & (PAGE_SIZE - 1u))
+#define SUPERPAGE_TLB_ENTRIES 4
+#define SUPERPAGE_SIZE 0x400000u
+#define ROUND_TO_SUPERPAGE(addr) ((addr) & ~(SUPERPAGE_SIZE - 1u))
+#define SUPERPAGE_OFFSET(addr) ((addr) & (SUPERPAGE_SIZE - 1u))
 
 #ifdef DUMP_INSTRUCTION_STATS
     #define TALLY_INSTRUCTION(type) thread->core->stat ## type++
@@ -44,6 +48,25 @@
 
 #define INVALID_LINK_ADDR 0xffffffff
 
+// A scatter/gather subcycle also services all later lanes that are in the
+// same cache line if at least this many of the remaining subcycles won't need
+// another access. This must match SCGATH_COALESCE_MIN_LANES in
+// hardware/core/dcache_data_stage.sv, or cosimulation will see different
+// writebacks.
+#define SCGATH_COALESCE_MIN_LANES 5
+
+// Approximate model of the L2 cache, used to record which lines would be
+// resident when saving state for hybrid simulation. This should match
+// L2_SETS/L2_WAYS in hardware/core/config.sv, but doesn't need to be exact.
+#define L2_MODEL_SETS 256
+#define L2_MODEL_WAYS 8
+#define INVALID_LINE_ADDR 0xffffffff
+
+// Layout of the architectural state file written by saveArchState. This must
+// match the restore logic in hardware/testbench/verilator_tb.sv.
+#define STATE_HEADER_WORDS 16
+#define STATE_THREAD_WORDS (48 + NUM_REGISTERS * NUM_VECTOR_LANES)
+
 // This is used to signal an instruction that may be a breakpoint. We use
 // a special instruction to avoid a breakpoint lookup on every instruction cycle.
 // This is an invalid instruction because it uses a reserved format type
@@ -64,6 +87,7 @@ struct Thread
 	uint32_t scratchpad0;
 	uint32_t scratchpad1;
 	uint32_t currentAsid;
+	uint32_t priority;
 	bool enableInterrupt;
 	bool enableMmu;
 	bool enableSupervisor;
@@ -72,6 +96,8 @@ struct Thread
 	bool prevEnableSupervisor;
 	uint32_t faultSubcycle;
 	uint32_t currentSubcycle;
+	uint32_t scgathDoneMask;	// Lanes of current scatter/gather already accessed
+	bool stoppedOnBreakpoint;	// Hasn't executed the instruction at currentPc - 4 yet
 	uint32_t scalarReg[NUM_REGISTERS - 1];	// 31 is PC, which is special
 	uint32_t vectorReg[NUM_REGISTERS][NUM_VECTOR_LANES];
 };
@@ -98,11 +124,18 @@ struct Core
 	uint32_t nextITlbWay;
 	TlbEntry *dtlb;
 	uint32_t nextDTlbWay;
+	TlbEntry itlbSuperpages[SUPERPAGE_TLB_ENTRIES];
+	uint32_t nextITlbSuperpage;
+	TlbEntry dtlbSuperpages[SUPERPAGE_TLB_ENTRIES];
+	uint32_t nextDTlbSuperpage;
 	bool crashed;
 	bool singleStepping;
 	bool stopOnFault;
 	bool enableTracing;
 	bool cosimEnable;
+	bool trackCacheLines;
+	uint32_t *l2LineAddr;	// [L2_MODEL_SETS][L2_MODEL_WAYS]
+	uint32_t *l2NextWay;
 	int64_t totalInstructions;
 	uint32_t startCycleCount;
 #ifdef DUMP_INSTRUCTION_STATS
@@ -132,16 +165,32 @@ static void invalidateSyncAddress(Core*, uint32_t address);
 static void dispatchFault(Thread*, uint32_t address, FaultReason);
 static void memoryAccessFault(Thread*, uint32_t address, FaultReason, bool isLoad);
 static void illegalInstruction(Thread*, uint32_t instruction);
+static const TlbEntry *lookupTlbEntry(const Thread*, uint32_t virtualAddress,
+	bool dataFetch);
+static uint32_t tlbPhysicalAddress(const TlbEntry*, uint32_t virtualAddress);
 static bool translateAddress(Thread*, uint32_t virtualAddress, uint32_t
 	*physicalAddress, bool data, bool isWrite);
+static void touchCacheLine(Core*, uint32_t physicalAddress);
+static bool probeDataTranslation(const Thread*, uint32_t virtualAddress,
+	uint32_t *outPhysicalAddress);
+static uint32_t readOriginalMemoryWord(const Core*, uint32_t address);
+static uint32_t reciprocalSqrtEstimate(uint32_t value);
+static uint32_t packedArithmeticOp(ArithmeticOp, uint32_t value1, uint32_t value2);
+static uint32_t packClamp(uint32_t value, uint32_t max);
+static uint32_t halfToFloat(uint32_t half);
+static uint32_t floatToHalf(uint32_t value);
 static uint32_t scalarArithmeticOp(ArithmeticOp, uint32_t value1, uint32_t value2);
 static bool isCompareOp(uint32_t op);
+static bool isReductionOp(uint32_t op);
+static uint32_t reduceLanes(ArithmeticOp, const uint32_t *values, uint32_t mask);
 static struct Breakpoint *lookupBreakpoint(Core*, uint32_t pc);
 static void executeRegisterArithInst(Thread*, uint32_t instruction);
 static void executeImmediateArithInst(Thread*, uint32_t instruction);
 static void executeScalarLoadStoreInst(Thread*, uint32_t instruction);
+static void executeAtomicInst(Thread*, uint32_t instruction);
 static void executeBlockLoadStoreInst(Thread*, uint32_t instruction);
 static void executeScatterGatherInst(Thread*, uint32_t instruction);
+static void executeTextureSampleInst(Thread*, uint32_t instruction);
 static void executeControlRegisterInst(Thread*, uint32_t instruction);
 static void executeMemoryAccessInst(Thread*, uint32_t instruction);
 static void executeBranchInst(Thread*, uint32_t instruction);
@@ -186,6 +235,12 @@ Core *initCore(uint32_t memorySize, uint32_t totalThreads, bool randomizeMemory)
 		core->dtlb[i].virtualAddress = 0xffffffffu;
 	}
 
+	for (i = 0; i < SUPERPAGE_TLB_ENTRIES; i++)
+	{
+		core->itlbSuperpages[i].virtualAddress = 0xffffffffu;
+		core->dtlbSuperpages[i].virtualAddress = 0xffffffffu;
+	}
+
 	core->totalThreads = totalThreads;
 	core->threads = (Thread*) calloc(sizeof(Thread), totalThreads);
 	for (threadid = 0; threadid < totalThreads; threadid++)
@@ -284,6 +339,146 @@ void enableCosimulation(Core *core)
 	core->cosimEnable = true;
 }
 
+void enableCacheLineTracking(Core *core)
+{
+	uint32_t i;
+
+	core->l2LineAddr = (uint32_t*) malloc(sizeof(uint32_t) * L2_MODEL_SETS * L2_MODEL_WAYS);
+	core->l2NextWay = (uint32_t*) calloc(sizeof(uint32_t), L2_MODEL_SETS);
+	for (i = 0; i < L2_MODEL_SETS * L2_MODEL_WAYS; i++)
+		core->l2LineAddr[i] = INVALID_LINE_ADDR;
+
+	core->trackCacheLines = true;
+}
+
+//
+// Write architectural state so the hardware model can resume execution at
+// this point (hybrid simulation). This creates three files:
+// <prefix>.hex     Memory contents, same format as the program image.
+// <prefix>.state   Registers and control registers, one hex word per line.
+// <prefix>.lines   Physical addresses of cache lines that would be in the
+//                  L2 cache (only if enableCacheLineTracking was called).
+//
+// The state file has a header of STATE_HEADER_WORDS:
+//  0 thread enable mask, 1 number of threads, 2 fault handler,
+//  3 TLB miss handler
+// Followed by STATE_THREAD_WORDS for each thread:
+//  0 pc, 1 flags, 2 saved flags, 3 fault pc, 4 fault reason,
+//  5 fault address, 6 ASID, 7 scratchpad 0, 8 scratchpad 1,
+//  9 saved subcycle, 10 issue priority, 16-46 s0-s30, 48+ v0-v31 (lane 0 first)
+//
+// TLB contents are not saved. The hardware starts with an empty TLB and
+// the TLB miss handler will reload entries as needed.
+//
+int saveArchState(Core *core, const char *prefix)
+{
+	char filename[256];
+	FILE *file;
+	uint32_t threadId;
+	uint32_t address;
+	uint32_t reg;
+	uint32_t lane;
+	uint32_t i;
+
+	// A scatter/gather instruction that is partially complete can't be
+	// restored, so run it to completion. This is a no-op for other threads.
+	for (threadId = 0; threadId < core->totalThreads; threadId++)
+	{
+		while (core->threads[threadId].currentSubcycle != 0 && !core->crashed)
+			executeInstruction(&core->threads[threadId]);
+	}
+
+	snprintf(filename, sizeof(filename), "%s.hex", prefix);
+	file = fopen(filename, "w");
+	if (file == NULL)
+	{
+		perror("Error opening state memory file");
+		return -1;
+	}
+
+	for (address = 0; address < core->memorySize; address += 4)
+		fprintf(file, "%08x\n", endianSwap32(readOriginalMemoryWord(core, address)));
+
+	fclose(file);
+
+	snprintf(filename, sizeof(filename), "%s.state", prefix);
+	file = fopen(filename, "w");
+	if (file == NULL)
+	{
+		perror("Error opening state file");
+		return -1;
+	}
+
+	fprintf(file, "%08x\n", core->threadEnableMask);
+	fprintf(file, "%08x\n", core->totalThreads);
+	fprintf(file, "%08x\n", core->faultHandlerPc);
+	fprintf(file, "%08x\n", core->tlbMissHandlerPc);
+	for (i = 4; i < STATE_HEADER_WORDS; i++)
+		fprintf(file, "00000000\n");
+
+	for (threadId = 0; threadId < core->totalThreads; threadId++)
+	{
+		const Thread *thread = &core->threads[threadId];
+		uint32_t pc = thread->currentPc;
+
+		// If this thread stopped on a breakpoint, it has not executed the
+		// instruction yet.
+		if (thread->stoppedOnBreakpoint)
+			pc -= 4;
+
+		fprintf(file, "%08x\n", pc);
+		fprintf(file, "%08x\n", (thread->enableInterrupt ? 1 : 0)
+			| (thread->enableMmu ? 2 : 0)
+			| (thread->enableSupervisor ? 4 : 0));
+		fprintf(file, "%08x\n", (thread->prevEnableInterrupt ? 1 : 0)
+			| (thread->prevEnableMmu ? 2 : 0)
+			| (thread->prevEnableSupervisor ? 4 : 0));
+		fprintf(file, "%08x\n", thread->lastFaultPc);
+		fprintf(file, "%08x\n", thread->lastFaultReason);
+		fprintf(file, "%08x\n", thread->lastFaultAddress);
+		fprintf(file, "%08x\n", thread->currentAsid);
+		fprintf(file, "%08x\n", thread->scratchpad0);
+		fprintf(file, "%08x\n", thread->scratchpad1);
+		fprintf(file, "%08x\n", thread->faultSubcycle);
+		fprintf(file, "%08x\n", thread->priority);
+		for (i = 11; i < 16; i++)
+			fprintf(file, "00000000\n");
+
+		for (reg = 0; reg < NUM_REGISTERS - 1; reg++)
+			fprintf(file, "%08x\n", thread->scalarReg[reg]);
+
+		fprintf(file, "00000000\n");
+		for (reg = 0; reg < NUM_REGISTERS; reg++)
+		{
+			for (lane = 0; lane < NUM_VECTOR_LANES; lane++)
+				fprintf(file, "%08x\n", thread->vectorReg[reg][lane]);
+		}
+	}
+
+	fclose(file);
+
+	if (core->trackCacheLines)
+	{
+		snprintf(filename, sizeof(filename), "%s.lines", prefix);
+		file = fopen(filename, "w");
+		if (file == NULL)
+		{
+			perror("Error opening cache line file");
+			return -1;
+		}
+
+		for (i = 0; i < L2_MODEL_SETS * L2_MODEL_WAYS; i++)
+		{
+			if (core->l2LineAddr[i] != INVALID_LINE_ADDR)
+				fprintf(file, "%08x\n", core->l2LineAddr[i]);
+		}
+
+		fclose(file);
+	}
+
+	return 0;
+}
+
 // Called when the verilog model in cosimulation indicates an interrupt.
 void cosimInterrupt(Core *core, uint32_t threadId, uint32_t pc)
 {
@@ -502,7 +697,10 @@ static void setScalarReg(Thread *thread, uint32_t reg, uint32_t value)
 		cosimSetScalarReg(thread->core, thread->currentPc - 4, reg, value);
 
 	if (reg == PC_REG)
+	{
 		thread->currentPc = value;
+		thread->stoppedOnBreakpoint = false;	// Debugger may move the PC
+	}
 	else
 		thread->scalarReg[reg] = value;
 }
@@ -605,15 +803,58 @@ static void illegalInstruction(Thread *thread, uint32_t instruction)
 	}
 }
 
+// Find the TLB entry that maps this address, or return NULL if there isn't
+// one. 4k page entries are checked first, then superpage entries, which
+// matches the priority in hardware/core/tlb.sv.
+static const TlbEntry *lookupTlbEntry(const Thread *thread, uint32_t virtualAddress,
+	bool dataFetch)
+{
+	const TlbEntry *setEntries;
+	const TlbEntry *superpages;
+	int way;
+	int i;
+
+	setEntries = (dataFetch ? thread->core->dtlb : thread->core->itlb)
+		+ ((virtualAddress / PAGE_SIZE) % TLB_SETS) * TLB_WAYS;
+	for (way = 0; way < TLB_WAYS; way++)
+	{
+		if (setEntries[way].virtualAddress == ROUND_TO_PAGE(virtualAddress)
+			&& ((setEntries[way].physAddrAndFlags & TLB_GLOBAL) != 0
+			|| setEntries[way].asid == thread->currentAsid))
+		{
+			return &setEntries[way];
+		}
+	}
+
+	superpages = dataFetch ? thread->core->dtlbSuperpages : thread->core->itlbSuperpages;
+	for (i = 0; i < SUPERPAGE_TLB_ENTRIES; i++)
+	{
+		if (superpages[i].virtualAddress == ROUND_TO_SUPERPAGE(virtualAddress)
+			&& ((superpages[i].physAddrAndFlags & TLB_GLOBAL) != 0
+			|| superpages[i].asid == thread->currentAsid))
+		{
+			return &superpages[i];
+		}
+	}
+
+	return NULL;
+}
+
+static uint32_t tlbPhysicalAddress(const TlbEntry *entry, uint32_t virtualAddress)
+{
+	if (entry->physAddrAndFlags & TLB_SUPERPAGE)
+		return ROUND_TO_SUPERPAGE(entry->physAddrAndFlags) | SUPERPAGE_OFFSET(virtualAddress);
+	else
+		return ROUND_TO_PAGE(entry->physAddrAndFlags) | PAGE_OFFSET(virtualAddress);
+}
+
 // Translate addresses using the translation lookaside buffer.
 // If there is a TLB miss, update the thread state to make it jump to the fault
 // handler.
 static bool translateAddress(Thread *thread, uint32_t virtualAddress, uint32_t *outPhysicalAddress,
 	bool dataFetch, bool isWrite)
 {
-	int tlbSet;
-	int way;
-	TlbEntry *setEntries;
+	const TlbEntry *entry;
 
 	if (!thread->enableMmu)
 	{
@@ -629,48 +870,45 @@ static bool translateAddress(Thread *thread, uint32_t virtualAddress, uint32_t *
 		}
 
 		*outPhysicalAddress = virtualAddress;
+		if (thread->core->trackCacheLines)
+			touchCacheLine(thread->core, virtualAddress);
+
 		return true;
 	}
 
-	tlbSet = (virtualAddress / PAGE_SIZE) % TLB_SETS;
-	setEntries = (dataFetch ? thread->core->dtlb : thread->core->itlb) + tlbSet * TLB_WAYS;
-	for (way = 0; way < TLB_WAYS; way++)
+	entry = lookupTlbEntry(thread, virtualAddress, dataFetch);
+	if (entry)
 	{
-		if (setEntries[way].virtualAddress == ROUND_TO_PAGE(virtualAddress)
-			&& ((setEntries[way].physAddrAndFlags & TLB_GLOBAL) != 0
-			|| setEntries[way].asid == thread->currentAsid))
+		if ((entry->physAddrAndFlags & TLB_SUPERVISOR) != 0 && !thread->enableSupervisor)
 		{
-			if ((setEntries[way].physAddrAndFlags & TLB_SUPERVISOR) != 0
-				&& !thread->enableSupervisor)
-			{
-				dispatchFault(thread, virtualAddress, dataFetch ? FR_DATA_SUPERVISOR
-					: FR_IFETCH_SUPERVISOR);
-				return false;
-			}
+			dispatchFault(thread, virtualAddress, dataFetch ? FR_DATA_SUPERVISOR
+				: FR_IFETCH_SUPERVISOR);
+			return false;
+		}
 
-			if (isWrite && (setEntries[way].physAddrAndFlags & TLB_WRITE_ENABLE) == 0)
-			{
-				// Write protected page, raise a fault
-				memoryAccessFault(thread, virtualAddress, FR_ILLEGAL_WRITE, false);
-				return false;
-			}
+		if (isWrite && (entry->physAddrAndFlags & TLB_WRITE_ENABLE) == 0)
+		{
+			// Write protected page, raise a fault
+			memoryAccessFault(thread, virtualAddress, FR_ILLEGAL_WRITE, false);
+			return false;
+		}
 
-			*outPhysicalAddress = ROUND_TO_PAGE(setEntries[way].physAddrAndFlags)
-				| PAGE_OFFSET(virtualAddress);
+		*outPhysicalAddress = tlbPhysicalAddress(entry, virtualAddress);
+		if (*outPhysicalAddress >= thread->core->memorySize && *outPhysicalAddress < 0xffff0000)
+		{
+			// This isn't an actual fault supported by the hardware, but a debugging
+			// aid only available in the emulator.
+			printf("Translated physical address out of range. va %08x pa %08x pc %08x\n",
+				virtualAddress, *outPhysicalAddress, thread->currentPc - 4);
+			printThreadRegisters(thread);
+			thread->core->crashed = true;
+			return false;
+		}
 
-			if (*outPhysicalAddress >= thread->core->memorySize && *outPhysicalAddress < 0xffff0000)
-			{
-				// This isn't an actual fault supported by the hardware, but a debugging
-				// aid only available in the emulator.
-				printf("Translated physical address out of range. va %08x pa %08x pc %08x\n",
-					virtualAddress, *outPhysicalAddress, thread->currentPc - 4);
-				printThreadRegisters(thread);
-				thread->core->crashed = true;
-				return false;
-			}
+		if (thread->core->trackCacheLines)
+			touchCacheLine(thread->core, *outPhysicalAddress);
 
-			return true;
-		}
+		return true;
 	}
 
 	// No translation found, raise exception
@@ -685,6 +923,204 @@ static bool translateAddress(Thread *thread, uint32_t virtualAddress, uint32_t *
 	return false;
 }
 
+// Like translateAddress, but returns false instead of raising a fault if
+// there is no valid mapping.
+static bool probeDataTranslation(const Thread *thread, uint32_t virtualAddress,
+	uint32_t *outPhysicalAddress)
+{
+	const TlbEntry *entry;
+
+	if (!thread->enableMmu)
+	{
+		*outPhysicalAddress = virtualAddress;
+		return virtualAddress < thread->core->memorySize;
+	}
+
+	entry = lookupTlbEntry(thread, virtualAddress, true);
+	if (entry == NULL || ((entry->physAddrAndFlags & TLB_SUPERVISOR) != 0
+		&& !thread->enableSupervisor))
+	{
+		return false;
+	}
+
+	*outPhysicalAddress = tlbPhysicalAddress(entry, virtualAddress);
+	return *outPhysicalAddress < thread->core->memorySize;
+}
+
+static void touchCacheLine(Core *core, uint32_t physicalAddress)
+{
+	uint32_t lineAddress = physicalAddress & ~CACHE_LINE_MASK;
+	uint32_t set = (physicalAddress / CACHE_LINE_LENGTH) % L2_MODEL_SETS;
+	uint32_t *setLines = core->l2LineAddr + set * L2_MODEL_WAYS;
+	uint32_t way;
+
+	if ((physicalAddress & 0xffff0000) == 0xffff0000)
+		return;	// Device registers are not cached
+
+	for (way = 0; way < L2_MODEL_WAYS; way++)
+	{
+		if (setLines[way] == lineAddress)
+			return;
+	}
+
+	setLines[core->l2NextWay[set]] = lineAddress;
+	core->l2NextWay[set] = (core->l2NextWay[set] + 1) % L2_MODEL_WAYS;
+}
+
+// Read memory, skipping over breakpoint instructions inserted by the debugger.
+static uint32_t readOriginalMemoryWord(const Core *core, uint32_t address)
+{
+	struct Breakpoint *breakpoint;
+
+	if (core->memory[address / 4] == BREAKPOINT_OP)
+	{
+		for (breakpoint = core->breakpoints; breakpoint; breakpoint = breakpoint->next)
+		{
+			if (breakpoint->address == address)
+				return breakpoint->originalInstruction;
+		}
+	}
+
+	return core->memory[address / 4];
+}
+
+// This must match the table generated by tools/misc/make_rsqrt_rom.py. It
+// only has 6 bits of accuracy. The input significand is truncated before
+// computing the estimate. When the unbiased exponent is odd, the significand
+// is doubled so the exponent can be halved.
+static uint32_t reciprocalSqrtEstimate(uint32_t value)
+{
+	uint32_t exponent = (value >> 23) & 0xff;
+	uint32_t significand = (value >> 17) & 0x3f;
+	uint32_t resultExponent;
+	double estimate;
+
+	if (exponent == 0)
+		return (value & 0x80000000) | 0x7f800000;	// Zero or subnormal = +/-inf
+
+	if ((value & 0x80000000) || (exponent == 0xff && (value & 0x7fffff)))
+		return 0x7fffffff;	// Negative or NaN = NaN
+
+	if (exponent == 0xff)
+		return 0;	// +inf = 0
+
+	estimate = 1.0 / sqrt((1.0 + significand / 64.0) * ((exponent & 1) ? 1.0 : 2.0));
+	resultExponent = (380 - exponent) >> 1;
+	if (estimate == 1.0)
+		return (resultExponent + 1) << 23;
+
+	return (resultExponent << 23) | (((uint32_t)(estimate * 128) & 0x3f) << 17);
+}
+
+// Saturating add/subtract and multiply high on packed unsigned bytes or
+// halfwords. Each field is independent.
+static uint32_t packedArithmeticOp(ArithmeticOp operation, uint32_t value1, uint32_t value2)
+{
+	uint32_t width;
+	uint32_t fieldMask;
+	uint32_t shift;
+	uint32_t result = 0;
+
+	if (operation == OP_ADDS_U16 || operation == OP_SUBS_U16 || operation == OP_MULHI_U16)
+		width = 16;
+	else
+		width = 8;
+
+	fieldMask = (1u << width) - 1;
+	for (shift = 0; shift < 32; shift += width)
+	{
+		uint32_t a = (value1 >> shift) & fieldMask;
+		uint32_t b = (value2 >> shift) & fieldMask;
+		uint32_t field;
+
+		switch (operation)
+		{
+			case OP_ADDS_U8:
+			case OP_ADDS_U16:
+				field = a + b > fieldMask ? fieldMask : a + b;
+				break;
+
+			case OP_SUBS_U8:
+			case OP_SUBS_U16:
+				field = a > b ? a - b : 0;
+				break;
+
+			default:	// OP_MULHI_U8, OP_MULHI_U16
+				field = (a * b) >> width;
+		}
+
+		result |= field << shift;
+	}
+
+	return result;
+}
+
+// Clamp a signed value to 0 - max
+static uint32_t packClamp(uint32_t value, uint32_t max)
+{
+	if ((int32_t) value < 0)
+		return 0;
+
+	return value > max ? max : value;
+}
+
+static uint32_t halfToFloat(uint32_t half)
+{
+	uint32_t sign = (half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1f;
+	uint32_t significand = half & 0x3ff;
+	int lz;
+
+	if (exponent == 0x1f)
+		return sign | 0x7f800000 | (significand << 13);	// Inf or NaN
+
+	if (exponent == 0)
+	{
+		if (significand == 0)
+			return sign;
+
+		// Subnormal, normalize
+		lz = __builtin_clz(significand) - 22;
+		return sign | ((uint32_t)(112 - lz) << 23) | (((significand << (lz + 1)) & 0x3ff) << 13);
+	}
+
+	return sign | ((exponent + 112) << 23) | (significand << 13);
+}
+
+// Round to nearest even. This matches the hardware, which shifts the
+// significand so the discarded bits are in the low 26 bits.
+static uint32_t floatToHalf(uint32_t value)
+{
+	uint32_t sign = (value >> 16) & 0x8000;
+	uint32_t exponent = (value >> 23) & 0xff;
+	int halfExponent = (int) exponent - 112;
+	uint64_t significand = (value & 0x7fffff) | 0x800000;
+	uint64_t shifted;
+	uint32_t shift;
+	uint32_t result;
+
+	if (exponent == 0xff && (value & 0x7fffff) != 0)
+		return sign | 0x7e00 | ((value >> 13) & 0x3ff);	// NaN (quiet)
+
+	if (halfExponent >= 31)
+		return sign | 0x7c00;	// Inf or overflow
+
+	if (halfExponent > 0)
+		shift = 13;
+	else if (halfExponent < -12)
+		shift = 26;
+	else
+		shift = (uint32_t)(14 - halfExponent);
+
+	shifted = (significand << 26) >> shift;
+	result = ((uint32_t)(halfExponent > 0 ? halfExponent : 0) << 10)
+		| (uint32_t)((shifted >> 26) & 0x3ff);
+	if (((shifted >> 25) & 1) && ((shifted & 0x1ffffff) != 0 || (result & 1)))
+		result++;
+
+	return sign | result;
+}
+
 static uint32_t scalarArithmeticOp(ArithmeticOp operation, uint32_t value1, uint32_t value2)
 {
 	switch (operation)
@@ -699,6 +1135,21 @@ static uint32_t scalarArithmeticOp(ArithmeticOp operation, uint32_t value1, uint
 		case OP_ASHR:	return (uint32_t)(((int32_t)value1) >> (value2 & 31));
 		case OP_SHR: return value1 >> (value2 & 31);
 		case OP_SHL: return value1 << (value2 & 31);
+		case OP_UNORM8_F: return valueAsInt((float)((value1 >> (value2 & 31)) & 0xff) / 255.0f);
+		case OP_ADDS_U8:
+		case OP_SUBS_U8:
+		case OP_ADDS_U16:
+		case OP_SUBS_U16:
+		case OP_MULHI_U8:
+		case OP_MULHI_U16:
+			return packedArithmeticOp(operation, value1, value2);
+
+		case OP_UNPACK_U8: return (value1 >> ((value2 & 3) * 8)) & 0xff;
+		case OP_UNPACK_U16: return (value1 >> ((value2 & 1) * 16)) & 0xffff;
+		case OP_PACK_U8: return (value1 << 8) | packClamp(value2, 0xff);
+		case OP_PACK_U16: return (value1 << 16) | packClamp(value2, 0xffff);
+		case OP_HTOF: return halfToFloat((value1 >> ((value2 & 1) * 16)) & 0xffff);
+		case OP_FTOH: return (value1 << 16) | floatToHalf(value2);
 		case OP_CLZ: return value2 == 0 ? 32u : (uint32_t)__builtin_clz(value2);
 		case OP_CTZ: return value2 == 0 ? 32u : (uint32_t)__builtin_ctz(value2);
 		case OP_MOVE: return value2;
@@ -724,6 +1175,7 @@ static uint32_t scalarArithmeticOp(ArithmeticOp operation, uint32_t value1, uint
 			return iresult;
 		}
 
+		case OP_RSQRT: return reciprocalSqrtEstimate(value2);
 		case OP_SEXT8: return (uint32_t)(int32_t)(int8_t)value2;
 		case OP_SEXT16: return (uint32_t)(int32_t)(int16_t)value2;
 		case OP_MULH_I: return (uint32_t) (((int64_t)(int32_t)value1 * (int64_t)(int32_t)value2) >> 32);
@@ -746,6 +1198,63 @@ static bool isCompareOp(uint32_t op)
 	return (op >= OP_CMPEQ_I && op <= OP_CMPLE_U) || (op >= OP_CMPGT_F && op <= OP_CMPNE_F);
 }
 
+static bool isReductionOp(uint32_t op)
+{
+	return op >= OP_HADD_I && op <= OP_HMAX_F;
+}
+
+// This must combine lanes in the same order as the tree in
+// int_execute_stage.sv, because the floating point forms are order dependent
+// when there are NaNs. Node n combines nodes 2n + 1 (left) and 2n (right),
+// and the lanes are the leaves. Masked off lanes don't change the result.
+static uint32_t reduceLanes(ArithmeticOp op, const uint32_t *values, uint32_t mask)
+{
+	uint32_t node[NUM_VECTOR_LANES * 2];
+	uint32_t identity;
+	int i;
+
+	switch (op)
+	{
+		case OP_HMIN_I: identity = 0x7fffffff; break;
+		case OP_HMAX_I: identity = 0x80000000; break;
+		case OP_HMIN_F: identity = 0x7f800000; break;	// +inf
+		case OP_HMAX_F: identity = 0xff800000; break;	// -inf
+		default: identity = 0;
+	}
+
+	for (i = 0; i < NUM_VECTOR_LANES; i++)
+		node[NUM_VECTOR_LANES + i] = (mask & (1 << i)) ? values[i] : identity;
+
+	for (i = NUM_VECTOR_LANES - 1; i > 0; i--)
+	{
+		uint32_t left = node[i * 2 + 1];
+		uint32_t right = node[i * 2];
+		switch (op)
+		{
+			case OP_HMIN_I:
+				node[i] = (int32_t) right < (int32_t) left ? right : left;
+				break;
+
+			case OP_HMAX_I:
+				node[i] = (int32_t) left < (int32_t) right ? right : left;
+				break;
+
+			case OP_HMIN_F:
+				node[i] = valueAsFloat(right) < valueAsFloat(left) ? right : left;
+				break;
+
+			case OP_HMAX_F:
+				node[i] = valueAsFloat(left) < valueAsFloat(right) ? right : left;
+				break;
+
+			default:
+				node[i] = left + right;
+		}
+	}
+
+	return node[1];
+}
+
 static struct Breakpoint *lookupBreakpoint(Core *core, uint32_t pc)
 {
 	struct Breakpoint *breakpoint;
@@ -782,6 +1291,64 @@ static void executeRegisterArithInst(Thread *thread, uint32_t instruction)
 		setScalarReg(thread, destreg, thread->vectorReg[op1reg][NUM_VECTOR_LANES - 1
 			- (getThreadScalarReg(thread, op2reg) & 0xf)]);
 	}
+	else if (isReductionOp(op))
+	{
+		// Only vector/vector forms. The result is scalar.
+		uint32_t mask;
+
+		switch (fmt)
+		{
+			case FMT_RA_VV:
+				mask = 0xffff;
+				break;
+
+			case FMT_RA_VV_M:
+				mask = getThreadScalarReg(thread, maskreg);
+				break;
+
+			default:
+				illegalInstruction(thread, instruction);
+				return;
+		}
+
+		TALLY_INSTRUCTION(VectorInst);
+		setScalarReg(thread, destreg, reduceLanes(op, thread->vectorReg[op2reg], mask));
+	}
+	else if (op == OP_COMPRESS)
+	{
+		// Only vector/scalar forms. The scalar operand selects the lanes to
+		// keep, which are moved to the lowest elements in order.
+		uint32_t result[NUM_VECTOR_LANES];
+		uint32_t select;
+		uint32_t mask;
+		int count = 0;
+
+		switch (fmt)
+		{
+			case FMT_RA_VS:
+				mask = 0xffff;
+				break;
+
+			case FMT_RA_VS_M:
+				mask = getThreadScalarReg(thread, maskreg);
+				break;
+
+			default:
+				illegalInstruction(thread, instruction);
+				return;
+		}
+
+		TALLY_INSTRUCTION(VectorInst);
+		select = getThreadScalarReg(thread, op2reg);
+		memset(result, 0, sizeof(result));
+		for (lane = NUM_VECTOR_LANES - 1; lane >= 0; lane--)
+		{
+			if (select & (1 << lane))
+				result[NUM_VECTOR_LANES - 1 - count++] = thread->vectorReg[op1reg][lane];
+		}
+
+		setVectorReg(thread, destreg, mask, result);
+	}
 	else if (isCompareOp(op))
 	{
 		uint32_t result = 0;
@@ -831,6 +1398,47 @@ static void executeRegisterArithInst(Thread *thread, uint32_t instruction)
 
 		setScalarReg(thread, destreg, result);
 	}
+	else if (op == OP_FMADD_F)
+	{
+		// The addend register is in the mask field, so there are no masked
+		// or scalar forms. In the vector/scalar form, the addend is a vector
+		// register. In the vector/vector form, it is a scalar register.
+		uint32_t result[NUM_VECTOR_LANES];
+
+		TALLY_INSTRUCTION(VectorInst);
+		switch (fmt)
+		{
+			case FMT_RA_VS:
+			{
+				float multiplier = valueAsFloat(getThreadScalarReg(thread, op2reg));
+				for (lane = 0; lane < NUM_VECTOR_LANES; lane++)
+				{
+					result[lane] = valueAsInt(fmaf(valueAsFloat(thread->vectorReg[op1reg][lane]),
+						multiplier, valueAsFloat(thread->vectorReg[maskreg][lane])));
+				}
+
+				break;
+			}
+
+			case FMT_RA_VV:
+			{
+				float addend = valueAsFloat(getThreadScalarReg(thread, maskreg));
+				for (lane = 0; lane < NUM_VECTOR_LANES; lane++)
+				{
+					result[lane] = valueAsInt(fmaf(valueAsFloat(thread->vectorReg[op1reg][lane]),
+						valueAsFloat(thread->vectorReg[op2reg][lane]), addend));
+				}
+
+				break;
+			}
+
+			default:
+				illegalInstruction(thread, instruction);
+				return;
+		}
+
+		setVectorReg(thread, destreg, 0xffff, result);
+	}
 	else if (fmt == FMT_RA_SS)
 	{
 		uint32_t result = scalarArithmeticOp(op, getThreadScalarReg(thread, op1reg),
@@ -1195,6 +1803,96 @@ static void executeScalarLoadStoreInst(Thread *thread, uint32_t instruction)
 	}
 }
 
+// Atomic read-modify-write. The hardware performs these in the L2 cache.
+// The offset is in bits 24:15 and the operation in bits 12:10.
+static void executeAtomicInst(Thread *thread, uint32_t instruction)
+{
+	AtomicOp op = extractUnsignedBits(instruction, 10, 3);
+	uint32_t ptrreg = extractUnsignedBits(instruction, 0, 5);
+	uint32_t offset = extractSignedBits(instruction, 15, 10);
+	uint32_t destsrcreg = extractUnsignedBits(instruction, 5, 5);
+	uint32_t virtualAddress;
+	uint32_t physicalAddress;
+	uint32_t operand;
+	uint32_t oldValue;
+	uint32_t newValue;
+
+	if (extractUnsignedBits(instruction, 29, 1))
+	{
+		illegalInstruction(thread, instruction);	// Store only
+		return;
+	}
+
+	virtualAddress = getThreadScalarReg(thread, ptrreg) + offset;
+	if ((virtualAddress & 3) != 0)
+	{
+		memoryAccessFault(thread, virtualAddress, FR_DATA_ALIGNMENT, false);
+		return;
+	}
+
+	if (!translateAddress(thread, virtualAddress, &physicalAddress, true, true))
+		return;
+
+	if ((physicalAddress & 0xffff0000) == 0xffff0000)
+	{
+		// This is not an actual CPU fault, but a debugging aid in the emulator.
+		printf("Invalid device access %08x, pc %08x\n", virtualAddress, thread->currentPc - 4);
+		printThreadRegisters(thread);
+		thread->core->crashed = true;
+		return;
+	}
+
+	operand = getThreadScalarReg(thread, destsrcreg);
+	oldValue = *UINT32_PTR(thread->core->memory, physicalAddress);
+	switch (op)
+	{
+		case ATOMIC_ADD:
+			newValue = oldValue + operand;
+			break;
+
+		case ATOMIC_AND:
+			newValue = oldValue & operand;
+			break;
+
+		case ATOMIC_OR:
+			newValue = oldValue | operand;
+			break;
+
+		case ATOMIC_XOR:
+			newValue = oldValue ^ operand;
+			break;
+
+		case ATOMIC_XCHG:
+			newValue = operand;
+			break;
+
+		case ATOMIC_MIN:
+			newValue = (int32_t) operand < (int32_t) oldValue ? operand : oldValue;
+			break;
+
+		case ATOMIC_MAX:
+			newValue = (int32_t) operand > (int32_t) oldValue ? operand : oldValue;
+			break;
+
+		default:
+			illegalInstruction(thread, instruction);
+			return;
+	}
+
+	*UINT32_PTR(thread->core->memory, physicalAddress) = newValue;
+	invalidateSyncAddress(thread->core, physicalAddress);
+	if (thread->core->enableTracing)
+	{
+		printf("%08x [th %d] atomic %d %08x %08x -> %08x\n", thread->currentPc - 4,
+			thread->id, op, virtualAddress, oldValue, newValue);
+	}
+
+	// Like a synchronized store, this has two side effects, but cosim can only
+	// track one. The hardware logs the old value that is written back to the
+	// register, so setScalarReg logs that and the memory write isn't logged.
+	setScalarReg(thread, destsrcreg, oldValue);
+}
+
 static void executeBlockLoadStoreInst(Thread *thread, uint32_t instruction)
 {
 	uint32_t op = extractUnsignedBits(instruction, 25, 4);
@@ -1219,6 +1917,19 @@ static void executeBlockLoadStoreInst(Thread *thread, uint32_t instruction)
 			offset = extractSignedBits(instruction, 10, 15);
 			break;
 
+		case MEM_BLOCK_VECTOR_NO_ALLOCATE:
+			// This is only a hint to the cache, so it behaves like a normal
+			// block store.
+			if (isLoad)
+			{
+				illegalInstruction(thread, instruction);
+				return;
+			}
+
+			mask = 0xffff;
+			offset = extractSignedBits(instruction, 10, 15);
+			break;
+
 		case MEM_BLOCK_VECTOR_MASK:
 			mask = getThreadScalarReg(thread, maskreg);
 			offset = extractSignedBits(instruction, 15, 10);
@@ -1290,6 +2001,10 @@ static void executeScatterGatherInst(Thread *thread, uint32_t instruction)
 	uint32_t mask;
 	uint32_t virtualAddress;
 	uint32_t physicalAddress;
+	uint32_t subcycle;
+	uint32_t endSubcycle;
+	uint32_t accessMask;
+	bool coalesce = false;
 
 	TALLY_INSTRUCTION(VectorInst);
 
@@ -1310,6 +2025,11 @@ static void executeScatterGatherInst(Thread *thread, uint32_t instruction)
 			assert(0);
 	}
 
+	// Lanes already accessed by an earlier subcycle are treated like they
+	// are masked off.
+	if (thread->currentSubcycle != 0)
+		mask &= ~thread->scgathDoneMask;
+
 	lane = NUM_VECTOR_LANES - 1 - thread->currentSubcycle;
 	virtualAddress = thread->vectorReg[ptrreg][lane] + offset;
 	if ((mask & (1 << lane)) && (virtualAddress & 3) != 0)
@@ -1321,16 +2041,92 @@ static void executeScatterGatherInst(Thread *thread, uint32_t instruction)
 	if (!translateAddress(thread, virtualAddress, &physicalAddress, true, !isLoad))
 		return;
 
+	// Find all later lanes in the same cache line. If enough of the remaining
+	// subcycles won't need another access, service them now and skip ahead to
+	// the first pending one, as the hardware does.
+	accessMask = mask & (1 << lane);
+	endSubcycle = thread->currentSubcycle + 1;
+	if (mask & (1 << lane))
+	{
+		uint32_t lineMask = 1 << lane;
+		uint32_t pendingCount = 0;
+		uint32_t resumeSubcycle = NUM_VECTOR_LANES;
+
+		for (subcycle = thread->currentSubcycle + 1; subcycle < NUM_VECTOR_LANES; subcycle++)
+		{
+			uint32_t otherLane = NUM_VECTOR_LANES - 1 - subcycle;
+			uint32_t otherAddress = thread->vectorReg[ptrreg][otherLane] + offset;
+			if ((mask & (1 << otherLane)) == 0)
+				continue;
+
+			if ((otherAddress & ~CACHE_LINE_MASK) == (virtualAddress & ~CACHE_LINE_MASK)
+				&& (otherAddress & 3) == 0)
+			{
+				lineMask |= 1 << otherLane;
+			}
+			else
+			{
+				if (pendingCount++ == 0)
+					resumeSubcycle = subcycle;
+			}
+		}
+
+		if (NUM_VECTOR_LANES - thread->currentSubcycle - pendingCount >= SCGATH_COALESCE_MIN_LANES)
+		{
+			coalesce = true;
+			accessMask = lineMask;
+			endSubcycle = resumeSubcycle;
+			thread->scgathDoneMask = (thread->currentSubcycle == 0 ? 0 : thread->scgathDoneMask)
+				| lineMask;
+		}
+	}
+
 	if (isLoad)
 	{
 		uint32_t loadValue[NUM_VECTOR_LANES];
+
 		memset(loadValue, 0, NUM_VECTOR_LANES * sizeof(uint32_t));
-		if (mask & (1 << lane))
-			loadValue[lane] = *UINT32_PTR(thread->core->memory, physicalAddress);
+		for (lane = 0; lane < NUM_VECTOR_LANES; lane++)
+		{
+			if (accessMask & (1 << lane))
+			{
+				uint32_t laneAddress = (physicalAddress & ~CACHE_LINE_MASK)
+					| ((thread->vectorReg[ptrreg][lane] + offset) & CACHE_LINE_MASK);
+				loadValue[lane] = *UINT32_PTR(thread->core->memory, laneAddress);
+			}
+		}
+
+		setVectorReg(thread, destsrcreg, accessMask, loadValue);
+	}
+	else if (coalesce)
+	{
+		// Coalesced scatter. This is a single store to the cache line, laid out
+		// like a block store. If two lanes write the same word, the later
+		// subcycle (lower lane) wins.
+		uint32_t storeValue[NUM_VECTOR_LANES];
+		uint32_t storeMask = 0;
+
+		memset(storeValue, 0, NUM_VECTOR_LANES * sizeof(uint32_t));
+		for (subcycle = thread->currentSubcycle; subcycle < NUM_VECTOR_LANES; subcycle++)
+		{
+			lane = NUM_VECTOR_LANES - 1 - subcycle;
+			if (accessMask & (1 << lane))
+			{
+				uint32_t lineOffset = (thread->vectorReg[ptrreg][lane] + offset) & CACHE_LINE_MASK;
+				uint32_t blockLane = NUM_VECTOR_LANES - 1 - lineOffset / 4;
 
-		setVectorReg(thread, destsrcreg, mask & (1 << lane), loadValue);
+				storeValue[blockLane] = thread->vectorReg[destsrcreg][lane];
+				storeMask |= 1 << blockLane;
+				*UINT32_PTR(thread->core->memory, (physicalAddress & ~CACHE_LINE_MASK) | lineOffset)
+					= thread->vectorReg[destsrcreg][lane];
+			}
+		}
+
+		invalidateSyncAddress(thread->core, physicalAddress);
+		if (thread->core->cosimEnable)
+			cosimWriteBlock(thread->core, thread->currentPc - 4, virtualAddress, storeMask, storeValue);
 	}
-	else if (mask & (1 << lane))
+	else if (accessMask)
 	{
 		*UINT32_PTR(thread->core->memory, physicalAddress)
 			= thread->vectorReg[destsrcreg][lane];
@@ -1342,10 +2138,104 @@ static void executeScatterGatherInst(Thread *thread, uint32_t instruction)
 		}
 	}
 
-	if (++thread->currentSubcycle == NUM_VECTOR_LANES)
+	if (endSubcycle == NUM_VECTOR_LANES)
+	{
+		// Finish
+		thread->currentSubcycle = 0;
+		thread->scgathDoneMask = 0;
+	}
+	else
+	{
+		thread->currentSubcycle = endSubcycle;
+		thread->currentPc -= 4;	// repeat current instruction
+	}
+}
+
+// Bilinear filtered texture sample, one lane per subcycle. Bits 23-0 of the u
+// and v coordinates are the fraction of the texture width/height and bits
+// 27-24 are log2 of the width/height. The texture is rows of packed 32 bit
+// texels starting at the base address. This reads the four texels around the
+// sample position, wrapping at the right and bottom edges, and writes each 8
+// bit channel weighted by the 8 bit fractional position. This must match the
+// hardware exactly.
+static void executeTextureSampleInst(Thread *thread, uint32_t instruction)
+{
+	uint32_t ureg = extractUnsignedBits(instruction, 0, 5);
+	uint32_t destreg = extractUnsignedBits(instruction, 5, 5);
+	uint32_t maskreg = extractUnsignedBits(instruction, 10, 5);
+	uint32_t basereg = extractUnsignedBits(instruction, 15, 5);
+	uint32_t vreg = extractUnsignedBits(instruction, 20, 5);
+	uint32_t mask = getThreadScalarReg(thread, maskreg);
+	uint32_t lane = NUM_VECTOR_LANES - 1 - thread->currentSubcycle;
+	uint32_t u = thread->vectorReg[ureg][lane];
+	uint32_t v = thread->vectorReg[vreg][lane];
+	uint32_t widthBits = (u >> 24) & 15;
+	uint32_t heightBits = (v >> 24) & 15;
+	uint32_t uFixed = (u & 0xffffff) >> (16 - widthBits);
+	uint32_t vFixed = (v & 0xffffff) >> (16 - heightBits);
+	uint32_t x[2];
+	uint32_t y[2];
+	uint32_t weight[4];
+	uint32_t texelAddress[4];
+	uint32_t texelValue[4];
+	uint32_t result[NUM_VECTOR_LANES];
+	uint32_t physicalAddress;
+	uint32_t texel;
+	uint32_t channel;
+
+	TALLY_INSTRUCTION(VectorInst);
+
+	x[0] = uFixed >> 8;
+	x[1] = (x[0] + 1) & ((1 << widthBits) - 1);
+	y[0] = vFixed >> 8;
+	y[1] = (y[0] + 1) & ((1 << heightBits) - 1);
+	weight[0] = (256 - (uFixed & 0xff)) * (256 - (vFixed & 0xff));
+	weight[1] = (uFixed & 0xff) * (256 - (vFixed & 0xff));
+	weight[2] = (256 - (uFixed & 0xff)) * (vFixed & 0xff);
+	weight[3] = (uFixed & 0xff) * (vFixed & 0xff);
+	for (texel = 0; texel < 4; texel++)
+	{
+		texelAddress[texel] = getThreadScalarReg(thread, basereg)
+			+ (((y[texel / 2] << widthBits) | x[texel % 2]) << 2);
+	}
+
+	memset(result, 0, NUM_VECTOR_LANES * sizeof(uint32_t));
+	if (mask & (1 << lane))
+	{
+		// All texels have the same alignment. The hardware reads them in
+		// order, so the first one that doesn't translate faults.
+		if ((texelAddress[0] & 3) != 0)
+		{
+			memoryAccessFault(thread, texelAddress[0], FR_DATA_ALIGNMENT, true);
+			return;
+		}
+
+		for (texel = 0; texel < 4; texel++)
+		{
+			if (!translateAddress(thread, texelAddress[texel], &physicalAddress, true, false))
+				return;
+
+			texelValue[texel] = *UINT32_PTR(thread->core->memory, physicalAddress);
+		}
+
+		for (channel = 0; channel < 32; channel += 8)
+		{
+			uint32_t sum = 32768;
+			for (texel = 0; texel < 4; texel++)
+				sum += ((texelValue[texel] >> channel) & 0xff) * weight[texel];
+
+			result[lane] |= ((sum >> 16) & 0xff) << channel;
+		}
+	}
+
+	setVectorReg(thread, destreg, mask & (1 << lane), result);
+	if (thread->currentSubcycle == NUM_VECTOR_LANES - 1)
 		thread->currentSubcycle = 0;	// Finish
 	else
+	{
+		thread->currentSubcycle++;
 		thread->currentPc -= 4;	// repeat current instruction
+	}
 }
 
 static void executeControlRegisterInst(Thread *thread, uint32_t instruction)
@@ -1420,6 +2310,10 @@ static void executeControlRegisterInst(Thread *thread, uint32_t instruction)
 			case CR_SUBCYCLE:
 				value = thread->faultSubcycle;
 				break;
+
+			case CR_THREAD_PRIORITY:
+				value = thread->priority;
+				break;
 		}
 
 		setScalarReg(thread, dstSrcReg, value);
@@ -1477,6 +2371,12 @@ static void executeControlRegisterInst(Thread *thread, uint32_t instruction)
 			case CR_SUBCYCLE:
 				thread->faultSubcycle = value;
 				break;
+
+			case CR_THREAD_PRIORITY:
+				// Only affects the order the hardware issues instructions,
+				// which the emulator doesn't model.
+				thread->priority = value & 3;
+				break;
 		}
 	}
 }
@@ -1509,14 +2409,29 @@ static void executeMemoryAccessInst(Thread *thread, uint32_t instruction)
 
 		case MEM_BLOCK_VECTOR:
 		case MEM_BLOCK_VECTOR_MASK:
+		case MEM_BLOCK_VECTOR_NO_ALLOCATE:
 			executeBlockLoadStoreInst(thread, instruction);
 			break;
 
+		case MEM_ATOMIC:
+			executeAtomicInst(thread, instruction);
+			break;
+
 		case MEM_SCGATH:
 		case MEM_SCGATH_MASK:
 			executeScatterGatherInst(thread, instruction);
 			break;
 
+		case MEM_SAMPLE:
+			if (!extractUnsignedBits(instruction, 29, 1))
+			{
+				illegalInstruction(thread, instruction);
+				return;
+			}
+
+			executeTextureSampleInst(thread, instruction);
+			break;
+
 		default:
 			illegalInstruction(thread, instruction);
 	}
@@ -1561,6 +2476,9 @@ static void executeBranchInst(Thread *thread, uint32_t instruction)
 			return; // Short circuit out, since we use register as destination.
 
 		case BRANCH_ERET:
+			// May return to the middle of a different scatter/gather
+			// instruction, so it will access the remaining lanes again.
+			thread->scgathDoneMask = 0;
 			if (!thread->enableSupervisor)
 			{
 				dispatchFault(thread, 0, FR_PRIVILEGED_OP);
@@ -1581,7 +2499,8 @@ static void executeBranchInst(Thread *thread, uint32_t instruction)
 
 static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 {
-	uint32_t op = extractUnsignedBits(instruction, 25, 3);
+	uint32_t op = extractUnsignedBits(instruction, 25, 3)
+		| (extractUnsignedBits(instruction, 14, 1) << 3);
 	uint32_t ptrReg = extractUnsignedBits(instruction, 0, 5);
 	uint32_t way;
 	bool updatedEntry;
@@ -1590,9 +2509,12 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 	{
 		case CC_DINVALIDATE:
 		case CC_DFLUSH:
+		case CC_DWAIT:
 		{
 			// This needs to fault if the TLB entry isn't present. translateAddress
-			// will do that as a side effect.
+			// will do that as a side effect. dwait is otherwise a no-op here:
+			// the hardware may wake the thread at any time (for example, on a
+			// timeout), so software always checks its condition again.
 			uint32_t offset = extractSignedBits(instruction, 15, 10);
 			uint32_t physicalAddress;
 			translateAddress(thread, getThreadScalarReg(thread, ptrReg) + offset,
@@ -1600,6 +2522,21 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 			break;
 		}
 
+		case CC_DTOUCH:
+		{
+			// This is a prefetch hint, which has no architectural effect and
+			// never faults. Update the cache model if the address is valid.
+			uint32_t offset = extractSignedBits(instruction, 15, 10);
+			uint32_t physicalAddress;
+			if (thread->core->trackCacheLines && probeDataTranslation(thread,
+				getThreadScalarReg(thread, ptrReg) + offset, &physicalAddress))
+			{
+				touchCacheLine(thread->core, physicalAddress);
+			}
+
+			break;
+		}
+
 		case CC_DTLB_INSERT:
 		case CC_ITLB_INSERT:
 		{
@@ -1607,7 +2544,8 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 			uint32_t physAddrReg = extractUnsignedBits(instruction, 5, 5);
 			uint32_t physAddrAndFlags = getThreadScalarReg(thread, physAddrReg);
 			uint32_t *wayPtr;
-			TlbEntry *tlb;
+			uint32_t numWays;
+			TlbEntry *entry;
 
 			if (!thread->enableSupervisor)
 			{
@@ -1615,20 +2553,41 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 				return;
 			}
 
-			if (op == CC_DTLB_INSERT)
+			if (physAddrAndFlags & TLB_SUPERPAGE)
 			{
-				tlb = thread->core->dtlb;
-				wayPtr = &thread->core->nextDTlbWay;
+				// Superpage entries are fully associative.
+				virtualAddress = ROUND_TO_SUPERPAGE(virtualAddress);
+				numWays = SUPERPAGE_TLB_ENTRIES;
+				if (op == CC_DTLB_INSERT)
+				{
+					entry = thread->core->dtlbSuperpages;
+					wayPtr = &thread->core->nextDTlbSuperpage;
+				}
+				else
+				{
+					entry = thread->core->itlbSuperpages;
+					wayPtr = &thread->core->nextITlbSuperpage;
+				}
 			}
 			else
 			{
-				tlb = thread->core->itlb;
-				wayPtr = &thread->core->nextITlbWay;
+				numWays = TLB_WAYS;
+				if (op == CC_DTLB_INSERT)
+				{
+					entry = thread->core->dtlb;
+					wayPtr = &thread->core->nextDTlbWay;
+				}
+				else
+				{
+					entry = thread->core->itlb;
+					wayPtr = &thread->core->nextITlbWay;
+				}
+
+				entry += ((virtualAddress / PAGE_SIZE) % TLB_SETS) * TLB_WAYS;
 			}
 
-			TlbEntry *entry = &tlb[((virtualAddress / PAGE_SIZE) % TLB_SETS) * TLB_WAYS];
 			updatedEntry = false;
-			for (way = 0; way < TLB_WAYS; way++)
+			for (way = 0; way < numWays; way++)
 			{
 				if (entry[way].virtualAddress == virtualAddress
 					&& ((entry[way].physAddrAndFlags & TLB_GLOBAL) != 0
@@ -1649,7 +2608,7 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 				entry[*wayPtr].asid = thread->currentAsid;
 			}
 
-			*wayPtr = (*wayPtr + 1) % TLB_WAYS;
+			*wayPtr = (*wayPtr + 1) % numWays;
 			break;
 		}
 
@@ -1668,6 +2627,16 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 					thread->core->dtlb[tlbIndex + way].virtualAddress = 0xffffffffu;
 			}
 
+			// Also remove a superpage that contains this address
+			for (way = 0; way < SUPERPAGE_TLB_ENTRIES; way++)
+			{
+				if (thread->core->itlbSuperpages[way].virtualAddress == ROUND_TO_SUPERPAGE(virtualAddress))
+					thread->core->itlbSuperpages[way].virtualAddress = 0xffffffffu;
+
+				if (thread->core->dtlbSuperpages[way].virtualAddress == ROUND_TO_SUPERPAGE(virtualAddress))
+					thread->core->dtlbSuperpages[way].virtualAddress = 0xffffffffu;
+			}
+
 			break;
 		}
 
@@ -1682,6 +2651,12 @@ static void executeCacheControlInst(Thread *thread, uint32_t instruction)
 				thread->core->dtlb[i].virtualAddress = 0xffffffffu;
 			}
 
+			for (i = 0; i < SUPERPAGE_TLB_ENTRIES; i++)
+			{
+				thread->core->itlbSuperpages[i].virtualAddress = 0xffffffffu;
+				thread->core->dtlbSuperpages[i].virtualAddress = 0xffffffffu;
+			}
+
 			break;
 		}
 	}
@@ -1692,6 +2667,8 @@ static int executeInstruction(Thread *thread)
 	uint32_t instruction;
 	uint32_t physicalPc;
 
+	thread->stoppedOnBreakpoint = false;
+
 	// Check PC alignment
 	if ((thread->currentPc & 3) != 0)
 	{
@@ -1732,6 +2709,7 @@ restart:
 			{
 				// Hit a breakpoint
 				breakpoint->restart = true;
+				thread->stoppedOnBreakpoint = true;
 				return 0;
 			}
 		}
@@ -24,12 +24,15 @@
 #define TLB_WRITE_ENABLE 2
 #define TLB_SUPERVISOR 8
 #define TLB_GLOBAL 16
+#define TLB_SUPERPAGE 32
 
 enum _ArithmeticOp
 {
 	OP_OR = 0,
 	OP_AND = 1,
+	OP_UNORM8_F = 2,
 	OP_XOR = 3,
+	OP_RSQRT = 4,
 	OP_ADD_I = 5,
 	OP_SUB_I = 6,
 	OP_MULL_I = 7,
@@ -60,13 +63,32 @@ enum _ArithmeticOp
 	OP_ADD_F = 32,
 	OP_SUB_F = 33,
 	OP_MUL_F = 34,
+	OP_FMADD_F = 35,
+	OP_ADDS_U8 = 36,
+	OP_SUBS_U8 = 37,
+	OP_ADDS_U16 = 38,
+	OP_SUBS_U16 = 39,
+	OP_MULHI_U8 = 40,
+	OP_MULHI_U16 = 41,
 	OP_ITOF	= 42,
+	OP_UNPACK_U8 = 43,
 	OP_CMPGT_F = 44,
 	OP_CMPGE_F = 45,
 	OP_CMPLT_F = 46,
 	OP_CMPLE_F = 47,
 	OP_CMPEQ_F = 48,
 	OP_CMPNE_F = 49,
+	OP_HADD_I = 50,
+	OP_HMIN_I = 51,
+	OP_HMAX_I = 52,
+	OP_HMIN_F = 53,
+	OP_HMAX_F = 54,
+	OP_COMPRESS = 55,
+	OP_UNPACK_U16 = 56,
+	OP_PACK_U8 = 57,
+	OP_PACK_U16 = 58,
+	OP_HTOF = 59,
+	OP_FTOH = 60,
 	OP_SYSCALL = 63
 };
 typedef enum _ArithmeticOp ArithmeticOp;
@@ -102,11 +124,26 @@ enum _MemoryOp
 	MEM_CONTROL_REG = 6,
 	MEM_BLOCK_VECTOR = 7,
 	MEM_BLOCK_VECTOR_MASK = 8,
+	MEM_BLOCK_VECTOR_NO_ALLOCATE = 9,	// Store only
+	MEM_ATOMIC = 10,	// Store only
+	MEM_SAMPLE = 11,	// Load only
 	MEM_SCGATH = 13,
 	MEM_SCGATH_MASK = 14
 };
 typedef enum _MemoryOp MemoryOp;
 
+enum _AtomicOp
+{
+	ATOMIC_ADD = 0,
+	ATOMIC_AND = 1,
+	ATOMIC_OR = 2,
+	ATOMIC_XOR = 3,
+	ATOMIC_XCHG = 4,
+	ATOMIC_MIN = 5,
+	ATOMIC_MAX = 6
+};
+typedef enum _AtomicOp AtomicOp;
+
 enum _BranchType
 {
 	BRANCH_ALL = 0,
@@ -133,7 +170,8 @@ enum _ControlRegister {
 	CR_CURRENT_ASID = 9,
 	CR_SCRATCHPAD0 = 11,
 	CR_SCRATCHPAD1 = 12,
-	CR_SUBCYCLE = 13
+	CR_SUBCYCLE = 13,
+	CR_THREAD_PRIORITY = 14
 };
 typedef enum _ControlRegister ControlRegister;
 
@@ -161,7 +199,10 @@ enum _CacheControlOp
 	CC_DFLUSH = 2,
 	CC_INVALIDATE_TLB = 5,
 	CC_INVALIDATE_TLB_ALL = 6,
-	CC_ITLB_INSERT = 7
+	CC_ITLB_INSERT = 7,
+	CC_DTOUCH = 10,		// Bit 3 of the operation is instruction bit 14
+	CC_DWAIT = 11,
+	CC_PAUSE = 12		// Spin loop hint, only affects thread scheduling
 };
 typedef enum _CacheControlOp CacheControlOp;
 
@@ -44,6 +44,10 @@ static void usage(void)
 	fprintf(stderr, "  -t <num> Total threads (default 4)\n");
 	fprintf(stderr, "  -c <size> Total amount of memory\n");
 	fprintf(stderr, "  -r <cycles> Refresh rate, cycles between each screen update\n");
+	fprintf(stderr, "  -s <prefix> Save architectural state to files starting with prefix when\n");
+	fprintf(stderr, "     execution stops. These can be loaded into the verilog model.\n");
+	fprintf(stderr, "  -x <pc> Stop when a thread reaches this program counter\n");
+	fprintf(stderr, "  -n <count> Stop after each thread executes count instructions\n");
 }
 
 static uint32_t parseNumArg(const char *argval)
@@ -70,6 +74,10 @@ int main(int argc, char *argv[])
 	uint32_t totalThreads = 4;
 	char *separator;
 	uint32_t memorySize = 0x1000000;
+	char *statePrefix = NULL;
+	bool stopPcEn = false;
+	uint32_t stopPc = 0;
+	uint32_t stopCount = 0x7fffffffu;
 
 	enum
 	{
@@ -86,7 +94,7 @@ int main(int argc, char *argv[])
 	setrlimit(RLIMIT_CORE, &limit);
 #endif
 
-	while ((option = getopt(argc, argv, "if:d:vm:b:t:c:r:")) != -1)
+	while ((option = getopt(argc, argv, "if:d:vm:b:t:c:r:s:x:n:")) != -1)
 	{
 		switch (option)
 		{
@@ -174,6 +182,19 @@ int main(int argc, char *argv[])
 
 				break;
 
+			case 's':
+				statePrefix = optarg;
+				break;
+
+			case 'x':
+				stopPc = parseNumArg(optarg);
+				stopPcEn = true;
+				break;
+
+			case 'n':
+				stopCount = parseNumArg(optarg);
+				break;
+
 			case '?':
 				usage();
 				return 1;
@@ -206,6 +227,12 @@ int main(int argc, char *argv[])
 			return 1;
 	}
 
+	if (statePrefix)
+		enableCacheLineTracking(core);
+
+	if (stopPcEn && setBreakpoint(core, stopPc) < 0)
+		return 1;
+
 	switch (mode)
 	{
 		case MODE_NORMAL:
@@ -215,14 +242,25 @@ int main(int argc, char *argv[])
 			setStopOnFault(core, false);
 			if (enableFbWindow)
 			{
-				while (executeInstructions(core, ALL_THREADS, gScreenRefreshRate))
+				// Update the window periodically, but still stop after
+				// stopCount instructions so the saved state is predictable.
+				while (stopCount > 0)
 				{
+					uint32_t count = stopCount < gScreenRefreshRate ? stopCount
+						: gScreenRefreshRate;
+					if (!executeInstructions(core, ALL_THREADS, count))
+						break;
+
+					stopCount -= count;
 					updateFramebuffer(core);
 					pollEvent();
 				}
 			}
 			else
-				executeInstructions(core, ALL_THREADS, 0x7fffffffu);
+				executeInstructions(core, ALL_THREADS, stopCount);
+
+			if (statePrefix && saveArchState(core, statePrefix) < 0)
+				return 1;
 
 			break;
 
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+#
+# Copyright 2026 agent
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+#
+# Create a verilog ROM that contains estimates for 1/sqrt(x) in floating point.
+# The input is the low bit of the exponent followed by the significand (with
+# an implicit leading one). The low bit of the exponent is needed because
+# the result depends on whether the exponent is even or odd. The output is
+# a normalized significand with an implicit leading one. The emulator
+# computes the same values, so any change here must also be made there.
+#
+
+import math
+import sys
+
+if len(sys.argv) != 2:
+	print('enter number of entries')
+	sys.exit(1)
+
+NUM_ENTRIES = int(sys.argv[1])
+if (NUM_ENTRIES & (NUM_ENTRIES - 1)) != 0:
+	# Must be power of two
+	print('number of entries must be power of two')
+	sys.exit(1)
+
+WIDTH = int(math.log(NUM_ENTRIES, 2))
+
+print('''
+//
+// This file is autogenerated by make_rsqrt_rom.py
+//
+
+module rsqrt_rom(
+	input [''' + str(WIDTH) + ''':0] index,
+	output logic['''  + str(WIDTH - 1) + ''':0] rsqrt_estimate);
+
+	always_comb
+	begin
+		case (index)''')
+
+# Index is {exponent[0], significand}
+for exponent_odd in range(0, 2):
+	for x in range(0, NUM_ENTRIES):
+		# When the unbiased exponent is odd (biased exponent is even), shift
+		# the significand left so the exponent can be divided by two.
+		value = (1.0 + float(x) / NUM_ENTRIES) * (1.0 if exponent_odd else 2.0)
+		rsqrt = 1.0 / math.sqrt(value)
+
+		# The result is in (0.5, 1.0]. Normalize by multiplying by two. 1.0 only
+		# occurs when the input is exactly 1.0 and the truncated significand
+		# is zero.
+		estimate = int(rsqrt * NUM_ENTRIES * 2) & (NUM_ENTRIES - 1)
+		print('\t\t\t%d\'h%x: rsqrt_estimate = %d\'h%x;' % (WIDTH + 1, (exponent_odd << WIDTH) | x,
+			WIDTH, estimate))
+
+print('''\t\t\tdefault: rsqrt_estimate = %d'h0;
+\t\tendcase
+\tend
+endmodule
+''' % WIDTH)
@@ -18,13 +18,21 @@
 import java.io.*;
 
 //
-// Stores trace information.
-// XXX this could be smarter about storing data in runs and using a binary
-// search to find ranges for display.
+// Stores trace information. Consecutive events with the same values for all
+// threads are collapsed into runs, and lookups use a binary search to find
+// the run that contains an event.
+//
+// This reads either the binary statetrace.bin format that the Verilog
+// testbench writes, or the older text format, which has one comma separated
+// line per cycle.
 //
 
 class TraceModel
 {
+	public static final int kStateMask = 7;
+	public static final int kIssueFlag = 8;
+	public static final int kRollbackFlag = 16;
+
 	public TraceModel(String filename)
 	{
 		readFile(filename);
@@ -40,41 +48,57 @@ class TraceModel
 		return fNumRows;
 	}
 
+	public int getFirstCycle()
+	{
+		return fFirstCycle;
+	}
+
+	// The text format doesn't record issue or rollback flags.
+	public boolean hasIssueInfo()
+	{
+		return fHasIssueInfo;
+	}
+
 	public int getEvent(int row, int eventIndex)
 	{
-		return fRawData[eventIndex * fNumRows + row];
+		int low = 0;
+		int high = fNumRuns - 1;
+		while (low < high)
+		{
+			int mid = (low + high + 1) / 2;
+			if (fRunStart[mid] <= eventIndex)
+				low = mid;
+			else
+				high = mid - 1;
+		}
+
+		return fRunData[low * fNumRows + row];
 	}
 
-	private static final int kMaxLines = 0x100000;
+	private static final int kTraceMagic = 0x4e595354;	// 'NYST'
+	private static final int kTraceVersion = 1;
 
 	private void readFile(String filename)
 	{
 		fNumEvents = 0;
-		fNumRows = 4;	// Number of threads XXX should determine dynamically
-		fRawData = new byte[kMaxLines * fNumRows];
-		int offset = 0;
+		fNumRuns = 0;
+		fFirstCycle = 0;
 		try
 		{
-			FileInputStream fstream = new FileInputStream(filename);
-			DataInputStream in = new DataInputStream(fstream);
-			BufferedReader br = new BufferedReader(new InputStreamReader(in));
-			String line;
-			for (fNumEvents = 0; fNumEvents < kMaxLines; fNumEvents++)
+			DataInputStream in = new DataInputStream(new BufferedInputStream(
+				new FileInputStream(filename)));
+			in.mark(4);
+			if (in.readInt() == kTraceMagic)
+				readBinary(in);
+			else
 			{
-				String eventLine = br.readLine();
-				if (eventLine == null)
-					break;
-
-				String[] tokens = eventLine.split(",");
-				for (int rowIndex = 0; rowIndex < fNumRows; rowIndex++)
-				{
-					// The constant values we are assigning here correspond
-					// to colors in the array in TraceView.java.
-					fRawData[offset++] = (byte) Integer.parseInt(tokens[rowIndex]);
-				}
+				in.reset();
+				readText(new BufferedReader(new InputStreamReader(in)));
 			}
 
-			System.out.println("read " + fNumEvents + " events");
+			in.close();
+			System.out.println("read " + fNumEvents + " events (" + fNumRuns
+				+ " runs) starting at cycle " + fFirstCycle);
 		}
 		catch (Exception exc)
 		{
@@ -83,7 +107,103 @@ class TraceModel
 		}
 	}
 
-	private byte[] fRawData;
+	private void readBinary(DataInputStream in) throws IOException
+	{
+		int version = in.readUnsignedByte();
+		if (version != kTraceVersion)
+			throw new IOException("unsupported trace version " + version);
+
+		fNumRows = in.readUnsignedByte();
+		in.readUnsignedShort();	// Reserved
+		fFirstCycle = in.readInt();
+		fHasIssueInfo = true;
+		allocateRuns(1024);
+		byte[] values = new byte[fNumRows];
+		while (true)
+		{
+			int count;
+			try
+			{
+				count = in.readUnsignedShort();
+			}
+			catch (EOFException exc)
+			{
+				break;
+			}
+
+			in.readFully(values);
+			addRun(count, values);
+		}
+	}
+
+	private void readText(BufferedReader br) throws IOException
+	{
+		fNumRows = 0;
+		fHasIssueInfo = false;
+		byte[] values = null;
+		String eventLine;
+		while ((eventLine = br.readLine()) != null)
+		{
+			String[] tokens = eventLine.split(",");
+			if (values == null)
+			{
+				fNumRows = tokens.length;
+				values = new byte[fNumRows];
+				allocateRuns(1024);
+			}
+
+			for (int rowIndex = 0; rowIndex < fNumRows; rowIndex++)
+				values[rowIndex] = (byte) Integer.parseInt(tokens[rowIndex].trim());
+
+			addRun(1, values);
+		}
+	}
+
+	private void allocateRuns(int count)
+	{
+		fRunStart = new int[count];
+		fRunData = new byte[count * fNumRows];
+	}
+
+	private void addRun(int count, byte[] values)
+	{
+		// Merge with the previous run if values are unchanged
+		if (fNumRuns > 0)
+		{
+			boolean same = true;
+			for (int row = 0; row < fNumRows; row++)
+			{
+				if (fRunData[(fNumRuns - 1) * fNumRows + row] != values[row])
+				{
+					same = false;
+					break;
+				}
+			}
+
+			if (same)
+			{
+				fNumEvents += count;
+				return;
+			}
+		}
+
+		if (fNumRuns == fRunStart.length)
+		{
+			fRunStart = java.util.Arrays.copyOf(fRunStart, fNumRuns * 2);
+			fRunData = java.util.Arrays.copyOf(fRunData, fNumRuns * 2 * fNumRows);
+		}
+
+		fRunStart[fNumRuns] = fNumEvents;
+		System.arraycopy(values, 0, fRunData, fNumRuns * fNumRows, fNumRows);
+		fNumRuns++;
+		fNumEvents += count;
+	}
+
+	private int[] fRunStart;
+	private byte[] fRunData;
+	private int fNumRuns;
 	private int fNumEvents;
 	private int fNumRows;
+	private int fFirstCycle;
+	private boolean fHasIssueInfo;
 }
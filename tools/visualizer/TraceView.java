@@ -38,7 +38,8 @@ class TraceView extends JPanel
 
 		Rectangle visibleRect = getVisibleRect();
 		int firstEvent = visibleRect.x / kEventWidth;
-		int lastEvent = visibleRect.x + visibleRect.width / kEventWidth + 1;
+		int lastEvent = Math.min((visibleRect.x + visibleRect.width) / kEventWidth + 1,
+			fModel.getNumEvents());
 
 		for (int event = firstEvent; event < lastEvent; event++)
 		{
@@ -46,11 +47,17 @@ class TraceView extends JPanel
 			for (int row = 0; row < fModel.getNumRows(); row++)
 			{
 				int value = fModel.getEvent(row, event);
-				if (value == 4)
+				int state = value & TraceModel.kStateMask;
+				if (fModel.hasIssueInfo() ? (value & TraceModel.kIssueFlag) != 0 : state == 4)
 					idle = false;
 
-				g.setColor(fEventColors[value]);
+				g.setColor(fEventColors[state]);
 				g.fillRect(event * kEventWidth, row * kRowHeight, kEventWidth - 1, kRowHeight - 2);
+				if ((value & TraceModel.kRollbackFlag) != 0)
+				{
+					g.setColor(Color.white);
+					g.fillRect(event * kEventWidth, row * kRowHeight, kEventWidth - 1, 6);
+				}
 			}
 
 			if (!idle)
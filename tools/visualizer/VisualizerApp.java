@@ -23,8 +23,8 @@ import javax.swing.text.*;
 import java.io.*;
 
 //
-// Given a flat text file that contains thread states x x x x, outputted from the
-// Verilog simulation model for each cycle, display a color bar chart of the states.
+// Given a trace file that contains thread states for each cycle, written by the
+// Verilog simulation model, display a color bar chart of the states.
 //
 
 class VisualizerApp extends JPanel